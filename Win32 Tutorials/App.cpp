@@ -37,9 +37,39 @@ App::App(const std::string& commandLine) :
 	scriptCommander(TokenizeQuoted(commandLine)),
 	light(wnd.Gfx())
 {
+	Profiler::SetThreadName("Main");
 	//TestMaterialSystemLoading(wnd.Gfx());
 	//TestDynamicMeshLoading();
 	//TestDynamicConstant();
+	//TestSurfaceStreaming("Images\\brickwall.jpg");
+	//TestMipResidency();
+	//TestRectPacking();
+	//TestGaussKernel();
+	//TestBlurCostModel();
+	//TestProfiler();
+	//BenchmarkProfiler();
+	//TestGpuTimerRing();
+	//BenchmarkInstancing();
+	//TestMeshBatcher();
+	//BenchmarkMeshBatcher("Models\\Sponza\\sponza.obj", 1.0f / 20.0f);
+	//TestLightBinner();
+	//BenchmarkLightBinning();
+	//BenchmarkDepthPrepass();
+	//TestRenderGraph();
+	//TestFramePacer();
+	//TestShaderPermutations();
+	//TestShaderPack();
+	//TestAssetArchive();
+	//BenchmarkVfs();
+	//TestInputSignature();
+	//TestStaticVertexLayout();
+	//BenchmarkStaticVertexLayout();
+	//TestGeometryGenerators();
+	//BenchmarkGeometry();
+	//TestGeometryProcessor();
+	//TestInputQueues();
+	//TestBindStateAcrossFrames();
+	//BenchmarkSrvBinds(wnd.Gfx(), "Models\\Sponza\\sponza.obj", 1.0f / 20.0f);
 
 	cube.SetPos({ 4.0f,0.0f,0.0f });
 	cube2.SetPos({ 0.0f,4.0f,0.0 });
@@ -53,20 +83,23 @@ int App::Go()
 {
 	while (true)
 	{
+		//waiting before the messages keeps the input as fresh as possible when the frame starts
+		wnd.Gfx().WaitForFrame();
 		if (const auto ecode = Window::ProcessMessages()) {
 			return *ecode; //if it has a value then it means there is a WM_QUIT message.
 		}
 		DoFrame();
+		Profiler::EndFrame();
 	}
 }
 
 void App::DoFrame()
 {
+	PROFILE_ZONE("App::DoFrame");
 	auto dt = timer.Mark() * simSpeed;
 
 	wnd.Gfx().BeginFrame(bgColour);
 	wnd.Gfx().SetCamera(cam.GetMatrix());
-	light.Bind(wnd.Gfx(), cam.GetMatrix());
 
 	PollInput(dt);
 
@@ -254,6 +287,10 @@ void App::DoFrame()
 
 	modelProbe.SpawnWindow(sponza);
 	SpawnBackgroundControlWindow();
+	SpawnBindStatsWindow();
+	SpawnPacingWindow();
+	SpawnProfilerWindow();
+	fc.ShowWindows(wnd.Gfx());
 	cam.SpawnControlWindow();
 	light.SpawnControlWindow();
 
@@ -262,6 +299,11 @@ void App::DoFrame()
 
 	ShowImguiDemoWindow();
 
+	const auto& stats = wnd.Gfx().GetBindStats();
+	PROFILE_COUNTER("Draw calls", stats.drawCalls);
+	PROFILE_COUNTER("SRV binds", stats.srvBinds);
+	PROFILE_COUNTER("Bytes uploaded", stats.uploadBytes);
+
 	wnd.Gfx().EndFrame();
 	fc.Reset();
 }
@@ -276,6 +318,89 @@ void App::SpawnBackgroundControlWindow() noexcept
 	ImGui::End();
 }
 
+void App::SpawnBindStatsWindow() noexcept
+{
+	if (ImGui::Begin("Bind Stats")) {
+		const auto& stats = wnd.Gfx().GetBindStats();
+		ImGui::Text("SRV binds: %u", stats.srvBinds);
+		ImGui::Text("SRV binds skipped: %u", stats.srvBindsSkipped);
+		ImGui::Text("Draw calls: %u", stats.drawCalls);
+		ImGui::Text("Instanced jobs: %u", stats.instancedJobs);
+		ImGui::Text("Buffer binds: %u (%u skipped)", stats.bufferBinds, stats.bufferBindsSkipped);
+		ImGui::Text("Bytes uploaded: %zu", stats.uploadBytes);
+		bool instancing = wnd.Gfx().IsInstancingEnabled();
+		if (ImGui::Checkbox("Instancing", &instancing)) {
+			wnd.Gfx().EnableInstancing(instancing);
+		}
+		bool prepass = fc.IsDepthPrepassEnabled();
+		if (ImGui::Checkbox("Depth pre-pass", &prepass)) {
+			fc.EnableDepthPrepass(prepass);
+		}
+	}
+	ImGui::End();
+}
+
+void App::SpawnPacingWindow()
+{
+	if (ImGui::Begin("Frame Pacing")) {
+		auto& gfx = wnd.Gfx();
+		const auto& pacer = gfx.GetFramePacer();
+		const auto stats = pacer.GetStats();
+		ImGui::Text("Refresh: %.0fHz", pacer.GetRefreshRate());
+		ImGui::Text("Present interval: %.2fms last, %.2fms avg", stats.lastMs, stats.avgMs);
+		ImGui::Text("P95: %.2fms, max: %.2fms", stats.p95Ms, stats.maxMs);
+		ImGui::Text("Dropped: %llu of %llu", (unsigned long long)stats.dropped, (unsigned long long)stats.presents);
+		const auto& settings = gfx.GetPresentSettings();
+		bool vsync = settings.vsync;
+		if (ImGui::Checkbox(gfx.IsTearingSupported() ? "VSync (tearing when off)" : "VSync", &vsync)) {
+			gfx.SetVsync(vsync);
+		}
+		int latency = int(settings.maxFrameLatency);
+		if (ImGui::SliderInt("Max latency", &latency, 1, 3)) {
+			gfx.SetMaxFrameLatency(UINT(latency));
+		}
+		int buffers = int(settings.bufferCount);
+		if (ImGui::SliderInt("Buffers", &buffers, 2, 4)) {
+			gfx.SetBufferCount(UINT(buffers));
+		}
+	}
+	ImGui::End();
+}
+
+void App::SpawnProfilerWindow() noexcept
+{
+	if (ImGui::Begin("Profiler")) {
+		ImGui::Text("Last %u frames, %llu zones dropped", (unsigned int)std::min<uint64_t>(Profiler::GetFrameCount(), Profiler::historyFrames),
+			(unsigned long long)Profiler::GetDroppedCount());
+		if (Profiler::IsTracing()) {
+			if (ImGui::Button("Stop Trace")) {
+				Profiler::EndTrace();
+			}
+		}
+		else if (ImGui::Button("Record Trace (300 frames)")) {
+			Profiler::BeginTrace("trace.json", 300u);
+		}
+		ImGui::Columns(6);
+		for (auto label : { "Zone","Calls","Min","Avg","P95","Max" }) {
+			ImGui::Text(label);
+			ImGui::NextColumn();
+		}
+		ImGui::Separator();
+		for (const auto& s : Profiler::GetStats()) {
+			ImGui::Text("T%u %*s%s", s.thread, int(s.depth * 2u), "", s.zone->name);
+			ImGui::NextColumn();
+			ImGui::Text("%.1f", s.calls);
+			ImGui::NextColumn();
+			for (auto ms : { s.minMs,s.avgMs,s.p95Ms,s.maxMs }) {
+				ImGui::Text("%.3fms", ms);
+				ImGui::NextColumn();
+			}
+		}
+		ImGui::Columns(1);
+	}
+	ImGui::End();
+}
+
 void App::ShowImguiDemoWindow()
 {
 	if (showDemoWindow) {
@@ -22,6 +22,9 @@ private:
 	void DoFrame();
 
 	void SpawnBackgroundControlWindow() noexcept;
+	void SpawnBindStatsWindow() noexcept;
+	void SpawnPacingWindow();
+	void SpawnProfilerWindow() noexcept;
 	void ShowImguiDemoWindow();
 
 	void PollInput(float dt);
@@ -0,0 +1,241 @@
+#include "AssetArchive.h"
+#include "Lz4.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	constexpr char magic[4] = { 'R','S','A','A' };
+	constexpr size_t headerSize = 16u;
+	constexpr size_t entrySize = 40u;
+	constexpr uint64_t dataAlignment = 16u;
+	constexpr uint32_t compressedFlag = 1u;
+
+	uint64_t ReadLE(const char* p, size_t bytes) noexcept
+	{
+		uint64_t value = 0u;
+		for (size_t i = 0; i < bytes; i++)
+		{
+			value |= uint64_t(static_cast<unsigned char>(p[i])) << (8u * i);
+		}
+		return value;
+	}
+
+	void WriteLE(char* p, uint64_t value, size_t bytes) noexcept
+	{
+		for (size_t i = 0; i < bytes; i++)
+		{
+			p[i] = char(value >> (8u * i));
+		}
+	}
+}
+
+AssetArchive::AssetArchive(const char* pData, size_t size, std::shared_ptr<const void> pStorage_in)
+	:
+	pStorage(std::move(pStorage_in))
+{
+	if (size < headerSize || std::memcmp(pData, magic, 4u) != 0)
+	{
+		throw Exception(__LINE__, __FILE__, "Not an asset archive");
+	}
+	if (ReadLE(pData + 4u, 4u) != version)
+	{
+		throw Exception(__LINE__, __FILE__, "Asset archive version " + std::to_string(ReadLE(pData + 4u, 4u)) + ", expected " + std::to_string(version));
+	}
+	const auto count = size_t(ReadLE(pData + 8u, 4u));
+	if ((size - headerSize) / entrySize < count)
+	{
+		throw Exception(__LINE__, __FILE__, "Asset archive index is truncated");
+	}
+	records.reserve(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		const auto e = pData + headerSize + i * entrySize;
+		const auto nameOffset = ReadLE(e, 4u), nameSize = ReadLE(e + 4u, 4u);
+		const auto dataOffset = ReadLE(e + 8u, 8u), storedSize = ReadLE(e + 16u, 8u);
+		if (nameOffset + nameSize > size || dataOffset > size || storedSize > size - dataOffset)
+		{
+			throw Exception(__LINE__, __FILE__, "Asset archive entry " + std::to_string(i) + " is out of bounds");
+		}
+		const auto flags = uint32_t(ReadLE(e + 32u, 4u));
+		records.push_back({
+			{ pData + nameOffset,size_t(nameSize) },pData + dataOffset,storedSize,ReadLE(e + 24u, 8u),(flags & compressedFlag) != 0u
+		});
+		if (i > 0u && !(records[i - 1u].name < records[i].name))
+		{
+			throw Exception(__LINE__, __FILE__, "Asset archive index is not sorted at " + std::string(records[i].name));
+		}
+	}
+}
+
+const AssetArchive::Record* AssetArchive::Find(std::string_view path) const noexcept
+{
+	const auto i = std::lower_bound(records.begin(), records.end(), path, [](const Record& r, std::string_view path)
+	{
+		return r.name < path;
+	});
+	return i != records.end() && i->name == path ? &*i : nullptr;
+}
+
+const std::vector<AssetArchive::Record>& AssetArchive::GetRecords() const noexcept
+{
+	return records;
+}
+
+const std::shared_ptr<const void>& AssetArchive::GetStorage() const noexcept
+{
+	return pStorage;
+}
+
+std::string AssetArchive::Normalize(std::string_view path)
+{
+	std::vector<std::string> segments;
+	size_t start = 0u;
+	while (start <= path.size())
+	{
+		const auto end = std::min(path.find_first_of("/\\", start), path.size());
+		std::string segment{ path.substr(start, end - start) };
+		if (segment == "..")
+		{
+			if (!segments.empty() && segments.back() != "..")
+			{
+				segments.pop_back();
+			}
+			else
+			{
+				segments.push_back(std::move(segment));
+			}
+		}
+		else if (!segment.empty() && segment != ".")
+		{
+			for (auto& c : segment)
+			{
+				c = char(std::tolower(static_cast<unsigned char>(c)));
+			}
+			segments.push_back(std::move(segment));
+		}
+		start = end + 1u;
+	}
+	std::string normalized;
+	for (const auto& s : segments)
+	{
+		normalized += (normalized.empty() ? "" : "/") + s;
+	}
+	return normalized;
+}
+
+size_t AssetArchive::Write(const std::vector<std::string>& sources, const std::string& archivePath, bool compress)
+{
+	std::vector<std::pair<std::string, fs::path>> files;
+	for (const auto& source : sources)
+	{
+		if (fs::is_directory(source))
+		{
+			for (const auto& file : fs::recursive_directory_iterator(source))
+			{
+				if (file.is_regular_file())
+				{
+					files.emplace_back(Normalize(file.path().generic_string()), file.path());
+				}
+			}
+		}
+		else if (fs::is_regular_file(source))
+		{
+			files.emplace_back(Normalize(source), source);
+		}
+		else
+		{
+			throw Exception(__LINE__, __FILE__, "Nothing to archive at " + source);
+		}
+	}
+	std::sort(files.begin(), files.end());
+	files.erase(std::unique(files.begin(), files.end(), [](const auto& a, const auto& b)
+	{
+		return a.first == b.first;
+	}), files.end());
+
+	// the index is filled in as the data goes out, then written over its placeholder
+	std::vector<char> head(headerSize + files.size() * entrySize);
+	std::memcpy(head.data(), magic, 4u);
+	WriteLE(head.data() + 4u, version, 4u);
+	WriteLE(head.data() + 8u, files.size(), 4u);
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		WriteLE(head.data() + headerSize + i * entrySize, head.size(), 4u);
+		WriteLE(head.data() + headerSize + i * entrySize + 4u, files[i].first.size(), 4u);
+		head.insert(head.end(), files[i].first.begin(), files[i].first.end());
+	}
+	std::ofstream out(archivePath, std::ios::binary);
+	out.write(head.data(), std::streamsize(head.size()));
+	uint64_t offset = head.size();
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		std::ifstream in(files[i].second, std::ios::binary);
+		if (!in.is_open())
+		{
+			throw Exception(__LINE__, __FILE__, "Unable to read " + files[i].second.string());
+		}
+		const std::vector<char> data{ std::istreambuf_iterator<char>(in),std::istreambuf_iterator<char>() };
+		std::vector<char> packed;
+		uint32_t flags = 0u;
+		if (compress && data.size() <= UINT32_MAX)
+		{
+			packed = Lz4::Compress(data.data(), data.size());
+			if (packed.size() <= data.size() - data.size() / 8u)
+			{
+				flags |= compressedFlag;
+			}
+		}
+		const auto& stored = flags & compressedFlag ? packed : data;
+		const auto padding = (dataAlignment - offset % dataAlignment) % dataAlignment;
+		const char zeros[dataAlignment] = {};
+		out.write(zeros, std::streamsize(padding));
+		offset += padding;
+		const auto e = head.data() + headerSize + i * entrySize;
+		WriteLE(e + 8u, offset, 8u);
+		WriteLE(e + 16u, stored.size(), 8u);
+		WriteLE(e + 24u, data.size(), 8u);
+		WriteLE(e + 32u, flags, 4u);
+		out.write(stored.data(), std::streamsize(stored.size()));
+		offset += stored.size();
+	}
+	out.seekp(0);
+	out.write(head.data(), std::streamsize(headerSize + files.size() * entrySize));
+	if (!out)
+	{
+		throw Exception(__LINE__, __FILE__, "Unable to write " + archivePath);
+	}
+	return files.size();
+}
+
+AssetArchive::Exception::Exception(int line, const char* file, std::string note) noexcept
+	:
+	RedSkyException(line, file),
+	note(std::move(note))
+{}
+
+const char* AssetArchive::Exception::what() const noexcept
+{
+	std::ostringstream oss;
+	oss << RedSkyException::what() << std::endl
+		<< "[Note] " << GetNote();
+	whatBuffer = oss.str();
+	return whatBuffer.c_str();
+}
+
+const char* AssetArchive::Exception::GetType() const noexcept
+{
+	return "RedSky Asset Archive Exception";
+}
+
+const std::string& AssetArchive::Exception::GetNote() const noexcept
+{
+	return note;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "RedSkyException.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Many asset files packed into one, read in place from a memory mapping. Entries are stored
+// raw or as one LZ4 block when that saves at least an eighth, and are found by binary search
+// of a directory index sorted by normalized path. Layout, all little endian:
+//   header   'RSAA' u32 version, u32 count, u32 0
+//   index    count x { u32 nameOffset, u32 nameSize, u64 dataOffset, u64 storedSize, u64 size, u32 flags, u32 0 }
+//   names, then data with every entry 16 byte aligned
+// Offsets are from the start of the file.
+class AssetArchive
+{
+public:
+	class Exception : public RedSkyException
+	{
+	public:
+		Exception(int line, const char* file, std::string note) noexcept;
+		const char* what() const noexcept override;
+		const char* GetType() const noexcept override;
+		const std::string& GetNote() const noexcept;
+	private:
+		std::string note;
+	};
+	struct Record
+	{
+		std::string_view name;
+		const char* pStored;
+		uint64_t storedSize;
+		uint64_t size;
+		bool compressed;
+	};
+	static constexpr uint32_t version = 1u;
+public:
+	// validates an archive in memory that pStorage (if any) keeps alive, throws when malformed
+	AssetArchive(const char* pData, size_t size, std::shared_ptr<const void> pStorage = nullptr);
+	// path must be normalized, nullptr when the archive doesn't have it
+	const Record* Find(std::string_view path) const noexcept;
+	const std::vector<Record>& GetRecords() const noexcept;
+	const std::shared_ptr<const void>& GetStorage() const noexcept;
+	// the name a path has in archives: forward slashes, lower case, no . or .. segments
+	static std::string Normalize(std::string_view path);
+	// packs every file under the sources (files or directories, recursively) under the paths
+	// they were reached by, returns how many
+	static size_t Write(const std::vector<std::string>& sources, const std::string& archivePath, bool compress);
+private:
+	std::vector<Record> records;
+	std::shared_ptr<const void> pStorage;
+};
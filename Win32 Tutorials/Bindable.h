@@ -19,6 +19,16 @@ namespace Bind {
 			assert(false);
 			return "";
 		}
+		// appends what identifies the state this sets, draws whose bindables append equal keys
+		// can share one instanced draw. Defaults to the object itself, which codex sharing covers
+		virtual void AppendBatchKey(std::string& key) const noexcept {
+			const auto p = this;
+			key.append(reinterpret_cast<const char*>(&p), sizeof(p));
+		}
+		// set from the drawing drawable, left out of instanced draws where the instance buffer supplies it
+		virtual bool IsPerInstance() const noexcept {
+			return false;
+		}
 		virtual ~Bindable() = default;
 	};
 
@@ -2,6 +2,7 @@
 
 #include "Bindable.h"
 #include "BindableCodex.h"
+#include "PerformanceLog.h"
 #include <type_traits>
 #include <memory>
 #include <unordered_map>
@@ -15,8 +16,14 @@ namespace Bind
 		static std::shared_ptr<T> Resolve(Graphics& gfx, Params&&...p) noxnd
 		{
 			static_assert(std::is_base_of<Bindable, T>::value, "Can only resolve classes derived from Bindable");
+			const Profiler::Scope scope{ resolveZone };
 			return Get().Resolve_<T>(gfx, std::forward<Params>(p)...);
 		}
+		// forgets every shared bindable, so a new device can start from scratch
+		static void Clear() noexcept
+		{
+			Get().binds.clear();
+		}
 	private:
 		template<class T, typename...Params>
 		std::shared_ptr<T> Resolve_(Graphics& gfx, Params&&...p) noxnd
@@ -40,6 +47,8 @@ namespace Bind
 			return codex;
 		}
 	private:
+		// shared by every instantiation so all resolves aggregate into one zone
+		static constexpr ProfileZone resolveZone{ "Codex::Resolve",__FILE__,__LINE__ };
 		std::unordered_map<std::string, std::shared_ptr<Bindable>> binds;
 	};
 }
\ No newline at end of file
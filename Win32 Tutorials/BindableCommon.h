@@ -13,4 +13,5 @@
 #include "Blender.h"
 #include "Rasterizer.h"
 #include "Stencil.h"
-#include "NullPixelShader.h"
\ No newline at end of file
+#include "NullPixelShader.h"
+#include "InstanceBuffer.h"
\ No newline at end of file
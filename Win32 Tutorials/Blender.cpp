@@ -34,6 +34,7 @@ namespace Bind
 			}
 		}
 		GFX_THROW_INFO(GetDevice(gfx)->CreateBlendState(&blendDesc, &pBlender));
+		gfx.CountResourceCreated();
 	}
 
 	void Blender::Bind(Graphics& gfx) noexcept
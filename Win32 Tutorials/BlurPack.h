@@ -1,13 +1,33 @@
 #pragma once
 #include "BindableCommon.h"
 #include "RedSkyMath.h"
+#include "GaussKernel.h"
+#include "RenderTarget.h"
+#include "RenderGraph.h"
+#include "GpuTimer.h"
+#include "imgui/imgui.h"
+#include <algorithm>
+#include <functional>
+#include <string>
 
+// Separable gaussian blur of a render target onto the swap buffer, as render graph passes.
+// With a downsample factor above 1 the source is first halved with bilinear copies, blurred
+// at the reduced size with a proportionally smaller kernel, then stretched back up while
+// compositing.
 class BlurPack {
 public:
-	BlurPack(Graphics& gfx, int radius = 7, float sigma = 2.6f) 
-		: shader(gfx, "Blur_PS.cso"), pcb(gfx,0u), ccb(gfx,1u)
+	struct Cost {
+		// texture sample instructions and pixels shaded for one frame
+		size_t fetches;
+		size_t pixels;
+	};
+
+public:
+	BlurPack(Graphics& gfx, int radius = 7, float sigma = 2.6f, int downsampleFactor = 1) 
+		: shader(gfx, "Blur_PS.cso"), passthrough(gfx, "Fullscreen_PS.cso"), pcb(gfx,0u), ccb(gfx,1u),
+		radius(radius), sigma(sigma), sourceWidth(gfx.GetWidth()), sourceHeight(gfx.GetHeight())
 	{
-		SetKernel(gfx, radius, sigma);
+		SetDownsampleFactor(gfx, downsampleFactor);
 	}
 
 	void Bind(Graphics& gfx) noexcept {
@@ -23,35 +43,225 @@ public:
 		ccb.Update(gfx, { FALSE });
 	}
 
-	void SetKernel(Graphics& gfx, int radius, float sigma) noxnd {
-		assert(radius <= 7);
-		Kernel k;
-		k.nTaps = radius * 2 + 1;
-		float sum = 0.0f;
-		for (int i = 0; i < k.nTaps; i++) {
-			const auto x = float(i - radius);
-			const auto g = gauss(x, sigma);
-			sum += g;
-			k.coefficients[i].x = g;
+	// radius and sigma are in full resolution texels, they shrink with the downsample factor
+	void SetKernel(Graphics& gfx, int radius_in, float sigma_in) noxnd {
+		radius = radius_in;
+		sigma = sigma_in;
+		ApplyKernel(gfx);
+	}
+
+	// power of two no larger than maxDownsample, 1 blurs at full resolution
+	void SetDownsampleFactor(Graphics& gfx, int factor) {
+		assert(factor >= 1 && factor <= maxDownsample && (factor & (factor - 1)) == 0);
+		downsample = factor;
+		ApplyKernel(gfx);
+	}
+
+	// blend the blurred result over an unblurred copy of the source instead of replacing it
+	void SetBlendUpsample(bool blend) noexcept {
+		blendUpsample = blend;
+	}
+
+	// adds the downsample, blur and composite passes reading source and writing output,
+	// with their intermediate targets. bindFullscreen binds the quad (nIndices indices), its
+	// vertex shader and a linear sampler
+	void AddPasses(RenderGraph& graph, RenderGraph::ResourceId source, RenderGraph::ResourceId output,
+		std::function<void(Graphics&)> bindFullscreen, UINT nIndices, GpuTimer& timer) {
+		using Desc = RenderGraph::TextureDesc;
+		// successive halvings, each bilinear copy averages 2x2 texels of the previous level
+		auto input = source;
+		UINT width = sourceWidth;
+		UINT height = sourceHeight;
+		for (int f = 2; f <= downsample; f *= 2) {
+			width = std::max(width / 2u, 1u);
+			height = std::max(height / 2u, 1u);
+			const auto level = graph.CreateTexture("Blur 1/" + std::to_string(f), { Desc::Type::Color,width,height });
+			graph.AddPass("Blur downsample 1/" + std::to_string(f)).Read(input).Write(level)
+				.Execute([=, &timer](Graphics& gfx, const RenderGraph::Resources& res) {
+					GPU_ZONE(timer, "Downsample");
+					bindFullscreen(gfx);
+					res.GetTarget(level).BindAsTarget(gfx);
+					res.GetTarget(input).BindAsTexture(gfx, 0u);
+					passthrough.Bind(gfx);
+					gfx.DrawIndexed(nIndices);
+				});
+			input = level;
 		}
-		for (int i = 0; i < k.nTaps; i++) {
-			k.coefficients[i].x /= sum;
+
+		const auto horizontal = graph.CreateTexture("Blur horizontal", { Desc::Type::Color,width,height });
+		graph.AddPass("Blur horizontal").Read(input).Write(horizontal)
+			.Execute([=, &timer](Graphics& gfx, const RenderGraph::Resources& res) {
+				GPU_ZONE(timer, "Horizontal");
+				bindFullscreen(gfx);
+				res.GetTarget(horizontal).BindAsTarget(gfx);
+				res.GetTarget(input).BindAsTexture(gfx, 0u);
+				Bind(gfx);
+				SetHorizontal(gfx);
+				gfx.DrawIndexed(nIndices);
+			});
+
+		if (downsample == 1) {
+			auto composite = graph.AddPass("Blur vertical + composite").Read(horizontal).Write(output);
+			if (blendUpsample) {
+				composite.Read(source);
+			}
+			composite.Execute([=, &timer](Graphics& gfx, const RenderGraph::Resources& res) {
+				GPU_ZONE(timer, "Vertical + composite");
+				bindFullscreen(gfx);
+				BeginComposite(gfx, res, source, nIndices);
+				res.GetTarget(horizontal).BindAsTexture(gfx, 0u);
+				Bind(gfx);
+				SetVertical(gfx);
+				gfx.DrawIndexed(nIndices);
+				Bind::Blender::Resolve(gfx, false)->Bind(gfx);
+			});
+			return;
 		}
-		pcb.Update(gfx, k);
+
+		// same size as the last level, which is free again once the horizontal pass read it,
+		// so the graph puts both in one texture
+		const auto vertical = graph.CreateTexture("Blur vertical", { Desc::Type::Color,width,height });
+		graph.AddPass("Blur vertical").Read(horizontal).Write(vertical)
+			.Execute([=, &timer](Graphics& gfx, const RenderGraph::Resources& res) {
+				GPU_ZONE(timer, "Vertical");
+				bindFullscreen(gfx);
+				res.GetTarget(vertical).BindAsTarget(gfx);
+				res.GetTarget(horizontal).BindAsTexture(gfx, 0u);
+				Bind(gfx);
+				SetVertical(gfx);
+				gfx.DrawIndexed(nIndices);
+			});
+		auto composite = graph.AddPass("Blur upsample + composite").Read(vertical).Write(output);
+		if (blendUpsample) {
+			composite.Read(source);
+		}
+		composite.Execute([=, &timer](Graphics& gfx, const RenderGraph::Resources& res) {
+			GPU_ZONE(timer, "Upsample + composite");
+			bindFullscreen(gfx);
+			BeginComposite(gfx, res, source, nIndices);
+			res.GetTarget(vertical).BindAsTexture(gfx, 0u);
+			passthrough.Bind(gfx);
+			gfx.DrawIndexed(nIndices);
+			Bind::Blender::Resolve(gfx, false)->Bind(gfx);
+		});
+	}
+
+	int GetDownsampleFactor() const noexcept {
+		return downsample;
+	}
+	bool IsBlendUpsample() const noexcept {
+		return blendUpsample;
+	}
+
+	static Cost EstimateCost(UINT width, UINT height, int radius, float sigma, int factor, bool blendUpsample = false) {
+		Cost cost = { 0u,0u };
+		const size_t fullPixels = size_t(width) * height;
+		for (int f = 2; f <= factor; f *= 2) {
+			width = std::max(width / 2u, 1u);
+			height = std::max(height / 2u, 1u);
+			cost.fetches += size_t(width) * height;
+			cost.pixels += size_t(width) * height;
+		}
+		const GaussKernel gk{ ScaleRadius(radius, factor), sigma / float(factor) };
+		const size_t blurPixels = size_t(width) * height;
+		cost.fetches += 2u * blurPixels * gk.GetFoldedFetchCount();
+		cost.pixels += 2u * blurPixels;
+		if (factor > 1) {
+			// stretching the result back up to the swap buffer
+			cost.fetches += fullPixels;
+			cost.pixels += fullPixels;
+		}
+		if (blendUpsample) {
+			cost.fetches += fullPixels;
+			cost.pixels += fullPixels;
+		}
+		return cost;
+	}
+
+	void SpawnControlWindow(Graphics& gfx) {
+		if (ImGui::Begin("Blur")) {
+			bool kernelChanged = ImGui::SliderInt("Radius", &radius, 0, maxRadius);
+			kernelChanged = ImGui::SliderFloat("Sigma", &sigma, 0.1f, 30.0f, "%.1f", 1.5f) || kernelChanged;
+			if (kernelChanged) {
+				ApplyKernel(gfx);
+			}
+			int level = 0;
+			while ((1 << level) < downsample) {
+				level++;
+			}
+			if (ImGui::SliderInt("Downsample", &level, 0, 3, ("1/" + std::to_string(1 << level)).c_str())) {
+				SetDownsampleFactor(gfx, 1 << level);
+			}
+			ImGui::Checkbox("Blend Upsample", &blendUpsample);
+			const auto cost = EstimateCost(gfx.GetWidth(), gfx.GetHeight(), radius, sigma, downsample, blendUpsample);
+			ImGui::Text("Fetches/frame: %.2fM", float(cost.fetches) / 1000000.0f);
+			ImGui::Text("Pixels/frame: %.2fM", float(cost.pixels) / 1000000.0f);
+		}
+		ImGui::End();
 	}
 
+public:
+	// folded taps pair up texels, so 32 taps cover everything out to 62 texels from the center
+	static constexpr int maxTaps = 32;
+	static constexpr int maxRadius = (maxTaps - 1) * 2;
+	static constexpr int maxDownsample = 8;
+
 private:
 	struct Kernel {
 		int nTaps;
 		float padding[3];
-		DirectX::XMFLOAT4 coefficients[15];
+		// two (offset, weight) pairs per register, the first pair is the center tap
+		DirectX::XMFLOAT4 taps[maxTaps / 2];
 	};
 	struct Control {
 		BOOL horizontal;
 		float padding[3];
 	};
 
+private:
+	static int ScaleRadius(int radius, int factor) noexcept {
+		return radius > 0 ? std::max(radius / factor, 1) : 0;
+	}
+
+	void ApplyKernel(Graphics& gfx) noxnd {
+		assert(radius <= maxRadius);
+		const GaussKernel gk{ ScaleRadius(radius, downsample), sigma / float(downsample) };
+		const auto& taps = gk.GetFoldedTaps();
+		Kernel k = {};
+		k.nTaps = (int)taps.size();
+		for (size_t i = 0; i < taps.size(); i++) {
+			auto& reg = k.taps[i / 2];
+			if (i % 2 == 0) {
+				reg.x = taps[i].offset;
+				reg.y = taps[i].weight;
+			}
+			else {
+				reg.z = taps[i].offset;
+				reg.w = taps[i].weight;
+			}
+		}
+		pcb.Update(gfx, k);
+	}
+
+	void BeginComposite(Graphics& gfx, const RenderGraph::Resources& res, RenderGraph::ResourceId source, UINT nIndices) noxnd {
+		gfx.BindSwapBuffer();
+		if (blendUpsample) {
+			res.GetTarget(source).BindAsTexture(gfx, 0u);
+			passthrough.Bind(gfx);
+			gfx.DrawIndexed(nIndices);
+			Bind::Blender::Resolve(gfx, true)->Bind(gfx);
+		}
+	}
+
+private:
 	Bind::PixelShader shader;
+	Bind::PixelShader passthrough;
 	Bind::PixelConstantBuffer<Kernel> pcb;
 	Bind::PixelConstantBuffer<Control> ccb;
+	int radius;
+	float sigma;
+	int downsample = 1;
+	bool blendUpsample = false;
+	UINT sourceWidth;
+	UINT sourceHeight;
 };
\ No newline at end of file
@@ -4,7 +4,9 @@ SamplerState splr;
 cbuffer Kernel
 {
     uint nTaps;
-    float coefficients[15];
+    // two (offset, weight) pairs per register, taps[0].xy is the center tap and the
+    // rest are folded pairs sampled between texels so linear filtering blends them
+    float4 taps[16];
 };
 
 cbuffer Control
@@ -16,26 +18,23 @@ float4 main(float2 uv : Texcoord) : SV_TARGET
 {
     uint width, height;
     tex.GetDimensions(width, height);
-    float dx, dy;
+    float2 texel;
     if (horizontal)
     {
-        dx = 1.0f / width;
-        dy = 0.0f;
+        texel = float2(1.0f / width, 0.0f);
     }
     else
     {
-        dx = 0.0f;
-        dy = 1.0f / height;
+        texel = float2(0.0f, 1.0f / height);
     }
-    const int r = nTaps / 2;
     
-    float4 acc = { 0.0f, 0.0f, 0.0f, 0.0f };
-    for (int i = -r; i <= r; i++)
+    float4 acc = tex.Sample(splr, uv) * taps[0].y;
+    for (uint i = 1; i < nTaps; i++)
     {
-        const float2 tc = uv + float2(dx * i, dy * i);
-        const float4 s = tex.Sample(splr, tc).rgba;
-        const float coef = coefficients[i + r];
-        acc += s * coef;
+        const float4 pair = taps[i / 2];
+        const float2 tap = (i % 2 == 0) ? pair.xy : pair.zw;
+        const float2 offset = texel * tap.x;
+        acc += (tex.Sample(splr, uv + offset) + tex.Sample(splr, uv - offset)) * tap.y;
     }
     return acc;
 }
\ No newline at end of file
@@ -75,3 +75,10 @@ DirectX::XMFLOAT3 Camera::GetPos() const noexcept
 {
 	return pos;
 }
+
+void Camera::SetPose(DirectX::XMFLOAT3 pos_in, float pitch_in, float yaw_in) noexcept
+{
+	pos = pos_in;
+	pitch = std::clamp(pitch_in, 0.995f * -PI / 2.0f, 0.995f * PI / 2.0f);
+	yaw = wrap_angle(yaw_in);
+}
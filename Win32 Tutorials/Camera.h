@@ -12,6 +12,7 @@ public:
 
 	void Rotate(float dx, float dy) noexcept;
 	void Translate(DirectX::XMFLOAT3 translation) noexcept;
+	void SetPose(DirectX::XMFLOAT3 pos_in, float pitch_in, float yaw_in) noexcept;
 
 	DirectX::XMFLOAT3 GetPos() const noexcept;
 private:
@@ -0,0 +1,62 @@
+#include "CameraPath.h"
+#include "RedSkyMath.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace dx = DirectX;
+
+CameraPath::CameraPath(std::vector<Key> keys_in)
+	:
+	keys(std::move(keys_in))
+{
+	assert(!keys.empty());
+}
+
+CameraPath::Key CameraPath::Sample(float t) const noexcept
+{
+	if (keys.size() == 1u)
+	{
+		return keys.front();
+	}
+	const float segments = float(keys.size() - 1u);
+	const float x = std::clamp(t, 0.0f, 1.0f) * segments;
+	const auto i = std::min(size_t(x), keys.size() - 2u);
+	const float s = x - float(i);
+
+	// end keys are repeated so the spline still passes through them
+	const auto& k0 = keys[i > 0u ? i - 1u : 0u];
+	const auto& k1 = keys[i];
+	const auto& k2 = keys[i + 1u];
+	const auto& k3 = keys[std::min(i + 2u, keys.size() - 1u)];
+
+	Key k;
+	dx::XMStoreFloat3(&k.pos, dx::XMVectorCatmullRom(
+		dx::XMLoadFloat3(&k0.pos), dx::XMLoadFloat3(&k1.pos),
+		dx::XMLoadFloat3(&k2.pos), dx::XMLoadFloat3(&k3.pos), s
+	));
+	k.pitch = k1.pitch + (k2.pitch - k1.pitch) * s;
+	k.yaw = k1.yaw + (k2.yaw - k1.yaw) * s;
+	return k;
+}
+
+const std::vector<CameraPath::Key>& CameraPath::GetKeys() const noexcept
+{
+	return keys;
+}
+
+CameraPath CameraPath::MakeOrbit(DirectX::XMFLOAT3 center, float radius, float height, unsigned int keyCount)
+{
+	std::vector<Key> keys;
+	for (unsigned int i = 0; i <= keyCount; i++)
+	{
+		const float angle = 2.0f * PI * float(i) / float(keyCount);
+		Key k;
+		k.pos = { center.x - radius * std::sin(angle),center.y + height,center.z - radius * std::cos(angle) };
+		// forward is +z turned by yaw and tipped down by positive pitch
+		k.pitch = std::atan2(height, radius);
+		k.yaw = angle;
+		keys.push_back(k);
+	}
+	return { std::move(keys) };
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+
+// Camera flight through keyframes, positions follow a catmull-rom spline through every key
+// and the angles are interpolated linearly. Sampled by normalized time so the same path
+// covers any number of frames, which keeps benchmark runs reproducible.
+class CameraPath
+{
+public:
+	struct Key
+	{
+		DirectX::XMFLOAT3 pos;
+		// radians, yaw is not wrapped between keys so turns can go past +-pi
+		float pitch;
+		float yaw;
+	};
+public:
+	CameraPath(std::vector<Key> keys);
+	// t in [0,1], keys are spaced evenly in time
+	Key Sample(float t) const noexcept;
+	const std::vector<Key>& GetKeys() const noexcept;
+	// closed loop of keys on a circle around center, always facing it
+	static CameraPath MakeOrbit(DirectX::XMFLOAT3 center, float radius, float height, unsigned int keyCount = 8u);
+private:
+	std::vector<Key> keys;
+};
@@ -21,6 +21,7 @@ namespace Bind
 			));
 			memcpy(msr.pData, &consts, sizeof(consts));
 			GetContext(gfx)->Unmap(pConstantBuffer.Get(), 0u);
+			gfx.CountConstantBufferUpload(sizeof(consts));
 		}
 		ConstantBuffer(Graphics& gfx, const C& consts, UINT slot = 0u)
 			:
@@ -39,6 +40,7 @@ namespace Bind
 			D3D11_SUBRESOURCE_DATA csd = {};
 			csd.pSysMem = &consts;
 			GFX_THROW_INFO(GetDevice(gfx)->CreateBuffer(&cbd, &csd, &pConstantBuffer));
+			gfx.CountResourceCreated();
 		}
 		ConstantBuffer(Graphics& gfx, UINT slot = 0u)
 			:
@@ -54,6 +56,7 @@ namespace Bind
 			cbd.ByteWidth = sizeof(C);
 			cbd.StructureByteStride = 0u;
 			GFX_THROW_INFO(GetDevice(gfx)->CreateBuffer(&cbd, nullptr, &pConstantBuffer));
+			gfx.CountResourceCreated();
 		}
 	protected:
 		Microsoft::WRL::ComPtr<ID3D11Buffer> pConstantBuffer;
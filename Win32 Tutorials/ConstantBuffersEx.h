@@ -3,6 +3,7 @@
 #include "GraphicsThrowMacros.h"
 #include "DynamicConstant.h"
 #include "TechniqueProbe.h"
+#include <typeinfo>
 
 namespace Bind
 {
@@ -22,6 +23,7 @@ namespace Bind
 			) );
 			memcpy( msr.pData,buf.GetData(),buf.GetSizeInBytes() );
 			GetContext( gfx )->Unmap( pConstantBuffer.Get(),0u );
+			gfx.CountConstantBufferUpload( buf.GetSizeInBytes() );
 		}
 
 		virtual const Dcb::LayoutElement& GetRootLayoutElement() const noexcept = 0;
@@ -45,10 +47,12 @@ namespace Bind
 				D3D11_SUBRESOURCE_DATA csd = {};
 				csd.pSysMem = pBuf->GetData();
 				GFX_THROW_INFO( GetDevice( gfx )->CreateBuffer( &cbd,&csd,&pConstantBuffer ) );
+				gfx.CountResourceCreated();
 			}
 			else
 			{
 				GFX_THROW_INFO( GetDevice( gfx )->CreateBuffer( &cbd,nullptr,&pConstantBuffer ) );
+				gfx.CountResourceCreated();
 			}
 		}
 	protected:
@@ -109,6 +113,14 @@ namespace Bind
 				dirty = true;
 			}
 		}
+		// per drawable copies holding the same values set the same state
+		void AppendBatchKey( std::string& key ) const noexcept override
+		{
+			const auto pType = &typeid( T );
+			key.append( reinterpret_cast<const char*>( &pType ),sizeof( pType ) );
+			key.append( reinterpret_cast<const char*>( &this->slot ),sizeof( this->slot ) );
+			key.append( buf.GetData(),buf.GetSizeInBytes() );
+		}
 	private:
 		bool dirty = false;
 		Dcb::Buffer buf;
@@ -20,6 +20,7 @@ DepthStencil::DepthStencil(Graphics& gfx, UINT width, UINT height)
 	descDepth.Usage = D3D11_USAGE_DEFAULT;
 	descDepth.BindFlags = D3D11_BIND_DEPTH_STENCIL;
 	GFX_THROW_INFO(GetDevice(gfx)->CreateTexture2D(&descDepth, nullptr, &pDepthStencil));
+	gfx.CountResourceCreated();
 
 	// create target view of depth stencil texture
 	GFX_THROW_INFO(GetDevice(gfx)->CreateDepthStencilView(
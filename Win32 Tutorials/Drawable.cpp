@@ -4,6 +4,7 @@
 #include "BindableCodex.h"
 #include <assimp/scene.h>
 #include "Material.h"
+#include "IndexedTriangleList.h"
 
 using namespace Bind;
 
@@ -20,14 +21,124 @@ Drawable::Drawable(Graphics& gfx, const Material& mat, const aiMesh& mesh, float
 {
 	pVertices = mat.MakeVertexBindable(gfx, mesh, scale);
 	pIndices = mat.MakeIndexBindable(gfx, mesh);
+	InitializeFromMesh(gfx, mat, mesh, scale);
+}
+
+Drawable::Drawable(Graphics& gfx, const Material& mat, const aiMesh& mesh, float scale, SharedGeometry geometry) noexcept
+	:
+	pIndices(std::move(geometry.pIndices)),
+	pVertices(std::move(geometry.pVertices)),
+	sharedGeometry(true),
+	startIndex(geometry.startIndex),
+	indexCount(geometry.indexCount),
+	baseVertex(geometry.baseVertex)
+{
+	InitializeFromMesh(gfx, mat, mesh, scale);
+}
+
+void Drawable::InitializeFromMesh(Graphics& gfx, const Material& mat, const aiMesh& mesh, float scale) noexcept
+{
 	pTopology = Bind::Topology::Resolve(gfx);
 
+	// bounds and average uv density feed texture mip residency
+	if (mesh.mNumVertices > 0u)
+	{
+		auto lo = mesh.mVertices[0];
+		auto hi = mesh.mVertices[0];
+		for (unsigned int i = 1; i < mesh.mNumVertices; i++)
+		{
+			const auto& v = mesh.mVertices[i];
+			lo = { std::min(lo.x,v.x),std::min(lo.y,v.y),std::min(lo.z,v.z) };
+			hi = { std::max(hi.x,v.x),std::max(hi.y,v.y),std::max(hi.z,v.z) };
+		}
+		const auto center = (lo + hi) * 0.5f;
+		boundsCenter = { center.x * scale,center.y * scale,center.z * scale };
+		boundsRadius = (hi - center).Length() * scale;
+	}
+	if (mesh.HasTextureCoords(0))
+	{
+		float worldArea = 0.0f;
+		float uvArea = 0.0f;
+		for (unsigned int i = 0; i < mesh.mNumFaces; i++)
+		{
+			const auto& face = mesh.mFaces[i];
+			if (face.mNumIndices != 3)
+			{
+				continue;
+			}
+			const auto& p0 = mesh.mVertices[face.mIndices[0]];
+			const auto& t0 = mesh.mTextureCoords[0][face.mIndices[0]];
+			const auto e1 = (mesh.mVertices[face.mIndices[1]] - p0) * scale;
+			const auto e2 = (mesh.mVertices[face.mIndices[2]] - p0) * scale;
+			const auto u1 = mesh.mTextureCoords[0][face.mIndices[1]] - t0;
+			const auto u2 = mesh.mTextureCoords[0][face.mIndices[2]] - t0;
+			worldArea += (e1 ^ e2).Length() * 0.5f;
+			uvArea += std::abs(u1.x * u2.y - u2.x * u1.y) * 0.5f;
+		}
+		if (worldArea > 0.0f && uvArea > 0.0f)
+		{
+			uvDensity = std::sqrt(uvArea / worldArea);
+		}
+	}
+
 	for (auto& t : mat.GetTechniques())
 	{
 		AddTechnique(std::move(t));
 	}
 }
 
+void Drawable::SetBounds(const IndexedTriangleList& model) noexcept
+{
+	namespace dx = DirectX;
+	using Type = rsexp::VertexLayout::ElementType;
+	const auto& verts = model.vertices;
+	if (verts.Size() == 0u)
+	{
+		return;
+	}
+	auto lo = dx::XMLoadFloat3(&verts[0].Attr<Type::Position3D>());
+	auto hi = lo;
+	for (size_t i = 1; i < verts.Size(); i++)
+	{
+		const auto v = dx::XMLoadFloat3(&verts[i].Attr<Type::Position3D>());
+		lo = dx::XMVectorMin(lo, v);
+		hi = dx::XMVectorMax(hi, v);
+	}
+	// box center, but the radius reaches the farthest vertex rather than the box corner
+	const auto center = dx::XMVectorScale(dx::XMVectorAdd(lo, hi), 0.5f);
+	dx::XMStoreFloat3(&boundsCenter, center);
+	boundsRadius = 0.0f;
+	for (size_t i = 0; i < verts.Size(); i++)
+	{
+		const auto v = dx::XMLoadFloat3(&verts[i].Attr<Type::Position3D>());
+		boundsRadius = std::max(boundsRadius, dx::XMVectorGetX(dx::XMVector3Length(dx::XMVectorSubtract(v, center))));
+	}
+
+	if (verts.GetLayout().Has(Type::Texture2D))
+	{
+		float worldArea = 0.0f;
+		float uvArea = 0.0f;
+		for (size_t i = 0; i + 2 < model.indices.size(); i += 3)
+		{
+			const auto v0 = verts[model.indices[i]];
+			const auto v1 = verts[model.indices[i + 1]];
+			const auto v2 = verts[model.indices[i + 2]];
+			const auto p0 = dx::XMLoadFloat3(&v0.Attr<Type::Position3D>());
+			const auto e1 = dx::XMVectorSubtract(dx::XMLoadFloat3(&v1.Attr<Type::Position3D>()), p0);
+			const auto e2 = dx::XMVectorSubtract(dx::XMLoadFloat3(&v2.Attr<Type::Position3D>()), p0);
+			const auto& t0 = v0.Attr<Type::Texture2D>();
+			const auto& t1 = v1.Attr<Type::Texture2D>();
+			const auto& t2 = v2.Attr<Type::Texture2D>();
+			worldArea += dx::XMVectorGetX(dx::XMVector3Length(dx::XMVector3Cross(e1, e2))) * 0.5f;
+			uvArea += std::abs((t1.x - t0.x) * (t2.y - t0.y) - (t2.x - t0.x) * (t1.y - t0.y)) * 0.5f;
+		}
+		if (worldArea > 0.0f && uvArea > 0.0f)
+		{
+			uvDensity = std::sqrt(uvArea / worldArea);
+		}
+	}
+}
+
 void Drawable::AddTechnique(Technique tech_in) noexcept
 {
 	tech_in.InitializeParentReferences(*this);
@@ -41,6 +152,17 @@ void Drawable::Bind(Graphics& gfx) const noexcept
 	pVertices->Bind(gfx);
 }
 
+void Drawable::AppendBatchKey(std::string& key) const noexcept
+{
+	pTopology->AppendBatchKey(key);
+	pIndices->AppendBatchKey(key);
+	pVertices->AppendBatchKey(key);
+	// merged meshes share buffers but not ranges
+	key.append(reinterpret_cast<const char*>(&startIndex), sizeof(startIndex));
+	key.append(reinterpret_cast<const char*>(&indexCount), sizeof(indexCount));
+	key.append(reinterpret_cast<const char*>(&baseVertex), sizeof(baseVertex));
+}
+
 void Drawable::Accept(TechniqueProbe& probe)
 {
 	for (auto& t : techniques)
@@ -51,7 +173,56 @@ void Drawable::Accept(TechniqueProbe& probe)
 
 UINT Drawable::GetIndexCount() const noxnd
 {
-	return pIndices->GetCount();
+	return sharedGeometry ? indexCount : pIndices->GetCount();
+}
+
+UINT Drawable::GetStartIndex() const noexcept
+{
+	return startIndex;
+}
+
+INT Drawable::GetBaseVertex() const noexcept
+{
+	return baseVertex;
+}
+
+float Drawable::GetScreenPixelsPerUv(Graphics& gfx) const noexcept
+{
+	namespace dx = DirectX;
+	if (uvDensity <= 0.0f)
+	{
+		return 0.0f;
+	}
+	const auto center = dx::XMVector3Transform(
+		dx::XMLoadFloat3(&boundsCenter),
+		GetTransformXM() * gfx.GetCamera()
+	);
+	// nearest point of the bounds, clamped so surfaces at the eye don't blow up
+	const float depth = std::max(dx::XMVectorGetZ(center) - boundsRadius, 0.5f);
+	const float pixelsPerWorld = dx::XMVectorGetY(gfx.GetProjection().r[1]) * float(gfx.GetHeight()) * 0.5f / depth;
+	return pixelsPerWorld / uvDensity;
+}
+
+bool Drawable::IsInView(Graphics& gfx) const noexcept
+{
+	namespace dx = DirectX;
+	if (boundsRadius <= 0.0f || !gfx.IsCullingEnabled())
+	{
+		return true;
+	}
+	dx::BoundingSphere bounds{ boundsCenter,boundsRadius };
+	bounds.Transform(bounds, GetTransformXM() * gfx.GetCamera());
+	return gfx.GetViewFrustum().Contains(bounds) != dx::DISJOINT;
+}
+
+float Drawable::GetViewDepth(Graphics& gfx) const noexcept
+{
+	namespace dx = DirectX;
+	const auto center = dx::XMVector3Transform(
+		dx::XMLoadFloat3(&boundsCenter),
+		GetTransformXM() * gfx.GetCamera()
+	);
+	return dx::XMVectorGetZ(center);
 }
 
 Drawable::~Drawable()
@@ -8,6 +8,8 @@
 class TechniqueProbe;
 class Material;
 struct aiMesh;
+template<typename Index>
+class BasicIndexedTriangleList;
 
 namespace Bind
 {
@@ -19,20 +21,55 @@ namespace Bind
 
 class Drawable
 {
+public:
+	// geometry merged with other drawables', drawn from a range of the shared buffers
+	struct SharedGeometry
+	{
+		std::shared_ptr<Bind::VertexBuffer> pVertices;
+		std::shared_ptr<Bind::IndexBuffer> pIndices;
+		UINT startIndex;
+		UINT indexCount;
+		INT baseVertex;
+	};
 public:
 	Drawable() = default;
 	Drawable(Graphics& gfx, const Material& mat, const aiMesh& mesh, float scale = 1.0f) noexcept;
+	Drawable(Graphics& gfx, const Material& mat, const aiMesh& mesh, float scale, SharedGeometry geometry) noexcept;
 	Drawable(const Drawable&) = delete;
 	void AddTechnique(Technique tech_in) noexcept;
 	virtual DirectX::XMMATRIX GetTransformXM() const noexcept = 0;
 	void Submit(class FrameCommander& frame) const noexcept;
 	void Bind(Graphics& gfx) const noexcept;
+	// identifies the geometry Bind sets, for merging draws into instanced batches
+	void AppendBatchKey(std::string& key) const noexcept;
 	void Accept(TechniqueProbe& probe);
 	UINT GetIndexCount() const noxnd;
+	UINT GetStartIndex() const noexcept;
+	INT GetBaseVertex() const noexcept;
+	// screen pixels covered by one unit of uv at this drawable's nearest point, 0 when unknown
+	float GetScreenPixelsPerUv(Graphics& gfx) const noexcept;
+	// false when the bounds are entirely outside the view frustum, drawables without bounds are always in view
+	bool IsInView(Graphics& gfx) const noexcept;
+	// view space depth of the bounds center, for ordering draws front to back
+	float GetViewDepth(Graphics& gfx) const noexcept;
 	virtual ~Drawable();
+protected:
+	// bounds and uv density from model space geometry, for drawables not built from an aiMesh
+	void SetBounds(const BasicIndexedTriangleList<unsigned short>& model) noexcept;
+private:
+	void InitializeFromMesh(Graphics& gfx, const Material& mat, const aiMesh& mesh, float scale) noexcept;
 protected:
 	std::shared_ptr<Bind::IndexBuffer> pIndices;
 	std::shared_ptr<Bind::VertexBuffer> pVertices;
 	std::shared_ptr<Bind::Topology> pTopology;
 	std::vector<Technique> techniques;
+	// range drawn from shared buffers, otherwise the whole index buffer is drawn
+	bool sharedGeometry = false;
+	UINT startIndex = 0u;
+	UINT indexCount = 0u;
+	INT baseVertex = 0;
+	// model space bounding sphere and uv units per world unit, used to pick texture mips
+	DirectX::XMFLOAT3 boundsCenter = { 0.0f,0.0f,0.0f };
+	float boundsRadius = 0.0f;
+	float uvDensity = 0.0f;
 };
\ No newline at end of file
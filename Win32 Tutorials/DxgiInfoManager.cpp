@@ -2,7 +2,7 @@
 #include "Window.h"
 #include "Graphics.h"
 #include <dxgidebug.h>
-#include <memory>
+#include <algorithm>
 
 #include "GraphicsThrowMacros.h"
 #include "WindowsThrowMacros.h"
@@ -39,20 +39,66 @@ void DxgiInfoManager::Set() noexcept
 }
 
 std::vector<std::string> DxgiInfoManager::GetMessages() const
+{
+	return Collect(DXGI_INFO_QUEUE_MESSAGE_SEVERITY_MESSAGE);
+}
+
+std::vector<std::string> DxgiInfoManager::Collect(DXGI_INFO_QUEUE_MESSAGE_SEVERITY leastSevere) const
 {
 	std::vector<std::string> messages;
 	const auto end = pDxgiInfoQueue->GetNumStoredMessages(DXGI_DEBUG_ALL);
+	//one buffer grown to the longest message, rather than an allocation per message
+	std::vector<DXGI_INFO_QUEUE_MESSAGE> storage;
 	for (auto i = next; i < end; i++) { //everything between next and the end of the queue, so everything that is inserted after the last time Set was called
 		HRESULT hr;
 		SIZE_T messageLength;
 
 		GFX_THROW_NOINFO(pDxgiInfoQueue->GetMessage(DXGI_DEBUG_ALL, i, nullptr, &messageLength)); //fills this info queue with the message and the message length
 
-		auto bytes = std::make_unique<byte[]>(messageLength); //creates enough space for the message length
-		auto pMessage = reinterpret_cast<DXGI_INFO_QUEUE_MESSAGE*>(bytes.get());
+		storage.resize(std::max(storage.size(), (messageLength + sizeof(DXGI_INFO_QUEUE_MESSAGE) - 1u) / sizeof(DXGI_INFO_QUEUE_MESSAGE)));
+		auto pMessage = storage.data();
 
 		GFX_THROW_NOINFO(pDxgiInfoQueue->GetMessage(DXGI_DEBUG_ALL, i, pMessage, &messageLength));
-		messages.emplace_back(pMessage->pDescription);
+		if (pMessage->Severity <= leastSevere) {
+			messages.emplace_back(pMessage->pDescription);
+		}
+	}
+	return messages;
+}
+
+std::vector<std::string> DxgiInfoManager::Drain(const char* context)
+{
+	if (pDxgiInfoQueue->GetNumStoredMessages(DXGI_DEBUG_ALL) == next) {
+		recorded = 0u;
+		return {};
 	}
+	//unwrapped calls get drained too, so informational chatter doesn't count
+	auto messages = Collect(DXGI_INFO_QUEUE_MESSAGE_SEVERITY_WARNING);
+	Set();
+	if (!messages.empty() && recorded != 0u) {
+		const auto kept = std::min(recorded, recentCallCount);
+		messages.push_back(std::string("Found after ") + context + ", " + std::to_string(recorded) + " calls since the last check, most recent last:");
+		for (auto i = recorded - kept; i < recorded; i++) {
+			const auto& c = recent[i % recentCallCount];
+			messages.push_back(std::string(c.file) + "(" + std::to_string(c.line) + "): " + c.call);
+		}
+	}
+	recorded = 0u;
 	return messages;
 }
+
+void DxgiInfoManager::SetBatched(bool enable) noexcept
+{
+	batched = enable;
+	//whatever was queued so far belongs to neither mode
+	Set();
+	recorded = 0u;
+}
+
+void DxgiInfoManager::ThrowIfMessages(int line, const char* file) const
+{
+	auto messages = GetMessages();
+	if (!messages.empty()) {
+		throw Graphics::InfoException(line, file, std::move(messages));
+	}
+}
@@ -2,12 +2,20 @@
 
 #include "RedSkyWin.h"
 #include <WRL.h>
+#include <array>
 #include <vector>
 #include <string>
 #include <dxgidebug.h>
 
+//Collects debug layer messages for graphics exceptions. Checking the queue after every call
+//is slow enough to make debug frames unusable, so by default wrapped calls are only recorded
+//in a small ring and the queue is drained once per pass and per frame. Messages found then
+//are reported along with the calls recorded since the last drain.
 class DxgiInfoManager
 {
+public:
+	//calls remembered for attributing messages found by Drain
+	static constexpr size_t recentCallCount = 16u;
 public:
 	DxgiInfoManager();
 	~DxgiInfoManager() = default;
@@ -15,8 +23,46 @@ public:
 	DxgiInfoManager& operator = (const DxgiInfoManager&) = delete;
 	void Set() noexcept;
 	std::vector<std::string> GetMessages() const;
+	//before a wrapped call, file and call must be string literals
+	void Begin(const char* file, int line, const char* call) noexcept
+	{
+		if (batched) {
+			recent[recorded % recentCallCount] = { file,line,call };
+			recorded++;
+		}
+		else {
+			Set();
+		}
+	}
+	//after a wrapped call that returns no HRESULT, throws in per call mode only
+	void Check(int line, const char* file) const
+	{
+		if (!batched) {
+			ThrowIfMessages(line, file);
+		}
+	}
+	//warnings and errors since the last drain followed by the calls they may have come
+	//from, empty when nothing was reported
+	std::vector<std::string> Drain(const char* context);
+	//checks the queue after every wrapped call instead, for exact attribution
+	void SetBatched(bool enable) noexcept;
+	bool IsBatched() const noexcept { return batched; }
+private:
+	struct RecentCall
+	{
+		const char* file;
+		int line;
+		const char* call;
+	};
+private:
+	//messages since next of at least the given severity (lower values are more severe)
+	std::vector<std::string> Collect(DXGI_INFO_QUEUE_MESSAGE_SEVERITY leastSevere) const;
+	void ThrowIfMessages(int line, const char* file) const;
 private:
 	unsigned long long next = 0u; //index of the last message 
 	Microsoft::WRL::ComPtr<IDXGIInfoQueue> pDxgiInfoQueue;
+	bool batched = true;
+	std::array<RecentCall, recentCallCount> recent = {};
+	//calls recorded since the last drain
+	size_t recorded = 0u;
 };
-
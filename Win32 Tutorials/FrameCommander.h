@@ -7,17 +7,20 @@
 #include "PerformanceLog.h"
 #include "DepthStencil.h"
 #include "RenderTarget.h"
+#include "RenderGraph.h"
 #include "BlurPack.h"
+#include "GpuTimer.h"
+#include "LightList.h"
+#include "TextureStreamer.h"
 #include <array>
 
 class FrameCommander
 {
 public:
 	FrameCommander(Graphics& gfx)
-		: ds(gfx, gfx.GetWidth(), gfx.GetHeight()),
-		rt1(gfx, gfx.GetWidth(), gfx.GetHeight()),
-		rt2(gfx, gfx.GetWidth(), gfx.GetHeight()),
-		blur(gfx)
+		: blur(gfx),
+		gpuTimer(gfx),
+		lights(gfx)
 	{
 		namespace dx = DirectX;
 
@@ -34,48 +37,76 @@ public:
 
 		pVsFull = Bind::VertexShader::Resolve(gfx, "Fullscreen_VS.cso");
 		pLayoutFull = Bind::InputLayout::Resolve(gfx, lay, pVsFull->GetBytecode());
-		pSamplerFull = Bind::Sampler::Resolve(gfx, false, true);
+		pSamplerFull = Bind::Sampler::Resolve(gfx, Bind::Sampler::Type::Bilinear, true);
 
-		
+		// the pre-pass draws nearest first so its own depth test rejects the most
+		passes[depthPass].SetFrontToBack(true);
+		EnableDepthPrepass(true);
+		BuildGraph(gfx);
 	}
 
 	void Accept(Job job, size_t target) noexcept
 	{
+		if (target == depthPass && !depthPrepass)
+		{
+			return;
+		}
 		passes[target].Accept(job);
 	}
+	// lays down depth for opaque geometry before the phong pass, so each of its pixels is
+	// shaded once. Without it the phong pass is sorted front to back instead
+	void EnableDepthPrepass(bool enabled) noexcept
+	{
+		depthPrepass = enabled;
+		passes[0].SetFrontToBack(!enabled);
+		graphDirty = true;
+	}
+	bool IsDepthPrepassEnabled() const noexcept
+	{
+		return depthPrepass;
+	}
 	void Execute(Graphics& gfx) noxnd
 	{
-		using namespace Bind;
-		// normally this would be a loop with each pass defining it setup / etc.
-		// and later on it would be a complex graph with parallel execution contingent
-		// on input / output requirements
-
-		ds.Clear(gfx);
-		rt1.Clear(gfx);
-		rt1.BindAsTarget(gfx, ds);
-
-		// main phong lighting pass
-		Blender::Resolve(gfx, false)->Bind(gfx);
-		Stencil::Resolve(gfx, Stencil::Mode::Off)->Bind(gfx);
-		passes[0].Execute(gfx);
-
-		rt2.BindAsTarget(gfx);
-		rt1.BindAsTexture(gfx, 0);
-
-		pVbFull->Bind(gfx);
-		pIbFull->Bind(gfx);
-		pVsFull->Bind(gfx);
-		pLayoutFull->Bind(gfx);
-		pSamplerFull->Bind(gfx);
+		PROFILE_ZONE("FrameCommander::Execute");
+		if (graphDirty || blur.GetDownsampleFactor() != graphDownsample || blur.IsBlendUpsample() != graphBlendUpsample)
+		{
+			BuildGraph(gfx);
+		}
 
-		blur.Bind(gfx);
-		blur.SetHorizontal(gfx);
-		gfx.DrawIndexed(pIbFull->GetCount());
+		gpuTimer.BeginFrame();
+		{
+			GPU_ZONE(gpuTimer, "GPU frame");
+			graph.Execute(gfx);
+		}
+		gpuTimer.EndFrame();
 
-		gfx.BindSwapBuffer();
-		rt2.BindAsTexture(gfx, 0u);
-		blur.SetVertical(gfx);
-		gfx.DrawIndexed(pIbFull->GetCount());
+		// mips requested by this frame's draws start streaming in
+		PROFILE_ZONE("Texture streaming");
+		TextureStreamer::Get()->Update(gfx);
+	}
+	size_t GetJobCount() const noexcept
+	{
+		size_t count = 0u;
+		for (const auto& p : passes)
+		{
+			count += p.GetJobCount();
+		}
+		return count;
+	}
+	void ShowWindows(Graphics& gfx)
+	{
+		blur.SpawnControlWindow(gfx);
+		graph.SpawnWindow();
+		gpuTimer.SpawnWindow();
+		lights.SpawnWindow();
+	}
+	const RenderGraph& GetGraph() const noexcept
+	{
+		return graph;
+	}
+	LightList& GetLights() noexcept
+	{
+		return lights;
 	}
 	void Reset() noexcept
 	{
@@ -83,14 +114,84 @@ public:
 		{
 			p.Reset();
 		}
+		lights.Clear();
 	}
 
 private:
-	std::array<Pass, 3> passes;
-	DepthStencil ds;
-	RenderTarget rt1;
-	RenderTarget rt2;
+	// declares the frame's passes and targets, again whenever a setting changes which run
+	void BuildGraph(Graphics& gfx)
+	{
+		using namespace Bind;
+		using Desc = RenderGraph::TextureDesc;
+		graph.Clear();
+		const auto depth = graph.CreateTexture("Depth", { Desc::Type::Depth,gfx.GetWidth(),gfx.GetHeight() });
+		const auto scene = graph.CreateTexture("Scene", { Desc::Type::Color,gfx.GetWidth(),gfx.GetHeight() });
+		const auto swap = graph.Import("Swap buffer");
+
+		// depth only, positions from each mesh's own vertex buffer and no pixel shader
+		if (depthPrepass)
+		{
+			graph.AddPass("Depth pre-pass").Write(depth)
+				.Execute([this, depth](Graphics& gfx, const RenderGraph::Resources& res)
+				{
+					GPU_ZONE(gpuTimer, "Depth pre-pass");
+					const auto& ds = res.GetDepth(depth);
+					ds.Clear(gfx);
+					ds.BindAsDepthStencil(gfx);
+					gfx.SetupViewport(int(gfx.GetWidth()), int(gfx.GetHeight()));
+					Blender::Resolve(gfx, false)->Bind(gfx);
+					Stencil::Resolve(gfx, Stencil::Mode::Off)->Bind(gfx);
+					passes[depthPass].Execute(gfx);
+				});
+		}
+
+		// main phong lighting pass, shading every light binned into each pixel's tile
+		graph.AddPass("Phong").Write(depth).Write(scene)
+			.Execute([this, depth, scene](Graphics& gfx, const RenderGraph::Resources& res)
+			{
+				GPU_ZONE(gpuTimer, "Phong pass");
+				const auto& ds = res.GetDepth(depth);
+				const auto& rt = res.GetTarget(scene);
+				if (!depthPrepass)
+				{
+					ds.Clear(gfx);
+				}
+				rt.Clear(gfx);
+				rt.BindAsTarget(gfx, ds);
+				lights.Bind(gfx);
+				Blender::Resolve(gfx, false)->Bind(gfx);
+				Stencil::Resolve(gfx, depthPrepass ? Stencil::Mode::DepthLessEqual : Stencil::Mode::Off)->Bind(gfx);
+				passes[0].Execute(gfx);
+			});
+
+		blur.AddPasses(graph, scene, swap, [this](Graphics& gfx)
+		{
+			pVbFull->Bind(gfx);
+			pIbFull->Bind(gfx);
+			pVsFull->Bind(gfx);
+			pLayoutFull->Bind(gfx);
+			pSamplerFull->Bind(gfx);
+		}, pIbFull->GetCount(), gpuTimer);
+
+		graph.Compile();
+		graph.Realize(gfx);
+		graphDirty = false;
+		graphDownsample = blur.GetDownsampleFactor();
+		graphBlendUpsample = blur.IsBlendUpsample();
+	}
+private:
+	// target of the depth pre-pass steps, after the phong (0) and outline (1, 2) passes
+	static constexpr size_t depthPass = 3u;
+	std::array<Pass, 4> passes;
+	bool depthPrepass = true;
+	RenderGraph graph;
+	// settings the graph was last built for
+	bool graphDirty = true;
+	int graphDownsample = 1;
+	bool graphBlendUpsample = false;
 	BlurPack blur;
+	GpuTimer gpuTimer;
+	LightList lights;
 	std::shared_ptr<Bind::VertexBuffer> pVbFull;
 	std::shared_ptr<Bind::IndexBuffer> pIbFull;
 	std::shared_ptr<Bind::VertexShader> pVsFull;
@@ -0,0 +1,102 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <cmath>
+
+FramePacer::FramePacer(float refreshHz, size_t window)
+	:
+	refreshHz(refreshHz),
+	intervals(std::max(window, size_t(1u)), 0.0f)
+{}
+
+void FramePacer::SetRefreshRate(float hz) noexcept
+{
+	refreshHz = hz;
+}
+
+float FramePacer::GetRefreshRate() const noexcept
+{
+	return refreshHz;
+}
+
+void FramePacer::SetSyncInterval(unsigned int interval) noexcept
+{
+	syncInterval = interval;
+}
+
+unsigned int FramePacer::GetSyncInterval() const noexcept
+{
+	return syncInterval;
+}
+
+void FramePacer::OnPresent(double timeMs)
+{
+	if (presents != 0u)
+	{
+		const auto interval = float(timeMs - lastPresent);
+		intervals[next] = interval;
+		next = (next + 1u) % intervals.size();
+		filled = std::min(filled + 1u, intervals.size());
+		const auto period = GetPeriodMs();
+		if (!hasStatistics && period > 0.0f && interval > period * 1.5f)
+		{
+			dropped += uint64_t(std::lround(interval / period)) - 1u;
+		}
+	}
+	lastPresent = timeMs;
+	presents++;
+}
+
+void FramePacer::OnFrameStatistics(uint32_t presentCount, uint32_t syncRefreshCount) noexcept
+{
+	// counts wrap, unsigned differences survive that
+	if (hasStatistics && syncInterval != 0u)
+	{
+		const auto shown = presentCount - lastPresentCount;
+		const auto refreshes = syncRefreshCount - lastRefreshCount;
+		// every refresh past the ones the shown presents were due for repeated a frame
+		if (refreshes > shown * syncInterval)
+		{
+			dropped += (refreshes - shown * syncInterval) / syncInterval;
+		}
+	}
+	hasStatistics = true;
+	lastPresentCount = presentCount;
+	lastRefreshCount = syncRefreshCount;
+}
+
+FramePacer::Stats FramePacer::GetStats() const
+{
+	Stats s;
+	s.presents = presents;
+	s.dropped = dropped;
+	if (filled == 0u)
+	{
+		return s;
+	}
+	s.lastMs = intervals[(next + intervals.size() - 1u) % intervals.size()];
+	std::vector<float> sorted(intervals.begin(), intervals.begin() + filled);
+	std::sort(sorted.begin(), sorted.end());
+	float total = 0.0f;
+	for (const auto i : sorted)
+	{
+		total += i;
+	}
+	s.avgMs = total / float(filled);
+	s.p95Ms = sorted[std::min(filled - 1u, filled * 95u / 100u)];
+	s.maxMs = sorted.back();
+	return s;
+}
+
+void FramePacer::Reset() noexcept
+{
+	next = 0u;
+	filled = 0u;
+	presents = 0u;
+	dropped = 0u;
+	hasStatistics = false;
+}
+
+float FramePacer::GetPeriodMs() const noexcept
+{
+	return refreshHz > 0.0f ? float(syncInterval) * 1000.0f / refreshHz : 0.0f;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Present to present timing of a swap chain over a window of recent frames. A present is
+// due sync interval refreshes after the previous one, one landing more than half a refresh
+// late counts each refresh it missed as a dropped frame. Once DXGI frame statistics are fed
+// in, drops are counted from their vblank counts instead, which don't depend on when the
+// cpu got back from Present. With vsync off nothing is due, so nothing is dropped.
+class FramePacer
+{
+public:
+	struct Stats
+	{
+		float lastMs = 0.0f;
+		float avgMs = 0.0f;
+		float p95Ms = 0.0f;
+		float maxMs = 0.0f;
+		uint64_t presents = 0u;
+		uint64_t dropped = 0u;
+	};
+public:
+	FramePacer(float refreshHz = 60.0f, size_t window = 120u);
+	void SetRefreshRate(float hz) noexcept;
+	float GetRefreshRate() const noexcept;
+	// 0 presents immediately (vsync off)
+	void SetSyncInterval(unsigned int interval) noexcept;
+	unsigned int GetSyncInterval() const noexcept;
+	// right after each present returns, in milliseconds from any fixed origin
+	void OnPresent(double timeMs);
+	// PresentCount and SyncRefreshCount of DXGI_FRAME_STATISTICS, read after a present
+	void OnFrameStatistics(uint32_t presentCount, uint32_t syncRefreshCount) noexcept;
+	// over the window, presents and dropped are totals
+	Stats GetStats() const;
+	void Reset() noexcept;
+private:
+	float GetPeriodMs() const noexcept;
+private:
+	float refreshHz;
+	unsigned int syncInterval = 1u;
+	// ring of the last intervals
+	std::vector<float> intervals;
+	size_t next = 0u;
+	size_t filled = 0u;
+	double lastPresent = 0.0;
+	uint64_t presents = 0u;
+	uint64_t dropped = 0u;
+	bool hasStatistics = false;
+	uint32_t lastPresentCount = 0u;
+	uint32_t lastRefreshCount = 0u;
+};
@@ -0,0 +1,9 @@
+Texture2D tex;
+SamplerState splr;
+
+// straight copy through the bound sampler, with linear filtering this halves a target
+// as a 2x2 box filter when drawn at half size and stretches it back up when drawn larger
+float4 main(float2 uv : Texcoord) : SV_TARGET
+{
+    return tex.Sample(splr, uv);
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "GaussKernel.h"
+#include "RedSkyMath.h"
+#include <cassert>
+
+GaussKernel::GaussKernel(int radius, float sigma)
+	:
+	radius(radius),
+	sigma(sigma)
+{
+	assert(radius >= 0);
+	float sum = 0.0f;
+	for (int i = -radius; i <= radius; i++)
+	{
+		const auto g = gauss(float(i), sigma);
+		sum += g;
+		weights.push_back(g);
+	}
+	for (auto& w : weights)
+	{
+		w /= sum;
+	}
+
+	// taps i and i+1 sampled at the weighted point between them give w(i) * p(i) + w(i+1) * p(i+1)
+	// under linear filtering, the last tap stays on its own when the radius is odd
+	folded.push_back({ 0.0f,weights[radius] });
+	for (int i = 1; i <= radius; i += 2)
+	{
+		const auto w0 = weights[radius + i];
+		if (i == radius)
+		{
+			folded.push_back({ float(i),w0 });
+			break;
+		}
+		const auto w1 = weights[radius + i + 1];
+		const auto w = w0 + w1;
+		folded.push_back({ (float(i) * w0 + float(i + 1) * w1) / w,w });
+	}
+}
+
+int GaussKernel::GetRadius() const noexcept
+{
+	return radius;
+}
+
+float GaussKernel::GetSigma() const noexcept
+{
+	return sigma;
+}
+
+const std::vector<float>& GaussKernel::GetWeights() const noexcept
+{
+	return weights;
+}
+
+const std::vector<GaussKernel::Tap>& GaussKernel::GetFoldedTaps() const noexcept
+{
+	return folded;
+}
+
+unsigned int GaussKernel::GetDiscreteFetchCount() const noexcept
+{
+	return (unsigned int)weights.size();
+}
+
+unsigned int GaussKernel::GetFoldedFetchCount() const noexcept
+{
+	return (unsigned int)folded.size() * 2u - 1u;
+}
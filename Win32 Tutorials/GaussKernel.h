@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+
+// Normalized 1D gaussian kernel for separable blurs. Besides the discrete weights it
+// provides a folded form where each pair of neighbouring taps is merged into one
+// linearly filtered sample between them, roughly halving the fetches per pass.
+class GaussKernel
+{
+public:
+	struct Tap
+	{
+		// distance from the center in texels, fractional for folded taps
+		float offset;
+		float weight;
+	};
+public:
+	GaussKernel(int radius, float sigma);
+	int GetRadius() const noexcept;
+	float GetSigma() const noexcept;
+	// 2 * radius + 1 weights summing to 1, index radius is the center
+	const std::vector<float>& GetWeights() const noexcept;
+	// center tap followed by the folded taps on the positive side, the negative side mirrors them
+	const std::vector<Tap>& GetFoldedTaps() const noexcept;
+	// texture fetches for one pass over a single texel
+	unsigned int GetDiscreteFetchCount() const noexcept;
+	unsigned int GetFoldedFetchCount() const noexcept;
+private:
+	int radius;
+	float sigma;
+	std::vector<float> weights;
+	std::vector<Tap> folded;
+};
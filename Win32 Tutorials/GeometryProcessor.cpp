@@ -0,0 +1,431 @@
+#include "GeometryProcessor.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+namespace
+{
+	using Type = rsexp::VertexLayout::ElementType;
+	constexpr auto npos = std::numeric_limits<size_t>::max();
+	// triangles, corners or vertices worth handing to another thread
+	constexpr size_t grain = 4096u;
+
+	struct Vec3
+	{
+		float x;
+		float y;
+		float z;
+	};
+	Vec3 operator+(const Vec3& a, const Vec3& b) noexcept
+	{
+		return { a.x + b.x,a.y + b.y,a.z + b.z };
+	}
+	Vec3 operator-(const Vec3& a, const Vec3& b) noexcept
+	{
+		return { a.x - b.x,a.y - b.y,a.z - b.z };
+	}
+	Vec3 operator*(const Vec3& a, float s) noexcept
+	{
+		return { a.x * s,a.y * s,a.z * s };
+	}
+	float Dot(const Vec3& a, const Vec3& b) noexcept
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+	Vec3 Cross(const Vec3& a, const Vec3& b) noexcept
+	{
+		return { a.y * b.z - a.z * b.y,a.z * b.x - a.x * b.z,a.x * b.y - a.y * b.x };
+	}
+	// v at unit length, or fallback when v has no direction
+	Vec3 Normalize(const Vec3& v, const Vec3& fallback) noexcept
+	{
+		const auto lengthSq = Dot(v, v);
+		if (!(lengthSq > 1e-30f))
+		{
+			return fallback;
+		}
+		return v * (1.0f / std::sqrt(lengthSq));
+	}
+	// v with the part along unit n taken out
+	Vec3 Project(const Vec3& v, const Vec3& n) noexcept
+	{
+		return v - n * Dot(v, n);
+	}
+	float Angle(const Vec3& a, const Vec3& b) noexcept
+	{
+		const auto cos = Dot(Normalize(a, {}), Normalize(b, {}));
+		return std::acos(std::clamp(cos, -1.0f, 1.0f));
+	}
+	// some unit vector at right angles to unit n
+	Vec3 Perpendicular(const Vec3& n) noexcept
+	{
+		const Vec3 axis = std::abs(n.x) < 0.9f ? Vec3{ 1.0f,0.0f,0.0f } : Vec3{ 0.0f,1.0f,0.0f };
+		return Normalize(Project(axis, n), {});
+	}
+	void Store(DirectX::XMFLOAT3& dst, const Vec3& v) noexcept
+	{
+		dst = { v.x,v.y,v.z };
+	}
+
+	// structure of arrays of vectors, one per triangle, corner or vertex
+	struct Vec3s
+	{
+		Vec3s(size_t size)
+			:
+			x(size),
+			y(size),
+			z(size)
+		{}
+		Vec3 operator[](size_t i) const noexcept
+		{
+			return { x[i],y[i],z[i] };
+		}
+		void Set(size_t i, const Vec3& v) noexcept
+		{
+			x[i] = v.x;
+			y[i] = v.y;
+			z[i] = v.z;
+		}
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+	};
+
+	Vec3s LoadPositions(rsexp::VertexBuffer& vb)
+	{
+		const rsexp::ElementView<Type::Position3D> view{ vb };
+		assert(view.IsValid() && "Layout has no positions");
+		Vec3s positions{ vb.Size() };
+		ParallelFor(vb.Size(), grain, [&](size_t i)
+		{
+			const auto& p = view[i];
+			positions.Set(i, { p.x,p.y,p.z });
+		});
+		return positions;
+	}
+
+	// corners (places in the index list) grouped by a key of each, counted and then filled in
+	struct Groups
+	{
+		template<typename F>
+		Groups(size_t keyCount, size_t cornerCount, F&& keyOf)
+			:
+			offsets(keyCount + 1u, 0u),
+			corners(cornerCount)
+		{
+			for (size_t c = 0; c < cornerCount; c++)
+			{
+				offsets[keyOf(c) + 1u]++;
+			}
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+			auto next = offsets;
+			for (size_t c = 0; c < cornerCount; c++)
+			{
+				corners[next[keyOf(c)]++] = c;
+			}
+		}
+		template<typename F>
+		void ForEach(size_t key, F&& f) const
+		{
+			for (auto i = offsets[key]; i < offsets[key + 1u]; i++)
+			{
+				f(corners[i]);
+			}
+		}
+		std::vector<size_t> offsets;
+		std::vector<size_t> corners;
+	};
+
+	// an id per vertex, the same for every vertex at exactly the same position
+	std::vector<size_t> WeldPositions(const Vec3s& positions, size_t& idCount)
+	{
+		const auto count = positions.x.size();
+		std::vector<size_t> order(count);
+		std::iota(order.begin(), order.end(), size_t(0u));
+		const auto key = [&positions](size_t i)
+		{
+			return std::make_tuple(positions.x[i], positions.y[i], positions.z[i]);
+		};
+		std::sort(order.begin(), order.end(), [&key](size_t a, size_t b)
+		{
+			return key(a) < key(b);
+		});
+		std::vector<size_t> ids(count);
+		idCount = 0u;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (i == 0u || key(order[i - 1u]) != key(order[i]))
+			{
+				idCount++;
+			}
+			ids[order[i]] = idCount - 1u;
+		}
+		return ids;
+	}
+
+	// the corners of a vertex are grouped by same(a, b), the first group keeps the vertex and
+	// every other one gets a copy of it appended to the buffer
+	template<typename Index, typename F>
+	void SplitVertices(rsexp::VertexBuffer& vb, std::vector<Index>& indices, F&& same)
+	{
+		const auto count = vb.Size();
+		const Groups byVertex{ count, indices.size(), [&indices](size_t c) { return size_t(indices[c]); } };
+		std::vector<size_t> sources;
+		std::vector<size_t> firsts;
+		std::vector<size_t> copies;
+		for (size_t v = 0; v < count; v++)
+		{
+			firsts.clear();
+			copies.clear();
+			byVertex.ForEach(v, [&](size_t c)
+			{
+				size_t g = 0;
+				while (g < firsts.size() && !same(firsts[g], c))
+				{
+					g++;
+				}
+				if (g == firsts.size())
+				{
+					firsts.push_back(c);
+					copies.push_back(g == 0u ? v : count + sources.size());
+					if (g != 0u)
+					{
+						sources.push_back(v);
+					}
+				}
+				indices[c] = Index(copies[g]);
+			});
+		}
+		if (sources.empty())
+		{
+			return;
+		}
+		assert(count + sources.size() - 1u <= std::numeric_limits<Index>::max() && "Split vertices overflow the index type");
+		vb.Resize(count + sources.size());
+		const auto stride = vb.GetLayout().Size();
+		const auto pData = vb.GetData();
+		for (size_t i = 0; i < sources.size(); i++)
+		{
+			std::memcpy(pData + (count + i) * stride, pData + sources[i] * stride, stride);
+		}
+	}
+}
+
+template<typename Index>
+void GeometryProcessor::SetFlatNormals(rsexp::VertexBuffer& vb, const std::vector<Index>& indices)
+{
+	assert(indices.size() % 3u == 0u);
+	const auto positions = LoadPositions(vb);
+	const rsexp::ElementView<Type::Normal> normals{ vb };
+	assert(normals.IsValid() && "Layout has no normals");
+	std::vector<size_t> last(vb.Size(), npos);
+	for (size_t c = 0; c < indices.size(); c++)
+	{
+		last[indices[c]] = c;
+	}
+	ParallelFor(vb.Size(), grain, [&](size_t v)
+	{
+		if (last[v] == npos)
+		{
+			return;
+		}
+		const auto t = last[v] / 3u * 3u;
+		const auto p0 = positions[indices[t]];
+		const auto p1 = positions[indices[t + 1u]];
+		const auto p2 = positions[indices[t + 2u]];
+		Store(normals[v], Normalize(Cross(p1 - p0, p2 - p0), {}));
+	});
+}
+
+template<typename Index>
+void GeometryProcessor::SetSmoothNormals(rsexp::VertexBuffer& vb, std::vector<Index>& indices,
+	NormalWeighting weighting, float creaseAngle)
+{
+	assert(indices.size() % 3u == 0u);
+	const auto positions = LoadPositions(vb);
+	const auto triangleCount = indices.size() / 3u;
+
+	// triangle normals, and each corner's weight in the normals of the others around it
+	Vec3s faceNormals{ triangleCount };
+	std::vector<float> weights(indices.size());
+	ParallelFor(triangleCount, grain, [&](size_t t)
+	{
+		const Vec3 p[3] = { positions[indices[t * 3u]],positions[indices[t * 3u + 1u]],positions[indices[t * 3u + 2u]] };
+		const auto n = Cross(p[1] - p[0], p[2] - p[0]);
+		faceNormals.Set(t, Normalize(n, {}));
+		for (size_t i = 0; i < 3u; i++)
+		{
+			weights[t * 3u + i] = weighting == NormalWeighting::Area ?
+				std::sqrt(Dot(n, n)) :
+				Angle(p[(i + 1u) % 3u] - p[i], p[(i + 2u) % 3u] - p[i]);
+		}
+	});
+
+	// corners meet by position rather than by vertex, so seams in texture coordinates don't
+	// show up as seams in the shading
+	size_t positionCount = 0u;
+	const auto welded = WeldPositions(positions, positionCount);
+	const Groups byPosition{ positionCount, indices.size(), [&](size_t c) { return welded[indices[c]]; } };
+	const auto minCos = creaseAngle >= float(PI_D) ? -2.0f : std::cos(creaseAngle);
+	const auto sumAround = [&](size_t position, const Vec3& own)
+	{
+		Vec3 sum = {};
+		byPosition.ForEach(position, [&](size_t other)
+		{
+			const auto n = faceNormals[other / 3u];
+			if (Dot(own, n) >= minCos)
+			{
+				sum = sum + n * weights[other];
+			}
+		});
+		return sum;
+	};
+	Vec3s cornerNormals{ indices.size() };
+	if (minCos < -1.0f)
+	{
+		// without creases every corner at a position sums the same triangles, once will do
+		Vec3s positionNormals{ positionCount };
+		ParallelFor(positionCount, grain, [&](size_t i)
+		{
+			positionNormals.Set(i, sumAround(i, {}));
+		});
+		ParallelFor(indices.size(), grain, [&](size_t c)
+		{
+			cornerNormals.Set(c, Normalize(positionNormals[welded[indices[c]]], faceNormals[c / 3u]));
+		});
+	}
+	else
+	{
+		ParallelFor(indices.size(), grain, [&](size_t c)
+		{
+			const auto own = faceNormals[c / 3u];
+			cornerNormals.Set(c, Normalize(sumAround(welded[indices[c]], own), own));
+		});
+	}
+
+	// corners summing the same triangles in the same order come out bit for bit equal
+	SplitVertices(vb, indices, [&cornerNormals](size_t a, size_t b)
+	{
+		return cornerNormals.x[a] == cornerNormals.x[b] && cornerNormals.y[a] == cornerNormals.y[b] &&
+			cornerNormals.z[a] == cornerNormals.z[b];
+	});
+	const rsexp::ElementView<Type::Normal> normals{ vb };
+	assert(normals.IsValid() && "Layout has no normals");
+	std::vector<size_t> corners(vb.Size(), npos);
+	for (size_t c = 0; c < indices.size(); c++)
+	{
+		corners[indices[c]] = c;
+	}
+	ParallelFor(vb.Size(), grain, [&](size_t v)
+	{
+		if (corners[v] != npos)
+		{
+			Store(normals[v], cornerNormals[corners[v]]);
+		}
+	});
+}
+
+template<typename Index>
+void GeometryProcessor::SetTangents(rsexp::VertexBuffer& vb, std::vector<Index>& indices)
+{
+	assert(indices.size() % 3u == 0u);
+	const auto triangleCount = indices.size() / 3u;
+
+	// how fast position changes along u, per triangle. Orientation is 1 where the texture
+	// keeps its handedness on the surface, -1 where it is mirrored and 0 where it has no area
+	Vec3s faceTangents{ triangleCount };
+	std::vector<int> orientations(triangleCount);
+	{
+		const auto positions = LoadPositions(vb);
+		const rsexp::ElementView<Type::Texture2D> texcoords{ vb };
+		assert(texcoords.IsValid() && "Layout has no texture coordinates");
+		ParallelFor(triangleCount, grain, [&](size_t t)
+		{
+			const auto i0 = indices[t * 3u], i1 = indices[t * 3u + 1u], i2 = indices[t * 3u + 2u];
+			const auto e1 = positions[i1] - positions[i0];
+			const auto e2 = positions[i2] - positions[i0];
+			const auto s1x = texcoords[i1].x - texcoords[i0].x, s1y = texcoords[i1].y - texcoords[i0].y;
+			const auto s2x = texcoords[i2].x - texcoords[i0].x, s2y = texcoords[i2].y - texcoords[i0].y;
+			const auto signedArea = s1x * s2y - s2x * s1y;
+			const auto orientation = signedArea > 0.0f ? 1 : (signedArea < 0.0f ? -1 : 0);
+			orientations[t] = orientation;
+			faceTangents.Set(t, Normalize((e1 * s2y - e2 * s1y) * float(orientation), {}));
+		});
+	}
+
+	// a vertex can't have both handednesses, corners without texture area side with whichever
+	// its other corners have
+	std::vector<int> cornerOrientations(indices.size());
+	{
+		const Groups byVertex{ vb.Size(), indices.size(), [&indices](size_t c) { return size_t(indices[c]); } };
+		ParallelFor(vb.Size(), grain, [&](size_t v)
+		{
+			int first = 0;
+			byVertex.ForEach(v, [&](size_t c)
+			{
+				if (first == 0)
+				{
+					first = orientations[c / 3u];
+				}
+			});
+			byVertex.ForEach(v, [&](size_t c)
+			{
+				const auto orientation = orientations[c / 3u];
+				cornerOrientations[c] = orientation != 0 ? orientation : (first != 0 ? first : 1);
+			});
+		});
+	}
+	SplitVertices(vb, indices, [&cornerOrientations](size_t a, size_t b)
+	{
+		return cornerOrientations[a] == cornerOrientations[b];
+	});
+
+	// each corner's triangle tangent in the plane of the vertex normal, weighed by the angle of
+	// the corner in that plane
+	const auto positions = LoadPositions(vb);
+	const rsexp::ElementView<Type::Normal> normals{ vb };
+	const rsexp::ElementView<Type::Tangent> tangents{ vb };
+	const rsexp::ElementView<Type::Bitangent> bitangents{ vb };
+	assert(normals.IsValid() && tangents.IsValid() && "Layout has no normals or tangents");
+	const Groups byVertex{ vb.Size(), indices.size(), [&indices](size_t c) { return size_t(indices[c]); } };
+	ParallelFor(vb.Size(), grain, [&](size_t v)
+	{
+		const auto& normal = normals[v];
+		const Vec3 n = Normalize({ normal.x,normal.y,normal.z }, { 0.0f,0.0f,1.0f });
+		const auto p = positions[v];
+		Vec3 sum = {};
+		int orientation = 1;
+		byVertex.ForEach(v, [&](size_t c)
+		{
+			const auto t = c / 3u;
+			const auto corner = c % 3u;
+			orientation = cornerOrientations[c];
+			if (orientations[t] == 0)
+			{
+				return;
+			}
+			const auto toNext = Project(positions[indices[t * 3u + (corner + 1u) % 3u]] - p, n);
+			const auto toPrev = Project(positions[indices[t * 3u + (corner + 2u) % 3u]] - p, n);
+			sum = sum + Normalize(Project(faceTangents[t], n), {}) * Angle(toNext, toPrev);
+		});
+		const auto tangent = Normalize(sum, Perpendicular(n));
+		Store(tangents[v], tangent);
+		if (bitangents.IsValid())
+		{
+			Store(bitangents[v], Cross(n, tangent) * -float(orientation));
+		}
+	});
+}
+
+template void GeometryProcessor::SetFlatNormals(rsexp::VertexBuffer&, const std::vector<unsigned short>&);
+template void GeometryProcessor::SetFlatNormals(rsexp::VertexBuffer&, const std::vector<uint32_t>&);
+template void GeometryProcessor::SetSmoothNormals(rsexp::VertexBuffer&, std::vector<unsigned short>&, NormalWeighting, float);
+template void GeometryProcessor::SetSmoothNormals(rsexp::VertexBuffer&, std::vector<uint32_t>&, NormalWeighting, float);
+template void GeometryProcessor::SetTangents(rsexp::VertexBuffer&, std::vector<unsigned short>&);
+template void GeometryProcessor::SetTangents(rsexp::VertexBuffer&, std::vector<uint32_t>&);
@@ -0,0 +1,34 @@
+#pragma once
+#include "Vertex.h"
+#include "RedSkyMath.h"
+#include <vector>
+
+// Normal and tangent frame generation for indexed triangle lists in a VertexBuffer. Triangle
+// and corner values are worked out into structure of arrays scratch in parallel chunks, then
+// gathered per vertex so no two threads ever write the same vertex. Where the corners sharing
+// a vertex disagree (across a crease, or where a texture is mirrored) the vertex is split and
+// the indices pointed at the copies, so both may grow.
+class GeometryProcessor
+{
+public:
+	enum class NormalWeighting
+	{
+		// big triangles count for more
+		Area,
+		// by the corner's angle, so splitting a triangle up changes nothing
+		Angle,
+	};
+public:
+	// every vertex takes the normal of the last triangle using it, for meshes sharing none
+	template<typename Index>
+	static void SetFlatNormals(rsexp::VertexBuffer& vb, const std::vector<Index>& indices);
+	// a corner's normal is the weighted average over triangles meeting at its position whose
+	// normals are within creaseAngle (radians) of its own triangle's, nothing is a crease at pi
+	template<typename Index>
+	static void SetSmoothNormals(rsexp::VertexBuffer& vb, std::vector<Index>& indices,
+		NormalWeighting weighting = NormalWeighting::Angle, float creaseAngle = float(PI_D));
+	// tangents as MikkTSpace builds them, from normals and texture coordinates already there.
+	// Bitangents complete the frame with the sign Assimp's point: up the texture, against v
+	template<typename Index>
+	static void SetTangents(rsexp::VertexBuffer& vb, std::vector<Index>& indices);
+};
@@ -0,0 +1,139 @@
+#include "GpuTimer.h"
+#include "GraphicsThrowMacros.h"
+#include "imgui/imgui.h"
+#include <algorithm>
+
+GpuTimer::GpuTimer(Graphics& gfx, size_t framesInFlight, size_t maxStages)
+	:
+	ring(*this, framesInFlight, maxStages),
+	pContext(GetContext(gfx)),
+	track(Profiler::RegisterTrack("GPU"))
+{
+	INFOMAN(gfx);
+
+	D3D11_QUERY_DESC disjointDesc = { D3D11_QUERY_TIMESTAMP_DISJOINT,0u };
+	D3D11_QUERY_DESC timestampDesc = { D3D11_QUERY_TIMESTAMP,0u };
+	disjoints.resize(ring.GetSlotCount());
+	timestamps.resize(ring.GetSlotCount() * ring.GetQueriesPerSlot());
+	for (auto& q : disjoints)
+	{
+		GFX_THROW_INFO(GetDevice(gfx)->CreateQuery(&disjointDesc, &q));
+		gfx.CountResourceCreated();
+	}
+	for (auto& q : timestamps)
+	{
+		GFX_THROW_INFO(GetDevice(gfx)->CreateQuery(&timestampDesc, &q));
+		gfx.CountResourceCreated();
+	}
+}
+
+void GpuTimer::BeginFrame()
+{
+	for (const auto& f : ring.Collect())
+	{
+		Accumulate(f);
+	}
+	ring.BeginFrame(Profiler::Now());
+}
+
+void GpuTimer::EndFrame()
+{
+	ring.EndFrame();
+}
+
+const std::vector<GpuTimer::StageStats>& GpuTimer::GetStats() const noexcept
+{
+	return stats;
+}
+
+void GpuTimer::SpawnWindow()
+{
+	if (ImGui::Begin("GPU Timings"))
+	{
+		ImGui::Text("Frame %llu, %.3fms", (unsigned long long)lastFrame, lastFrameMs);
+		ImGui::Text("Untimed frames: %llu, disjoint: %llu",
+			(unsigned long long)ring.GetSkippedFrames(), (unsigned long long)ring.GetDisjointFrames());
+		ImGui::Columns(3, "gpu", false);
+		ImGui::Text("Stage"); ImGui::NextColumn();
+		ImGui::Text("Last ms"); ImGui::NextColumn();
+		ImGui::Text("Avg ms"); ImGui::NextColumn();
+		for (const auto& s : stats)
+		{
+			ImGui::Text("%*s%s", int(s.depth * 2u), "", s.zone->name); ImGui::NextColumn();
+			ImGui::Text("%.3f", s.lastMs); ImGui::NextColumn();
+			ImGui::Text("%.3f", s.avgMs); ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+	}
+	ImGui::End();
+}
+
+void GpuTimer::BeginDisjoint(size_t slot)
+{
+	pContext->Begin(disjoints[slot].Get());
+}
+
+void GpuTimer::EndDisjoint(size_t slot)
+{
+	pContext->End(disjoints[slot].Get());
+}
+
+void GpuTimer::Timestamp(size_t slot, size_t query)
+{
+	pContext->End(timestamps[slot * ring.GetQueriesPerSlot() + query].Get());
+}
+
+bool GpuTimer::ReadDisjoint(size_t slot, uint64_t& frequency, bool& disjoint)
+{
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT data;
+	// S_FALSE until the gpu gets there, DONOTFLUSH keeps the poll from submitting work
+	if (pContext->GetData(disjoints[slot].Get(), &data, sizeof(data), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+	{
+		return false;
+	}
+	frequency = data.Frequency;
+	disjoint = data.Disjoint != FALSE;
+	return true;
+}
+
+bool GpuTimer::ReadTimestamp(size_t slot, size_t query, uint64_t& ticks)
+{
+	UINT64 data;
+	if (pContext->GetData(timestamps[slot * ring.GetQueriesPerSlot() + query].Get(), &data, sizeof(data), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+	{
+		return false;
+	}
+	ticks = data;
+	return true;
+}
+
+void GpuTimer::Accumulate(const GpuTimerRing::FrameTimings& frame)
+{
+	const auto toTicks = [](float ms)
+	{
+		return int64_t(double(ms) * Profiler::Clock::period::den / (Profiler::Clock::period::num * 1000.0));
+	};
+	lastFrame = frame.frame;
+	lastFrameMs = 0.0f;
+	for (const auto& s : frame.stages)
+	{
+		// gpu clocks aren't tied to the cpu one, so stages are placed relative to when the frame was recorded
+		const auto start = frame.cpuStart + toTicks(s.startMs);
+		track.Push({ s.zone,s.parent,start,start + toTicks(s.ms),s.depth,Profiler::Event::Type::Zone,0 });
+		if (s.depth == 0u)
+		{
+			lastFrameMs += s.ms;
+		}
+
+		auto i = std::find_if(stats.begin(), stats.end(), [&s](const StageStats& x) { return x.zone == s.zone; });
+		if (i == stats.end())
+		{
+			stats.push_back({ s.zone,s.depth,s.ms,s.ms });
+		}
+		else
+		{
+			i->lastMs = s.ms;
+			i->avgMs += (s.ms - i->avgMs) * 0.05f;
+		}
+	}
+}
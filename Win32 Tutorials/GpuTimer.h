@@ -0,0 +1,71 @@
+#pragma once
+#include "GraphicsResource.h"
+#include "GpuTimerRing.h"
+#include "PerformanceLog.h"
+#include <wrl.h>
+#include <vector>
+
+// Times stages of the frame on the gpu with timestamp queries bracketed by a disjoint
+// query. Results come back a few frames late through a GpuTimerRing and are read without
+// flushing or waiting. Finished frames go to the profiler's "GPU" track, so they show up
+// in the perf log and traces next to the cpu zones, and to the GPU Timings window.
+class GpuTimer : public GraphicsResource, private GpuQuerySource
+{
+public:
+	class Scope
+	{
+	public:
+		Scope(GpuTimer& timer, const ProfileZone& zone)
+			:
+			timer(timer),
+			stage(timer.ring.Begin(zone))
+		{}
+		~Scope()
+		{
+			timer.ring.End(stage);
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	private:
+		GpuTimer& timer;
+		size_t stage;
+	};
+	struct StageStats
+	{
+		const ProfileZone* zone;
+		uint32_t depth;
+		float lastMs;
+		// exponential moving average, steadier to read than the last frame
+		float avgMs;
+	};
+public:
+	// framesInFlight is how far behind the gpu may fall before frames go untimed
+	GpuTimer(Graphics& gfx, size_t framesInFlight = 4u, size_t maxStages = 16u);
+	// collects finished frames and starts timing this one
+	void BeginFrame();
+	void EndFrame();
+	const std::vector<StageStats>& GetStats() const noexcept;
+	void SpawnWindow();
+private:
+	void BeginDisjoint(size_t slot) override;
+	void EndDisjoint(size_t slot) override;
+	void Timestamp(size_t slot, size_t query) override;
+	bool ReadDisjoint(size_t slot, uint64_t& frequency, bool& disjoint) override;
+	bool ReadTimestamp(size_t slot, size_t query, uint64_t& ticks) override;
+	void Accumulate(const GpuTimerRing::FrameTimings& frame);
+private:
+	GpuTimerRing ring;
+	// the device outlives every frame commander
+	ID3D11DeviceContext* pContext;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11Query>> disjoints;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11Query>> timestamps;
+	Profiler::ThreadRing& track;
+	std::vector<StageStats> stats;
+	uint64_t lastFrame = 0u;
+	float lastFrameMs = 0.0f;
+};
+
+// times the rest of the enclosing scope on the gpu under the given name (a string literal)
+#define GPU_ZONE(timer,name) \
+	static constexpr ProfileZone PROFILE_CONCAT(gpuZone_,__LINE__){ name,__FILE__,__LINE__ }; \
+	const GpuTimer::Scope PROFILE_CONCAT(gpuScope_,__LINE__){ (timer),PROFILE_CONCAT(gpuZone_,__LINE__) }
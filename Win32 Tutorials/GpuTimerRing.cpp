@@ -0,0 +1,151 @@
+#include "GpuTimerRing.h"
+#include <algorithm>
+#include <cassert>
+
+GpuTimerRing::GpuTimerRing(GpuQuerySource& source, size_t framesInFlight, size_t maxStages)
+	:
+	source(source),
+	maxStages(maxStages),
+	slots(framesInFlight)
+{
+	assert(framesInFlight > 0u);
+}
+
+size_t GpuTimerRing::GetQueriesPerSlot() const noexcept
+{
+	return 1u + 2u * maxStages;
+}
+
+size_t GpuTimerRing::GetSlotCount() const noexcept
+{
+	return slots.size();
+}
+
+void GpuTimerRing::BeginFrame(int64_t cpuTime)
+{
+	assert(current == npos && "EndFrame was not called");
+	const auto index = size_t(frameCount % slots.size());
+	auto& slot = slots[index];
+	frameCount++;
+	// results for this slot are still outstanding, overwriting its queries would mean waiting on them
+	if (slot.state != State::Free)
+	{
+		skipped++;
+		return;
+	}
+	current = index;
+	slot.state = State::Recording;
+	slot.frame = frameCount;
+	slot.cpuStart = cpuTime;
+	slot.stages.clear();
+	open.clear();
+	source.BeginDisjoint(index);
+	source.Timestamp(index, 0u);
+}
+
+size_t GpuTimerRing::Begin(const ProfileZone& zone)
+{
+	if (current == npos || slots[current].stages.size() >= maxStages)
+	{
+		return npos;
+	}
+	auto& stages = slots[current].stages;
+	const auto stage = stages.size();
+	stages.push_back({ &zone,open.empty() ? npos : open.back() });
+	open.push_back(stage);
+	source.Timestamp(current, 1u + 2u * stage);
+	return stage;
+}
+
+void GpuTimerRing::End(size_t stage)
+{
+	if (current == npos || stage == npos)
+	{
+		return;
+	}
+	assert(!open.empty() && open.back() == stage && "gpu stages must end in reverse order");
+	open.pop_back();
+	source.Timestamp(current, 2u + 2u * stage);
+}
+
+void GpuTimerRing::EndFrame()
+{
+	if (current == npos)
+	{
+		return;
+	}
+	source.EndDisjoint(current);
+	slots[current].state = State::Pending;
+	current = npos;
+}
+
+std::vector<GpuTimerRing::FrameTimings> GpuTimerRing::Collect()
+{
+	std::vector<size_t> pending;
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		if (slots[i].state == State::Pending)
+		{
+			pending.push_back(i);
+		}
+	}
+	std::sort(pending.begin(), pending.end(), [this](size_t a, size_t b) { return slots[a].frame < slots[b].frame; });
+
+	std::vector<FrameTimings> frames;
+	// the gpu finishes frames in order, so the first one not ready ends the search
+	for (auto i : pending)
+	{
+		auto& slot = slots[i];
+		uint64_t frequency = 0u;
+		bool disjoint = false;
+		if (!source.ReadDisjoint(i, frequency, disjoint))
+		{
+			break;
+		}
+		std::vector<uint64_t> ticks(1u + 2u * slot.stages.size());
+		bool ready = true;
+		for (size_t q = 0; q < ticks.size() && ready; q++)
+		{
+			ready = source.ReadTimestamp(i, q, ticks[q]);
+		}
+		if (!ready)
+		{
+			break;
+		}
+		slot.state = State::Free;
+		// a clock change mid frame makes every timestamp in it meaningless
+		if (disjoint || frequency == 0u)
+		{
+			disjointFrames++;
+			continue;
+		}
+		const auto toMs = [frequency](uint64_t from, uint64_t to)
+		{
+			return to >= from ? float(double(to - from) * 1000.0 / double(frequency)) : 0.0f;
+		};
+		FrameTimings f{ slot.frame,slot.cpuStart,{} };
+		for (size_t s = 0; s < slot.stages.size(); s++)
+		{
+			const auto parent = slot.stages[s].second;
+			f.stages.push_back({
+				slot.stages[s].first,
+				parent == npos ? nullptr : f.stages[parent].zone,
+				parent == npos ? 0u : f.stages[parent].depth + 1u,
+				toMs(ticks[0],ticks[1u + 2u * s]),
+				toMs(ticks[1u + 2u * s],ticks[2u + 2u * s])
+			});
+		}
+		frames.push_back(std::move(f));
+	}
+	return frames;
+}
+
+uint64_t GpuTimerRing::GetSkippedFrames() const noexcept
+{
+	return skipped;
+}
+
+uint64_t GpuTimerRing::GetDisjointFrames() const noexcept
+{
+	return disjointFrames;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "PerformanceLog.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Issues and reads back the gpu queries a GpuTimerRing schedules. The d3d implementation
+// wraps timestamp and disjoint queries, tests can substitute a mock.
+class GpuQuerySource
+{
+public:
+	virtual ~GpuQuerySource() = default;
+	virtual void BeginDisjoint(size_t slot) = 0;
+	virtual void EndDisjoint(size_t slot) = 0;
+	virtual void Timestamp(size_t slot, size_t query) = 0;
+	// false while the gpu hasn't reached the query yet, must never wait for it
+	virtual bool ReadDisjoint(size_t slot, uint64_t& frequency, bool& disjoint) = 0;
+	virtual bool ReadTimestamp(size_t slot, size_t query, uint64_t& ticks) = 0;
+};
+
+// Schedules per frame gpu timestamp queries over a ring of frame slots. A slot is only
+// reused once its results have been read, results are read without waiting, so timing
+// never stalls the cpu on the gpu: when the gpu falls more than a ring behind, frames
+// simply go untimed. Query 0 of a slot marks the frame start, stage i uses 1+2i and 2+2i.
+class GpuTimerRing
+{
+public:
+	struct Stage
+	{
+		const ProfileZone* zone;
+		// the stage that was open when this one began, stages nest like profiler zones
+		const ProfileZone* parent;
+		uint32_t depth;
+		// relative to the frame start timestamp
+		float startMs;
+		float ms;
+	};
+	struct FrameTimings
+	{
+		uint64_t frame;
+		// cpu clock when the frame was recorded, lines the gpu timeline up with cpu zones
+		int64_t cpuStart;
+		std::vector<Stage> stages;
+	};
+public:
+	static constexpr size_t npos = ~size_t(0);
+public:
+	GpuTimerRing(GpuQuerySource& source, size_t framesInFlight, size_t maxStages);
+	// timestamps queried per slot
+	size_t GetQueriesPerSlot() const noexcept;
+	size_t GetSlotCount() const noexcept;
+	void BeginFrame(int64_t cpuTime);
+	// stage index to End, npos when this frame isn't timed or has run out of stages
+	size_t Begin(const ProfileZone& zone);
+	// stages end in the reverse order they began
+	void End(size_t stage);
+	void EndFrame();
+	// frames whose results arrived since the last call, oldest first
+	std::vector<FrameTimings> Collect();
+	uint64_t GetSkippedFrames() const noexcept;
+	uint64_t GetDisjointFrames() const noexcept;
+private:
+	enum class State
+	{
+		Free,
+		Recording,
+		Pending,
+	};
+	struct Slot
+	{
+		State state = State::Free;
+		uint64_t frame = 0u;
+		int64_t cpuStart = 0;
+		// zone, index of the enclosing stage (npos at the top)
+		std::vector<std::pair<const ProfileZone*, size_t>> stages;
+	};
+private:
+	GpuQuerySource& source;
+	size_t maxStages;
+	std::vector<Slot> slots;
+	size_t current = npos;
+	// stages begun but not yet ended in the recording slot
+	std::vector<size_t> open;
+	uint64_t frameCount = 0u;
+	uint64_t skipped = 0u;
+	uint64_t disjointFrames = 0u;
+};
@@ -2,6 +2,7 @@
 #include "dxerr.h"
 #include <sstream>
 #include <d3dcompiler.h>
+#include <cassert>
 #include <cmath>
 #include <DirectXMath.h>
 #include "GraphicsThrowMacros.h"
@@ -9,6 +10,9 @@
 #include "imgui/imgui_impl_dx11.h"
 #include "imgui/imgui_impl_win32.h"
 #include "DepthStencil.h"
+#include "PerformanceLog.h"
+#include <algorithm>
+#include <chrono>
 
 //shorthand for Microsoft::WRL
 namespace wrl = Microsoft::WRL;
@@ -16,13 +20,15 @@ namespace wrl = Microsoft::WRL;
 //adds the d3d11 and D3DCompiler library to the project settings
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "D3DCompiler.lib")
+#pragma comment(lib, "dxgi.lib")
 
-Graphics::Graphics(HWND hWnd, int width, int height)
-	: width(width), height(height)
+Graphics::Graphics(HWND hWnd, int width, int height, const PresentSettings& settings)
+	: width(width), height(height), presentSettings(settings)
 {
 	HRESULT hr;
 
 	SetupSwapchainAndDevice(hWnd, width, height);
+	SetupFrameLatency();
 	SetupRenderTarget();
 
 	//Bind Render target
@@ -33,9 +39,34 @@ Graphics::Graphics(HWND hWnd, int width, int height)
 	ImGui_ImplDX11_Init(pDevice.Get(), pContext.Get());
 }
 
+Graphics::Graphics(int width, int height, Backend backend)
+	: width(width), height(height), imguiEnabled(false)
+{
+	SetupHeadlessDevice(width, height, backend);
+
+	pContext->OMSetRenderTargets(1u, pTarget.GetAddressOf(), nullptr);
+
+	SetupViewport(width, height);
+}
+
 #pragma region DirectX Setup
 void Graphics::SetupSwapchainAndDevice(HWND& hWnd, int width, int height)
 {
+	//tearing needs dxgi 1.5 and a system that supports it
+	if (presentSettings.allowTearing) {
+		wrl::ComPtr<IDXGIFactory5> pFactory;
+		BOOL allow = FALSE;
+		if (SUCCEEDED(CreateDXGIFactory1(__uuidof(IDXGIFactory5), &pFactory)) &&
+			SUCCEEDED(pFactory->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allow, sizeof(allow)))) {
+			tearingSupported = allow == TRUE;
+		}
+	}
+	swapFlags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+	if (tearingSupported) {
+		swapFlags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+	}
+	presentSettings.bufferCount = std::clamp(presentSettings.bufferCount, 2u, UINT(DXGI_MAX_SWAP_CHAIN_BUFFERS));
+
 	DXGI_SWAP_CHAIN_DESC sd = {};
 	//Direct3D gets the width and height of the window
 	sd.BufferDesc.Width = width;
@@ -48,11 +79,11 @@ void Graphics::SetupSwapchainAndDevice(HWND& hWnd, int width, int height)
 	sd.SampleDesc.Count = 1; //no Anti Aliasing
 	sd.SampleDesc.Quality = 0;
 	sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT; //Sets this as the render target output
-	sd.BufferCount = 1; //one back buffer and one front buffer
+	sd.BufferCount = presentSettings.bufferCount; //flip model needs at least two
 	sd.OutputWindow = hWnd; //Sets the window
 	sd.Windowed = TRUE;
-	sd.SwapEffect = DXGI_SWAP_EFFECT_DISCARD; //swap effect discard is the standard effect
-	sd.Flags = 0; //no flags currently
+	sd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD; //hands buffers to the compositor instead of copying them
+	sd.Flags = swapFlags;
 
 	UINT swapCreateFlags = 0u;
 
@@ -79,6 +110,75 @@ void Graphics::SetupSwapchainAndDevice(HWND& hWnd, int width, int height)
 	));
 }
 
+void Graphics::SetupFrameLatency()
+{
+	HRESULT hr;
+	wrl::ComPtr<IDXGISwapChain2> pSwap2;
+	GFX_THROW_INFO(pSwap.As(&pSwap2));
+	GFX_THROW_INFO(pSwap2->SetMaximumFrameLatency(presentSettings.maxFrameLatency));
+	frameLatencyWaitable = pSwap2->GetFrameLatencyWaitableObject();
+
+	//pacing counts drops against the refresh rate of the desktop the window opens on
+	DEVMODE dm = {};
+	dm.dmSize = sizeof(dm);
+	if (EnumDisplaySettings(nullptr, ENUM_CURRENT_SETTINGS, &dm) && dm.dmDisplayFrequency > 1u) {
+		pacer.SetRefreshRate(float(dm.dmDisplayFrequency));
+	}
+	pacer.SetSyncInterval(presentSettings.vsync ? 1u : 0u);
+}
+
+void Graphics::SetupHeadlessDevice(int width, int height, Backend backend)
+{
+	UINT createFlags = 0u;
+
+#ifndef NDEBUG
+	createFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+	D3D_DRIVER_TYPE driverType = D3D_DRIVER_TYPE_HARDWARE;
+	switch (backend)
+	{
+	case Backend::Warp:
+		driverType = D3D_DRIVER_TYPE_WARP;
+		break;
+	case Backend::Null:
+		driverType = D3D_DRIVER_TYPE_NULL;
+		break;
+	}
+
+	HRESULT hr;
+
+	GFX_THROW_INFO(D3D11CreateDevice(
+		nullptr,
+		driverType,
+		nullptr,
+		createFlags,
+		nullptr,
+		0,
+		D3D11_SDK_VERSION,
+		&pDevice,
+		nullptr,
+		&pContext
+	));
+
+	//offscreen stand in for the back buffer
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+	textureDesc.Width = width;
+	textureDesc.Height = height;
+	textureDesc.MipLevels = 1;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+	textureDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.MiscFlags = 0;
+	wrl::ComPtr<ID3D11Texture2D> pBackBuffer;
+	GFX_THROW_INFO(pDevice->CreateTexture2D(&textureDesc, nullptr, &pBackBuffer));
+	GFX_THROW_INFO(pDevice->CreateRenderTargetView(pBackBuffer.Get(), nullptr, &pTarget));
+}
+
 void Graphics::SetupRenderTarget()
 {
 	HRESULT hr;
@@ -104,7 +204,21 @@ void Graphics::SetupViewport(int width, int height)
 #pragma endregion DirectX Setup Functions
 
 Graphics::~Graphics() {
-	ImGui_ImplDX11_Shutdown();
+	if (frameLatencyWaitable != nullptr) {
+		CloseHandle(frameLatencyWaitable);
+	}
+	if (!IsHeadless()) {
+		ImGui_ImplDX11_Shutdown();
+	}
+}
+
+void Graphics::WaitForFrame() noexcept
+{
+	if (frameLatencyWaitable != nullptr) {
+		PROFILE_ZONE("Wait for frame latency");
+		//bounded so a present that never completes can't hang the window
+		WaitForSingleObjectEx(frameLatencyWaitable, 1000u, TRUE);
+	}
 }
 
 void Graphics::BeginFrame(DirectX::XMFLOAT4 colour) noexcept
@@ -117,6 +231,9 @@ void Graphics::BeginFrame(DirectX::XMFLOAT4 colour) noexcept
 
 	const float color[] = { colour.x, colour.y, colour.z, 0.0f };
 	pContext->ClearRenderTargetView(pTarget.Get(), color);
+
+	// imgui and render target hazards change slots behind our back, so start each frame clean
+	ResetBindState();
 }
 
 void Graphics::EndFrame()
@@ -129,34 +246,185 @@ void Graphics::EndFrame()
 
 	HRESULT hr; //GFX_THROW_FAILED requires a local hresult variable
 
-#ifndef NDEBUG
-	infoManager.Set();
-#endif // !NDEBUG
+	//anything the debug layer reported this frame, before present adds its own
+	GFX_THROW_INFO_DRAIN("the frame");
 
-	if (FAILED(hr = pSwap->Present(1u, 0u))) { //if the buffer swap fails
-		if (hr == DXGI_ERROR_DEVICE_REMOVED) { //unstable gpu error
-			throw GFX_DEVICE_REMOVED_EXCEPT(pDevice->GetDeviceRemovedReason()); //gets the reason for this error, usually caused due to hardware errors or drivers
-		}
-		else
-		{
-			throw GFX_EXCEPT(hr); //General purpose error
+	if (IsHeadless()) {
+		//nothing to present, just hand the frame's commands to the device
+		pContext->Flush();
+		return;
+	}
+
+	const UINT syncInterval = presentSettings.vsync ? 1u : 0u;
+	const UINT presentFlags = !presentSettings.vsync && tearingSupported ? DXGI_PRESENT_ALLOW_TEARING : 0u;
+	{
+		PROFILE_ZONE("Present");
+		if (FAILED(hr = pSwap->Present(syncInterval, presentFlags))) { //if the buffer swap fails
+			if (hr == DXGI_ERROR_DEVICE_REMOVED) { //unstable gpu error
+				throw GFX_DEVICE_REMOVED_EXCEPT(pDevice->GetDeviceRemovedReason()); //gets the reason for this error, usually caused due to hardware errors or drivers
+			}
+			else
+			{
+				throw GFX_EXCEPT(hr); //General purpose error
+			}
 		}
 	}
+
+	//vblank counts are exact when dxgi has them, they lag a few presents behind
+	pacer.OnPresent(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	DXGI_FRAME_STATISTICS frameStats;
+	if (SUCCEEDED(pSwap->GetFrameStatistics(&frameStats))) {
+		pacer.OnFrameStatistics(frameStats.PresentCount, frameStats.SyncRefreshCount);
+	}
+	const auto pacing = pacer.GetStats();
+	PROFILE_COUNTER("Present interval (us)", pacing.lastMs * 1000.0f);
+	PROFILE_COUNTER("Dropped frames", pacing.dropped);
+}
+
+void Graphics::SetVsync(bool enable) noexcept
+{
+	presentSettings.vsync = enable;
+	pacer.SetSyncInterval(enable ? 1u : 0u);
+}
+
+void Graphics::SetMaxFrameLatency(UINT frames)
+{
+	presentSettings.maxFrameLatency = frames;
+	if (IsHeadless()) {
+		return;
+	}
+	HRESULT hr;
+	wrl::ComPtr<IDXGISwapChain2> pSwap2;
+	GFX_THROW_INFO(pSwap.As(&pSwap2));
+	GFX_THROW_INFO(pSwap2->SetMaximumFrameLatency(frames));
+}
+
+void Graphics::SetBufferCount(UINT count)
+{
+	presentSettings.bufferCount = std::clamp(count, 2u, UINT(DXGI_MAX_SWAP_CHAIN_BUFFERS));
+	if (IsHeadless()) {
+		return;
+	}
+	HRESULT hr;
+	//the buffers can only be replaced once nothing refers to them
+	pContext->OMSetRenderTargets(0u, nullptr, nullptr);
+	pTarget.Reset();
+	pContext->Flush();
+	GFX_THROW_INFO(pSwap->ResizeBuffers(presentSettings.bufferCount, 0u, 0u, DXGI_FORMAT_UNKNOWN, swapFlags));
+	SetupRenderTarget();
+	BindSwapBuffer();
 }
 
 void Graphics::BindSwapBuffer() noexcept
 {
 	pContext->OMSetRenderTargets(1u, pTarget.GetAddressOf(), nullptr);
+	// render targets may have shrunk the viewport
+	SetupViewport(width, height);
 }
 
 void Graphics::BindSwapBuffer(const DepthStencil& ds) noexcept
 {
 	pContext->OMSetRenderTargets(1u, pTarget.GetAddressOf(), ds.pDepthStencilView.Get());
+	SetupViewport(width, height);
+}
+
+void Graphics::DrainDebugMessages(const char* context) noxnd
+{
+	GFX_THROW_INFO_DRAIN(context);
+}
+
+void Graphics::SetDebugChecksBatched(bool enable) noexcept
+{
+#ifndef NDEBUG
+	infoManager.SetBatched(enable);
+#endif
+}
+
+void Graphics::DrawIndexed(UINT count, UINT startIndex, INT baseVertex) noxnd
+{
+	bindStats.drawCalls++;
+	GFX_THROW_INFO_ONLY(pContext->DrawIndexed(count, startIndex, baseVertex));
 }
 
-void Graphics::DrawIndexed(UINT count) noxnd
+void Graphics::DrawIndexedInstanced(UINT count, UINT instances, UINT startIndex, INT baseVertex) noxnd
 {
-	GFX_THROW_INFO_ONLY(pContext->DrawIndexed(count, 0u, 0u));
+	bindStats.drawCalls++;
+	GFX_THROW_INFO_ONLY(pContext->DrawIndexedInstanced(count, instances, startIndex, baseVertex, 0u));
+}
+
+void Graphics::BindVertexBuffer(ID3D11Buffer* pBuffer, UINT stride) noexcept
+{
+	if (boundVertexBuffer == pBuffer)
+	{
+		bindStats.bufferBindsSkipped++;
+		return;
+	}
+	const UINT offset = 0u;
+	pContext->IASetVertexBuffers(0u, 1u, &pBuffer, &stride, &offset);
+	boundVertexBuffer = pBuffer;
+	bindStats.bufferBinds++;
+}
+
+void Graphics::BindIndexBuffer(ID3D11Buffer* pBuffer, DXGI_FORMAT format) noexcept
+{
+	if (boundIndexBuffer == pBuffer)
+	{
+		bindStats.bufferBindsSkipped++;
+		return;
+	}
+	pContext->IASetIndexBuffer(pBuffer, format, 0u);
+	boundIndexBuffer = pBuffer;
+	bindStats.bufferBinds++;
+}
+
+void Graphics::ResetBindState() noexcept
+{
+	// the device's slots are cleared along with the cache, a view left bound there while the
+	// cache forgot it would never be unbound before becoming a render target
+	const std::array<ID3D11ShaderResourceView*, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> nulls = {};
+	pContext->PSSetShaderResources(0u, (UINT)nulls.size(), nulls.data());
+	boundPixelSrvs.fill(nullptr);
+	boundVertexBuffer = nullptr;
+	boundIndexBuffer = nullptr;
+	bindStats = {};
+}
+
+void Graphics::UnbindPixelShaderResource(ID3D11ShaderResourceView* pView) noexcept
+{
+#ifndef NDEBUG
+	// a slot bound behind the cache's back would keep the view bound as it becomes a target
+	std::array<ID3D11ShaderResourceView*, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> deviceSrvs = {};
+	pContext->PSGetShaderResources(0u, (UINT)deviceSrvs.size(), deviceSrvs.data());
+	for (UINT slot = 0u; slot < deviceSrvs.size(); slot++)
+	{
+		if (deviceSrvs[slot] != nullptr)
+		{
+			deviceSrvs[slot]->Release();
+		}
+		assert(deviceSrvs[slot] == boundPixelSrvs[slot] && "Pixel shader view bound without BindPixelShaderResource");
+	}
+#endif
+	for (UINT slot = 0u; slot < boundPixelSrvs.size(); slot++)
+	{
+		if (boundPixelSrvs[slot] == pView)
+		{
+			ID3D11ShaderResourceView* const pNull = nullptr;
+			pContext->PSSetShaderResources(slot, 1u, &pNull);
+			boundPixelSrvs[slot] = nullptr;
+		}
+	}
+}
+
+void Graphics::BindPixelShaderResource(UINT slot, ID3D11ShaderResourceView* pView) noexcept
+{
+	if (boundPixelSrvs[slot] == pView)
+	{
+		bindStats.srvBindsSkipped++;
+		return;
+	}
+	boundPixelSrvs[slot] = pView;
+	bindStats.srvBinds++;
+	pContext->PSSetShaderResources(slot, 1u, &pView);
 }
 
 //Graphics Exception Classes
@@ -3,16 +3,20 @@
 #include "RedSkyWin.h"
 #include "RedSkyException.h"
 #include <d3d11.h>
+#include <dxgi1_5.h>
 #include <wrl.h>
 #include <vector>
 #include <memory>
 #include "DxgiInfoManager.h"
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
+#include <DirectXCollision.h>
 #include <memory>
 #include <random>
+#include <array>
 
 #include "ConditionalNoexcept.h"
+#include "FramePacer.h"
 
 class DepthStencil;
 
@@ -60,41 +64,138 @@ public:
 	};
 
 
+public:
+	//Pixel shader resource binds, draws and bytes uploaded since BeginFrame
+	struct BindStats
+	{
+		UINT srvBinds = 0u;
+		UINT srvBindsSkipped = 0u;
+		UINT drawCalls = 0u;
+		size_t uploadBytes = 0u;
+		UINT bindableBinds = 0u;
+		//buffers, textures, shaders, states and queries created, a texture's views count with it
+		UINT resourcesCreated = 0u;
+		size_t constantBufferBytes = 0u;
+		UINT culledDraws = 0u;
+		//jobs drawn as instances of a shared draw call instead of with their own
+		UINT instancedJobs = 0u;
+		UINT bufferBinds = 0u;
+		UINT bufferBindsSkipped = 0u;
+	};
+	//Device used by a headless Graphics. Null accepts every call but never executes
+	//anything, so only the cpu side of a frame is measured
+	enum class Backend
+	{
+		Hardware,
+		Warp,
+		Null,
+	};
+	//Flip model swap chain setup
+	struct PresentSettings
+	{
+		UINT bufferCount = 2u;
+		//frames the cpu may queue ahead of the gpu, waited on before each frame's input
+		UINT maxFrameLatency = 1u;
+		bool vsync = true;
+		//with vsync off, present without waiting for a vblank when the system supports it
+		bool allowTearing = true;
+	};
+
 public:
 	//Constructor related methods
-	Graphics(HWND hWnd, int width, int height);
+	Graphics(HWND hWnd, int width, int height, const PresentSettings& settings = {});
+	//Windowless, renders into an offscreen target and never presents
+	Graphics(int width, int height, Backend backend);
 	Graphics(const Graphics&) = delete;
 	Graphics& operator=(const Graphics&) = delete;
 	~Graphics();
 
 	//DirectX Setup
 	void SetupSwapchainAndDevice(HWND& hWnd, int width, int height);
+	void SetupFrameLatency();
+	void SetupHeadlessDevice(int width, int height, Backend backend);
 	void SetupRenderTarget();
 	void SetupViewport(int width, int height);
 
 	//Swap Chain related functions
+	//Blocks until the swap chain can take another frame, call before reading the frame's input
+	void WaitForFrame() noexcept;
 	void EndFrame();
 	void BeginFrame(DirectX::XMFLOAT4 colour) noexcept;
 	void BindSwapBuffer() noexcept;
 	void BindSwapBuffer(const DepthStencil& ds) noexcept;
 
 
+	//Debug builds throw with any warnings or errors the debug layer reported since the last
+	//drain, context names the work that just ran. Does nothing in release builds
+	void DrainDebugMessages(const char* context) noxnd;
+	//Checks the debug layer after every wrapped call instead of at each drain, slow but exact
+	void SetDebugChecksBatched(bool enable) noexcept;
+
 	//Indexed Objects
-	void DrawIndexed(UINT count) noxnd;
+	void DrawIndexed(UINT count, UINT startIndex = 0u, INT baseVertex = 0) noxnd;
+	void DrawIndexedInstanced(UINT count, UINT instances, UINT startIndex = 0u, INT baseVertex = 0) noxnd;
+
+	//Input assembler buffer binds, skipped when that buffer is already bound this frame.
+	//Meshes merged into shared buffers skip them on every draw after the first
+	void BindVertexBuffer(ID3D11Buffer* pBuffer, UINT stride) noexcept;
+	void BindIndexBuffer(ID3D11Buffer* pBuffer, DXGI_FORMAT format = DXGI_FORMAT_R16_UINT) noexcept;
+
+	//Binds a pixel shader resource unless it is already bound to that slot this frame. Every
+	//pixel shader view must be bound through here so the cached slots match the device's
+	void BindPixelShaderResource(UINT slot, ID3D11ShaderResourceView* pView) noexcept;
+	//Unbinds a view from every slot it occupies, before its texture becomes a render target.
+	//Goes by the cached slots, debug builds check them against the device
+	void UnbindPixelShaderResource(ID3D11ShaderResourceView* pView) noexcept;
+	const BindStats& GetBindStats() const noexcept { return bindStats; }
+	void CountUpload(size_t bytes) noexcept { bindStats.uploadBytes += bytes; }
+	void CountConstantBufferUpload(size_t bytes) noexcept { bindStats.constantBufferBytes += bytes; CountUpload(bytes); }
+	void CountCulledDraw() noexcept { bindStats.culledDraws++; }
+	void CountInstancedJobs(UINT count) noexcept { bindStats.instancedJobs += count; }
+	void CountBindableBinds(size_t count) noexcept { bindStats.bindableBinds += (UINT)count; }
+	void CountResourceCreated() noexcept { bindStats.resourcesCreated++; }
+	void ResetBindState() noexcept;
 
 	//Getter/Setter for the projection
-	void SetProjection(DirectX::FXMMATRIX proj) noexcept { projection = proj; }
+	void SetProjection(DirectX::FXMMATRIX proj) noexcept
+	{
+		projection = proj;
+		DirectX::BoundingFrustum::CreateFromMatrix(viewFrustum, proj);
+	}
 	DirectX::XMMATRIX GetProjection() const noexcept { return projection; }
 
 	//Getter/Setter for camera
 	void SetCamera(DirectX::FXMMATRIX cam) noexcept { camera = cam; }
 	DirectX::XMMATRIX GetCamera() const noexcept { return camera; }
 
+	//View space frustum of the projection, draws whose bounds fall outside it are skipped
+	const DirectX::BoundingFrustum& GetViewFrustum() const noexcept { return viewFrustum; }
+	void EnableCulling(bool enable) noexcept { cullingEnabled = enable; }
+	bool IsCullingEnabled() const noexcept { return cullingEnabled; }
+
+	//Passes merge jobs sharing geometry and step state into instanced draws
+	void EnableInstancing(bool enable) noexcept { instancingEnabled = enable; }
+	bool IsInstancingEnabled() const noexcept { return instancingEnabled; }
+
+	//Screen pixels spanned by one unit of uv for the draw being recorded, 0 when unknown
+	void SetTexelDemand(float screenPixelsPerUv) noexcept { texelDemand = screenPixelsPerUv; }
+	float GetTexelDemand() const noexcept { return texelDemand; }
+
 	//Getter/Setter for ImGui
-	void EnableImgui() noexcept { imguiEnabled = true; }
+	void EnableImgui() noexcept { imguiEnabled = !IsHeadless(); }
 	void DisableImgui() noexcept { imguiEnabled = false; }
 	bool IsImGuiEnabled() const noexcept { return imguiEnabled; }
 
+	bool IsHeadless() const noexcept { return pSwap == nullptr; }
+
+	//Presentation settings, take effect from the next present
+	void SetVsync(bool enable) noexcept;
+	void SetMaxFrameLatency(UINT frames);
+	void SetBufferCount(UINT count);
+	const PresentSettings& GetPresentSettings() const noexcept { return presentSettings; }
+	bool IsTearingSupported() const noexcept { return tearingSupported; }
+	const FramePacer& GetFramePacer() const noexcept { return pacer; }
+
 	UINT GetWidth() const noexcept { return width; }
 	UINT GetHeight() const noexcept { return height; }
 
@@ -104,8 +205,21 @@ private:
 
 	DirectX::XMMATRIX camera;
 	DirectX::XMMATRIX projection;
+	DirectX::BoundingFrustum viewFrustum;
+	bool cullingEnabled = true;
+	bool instancingEnabled = true;
+	float texelDemand = 0.0f;
+	std::array<ID3D11ShaderResourceView*, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> boundPixelSrvs = {};
+	ID3D11Buffer* boundVertexBuffer = nullptr;
+	ID3D11Buffer* boundIndexBuffer = nullptr;
+	BindStats bindStats;
 
 	bool imguiEnabled = true;
+	PresentSettings presentSettings;
+	bool tearingSupported = false;
+	UINT swapFlags = 0u;
+	HANDLE frameLatencyWaitable = nullptr;
+	FramePacer pacer;
 #ifndef NDEBUG 
 	//if not in debug mode
 	DxgiInfoManager infoManager;
@@ -6,14 +6,17 @@
 
 #ifndef NDEBUG //if in debug mode //use the info manager to add additional messages to the error window 
 #define GFX_EXCEPT(hr) Graphics::HrException( __LINE__,__FILE__,(hr),infoManager.GetMessages() )
-#define GFX_THROW_INFO(hrcall) infoManager.Set(); if( FAILED( hr = (hrcall) ) ) throw GFX_EXCEPT(hr) //calls set so only new messages are outputted 
+#define GFX_THROW_INFO(hrcall) infoManager.Begin(__FILE__,__LINE__,#hrcall); if( FAILED( hr = (hrcall) ) ) throw GFX_EXCEPT(hr) //only new messages are outputted, or since the last drain when batched
 #define GFX_DEVICE_REMOVED_EXCEPT(hr) Graphics::DeviceRemovedException( __LINE__,__FILE__,(hr),infoManager.GetMessages() )
-#define GFX_THROW_INFO_ONLY(call) infoManager.Set(); (call); {auto v = infoManager.GetMessages(); if(!v.empty()) {throw Graphics::InfoException(__LINE__,__FILE__,v);}}
+#define GFX_THROW_INFO_ONLY(call) infoManager.Begin(__FILE__,__LINE__,#call); (call); infoManager.Check(__LINE__,__FILE__)
+//throws with whatever the debug layer reported since the last drain, context names what just ran
+#define GFX_THROW_INFO_DRAIN(context) {auto v = infoManager.Drain(context); if(!v.empty()) {throw Graphics::InfoException(__LINE__,__FILE__,v);}}
 #else //if in release mode
 #define GFX_EXCEPT(hr) Graphics::HrException( __LINE__,__FILE__,(hr) )
 #define GFX_THROW_INFO(hrcall) GFX_THROW_NOINFO(hrcall) //throws with no information if in release mode
 #define GFX_DEVICE_REMOVED_EXCEPT(hr) Graphics::DeviceRemovedException(__LINE__,__FILE__,(hr))
 #define GFX_THROW_INFO_ONLY(call) (call)
+#define GFX_THROW_INFO_DRAIN(context)
 #endif
 
 #ifdef NDEBUG
@@ -0,0 +1,372 @@
+#include "HeadlessBenchmark.h"
+#include "FrameCommander.h"
+#include "Model.h"
+#include "PointLight.h"
+#include "TestCube.h"
+#include "Camera.h"
+#include "RedSkyMath.h"
+#include "json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace jso = nlohmann;
+
+int HeadlessBenchmark::RunFromCommandLine(const std::vector<std::string>& args)
+{
+	Settings settings;
+	try
+	{
+		for (size_t i = 1; i + 1 < args.size(); i += 2)
+		{
+			const auto& key = args[i];
+			const auto& value = args[i + 1];
+			if (key == "--scene")
+			{
+				settings.scene = value;
+			}
+			else if (key == "--model")
+			{
+				settings.scene = "model";
+				settings.modelPath = value;
+			}
+			else if (key == "--scale")
+			{
+				settings.scale = std::stof(value);
+			}
+			else if (key == "--cubes")
+			{
+				settings.cubeCount = (unsigned int)std::stoul(value);
+			}
+			else if (key == "--frames")
+			{
+				settings.frames = (unsigned int)std::stoul(value);
+			}
+			else if (key == "--culling")
+			{
+				settings.culling = value != "0";
+			}
+			else if (key == "--instancing")
+			{
+				settings.instancing = value != "0";
+			}
+			else if (key == "--merge")
+			{
+				settings.mergeMeshes = value != "0";
+			}
+			else if (key == "--prepass")
+			{
+				settings.depthPrepass = value != "0";
+			}
+			else if (key == "--lights")
+			{
+				settings.lights = (unsigned int)std::stoul(value);
+			}
+			else if (key == "--light-radius")
+			{
+				settings.lightRadius = std::stof(value);
+			}
+			else if (key == "--backend")
+			{
+				settings.backend = value == "hardware" ? Graphics::Backend::Hardware :
+					value == "warp" ? Graphics::Backend::Warp : Graphics::Backend::Null;
+			}
+			else if (key == "--report")
+			{
+				settings.reportPath = value;
+			}
+			else if (key == "--baseline")
+			{
+				settings.baselinePath = value;
+			}
+			else if (key == "--tolerance")
+			{
+				settings.tolerance = std::stof(value);
+			}
+		}
+
+		const auto result = Run(settings);
+		WriteReport(result, settings);
+		if (!settings.baselinePath.empty())
+		{
+			const auto regression = CompareToBaseline(result, settings.baselinePath, settings.tolerance);
+			if (!regression.empty())
+			{
+				std::ofstream{ settings.reportPath + ".regression.txt" } << regression;
+				return 1;
+			}
+		}
+		return 0;
+	}
+	// there is no window to show errors in, so they go next to the report
+	catch (const std::exception& e)
+	{
+		std::ofstream{ settings.reportPath + ".error.txt" } << e.what();
+	}
+	return -1;
+}
+
+HeadlessBenchmark::Settings HeadlessBenchmark::ParseSettings(const std::string& json)
+{
+	const auto j = jso::json::parse(json);
+	Settings s;
+	s.scene = j.value("scene", s.scene);
+	s.modelPath = j.value("modelPath", s.modelPath);
+	s.scale = j.value("scale", s.scale);
+	s.cubeCount = j.value("cubeCount", s.cubeCount);
+	s.frames = j.value("frames", s.frames);
+	s.culling = j.value("culling", s.culling);
+	s.instancing = j.value("instancing", s.instancing);
+	s.mergeMeshes = j.value("mergeMeshes", s.mergeMeshes);
+	s.depthPrepass = j.value("depthPrepass", s.depthPrepass);
+	s.lights = j.value("lights", s.lights);
+	s.lightRadius = j.value("lightRadius", s.lightRadius);
+	const auto backend = j.value("backend", std::string{ "null" });
+	s.backend = backend == "hardware" ? Graphics::Backend::Hardware :
+		backend == "warp" ? Graphics::Backend::Warp : Graphics::Backend::Null;
+	s.reportPath = j.value("report", s.reportPath);
+	s.baselinePath = j.value("baseline", s.baselinePath);
+	s.tolerance = j.value("tolerance", s.tolerance);
+	if (j.contains("path"))
+	{
+		for (const auto& k : j.at("path"))
+		{
+			const auto& p = k.at("pos");
+			s.path.push_back({
+				{ p.at(0).get<float>(),p.at(1).get<float>(),p.at(2).get<float>() },
+				to_rad(k.value("pitch", 0.0f)),
+				to_rad(k.value("yaw", 0.0f))
+			});
+		}
+	}
+	return s;
+}
+
+HeadlessBenchmark::Result HeadlessBenchmark::Run(const Settings& settings)
+{
+	namespace dx = DirectX;
+	using Clock = std::chrono::steady_clock;
+	Result result;
+
+	// bindables shared by an earlier run belong to a device that no longer exists
+	Bind::Codex::Clear();
+	Graphics gfx{ 1280,720,settings.backend };
+	gfx.SetProjection(dx::XMMatrixPerspectiveLH(1.0f, 9.0f / 16.0f, 0.5f, 400.0f));
+	gfx.EnableCulling(settings.culling);
+	gfx.EnableInstancing(settings.instancing);
+
+	const auto loadStart = Clock::now();
+	FrameCommander fc{ gfx };
+	fc.EnableDepthPrepass(settings.depthPrepass);
+	PointLight light{ gfx };
+	std::unique_ptr<Model> pModel;
+	std::vector<std::unique_ptr<TestCube>> cubes;
+	if (settings.scene == "sponza")
+	{
+		pModel = std::make_unique<Model>(gfx, "Models\\Sponza\\sponza.obj", 1.0f / 20.0f, settings.mergeMeshes);
+	}
+	else if (settings.scene == "nanosuit")
+	{
+		pModel = std::make_unique<Model>(gfx, "Models\\nanoTextured\\nanosuit.obj", 2.0f, settings.mergeMeshes);
+	}
+	else if (settings.scene == "cubes")
+	{
+		// square grid centered on the origin
+		const auto side = (unsigned int)std::ceil(std::sqrt(float(settings.cubeCount)));
+		for (unsigned int i = 0; i < settings.cubeCount; i++)
+		{
+			auto& c = cubes.emplace_back(std::make_unique<TestCube>(gfx, 4.0f));
+			c->SetPos({ (float(i % side) - float(side - 1u) * 0.5f) * 6.0f,0.0f,(float(i / side) - float(side - 1u) * 0.5f) * 6.0f });
+		}
+	}
+	else
+	{
+		pModel = std::make_unique<Model>(gfx, settings.modelPath, settings.scale, settings.mergeMeshes);
+	}
+	if (settings.scene == "cubes")
+	{
+		const float extent = std::ceil(std::sqrt(float(settings.cubeCount))) * 3.0f;
+		fc.GetLights().Scatter(settings.lights, settings.lightRadius, { -extent,0.0f,-extent }, { extent,10.0f,extent });
+	}
+	else
+	{
+		fc.GetLights().Scatter(settings.lights, settings.lightRadius, { -60.0f,0.0f,-30.0f }, { 60.0f,40.0f,30.0f });
+	}
+	result.loadMs = std::chrono::duration<float, std::milli>(Clock::now() - loadStart).count();
+	result.resourcesCreated = gfx.GetBindStats().resourcesCreated;
+
+	const auto path = settings.path.empty() ? MakeDefaultPath(settings) : CameraPath{ settings.path };
+	Camera cam;
+	std::vector<float> frameMs;
+	frameMs.reserve(settings.frames);
+	for (unsigned int i = 0; i < settings.frames; i++)
+	{
+		const auto frameStart = Clock::now();
+		{
+			PROFILE_ZONE("Benchmark frame");
+			gfx.BeginFrame({ 0.1f,0.1f,0.2f,1.0f });
+			const auto key = path.Sample(settings.frames > 1u ? float(i) / float(settings.frames - 1u) : 0.0f);
+			cam.SetPose(key.pos, key.pitch, key.yaw);
+			gfx.SetCamera(cam.GetMatrix());
+			{
+				PROFILE_ZONE("Submit");
+				light.Submit(fc);
+				if (pModel)
+				{
+					pModel->Submit(fc);
+				}
+				for (const auto& c : cubes)
+				{
+					c->Submit(fc);
+				}
+			}
+			result.jobs += fc.GetJobCount();
+			fc.Execute(gfx);
+			result.tileLights += fc.GetLights().GetBinner().GetLightIndices().size();
+
+			const auto& stats = gfx.GetBindStats();
+			result.drawCalls += stats.drawCalls;
+			result.culledDraws += stats.culledDraws;
+			result.instancedJobs += stats.instancedJobs;
+			result.bindableBinds += stats.bindableBinds;
+			result.bufferBinds += stats.bufferBinds;
+			result.srvBinds += stats.srvBinds;
+			result.constantBufferBytes += stats.constantBufferBytes;
+			result.uploadBytes += stats.uploadBytes;
+
+			gfx.EndFrame();
+			fc.Reset();
+		}
+		Profiler::EndFrame();
+		frameMs.push_back(std::chrono::duration<float, std::milli>(Clock::now() - frameStart).count());
+	}
+	result.stages = Profiler::GetStats();
+
+	if (!frameMs.empty())
+	{
+		float sum = 0.0f;
+		for (auto ms : frameMs)
+		{
+			sum += ms;
+		}
+		std::sort(frameMs.begin(), frameMs.end());
+		result.avgFrameMs = sum / float(frameMs.size());
+		result.p95FrameMs = frameMs[(frameMs.size() * 95u + 99u) / 100u - 1u];
+		result.maxFrameMs = frameMs.back();
+	}
+	return result;
+}
+
+void HeadlessBenchmark::WriteReport(const Result& result, const Settings& settings)
+{
+	jso::json j;
+	j["scene"] = settings.scene == "model" ? settings.modelPath : settings.scene;
+	j["frames"] = settings.frames;
+	j["culling"] = settings.culling;
+	j["instancing"] = settings.instancing;
+	j["mergeMeshes"] = settings.mergeMeshes;
+	j["depthPrepass"] = settings.depthPrepass;
+	j["lights"] = settings.lights;
+	j["loadMs"] = result.loadMs;
+	j["avgFrameMs"] = result.avgFrameMs;
+	j["p95FrameMs"] = result.p95FrameMs;
+	j["maxFrameMs"] = result.maxFrameMs;
+	j["resourcesCreated"] = result.resourcesCreated;
+	j["jobs"] = result.jobs;
+	j["drawCalls"] = result.drawCalls;
+	j["culledDraws"] = result.culledDraws;
+	j["instancedJobs"] = result.instancedJobs;
+	j["bindableBinds"] = result.bindableBinds;
+	j["bufferBinds"] = result.bufferBinds;
+	j["tileLights"] = result.tileLights;
+	j["srvBinds"] = result.srvBinds;
+	j["constantBufferBytes"] = result.constantBufferBytes;
+	j["uploadBytes"] = result.uploadBytes;
+	auto& stages = j["stages"] = jso::json::array();
+	for (const auto& s : result.stages)
+	{
+		stages.push_back({
+			{ "zone",s.zone->name },
+			{ "parent",s.parent ? s.parent->name : "" },
+			{ "thread",s.thread },
+			{ "calls",s.calls },
+			{ "minMs",s.minMs },
+			{ "avgMs",s.avgMs },
+			{ "p95Ms",s.p95Ms },
+			{ "maxMs",s.maxMs },
+		});
+	}
+	std::ofstream{ settings.reportPath } << j.dump(1, '\t');
+}
+
+std::string HeadlessBenchmark::CompareToBaseline(const Result& result, const std::string& baselinePath, float tolerance)
+{
+	std::ifstream file{ baselinePath };
+	if (!file.is_open())
+	{
+		return "Unable to open baseline " + baselinePath + "\n";
+	}
+	jso::json baseline;
+	file >> baseline;
+
+	std::ostringstream oss;
+	// the submitted work is deterministic, any change in it is a behaviour change
+	const auto count = [&](const char* key, size_t value)
+	{
+		// baselines from before a count existed don't check it
+		if (!baseline.contains(key))
+		{
+			return;
+		}
+		const auto expected = baseline.at(key).get<size_t>();
+		if (expected != value)
+		{
+			oss << key << ": " << value << " (baseline " << expected << ")\n";
+		}
+	};
+	const auto time = [&](const char* key, float value)
+	{
+		const auto expected = baseline.at(key).get<float>();
+		if (value > expected * (1.0f + tolerance))
+		{
+			oss << key << ": " << value << "ms (baseline " << expected << "ms)\n";
+		}
+	};
+	count("resourcesCreated", result.resourcesCreated);
+	count("jobs", result.jobs);
+	count("drawCalls", result.drawCalls);
+	count("culledDraws", result.culledDraws);
+	count("instancedJobs", result.instancedJobs);
+	count("bindableBinds", result.bindableBinds);
+	count("bufferBinds", result.bufferBinds);
+	count("tileLights", result.tileLights);
+	count("srvBinds", result.srvBinds);
+	count("constantBufferBytes", result.constantBufferBytes);
+	time("loadMs", result.loadMs);
+	time("avgFrameMs", result.avgFrameMs);
+	time("p95FrameMs", result.p95FrameMs);
+	return oss.str();
+}
+
+CameraPath HeadlessBenchmark::MakeDefaultPath(const Settings& settings)
+{
+	if (settings.scene == "sponza")
+	{
+		// down the length of the atrium, then turn and come back higher up
+		return { {
+			{ { -47.0f,10.0f,1.4f },0.0f,PI / 2.0f },
+			{ { 0.0f,10.0f,1.4f },0.0f,PI / 2.0f },
+			{ { 45.0f,10.0f,1.4f },0.0f,PI / 2.0f },
+			{ { 45.0f,25.0f,1.4f },0.2f,PI * 1.5f },
+			{ { -47.0f,25.0f,1.4f },0.2f,PI * 1.5f },
+		} };
+	}
+	if (settings.scene == "cubes")
+	{
+		const float extent = std::ceil(std::sqrt(float(settings.cubeCount))) * 6.0f;
+		return CameraPath::MakeOrbit({ 0.0f,0.0f,0.0f }, extent * 0.75f + 10.0f, extent * 0.5f);
+	}
+	return CameraPath::MakeOrbit({ 0.0f,15.0f,0.0f }, 40.0f, 5.0f);
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "Graphics.h"
+#include "CameraPath.h"
+#include "PerformanceLog.h"
+#include <string>
+#include <vector>
+
+// Runs the cpu side of the renderer without a window or imgui. A named scene is loaded on
+// a headless Graphics (the d3d null device by default, so no gpu is needed), the camera
+// flies a scripted path for a fixed number of frames, and load/frame timings, per stage
+// profiler zones and call counts are written as json. Given a baseline report it fails
+// when counts differ or timings regress.
+class HeadlessBenchmark
+{
+public:
+	struct Settings
+	{
+		// sponza, nanosuit, cubes or model (modelPath at scale)
+		std::string scene = "sponza";
+		std::string modelPath;
+		float scale = 1.0f;
+		unsigned int cubeCount = 100u;
+		unsigned int frames = 300u;
+		// empty for the scene's default flight
+		std::vector<CameraPath::Key> path;
+		bool culling = true;
+		bool instancing = true;
+		// load models with their meshes merged into shared buffers
+		bool mergeMeshes = true;
+		bool depthPrepass = true;
+		// point lights scattered through the scene besides its main light
+		unsigned int lights = 0u;
+		float lightRadius = 8.0f;
+		Graphics::Backend backend = Graphics::Backend::Null;
+		std::string reportPath = "benchmark-report.json";
+		// empty to skip the regression check
+		std::string baselinePath;
+		// allowed slowdown relative to the baseline timings
+		float tolerance = 0.1f;
+	};
+	struct Result
+	{
+		float loadMs = 0.0f;
+		float avgFrameMs = 0.0f;
+		float p95FrameMs = 0.0f;
+		float maxFrameMs = 0.0f;
+		// resources created while loading, the rest are totals over every frame
+		UINT resourcesCreated = 0u;
+		size_t jobs = 0u;
+		size_t drawCalls = 0u;
+		size_t culledDraws = 0u;
+		size_t instancedJobs = 0u;
+		size_t bindableBinds = 0u;
+		// vertex/index buffer binds that reached the context
+		size_t bufferBinds = 0u;
+		// lights binned into screen tiles, a light counts once for every tile it reaches
+		size_t tileLights = 0u;
+		size_t srvBinds = 0u;
+		size_t constantBufferBytes = 0u;
+		// depends on how far streaming got, so it is reported but not compared
+		size_t uploadBytes = 0u;
+		// profiler zones over the last frames of the run
+		std::vector<Profiler::ZoneStats> stages;
+	};
+public:
+	// --headless [--scene s] [--model path] [--scale s] [--cubes n] [--frames n] [--culling 0|1] [--instancing 0|1] [--merge 0|1] [--prepass 0|1]
+	// [--lights n] [--light-radius r] [--backend null|warp|hardware] [--report path] [--baseline path] [--tolerance t],
+	// returns the process exit code
+	static int RunFromCommandLine(const std::vector<std::string>& args);
+	// settings from a json object with the same keys as Settings, path keys take degrees
+	static Settings ParseSettings(const std::string& json);
+	static Result Run(const Settings& settings);
+	static void WriteReport(const Result& result, const Settings& settings);
+	// empty when result is within tolerance of the baseline, otherwise what regressed
+	static std::string CompareToBaseline(const Result& result, const std::string& baselinePath, float tolerance);
+	static CameraPath MakeDefaultPath(const Settings& settings);
+};
@@ -11,7 +11,20 @@ namespace Bind
 	IndexBuffer::IndexBuffer(Graphics& gfx, std::string tag, const std::vector<unsigned short>& indices)
 		:
 		tag(tag),
-		count((UINT)indices.size())
+		count((UINT)indices.size()),
+		format(DXGI_FORMAT_R16_UINT)
+	{
+		Create(gfx, indices.data(), sizeof(unsigned short));
+	}
+	IndexBuffer::IndexBuffer(Graphics& gfx, std::string tag, const std::vector<uint32_t>& indices)
+		:
+		tag(tag),
+		count((UINT)indices.size()),
+		format(DXGI_FORMAT_R32_UINT)
+	{
+		Create(gfx, indices.data(), sizeof(uint32_t));
+	}
+	void IndexBuffer::Create(Graphics& gfx, const void* pIndices, UINT indexSize)
 	{
 		INFOMAN(gfx);
 
@@ -20,16 +33,17 @@ namespace Bind
 		ibd.Usage = D3D11_USAGE_DEFAULT;
 		ibd.CPUAccessFlags = 0u;
 		ibd.MiscFlags = 0u;
-		ibd.ByteWidth = UINT(count * sizeof(unsigned short));
-		ibd.StructureByteStride = sizeof(unsigned short);
+		ibd.ByteWidth = count * indexSize;
+		ibd.StructureByteStride = indexSize;
 		D3D11_SUBRESOURCE_DATA isd = {};
-		isd.pSysMem = indices.data();
+		isd.pSysMem = pIndices;
 		GFX_THROW_INFO(GetDevice(gfx)->CreateBuffer(&ibd, &isd, &pIndexBuffer));
+		gfx.CountResourceCreated();
 	}
 
 	void IndexBuffer::Bind(Graphics& gfx) noexcept
 	{
-		GetContext(gfx)->IASetIndexBuffer(pIndexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0u);
+		gfx.BindIndexBuffer(pIndexBuffer.Get(), format);
 	}
 
 	UINT IndexBuffer::GetCount() const noexcept
@@ -42,6 +56,12 @@ namespace Bind
 		assert(tag != "?");
 		return Codex::Resolve<IndexBuffer>(gfx, tag, indices);
 	}
+	std::shared_ptr<IndexBuffer> IndexBuffer::Resolve(Graphics& gfx, const std::string& tag,
+		const std::vector<uint32_t>& indices)
+	{
+		assert(tag != "?");
+		return Codex::Resolve<IndexBuffer>(gfx, tag, indices);
+	}
 	std::string IndexBuffer::GenerateUID_(const std::string& tag)
 	{
 		using namespace std::string_literals;
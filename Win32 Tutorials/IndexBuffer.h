@@ -1,5 +1,6 @@
 #pragma once
 #include "Bindable.h"
+#include <cstdint>
 
 namespace Bind
 {
@@ -8,10 +9,14 @@ namespace Bind
 	public:
 		IndexBuffer(Graphics& gfx, const std::vector<unsigned short>& indices);
 		IndexBuffer(Graphics& gfx, std::string tag, const std::vector<unsigned short>& indices);
+		// for meshes past 65536 vertices
+		IndexBuffer(Graphics& gfx, std::string tag, const std::vector<uint32_t>& indices);
 		void Bind(Graphics& gfx) noexcept override;
 		UINT GetCount() const noexcept;
 		static std::shared_ptr<IndexBuffer> Resolve(Graphics& gfx, const std::string& tag,
 			const std::vector<unsigned short>& indices);
+		static std::shared_ptr<IndexBuffer> Resolve(Graphics& gfx, const std::string& tag,
+			const std::vector<uint32_t>& indices);
 		template<typename...Ignore>
 		static std::string GenerateUID(const std::string& tag, Ignore&&...ignore)
 		{
@@ -20,9 +25,11 @@ namespace Bind
 		std::string GetUID() const noexcept override;
 	private:
 		static std::string GenerateUID_(const std::string& tag);
+		void Create(Graphics& gfx, const void* pIndices, UINT indexSize);
 	protected:
 		std::string tag;
 		UINT count;
+		DXGI_FORMAT format;
 		Microsoft::WRL::ComPtr<ID3D11Buffer> pIndexBuffer;
 	};
 }
\ No newline at end of file
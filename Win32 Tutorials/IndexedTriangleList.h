@@ -1,13 +1,16 @@
 #pragma once
 #include "Vertex.h"
+#include "GeometryProcessor.h"
+#include <cstdint>
 #include <vector>
 #include <DirectXMath.h>
 
-class IndexedTriangleList
+template<typename Index>
+class BasicIndexedTriangleList
 {
 public:
-	IndexedTriangleList() = default;
-	IndexedTriangleList( rsexp::VertexBuffer verts_in,std::vector<unsigned short> indices_in )
+	BasicIndexedTriangleList() = default;
+	BasicIndexedTriangleList( rsexp::VertexBuffer verts_in,std::vector<Index> indices_in )
 		:
 		vertices( std::move( verts_in ) ),
 		indices( std::move( indices_in ) )
@@ -17,10 +20,10 @@ public:
 	}
 	void Transform( DirectX::FXMMATRIX matrix )
 	{
-		using Elements = rsexp::VertexLayout::ElementType;
-		for( int i = 0; i < vertices.Size(); i++ )
+		const rsexp::ElementView<rsexp::VertexLayout::Position3D> positions{ vertices };
+		for( size_t i = 0; i < vertices.Size(); i++ )
 		{
-			auto& pos = vertices[i].Attr<Elements::Position3D>();
+			auto& pos = positions[i];
 			DirectX::XMStoreFloat3(
 				&pos,
 				DirectX::XMVector3Transform( DirectX::XMLoadFloat3( &pos ),matrix )
@@ -29,26 +32,26 @@ public:
 	}
 	void SetNormalsIndependentFlat() noxnd
 	{
-		using namespace DirectX;
-		using Type = rsexp::VertexLayout::ElementType;
-		for( size_t i = 0; i < indices.size(); i += 3 )
-		{
-			auto v0 = vertices[indices[i]];
-			auto v1 = vertices[indices[i + 1]];
-			auto v2 = vertices[indices[i + 2]];
-			const auto p0 = XMLoadFloat3( &v0.Attr<Type::Position3D>() );
-			const auto p1 = XMLoadFloat3( &v1.Attr<Type::Position3D>() );
-			const auto p2 = XMLoadFloat3( &v2.Attr<Type::Position3D>() );
-
-			const auto n = XMVector3Normalize( XMVector3Cross( (p1 - p0),(p2 - p0) ) );
-			
-			XMStoreFloat3( &v0.Attr<Type::Normal>(),n );
-			XMStoreFloat3( &v1.Attr<Type::Normal>(),n );
-			XMStoreFloat3( &v2.Attr<Type::Normal>(),n );
-		}
+		GeometryProcessor::SetFlatNormals( vertices,indices );
+	}
+	// shared vertices get the average of their triangles, vertices on creases are split
+	void SetNormalsSmooth( GeometryProcessor::NormalWeighting weighting = GeometryProcessor::NormalWeighting::Angle,
+		float creaseAngle = float( PI_D ) )
+	{
+		GeometryProcessor::SetSmoothNormals( vertices,indices,weighting,creaseAngle );
+	}
+	// tangents and bitangents for normal mapping, normals and texture coordinates must be set
+	void SetTangentSpace()
+	{
+		GeometryProcessor::SetTangents( vertices,indices );
 	}
 
 public:
 	rsexp::VertexBuffer vertices;
-	std::vector<unsigned short> indices;
-};
\ No newline at end of file
+	std::vector<Index> indices;
+};
+
+// up to 65536 vertices
+using IndexedTriangleList = BasicIndexedTriangleList<unsigned short>;
+// for meshes past that, takes twice the index memory
+using IndexedTriangleList32 = BasicIndexedTriangleList<uint32_t>;
\ No newline at end of file
@@ -1,26 +1,82 @@
 #include "InputLayout.h"
 #include "GraphicsThrowMacros.h"
 #include "BindableCodex.h"
+#include "InputSignature.h"
 #include "Vertex.h"
 
+namespace
+{
+	// the elements a shader reads out of the vertex (slot 0) and instance (slot 1) layouts,
+	// the key names them so layouts matching the same way share it
+	std::vector<D3D11_INPUT_ELEMENT_DESC> Match(const rsexp::VertexLayout& layout,
+		const rsexp::VertexLayout& instanceLayout, ShaderBytecode vertexShaderBytecode, std::string& key)
+	{
+		std::vector<D3D11_INPUT_ELEMENT_DESC> offered;
+		std::vector<std::string> names;
+		for (const UINT slot : { 0u,1u })
+		{
+			const auto& lay = slot == 0u ? layout : instanceLayout;
+			const auto descs = lay.GetD3DLayout(slot, slot != 0u);
+			size_t d = 0u;
+			for (size_t i = 0; i < lay.GetElementCount(); i++)
+			{
+				const auto& e = lay.ResolveByIndex(i);
+				// a transform takes one desc per row
+				const size_t rows = e.GetType() == rsexp::VertexLayout::InstanceTransform ? 4u : 1u;
+				for (size_t r = 0; r < rows; r++, d++)
+				{
+					offered.push_back(descs[d]);
+					names.push_back((slot != 0u ? "|" : "") + std::string(e.GetCode()) + "@" + std::to_string(descs[d].AlignedByteOffset));
+				}
+			}
+		}
+		std::vector<InputSignature::Semantic> semantics;
+		semantics.reserve(offered.size());
+		for (const auto& d : offered)
+		{
+			semantics.push_back({ d.SemanticName,d.SemanticIndex });
+		}
+		const auto used = InputSignature{ vertexShaderBytecode }.GetUsedMask(semantics);
+		std::vector<D3D11_INPUT_ELEMENT_DESC> matched;
+		for (size_t i = 0; i < offered.size(); i++)
+		{
+			if (used >> i & 1u)
+			{
+				matched.push_back(offered[i]);
+				key += names[i];
+			}
+		}
+		return matched;
+	}
+}
+
 namespace Bind
 {
 	InputLayout::InputLayout(Graphics& gfx,
 		rsexp::VertexLayout layout_in,
-		ID3DBlob* pVertexShaderBytecode)
+		ShaderBytecode vertexShaderBytecode)
+		:
+		InputLayout(gfx, std::move(layout_in), {}, vertexShaderBytecode)
+	{}
+	InputLayout::InputLayout(Graphics& gfx,
+		rsexp::VertexLayout layout_in,
+		rsexp::VertexLayout instanceLayout_in,
+		ShaderBytecode vertexShaderBytecode)
 		:
-		layout(std::move(layout_in))
+		layout(std::move(layout_in)),
+		instanceLayout(std::move(instanceLayout_in))
 	{
 		INFOMAN(gfx);
 
-		const auto d3dLayout = layout.GetD3DLayout();
+		const auto d3dLayout = Match(layout, instanceLayout, vertexShaderBytecode, key);
 
 		GFX_THROW_INFO(GetDevice(gfx)->CreateInputLayout(
 			d3dLayout.data(), (UINT)d3dLayout.size(),
-			pVertexShaderBytecode->GetBufferPointer(),
-			pVertexShaderBytecode->GetBufferSize(),
+			vertexShaderBytecode.pData,
+			vertexShaderBytecode.size,
 			&pInputLayout
 		));
+		gfx.CountResourceCreated();
 	}
 	const rsexp::VertexLayout InputLayout::GetLayout() const noexcept
 	{
@@ -32,17 +88,33 @@ namespace Bind
 		GetContext(gfx)->IASetInputLayout(pInputLayout.Get());
 	}
 	std::shared_ptr<InputLayout> InputLayout::Resolve(Graphics& gfx,
-		const rsexp::VertexLayout& layout, ID3DBlob* pVertexShaderBytecode)
+		const rsexp::VertexLayout& layout, ShaderBytecode vertexShaderBytecode)
 	{
-		return Codex::Resolve<InputLayout>(gfx, layout, pVertexShaderBytecode);
+		return Codex::Resolve<InputLayout>(gfx, layout, vertexShaderBytecode);
 	}
-	std::string InputLayout::GenerateUID(const rsexp::VertexLayout& layout, ID3DBlob* pVertexShaderBytecode)
+	std::shared_ptr<InputLayout> InputLayout::Resolve(Graphics& gfx,
+		const rsexp::VertexLayout& layout, const rsexp::VertexLayout& instanceLayout, ShaderBytecode vertexShaderBytecode)
+	{
+		return Codex::Resolve<InputLayout>(gfx, layout, instanceLayout, vertexShaderBytecode);
+	}
+	std::string InputLayout::GenerateKey(const rsexp::VertexLayout& layout, const rsexp::VertexLayout& instanceLayout, ShaderBytecode vertexShaderBytecode)
+	{
+		std::string key;
+		Match(layout, instanceLayout, vertexShaderBytecode, key);
+		return key;
+	}
+	std::string InputLayout::GenerateUID(const rsexp::VertexLayout& layout, ShaderBytecode vertexShaderBytecode)
+	{
+		return GenerateUID(layout, {}, vertexShaderBytecode);
+	}
+	std::string InputLayout::GenerateUID(const rsexp::VertexLayout& layout, const rsexp::VertexLayout& instanceLayout, ShaderBytecode vertexShaderBytecode)
 	{
 		using namespace std::string_literals;
-		return typeid(InputLayout).name() + "#"s + layout.GetCode();
+		return typeid(InputLayout).name() + "#"s + GenerateKey(layout, instanceLayout, vertexShaderBytecode);
 	}
 	std::string InputLayout::GetUID() const noexcept
 	{
-		return GenerateUID(layout);
+		using namespace std::string_literals;
+		return typeid(InputLayout).name() + "#"s + key;
 	}
 }
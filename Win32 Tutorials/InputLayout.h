@@ -1,23 +1,41 @@
 #pragma once
 #include "Bindable.h"
 #include "Vertex.h"
+#include "ShaderBytecode.h"
 
 namespace Bind
 {
+	// Holds only the elements the vertex shader's input signature reads, so one layout serves
+	// every vertex format giving the shader the same elements at the same offsets (the
+	// position-only shaders of the depth and outline steps share one across all meshes).
+	// Layouts are keyed by those elements rather than by the full vertex layout.
 	class InputLayout : public Bindable
 	{
 	public:
 		InputLayout(Graphics& gfx,
 			rsexp::VertexLayout layout,
-			ID3DBlob* pVertexShaderBytecode);
+			ShaderBytecode vertexShaderBytecode);
+		// vertices from slot 0, per instance data from slot 1
+		InputLayout(Graphics& gfx,
+			rsexp::VertexLayout layout,
+			rsexp::VertexLayout instanceLayout,
+			ShaderBytecode vertexShaderBytecode);
 		void Bind(Graphics& gfx) noexcept override;
 		const rsexp::VertexLayout GetLayout() const noexcept;
+		// code@offset of every element kept, instance elements after a '|'. Without bytecode
+		// the signature is unknown and every element is kept
+		static std::string GenerateKey(const rsexp::VertexLayout& layout, const rsexp::VertexLayout& instanceLayout, ShaderBytecode vertexShaderBytecode);
+		static std::shared_ptr<InputLayout> Resolve(Graphics& gfx,
+			const rsexp::VertexLayout& layout, ShaderBytecode vertexShaderBytecode);
 		static std::shared_ptr<InputLayout> Resolve(Graphics& gfx,
-			const rsexp::VertexLayout& layout, ID3DBlob* pVertexShaderBytecode);
-		static std::string GenerateUID(const rsexp::VertexLayout& layout, ID3DBlob* pVertexShaderBytecode = nullptr);
+			const rsexp::VertexLayout& layout, const rsexp::VertexLayout& instanceLayout, ShaderBytecode vertexShaderBytecode);
+		static std::string GenerateUID(const rsexp::VertexLayout& layout, ShaderBytecode vertexShaderBytecode = {});
+		static std::string GenerateUID(const rsexp::VertexLayout& layout, const rsexp::VertexLayout& instanceLayout, ShaderBytecode vertexShaderBytecode = {});
 		std::string GetUID() const noexcept override;
 	protected:
 		rsexp::VertexLayout layout;
+		rsexp::VertexLayout instanceLayout;
+		std::string key;
 		Microsoft::WRL::ComPtr<ID3D11InputLayout> pInputLayout;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "InputSignature.h"
+#include <cstring>
+
+namespace
+{
+	// DXBC container: 'DXBC', 16 byte checksum, u32 version, u32 total size, u32 chunk count,
+	// then a u32 offset for every chunk. A chunk is a fourcc and a u32 size before its data
+	constexpr size_t containerHeaderSize = 32u;
+	constexpr size_t chunkHeaderSize = 8u;
+
+	uint32_t ReadU32(const unsigned char* p) noexcept
+	{
+		return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+	}
+
+	bool EqualsNoCase(std::string_view a, std::string_view b) noexcept
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			const auto lower = [](char c)
+			{
+				return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c;
+			};
+			if (lower(a[i]) != lower(b[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+InputSignature::InputSignature(ShaderBytecode bytecode)
+{
+	const auto pBytes = static_cast<const unsigned char*>(bytecode.pData);
+	const auto size = bytecode.size;
+	if (!pBytes || size < containerHeaderSize || std::memcmp(pBytes, "DXBC", 4u) != 0)
+	{
+		return;
+	}
+	const size_t chunkCount = ReadU32(pBytes + 28u);
+	if ((size - containerHeaderSize) / 4u < chunkCount)
+	{
+		return;
+	}
+	for (size_t c = 0; c < chunkCount; c++)
+	{
+		const size_t chunkOffset = ReadU32(pBytes + containerHeaderSize + c * 4u);
+		if (chunkOffset > size || size - chunkOffset < chunkHeaderSize)
+		{
+			return;
+		}
+		const auto pChunk = pBytes + chunkOffset;
+		// ISG1 (shader model 5.1) puts a stream index first and a min precision last
+		const bool isg1 = std::memcmp(pChunk, "ISG1", 4u) == 0;
+		if (!isg1 && std::memcmp(pChunk, "ISGN", 4u) != 0)
+		{
+			continue;
+		}
+		const size_t chunkSize = ReadU32(pChunk + 4u);
+		const auto pData = pChunk + chunkHeaderSize;
+		if (chunkSize > size - chunkOffset - chunkHeaderSize || chunkSize < 8u)
+		{
+			return;
+		}
+		const size_t count = ReadU32(pData);
+		const size_t entrySize = isg1 ? 32u : 24u;
+		const size_t first = isg1 ? 4u : 0u;
+		if ((chunkSize - 8u) / entrySize < count)
+		{
+			return;
+		}
+		std::vector<Element> read;
+		read.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			const auto pEntry = pData + 8u + i * entrySize + first;
+			// names are offsets from the start of the chunk data, null terminated
+			const size_t nameOffset = ReadU32(pEntry);
+			const auto semanticIndex = ReadU32(pEntry + 4u);
+			const auto systemValue = ReadU32(pEntry + 8u);
+			if (nameOffset >= chunkSize)
+			{
+				return;
+			}
+			const auto pName = reinterpret_cast<const char*>(pData + nameOffset);
+			const auto pEnd = static_cast<const char*>(std::memchr(pName, '\0', chunkSize - nameOffset));
+			if (!pEnd)
+			{
+				return;
+			}
+			if (systemValue == 0u)
+			{
+				read.push_back({ { pName,size_t(pEnd - pName) },semanticIndex });
+			}
+		}
+		elements = std::move(read);
+		known = true;
+		return;
+	}
+}
+
+bool InputSignature::IsKnown() const noexcept
+{
+	return known;
+}
+
+const std::vector<InputSignature::Element>& InputSignature::GetElements() const noexcept
+{
+	return elements;
+}
+
+bool InputSignature::Reads(std::string_view semantic, unsigned int index) const noexcept
+{
+	for (const auto& e : elements)
+	{
+		if (e.index == index && EqualsNoCase(e.semantic, semantic))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+uint64_t InputSignature::GetUsedMask(const std::vector<Semantic>& offered) const noexcept
+{
+	uint64_t mask = 0u;
+	for (size_t i = 0; i < offered.size() && i < 64u; i++)
+	{
+		if (!known || Reads(offered[i].name, offered[i].index))
+		{
+			mask |= uint64_t(1u) << i;
+		}
+	}
+	return mask;
+}
+
+bool InputSignature::IsSatisfiedBy(const std::vector<Semantic>& offered) const noexcept
+{
+	for (const auto& e : elements)
+	{
+		bool found = false;
+		for (const auto& o : offered)
+		{
+			if (o.index == e.index && EqualsNoCase(o.name, e.semantic))
+			{
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+		{
+			return false;
+		}
+	}
+	return true;
+}
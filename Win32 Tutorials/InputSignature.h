@@ -0,0 +1,40 @@
+#pragma once
+#include "ShaderBytecode.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// The vertex inputs a compiled shader declares, read from the ISGN (or ISG1) chunk of its
+// DXBC container. Bytecode the reader doesn't understand gives an unknown signature, which
+// is treated as reading everything offered. System values (SV_VertexID, SV_InstanceID) are
+// generated by the input assembler and left out.
+class InputSignature
+{
+public:
+	struct Element
+	{
+		// a view into the bytecode, valid while it is
+		std::string_view semantic;
+		unsigned int index;
+	};
+	// what an input layout provides, one entry per D3D11_INPUT_ELEMENT_DESC
+	struct Semantic
+	{
+		std::string_view name;
+		unsigned int index;
+	};
+public:
+	InputSignature() = default;
+	InputSignature(ShaderBytecode bytecode);
+	bool IsKnown() const noexcept;
+	const std::vector<Element>& GetElements() const noexcept;
+	// semantics compare case insensitively, as hlsl does
+	bool Reads(std::string_view semantic, unsigned int index) const noexcept;
+	// bit i set when the shader reads offered[i], every bit when the signature is unknown
+	uint64_t GetUsedMask(const std::vector<Semantic>& offered) const noexcept;
+	// false when the shader reads something not offered, creating the layout would fail
+	bool IsSatisfiedBy(const std::vector<Semantic>& offered) const noexcept;
+private:
+	std::vector<Element> elements;
+	bool known = false;
+};
@@ -0,0 +1,77 @@
+#include "InstanceBuffer.h"
+#include "GraphicsThrowMacros.h"
+#include <algorithm>
+
+namespace Bind
+{
+	InstanceBuffer::InstanceBuffer(Graphics& gfx, UINT capacity)
+		:
+		projection(gfx, 0u)
+	{
+		Allocate(gfx, capacity);
+	}
+
+	rsexp::VertexLayout InstanceBuffer::GetLayout() noxnd
+	{
+		return rsexp::VertexLayout{}.Append(rsexp::VertexLayout::InstanceTransform);
+	}
+
+	void InstanceBuffer::Clear() noexcept
+	{
+		transforms.clear();
+	}
+
+	void InstanceBuffer::Append(DirectX::FXMMATRIX modelView) noexcept
+	{
+		// rows as they are, the shader rebuilds the matrix from them and multiplies row vectors
+		DirectX::XMStoreFloat4x4(&transforms.emplace_back(), modelView);
+	}
+
+	UINT InstanceBuffer::GetCount() const noexcept
+	{
+		return (UINT)transforms.size();
+	}
+
+	void InstanceBuffer::Bind(Graphics& gfx) noexcept
+	{
+		INFOMAN(gfx);
+
+		if (transforms.size() > capacity)
+		{
+			Allocate(gfx, std::max(capacity * 2u, (UINT)transforms.size()));
+		}
+		const auto bytes = transforms.size() * sizeof(DirectX::XMFLOAT4X4);
+		D3D11_MAPPED_SUBRESOURCE msr;
+		GFX_THROW_INFO(GetContext(gfx)->Map(
+			pBuffer.Get(), 0u,
+			D3D11_MAP_WRITE_DISCARD, 0u,
+			&msr
+		));
+		memcpy(msr.pData, transforms.data(), bytes);
+		GetContext(gfx)->Unmap(pBuffer.Get(), 0u);
+		gfx.CountUpload(bytes);
+
+		const UINT stride = sizeof(DirectX::XMFLOAT4X4);
+		const UINT offset = 0u;
+		GetContext(gfx)->IASetVertexBuffers(slot, 1u, pBuffer.GetAddressOf(), &stride, &offset);
+
+		projection.Update(gfx, DirectX::XMMatrixTranspose(gfx.GetProjection()));
+		projection.Bind(gfx);
+	}
+
+	void InstanceBuffer::Allocate(Graphics& gfx, UINT capacity_in)
+	{
+		INFOMAN(gfx);
+
+		capacity = capacity_in;
+		D3D11_BUFFER_DESC bd = {};
+		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bd.Usage = D3D11_USAGE_DYNAMIC;
+		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		bd.MiscFlags = 0u;
+		bd.ByteWidth = UINT(capacity * sizeof(DirectX::XMFLOAT4X4));
+		bd.StructureByteStride = sizeof(DirectX::XMFLOAT4X4);
+		GFX_THROW_INFO(GetDevice(gfx)->CreateBuffer(&bd, nullptr, &pBuffer));
+		gfx.CountResourceCreated();
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "Bindable.h"
+#include "ConstantBuffers.h"
+#include "Vertex.h"
+#include <vector>
+
+namespace Bind
+{
+	// Per instance model view transforms for instanced draws, streamed from input slot 1,
+	// together with the projection the instanced vertex shaders apply after them. Transforms
+	// are collected on the cpu and uploaded in one map when bound.
+	class InstanceBuffer : public Bindable
+	{
+	public:
+		InstanceBuffer(Graphics& gfx, UINT capacity = 256u);
+		// instance layout the instanced input layouts are built with
+		static rsexp::VertexLayout GetLayout() noxnd;
+		void Clear() noexcept;
+		void Append(DirectX::FXMMATRIX modelView) noexcept;
+		UINT GetCount() const noexcept;
+		// uploads the appended transforms, growing the buffer first if they don't fit
+		void Bind(Graphics& gfx) noexcept override;
+	private:
+		void Allocate(Graphics& gfx, UINT capacity);
+	private:
+		static constexpr UINT slot = 1u;
+		UINT capacity = 0u;
+		std::vector<DirectX::XMFLOAT4X4> transforms;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> pBuffer;
+		VertexConstantBuffer<DirectX::XMMATRIX> projection;
+	};
+}
@@ -1,6 +1,8 @@
 #include "Job.h"
 #include "Step.h"
 #include "Drawable.h"
+#include "InstanceBuffer.h"
+#include <algorithm>
 
 
 Job::Job(const Step* pStep, const Drawable* pDrawable)
@@ -11,7 +13,60 @@ Job::Job(const Step* pStep, const Drawable* pDrawable)
 
 void Job::Execute(Graphics& gfx) const noxnd
 {
+	// off screen drawables skip their binds as well as the draw
+	if (!pDrawable->IsInView(gfx))
+	{
+		gfx.CountCulledDraw();
+		return;
+	}
 	pDrawable->Bind(gfx);
+	// streamed textures bound by the step pick their mip from this
+	gfx.SetTexelDemand(pDrawable->GetScreenPixelsPerUv(gfx));
 	pStep->Bind(gfx);
-	gfx.DrawIndexed(pDrawable->GetIndexCount());
+	gfx.DrawIndexed(pDrawable->GetIndexCount(), pDrawable->GetStartIndex(), pDrawable->GetBaseVertex());
+}
+
+bool Job::AppendBatchKey(std::string& key) const noexcept
+{
+	if (!pStep->AppendBatchKey(key))
+	{
+		return false;
+	}
+	pDrawable->AppendBatchKey(key);
+	return true;
+}
+
+float Job::GetViewDepth(Graphics& gfx) const noexcept
+{
+	return pDrawable->GetViewDepth(gfx);
+}
+
+void Job::ExecuteInstanced(Graphics& gfx, const std::vector<const Job*>& jobs, Bind::InstanceBuffer& instances) noxnd
+{
+	instances.Clear();
+	float texelDemand = 0.0f;
+	for (const auto* pJob : jobs)
+	{
+		const auto& drawable = *pJob->pDrawable;
+		if (!drawable.IsInView(gfx))
+		{
+			gfx.CountCulledDraw();
+			continue;
+		}
+		instances.Append(drawable.GetTransformXM() * gfx.GetCamera());
+		// instances share their textures, which stream for whichever needs the most detail
+		texelDemand = std::max(texelDemand, drawable.GetScreenPixelsPerUv(gfx));
+	}
+	if (instances.GetCount() == 0u)
+	{
+		return;
+	}
+	const auto& first = *jobs.front();
+	first.pDrawable->Bind(gfx);
+	gfx.SetTexelDemand(texelDemand);
+	first.pStep->BindInstanced(gfx);
+	instances.Bind(gfx);
+	gfx.DrawIndexedInstanced(first.pDrawable->GetIndexCount(), instances.GetCount(),
+		first.pDrawable->GetStartIndex(), first.pDrawable->GetBaseVertex());
+	gfx.CountInstancedJobs(instances.GetCount());
 }
\ No newline at end of file
@@ -1,11 +1,24 @@
 #pragma once
 #include "ConditionalNoexcept.h"
+#include <string>
+#include <vector>
+
+namespace Bind
+{
+	class InstanceBuffer;
+}
 
 class Job
 {
 public:
 	Job(const class Step* pStep, const class Drawable* pDrawable);
 	void Execute(class Graphics& gfx) const noxnd;
+	// false when the job can't be instanced, otherwise appends the step and geometry state it
+	// draws with. Jobs appending equal keys differ only in their transforms
+	bool AppendBatchKey(std::string& key) const noexcept;
+	float GetViewDepth(class Graphics& gfx) const noexcept;
+	// draws jobs with equal batch keys in one instanced call, culling each instance first
+	static void ExecuteInstanced(class Graphics& gfx, const std::vector<const Job*>& jobs, Bind::InstanceBuffer& instances) noxnd;
 private:
 	const class Drawable* pDrawable;
 	const class Step* pStep;
@@ -3,34 +3,23 @@
 
 std::optional<Keyboard::Event> Keyboard::ReadKey() noexcept
 {
-	if (keyBuffer.size() > 0u) { //if there is anything on the key buffer
-		Keyboard::Event e = keyBuffer.front(); //copy the first thing in the queue
-		keyBuffer.pop(); //Pops of the key
-		return e; //returns it
-	}
-	return {};
+	return keyBuffer.Pop(); //the oldest event, if there is one
 }
 
 
 std::optional<char> Keyboard::ReadChar() noexcept
 {
-	if (charBuffer.size() > 0u) {
-		//pulls a character off the queue and returns it
-		unsigned char charcode = charBuffer.front(); 
-		charBuffer.pop();
-		return charcode;
-	}
-	return {};
+	return charBuffer.Pop();
 }
 
 void Keyboard::FlushKey() noexcept
 {
-	keyBuffer = std::queue<Event>(); //Resets the queue
+	keyBuffer.Clear(); //Resets the queue
 }
 
 void Keyboard::FlushChar() noexcept
 {
-	charBuffer = std::queue<char>(); //Resets the queue
+	charBuffer.Clear(); //Resets the queue
 }
 
 void Keyboard::Flush() noexcept
@@ -42,34 +31,38 @@ void Keyboard::Flush() noexcept
 
 
 //Windows class uses this
-void Keyboard::OnKeyPressed(unsigned char keycode) noexcept
+void Keyboard::OnKeyPressed(unsigned char keycode, Clock::time_point timestamp) noexcept
 {
 	//updates keystate and keybuffer to pressed
-	keyStates[keycode] = true;
-	keyBuffer.push(Keyboard::Event(Keyboard::Event::Type::Press, keycode));
-	TrimBuffer(keyBuffer); //limits the key buffer size in case it goes over size
+	keyStates[keycode].store(true, std::memory_order_relaxed);
+	Push(keyBuffer, Keyboard::Event(Keyboard::Event::Type::Press, keycode, timestamp));
 }
 
-void Keyboard::OnKeyReleased(unsigned char keycode) noexcept
+void Keyboard::OnKeyReleased(unsigned char keycode, Clock::time_point timestamp) noexcept
 {
-	keyStates[keycode] = false;
-	keyBuffer.push(Keyboard::Event(Keyboard::Event::Type::Release, keycode));
-	TrimBuffer(keyBuffer);
+	keyStates[keycode].store(false, std::memory_order_relaxed);
+	Push(keyBuffer, Keyboard::Event(Keyboard::Event::Type::Release, keycode, timestamp));
 }
 
 void Keyboard::OnChar(char character) noexcept
 {
-	//push onto queue and trims
-	charBuffer.push(character);
-	TrimBuffer(charBuffer);
+	Push(charBuffer, character);
+}
+
+void Keyboard::ClearState() noexcept
+{
+	for (auto& state : keyStates)
+	{
+		state.store(false, std::memory_order_relaxed);
+	}
 }
 
 
-//Template to work on both the queue<char> and queue<event>
-template<typename T>
-void Keyboard::TrimBuffer(std::queue<T>& buffer) noexcept
+//Template to work on both the key and char queues
+template<typename T, size_t Capacity>
+void Keyboard::Push(SpscQueue<T, Capacity>& buffer, const T& item) noexcept
 {
-	while (buffer.size() > bufferSize) {
-		buffer.pop();
+	if (!buffer.Push(item)) {
+		dropped.fetch_add(1u, std::memory_order_relaxed);
 	}
-}
\ No newline at end of file
+}
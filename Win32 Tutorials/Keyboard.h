@@ -1,14 +1,21 @@
 #pragma once
 
-#include <queue>
-#include <bitset>
+#include "SpscQueue.h"
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <optional>
 
+//Events are queued by the thread pumping window messages and read by the one running the frame,
+//they can be different threads. Queues are fixed size lock free rings, events arriving while one
+//is full are dropped and counted
 class Keyboard
 {
 	//friend classes can access your private members
 	friend class Window;
+	friend void TestInputQueues();
 public:
+	using Clock = std::chrono::steady_clock;
 	//Event class holds the requirements for each key, pressed released and invalid, and keycode as well as getters for each of those
 	class Event {
 	public:
@@ -20,14 +27,17 @@ public:
 	private:
 		Type type;
 		unsigned char code;
+		Clock::time_point timestamp;
 	public:
 		Event() noexcept : type(Type::Invalid), code(0u) {}
-		Event(Type type, unsigned char code) noexcept : type(type), code(code) {}
+		Event(Type type, unsigned char code, Clock::time_point timestamp) noexcept : type(type), code(code), timestamp(timestamp) {}
 
 		bool IsPress() const noexcept { return type == Type::Press; }
 		bool IsRelease() const noexcept { return type == Type::Release; }
 		bool IsValid() const noexcept { return type == Type::Invalid; }
 		unsigned char GetCode() const noexcept { return code; }
+		//when the message was handled, input latency is measured from here
+		Clock::time_point GetTimestamp() const noexcept { return timestamp; }
 	};
 public:
 	Keyboard() = default; //Default copy constructor
@@ -35,16 +45,17 @@ public:
 	Keyboard& operator=(const Keyboard&) = delete; //Copy constructor
 
 	//Key Events
-	bool KeyIsPressed(unsigned char keycode) const noexcept { return keyStates[keycode]; }
+	bool KeyIsPressed(unsigned char keycode) const noexcept { return keyStates[keycode].load(std::memory_order_relaxed); }
 	std::optional<Event> ReadKey() noexcept;
-	bool KeyIsEmpty() const noexcept { return keyBuffer.empty(); }
+	bool KeyIsEmpty() const noexcept { return keyBuffer.IsEmpty(); }
 	void FlushKey() noexcept;
 
 	//Char Event Reading and cleaning
 	std::optional<char> ReadChar() noexcept;
-	bool CharIsEmpty() const noexcept { return charBuffer.empty(); }
+	bool CharIsEmpty() const noexcept { return charBuffer.IsEmpty(); }
 	void FlushChar() noexcept;
 	void Flush() noexcept; //Flush both queues
+	size_t GetDroppedCount() const noexcept { return dropped.load(std::memory_order_relaxed); }
 
 	//Autorepeat Getter/Setter
 	void EnableAutorepeat() noexcept { autoRepeatEnabled = true; }
@@ -56,22 +67,23 @@ private:
 	//The Window class has access to these as it is a friend class
 
 	//Key event handling
-	void OnKeyPressed(unsigned char keycode) noexcept;
-	void OnKeyReleased(unsigned char keycode) noexcept;
+	void OnKeyPressed(unsigned char keycode, Clock::time_point timestamp = Clock::now()) noexcept;
+	void OnKeyReleased(unsigned char keycode, Clock::time_point timestamp = Clock::now()) noexcept;
 	void OnChar(char character) noexcept;
-	void ClearState() noexcept { keyStates.reset(); }
+	void ClearState() noexcept;
 
-	template<typename T>
-	//Buffers can have a maximum size of 16, removes items until buffer size is back  at 16
-	static void TrimBuffer(std::queue<T>& buffer) noexcept;
+	template<typename T, size_t Capacity>
+	//Pushes onto a queue, counting the item as dropped when it is full
+	void Push(SpscQueue<T, Capacity>& buffer, const T& item) noexcept;
 
 private:
 	static constexpr unsigned int nKeys = 256u; //
-	static constexpr unsigned int bufferSize = 16u;
-	bool autoRepeatEnabled = false;
-	std::bitset<nKeys> keyStates; //maps 256 bools into a single byte
-	std::queue<Event> keyBuffer; //add to the back pull from the front
-	std::queue<char> charBuffer;
+	static constexpr unsigned int bufferSize = 256u;
+	std::atomic<bool> autoRepeatEnabled = false;
+	std::array<std::atomic<bool>, nKeys> keyStates = {};
+	SpscQueue<Event, bufferSize> keyBuffer; //add to the back pull from the front
+	SpscQueue<char, bufferSize> charBuffer;
+	std::atomic<size_t> dropped = 0u;
 };
 
 
@@ -0,0 +1,364 @@
+#include "LightBinner.h"
+#include "PerformanceLog.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace dx = DirectX;
+
+namespace
+{
+	// inward normal of the plane through the eye and the ndc line at a, scaled by the projection
+	void MakePlane(float scale, float a, float sign, float& outA, float& outZ) noexcept
+	{
+		const auto length = std::sqrt(scale * scale + a * a);
+		outA = sign * scale / length;
+		outZ = -sign * a / length;
+	}
+	dx::XMVECTOR XM_CALLCONV LoadLanes(const std::vector<float>& v, size_t i) noexcept
+	{
+		return dx::XMLoadFloat4(reinterpret_cast<const dx::XMFLOAT4*>(&v[i]));
+	}
+}
+
+// The binning threads of the process. Threads are only ever added, up to the most workers any
+// binner has asked for, so creating binners (one per FrameCommander) starts no new threads
+// once the pool is big enough. Binners take turns on it, each using its first workers.
+class LightBinner::WorkerPool
+{
+public:
+	static WorkerPool& Get()
+	{
+		static WorkerPool pool;
+		return pool;
+	}
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			done = true;
+		}
+		startCv.notify_all();
+		for (auto& w : workers)
+		{
+			w.join();
+		}
+	}
+	void Reserve(unsigned int count)
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		while (workers.size() < count)
+		{
+			workers.emplace_back(&WorkerPool::Work, this, workers.size());
+		}
+	}
+	// bins the binner's rows on its workers and the calling thread
+	void Bin(LightBinner& binner)
+	{
+		std::lock_guard<std::mutex> turn{ binMutex };
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			pBinner = &binner;
+			active = binner.workerCount;
+			pending = active;
+			generation++;
+		}
+		startCv.notify_all();
+		binner.BinRows(binner.scratch.back());
+		std::unique_lock<std::mutex> lock{ mutex };
+		doneCv.wait(lock, [this] { return pending == 0u; });
+	}
+private:
+	WorkerPool()
+	{
+		// the profiler must outlive the workers, which hand back their rings as they exit
+		Profiler::GetFrameCount();
+	}
+	void Work(size_t index)
+	{
+		Profiler::SetThreadName("Light binner " + std::to_string(index));
+		uint64_t seen = 0u;
+		while (true)
+		{
+			LightBinner* pJob = nullptr;
+			{
+				std::unique_lock<std::mutex> lock{ mutex };
+				startCv.wait(lock, [this, seen] { return done || generation != seen; });
+				if (done)
+				{
+					return;
+				}
+				seen = generation;
+				if (index >= active)
+				{
+					continue;
+				}
+				pJob = pBinner;
+			}
+			pJob->BinRows(pJob->scratch[index]);
+			{
+				std::lock_guard<std::mutex> lock{ mutex };
+				pending--;
+			}
+			doneCv.notify_one();
+		}
+	}
+private:
+	// held for a whole Bin, so binners on different threads wait their turn
+	std::mutex binMutex;
+	std::mutex mutex;
+	std::condition_variable startCv;
+	std::condition_variable doneCv;
+	LightBinner* pBinner = nullptr;
+	size_t active = 0u;
+	size_t pending = 0u;
+	uint64_t generation = 0u;
+	bool done = false;
+	std::vector<std::thread> workers;
+};
+
+LightBinner::LightBinner(unsigned int workerCount)
+	:
+	workerCount(workerCount),
+	scratch(workerCount + 1u)
+{
+	if (workerCount > 0u)
+	{
+		WorkerPool::Get().Reserve(workerCount);
+	}
+}
+
+void LightBinner::SetView(dx::FXMMATRIX proj, uint32_t width_in, uint32_t height_in, uint32_t tileSize_in)
+{
+	dx::XMFLOAT4X4 p;
+	dx::XMStoreFloat4x4(&p, proj);
+	if (std::memcmp(&p, &projection, sizeof(p)) == 0 && width == width_in && height == height_in && tileSize == tileSize_in)
+	{
+		return;
+	}
+	projection = p;
+	width = width_in;
+	height = height_in;
+	tileSize = tileSize_in;
+	tilesX = (width + tileSize - 1u) / tileSize;
+	tilesY = (height + tileSize - 1u) / tileSize;
+	// z row of a left handed perspective: _33 = f/(f-n), _43 = -n*f/(f-n)
+	nearZ = -p._43 / p._33;
+	farZ = p._33 * nearZ / (p._33 - 1.0f);
+
+	// a view point is inside the column when its ndc x = x*_11/z lies between the column's
+	// edges, so each side is a plane through the eye
+	const auto column = [this, &p](uint32_t first, uint32_t last)
+	{
+		SlabPlanes planes;
+		const auto left = 2.0f * float(first * tileSize) / float(width) - 1.0f;
+		const auto right = 2.0f * float(std::min(last * tileSize, width)) / float(width) - 1.0f;
+		MakePlane(p._11, left, 1.0f, planes.lowA, planes.lowZ);
+		MakePlane(p._11, right, -1.0f, planes.highA, planes.highZ);
+		return planes;
+	};
+	columns.clear();
+	for (uint32_t c = 0; c < tilesX; c++)
+	{
+		columns.push_back(column(c, c + 1u));
+	}
+	blocks.clear();
+	for (uint32_t c = 0; c < tilesX; c += blockSize)
+	{
+		blocks.push_back(column(c, std::min(c + blockSize, tilesX)));
+	}
+	// pixel rows run down the screen, ndc y up
+	rows.resize(tilesY);
+	for (uint32_t r = 0; r < tilesY; r++)
+	{
+		const auto top = 1.0f - 2.0f * float(r * tileSize) / float(height);
+		const auto bottom = 1.0f - 2.0f * float(std::min((r + 1u) * tileSize, height)) / float(height);
+		MakePlane(p._22, bottom, 1.0f, rows[r].lowA, rows[r].lowZ);
+		MakePlane(p._22, top, -1.0f, rows[r].highA, rows[r].highZ);
+	}
+	rowIndices.resize(tilesY);
+	tiles.assign(size_t(tilesX) * tilesY, { 0u,0u });
+}
+
+void LightBinner::Bin(const std::vector<Sphere>& lights)
+{
+	PROFILE_ZONE("LightBinner::Bin");
+	visible.Clear();
+	for (uint32_t i = 0; i < lights.size(); i++)
+	{
+		const auto& l = lights[i];
+		if (l.center.z + l.radius >= nearZ && l.center.z - l.radius <= farZ)
+		{
+			visible.x.push_back(l.center.x);
+			visible.y.push_back(l.center.y);
+			visible.z.push_back(l.center.z);
+			visible.r.push_back(l.radius);
+			visible.index.push_back(i);
+		}
+	}
+	visible.Pad();
+
+	nextRow.store(0u, std::memory_order_relaxed);
+	if (workerCount > 0u)
+	{
+		WorkerPool::Get().Bin(*this);
+	}
+	else
+	{
+		BinRows(scratch.back());
+	}
+
+	// rows were binned into their own lists, join them in order
+	indices.clear();
+	maxPerTile = 0u;
+	for (uint32_t r = 0; r < tilesY; r++)
+	{
+		const auto base = uint32_t(indices.size());
+		for (uint32_t c = 0; c < tilesX; c++)
+		{
+			auto& t = tiles[size_t(r) * tilesX + c];
+			t.offset += base;
+			maxPerTile = std::max(maxPerTile, t.count);
+		}
+		indices.insert(indices.end(), rowIndices[r].begin(), rowIndices[r].end());
+	}
+}
+
+uint32_t LightBinner::GetTileSize() const noexcept
+{
+	return tileSize;
+}
+
+uint32_t LightBinner::GetTilesX() const noexcept
+{
+	return tilesX;
+}
+
+uint32_t LightBinner::GetTilesY() const noexcept
+{
+	return tilesY;
+}
+
+const std::vector<LightBinner::TileRange>& LightBinner::GetTileRanges() const noexcept
+{
+	return tiles;
+}
+
+const std::vector<uint32_t>& LightBinner::GetLightIndices() const noexcept
+{
+	return indices;
+}
+
+uint32_t LightBinner::GetMaxLightsPerTile() const noexcept
+{
+	return maxPerTile;
+}
+
+unsigned int LightBinner::GetWorkerCount() const noexcept
+{
+	return workerCount;
+}
+
+unsigned int LightBinner::DefaultWorkerCount() noexcept
+{
+	// leave a core for the rest of the frame, binning stops scaling well past a handful
+	const auto cores = std::max(std::thread::hardware_concurrency(), 1u);
+	return std::min(cores - 1u, 7u);
+}
+
+void LightBinner::BinRows(Scratch& s)
+{
+	PROFILE_ZONE("Bin rows");
+	for (auto r = nextRow.fetch_add(1u, std::memory_order_relaxed); r < tilesY; r = nextRow.fetch_add(1u, std::memory_order_relaxed))
+	{
+		BinRow(r, s);
+	}
+}
+
+void LightBinner::BinRow(uint32_t row, Scratch& s)
+{
+	s.row.Clear();
+	ForEachInSlab(visible, visible.y, rows[row], [&s, this](size_t i) { s.row.Push(visible, i); });
+	s.row.Pad();
+
+	auto& out = rowIndices[row];
+	out.clear();
+	for (uint32_t b = 0; b < blocks.size(); b++)
+	{
+		s.block.Clear();
+		ForEachInSlab(s.row, s.row.x, blocks[b], [&s](size_t i) { s.block.Push(s.row, i); });
+		s.block.Pad();
+		const auto last = std::min((b + 1u) * blockSize, tilesX);
+		for (uint32_t c = b * blockSize; c < last; c++)
+		{
+			auto& tile = tiles[size_t(row) * tilesX + c];
+			tile.offset = uint32_t(out.size());
+			ForEachInSlab(s.block, s.block.x, columns[c], [&s, &out](size_t i) { out.push_back(s.block.index[i]); });
+			tile.count = uint32_t(out.size()) - tile.offset;
+		}
+	}
+}
+
+template<typename F>
+void LightBinner::ForEachInSlab(const Candidates& c, const std::vector<float>& a, const SlabPlanes& planes, F&& f)
+{
+	const auto lowA = dx::XMVectorReplicate(planes.lowA);
+	const auto lowZ = dx::XMVectorReplicate(planes.lowZ);
+	const auto highA = dx::XMVectorReplicate(planes.highA);
+	const auto highZ = dx::XMVectorReplicate(planes.highZ);
+	uint32_t mask[4];
+	for (size_t i = 0; i < a.size(); i += 4u)
+	{
+		const auto av = LoadLanes(a, i);
+		const auto z = LoadLanes(c.z, i);
+		const auto negR = dx::XMVectorNegate(LoadLanes(c.r, i));
+		auto inside = dx::XMVectorGreaterOrEqual(dx::XMVectorMultiplyAdd(av, lowA, dx::XMVectorMultiply(z, lowZ)), negR);
+		inside = dx::XMVectorAndInt(inside, dx::XMVectorGreaterOrEqual(dx::XMVectorMultiplyAdd(av, highA, dx::XMVectorMultiply(z, highZ)), negR));
+		dx::XMStoreInt4(mask, inside);
+		for (size_t lane = 0; lane < 4u; lane++)
+		{
+			if (mask[lane] != 0u)
+			{
+				f(i + lane);
+			}
+		}
+	}
+}
+
+void LightBinner::Candidates::Clear() noexcept
+{
+	x.clear();
+	y.clear();
+	z.clear();
+	r.clear();
+	index.clear();
+}
+
+void LightBinner::Candidates::Push(const Candidates& from, size_t i)
+{
+	x.push_back(from.x[i]);
+	y.push_back(from.y[i]);
+	z.push_back(from.z[i]);
+	r.push_back(from.r[i]);
+	index.push_back(from.index[i]);
+}
+
+void LightBinner::Candidates::Pad()
+{
+	// padding lanes fail every test, their negated radius is larger than any distance
+	while (x.size() % 4u != 0u)
+	{
+		x.push_back(0.0f);
+		y.push_back(0.0f);
+		z.push_back(0.0f);
+		r.push_back(-FLT_MAX);
+		index.push_back(0u);
+	}
+}
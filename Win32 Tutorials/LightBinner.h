@@ -0,0 +1,104 @@
+#pragma once
+#include <DirectXMath.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Bins view space point light spheres into screen tiles for forward+ shading. Lights are
+// tested against the planes of the tile frusta four at a time with DirectXMath, narrowing
+// down hierarchically: each row of tiles keeps the lights crossing its slab of the
+// frustum, each block of tiles in the row the ones crossing its columns, and each tile
+// tests only its block's lights. Rows are handed out to worker threads, which are shared by
+// every binner and kept for the life of the process. The result is an offset and count per
+// tile into one flat list of light indices.
+class LightBinner
+{
+public:
+	struct Sphere
+	{
+		DirectX::XMFLOAT3 center;
+		float radius;
+	};
+	struct TileRange
+	{
+		uint32_t offset;
+		uint32_t count;
+	};
+public:
+	// workers besides the calling thread, which always bins rows too
+	LightBinner(unsigned int workerCount = DefaultWorkerCount());
+	LightBinner(const LightBinner&) = delete;
+	LightBinner& operator=(const LightBinner&) = delete;
+	// a left handed perspective projection without off center terms, as made by
+	// XMMatrixPerspectiveLH / XMMatrixPerspectiveFovLH. Cheap when nothing changed
+	void SetView(DirectX::FXMMATRIX projection, uint32_t width, uint32_t height, uint32_t tileSize = 16u);
+	void Bin(const std::vector<Sphere>& lights);
+	uint32_t GetTileSize() const noexcept;
+	uint32_t GetTilesX() const noexcept;
+	uint32_t GetTilesY() const noexcept;
+	// row major, one per tile
+	const std::vector<TileRange>& GetTileRanges() const noexcept;
+	const std::vector<uint32_t>& GetLightIndices() const noexcept;
+	uint32_t GetMaxLightsPerTile() const noexcept;
+	unsigned int GetWorkerCount() const noexcept;
+	static unsigned int DefaultWorkerCount() noexcept;
+private:
+	// inward facing planes through the eye, as (x or y, z) normal components
+	struct SlabPlanes
+	{
+		float lowA;
+		float lowZ;
+		float highA;
+		float highZ;
+	};
+	// structure of arrays of lights padded to whole vectors, index is into the binned lights
+	struct Candidates
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> r;
+		std::vector<uint32_t> index;
+		void Clear() noexcept;
+		void Push(const Candidates& from, size_t i);
+		void Pad();
+	};
+	struct Scratch
+	{
+		Candidates row;
+		Candidates block;
+	};
+	class WorkerPool;
+private:
+	void BinRows(Scratch& scratch);
+	void BinRow(uint32_t row, Scratch& scratch);
+	// calls f with the position in c of every light reaching the slab between the planes,
+	// a is x for column slabs and y for row slabs
+	template<typename F>
+	static void ForEachInSlab(const Candidates& c, const std::vector<float>& a, const SlabPlanes& planes, F&& f);
+private:
+	// tiles per column block
+	static constexpr uint32_t blockSize = 8u;
+private:
+	DirectX::XMFLOAT4X4 projection = {};
+	uint32_t width = 0u;
+	uint32_t height = 0u;
+	uint32_t tileSize = 16u;
+	uint32_t tilesX = 0u;
+	uint32_t tilesY = 0u;
+	float nearZ = 0.0f;
+	float farZ = 0.0f;
+	std::vector<SlabPlanes> columns;
+	std::vector<SlabPlanes> blocks;
+	std::vector<SlabPlanes> rows;
+	// the lights being binned that are between the near and far planes
+	Candidates visible;
+	std::vector<std::vector<uint32_t>> rowIndices;
+	std::vector<TileRange> tiles;
+	std::vector<uint32_t> indices;
+	uint32_t maxPerTile = 0u;
+	unsigned int workerCount;
+	// one per worker, then the calling thread's
+	std::vector<Scratch> scratch;
+	std::atomic<uint32_t> nextRow = 0u;
+};
@@ -0,0 +1,197 @@
+#include "LightList.h"
+#include "GraphicsThrowMacros.h"
+#include "PerformanceLog.h"
+#include "imgui/imgui.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace dx = DirectX;
+
+LightList::LightList(Graphics& gfx)
+	:
+	gridCbuf(gfx, 0u)
+{}
+
+void LightList::Clear() noexcept
+{
+	lights.clear();
+}
+
+void LightList::Add(const PointLight& light)
+{
+	lights.push_back(light);
+}
+
+void LightList::SetAmbient(const dx::XMFLOAT3& ambient_in) noexcept
+{
+	ambient = ambient_in;
+}
+
+void LightList::Scatter(size_t count, float radius, const dx::XMFLOAT3& boxMin, const dx::XMFLOAT3& boxMax, unsigned int seed)
+{
+	std::mt19937 rng{ seed };
+	std::uniform_real_distribution<float> unit{ 0.0f,1.0f };
+	std::uniform_real_distribution<float> hue{ 0.0f,6.0f };
+	scattered.clear();
+	for (size_t i = 0; i < count; i++)
+	{
+		PointLight l;
+		l.pos = {
+			boxMin.x + (boxMax.x - boxMin.x) * unit(rng),
+			boxMin.y + (boxMax.y - boxMin.y) * unit(rng),
+			boxMin.z + (boxMax.z - boxMin.z) * unit(rng),
+		};
+		// saturated colors around the hue wheel
+		const auto h = hue(rng);
+		const auto channel = [h](float offset)
+		{
+			return std::clamp(std::abs(std::fmod(h + offset, 6.0f) - 3.0f) - 1.0f, 0.0f, 1.0f);
+		};
+		l.diffuseColor = { channel(0.0f),channel(4.0f),channel(2.0f) };
+		l.diffuseIntensity = 1.0f;
+		// quadratic falloff reaching the cutoff exactly at the radius
+		l.attConst = 1.0f;
+		l.attLin = 0.0f;
+		l.attQuad = (l.diffuseIntensity / cutoff - 1.0f) / (radius * radius);
+		scattered.push_back(l);
+	}
+}
+
+void LightList::Bind(Graphics& gfx)
+{
+	PROFILE_ZONE("LightList::Bind");
+	const auto view = gfx.GetCamera();
+	viewLights.clear();
+	spheres.clear();
+	const auto add = [this, view](const PointLight& l)
+	{
+		ViewLight v;
+		dx::XMStoreFloat3(&v.viewPos, dx::XMVector3Transform(dx::XMLoadFloat3(&l.pos), view));
+		v.radius = GetRadius(l);
+		v.diffuseColor = l.diffuseColor;
+		v.diffuseIntensity = l.diffuseIntensity;
+		v.attConst = l.attConst;
+		v.attLin = l.attLin;
+		v.attQuad = l.attQuad;
+		v.padding = 0.0f;
+		viewLights.push_back(v);
+		spheres.push_back({ v.viewPos,v.radius });
+	};
+	for (const auto& l : lights)
+	{
+		add(l);
+	}
+	for (const auto& l : scattered)
+	{
+		add(l);
+	}
+
+	const auto binStart = std::chrono::steady_clock::now();
+	binner.SetView(gfx.GetProjection(), gfx.GetWidth(), gfx.GetHeight(), tileSize);
+	binner.Bin(spheres);
+	binMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - binStart).count();
+
+	Upload(gfx, lightArray, viewLights.data(), viewLights.size());
+	Upload(gfx, rangeArray, binner.GetTileRanges().data(), binner.GetTileRanges().size());
+	Upload(gfx, indexArray, binner.GetLightIndices().data(), binner.GetLightIndices().size());
+	gfx.BindPixelShaderResource(lightSlot, lightArray.pView.Get());
+	gfx.BindPixelShaderResource(tileRangeSlot, rangeArray.pView.Get());
+	gfx.BindPixelShaderResource(tileIndexSlot, indexArray.pView.Get());
+
+	gridCbuf.Update(gfx, { ambient,tileSize,binner.GetTilesX(),(UINT)viewLights.size(),{ 0u,0u } });
+	gridCbuf.Bind(gfx);
+}
+
+void LightList::SpawnWindow()
+{
+	if (ImGui::Begin("Light List"))
+	{
+		const auto tiles = binner.GetTileRanges().size();
+		ImGui::Text("Lights: %zu, tiles: %ux%u", viewLights.size(), binner.GetTilesX(), binner.GetTilesY());
+		ImGui::Text("Lights per tile: %.2f avg, %u max",
+			tiles != 0u ? float(binner.GetLightIndices().size()) / float(tiles) : 0.0f, binner.GetMaxLightsPerTile());
+		ImGui::Text("Binning: %.3fms on %u threads", binMs, binner.GetWorkerCount() + 1u);
+		ImGui::SliderInt("Scattered", &scatterCount, 0, 4096);
+		ImGui::SliderFloat("Radius", &scatterRadius, 1.0f, 40.0f, "%.1f");
+		if (ImGui::Button("Scatter"))
+		{
+			// roughly the extent of sponza as loaded by the demo
+			Scatter(size_t(scatterCount), scatterRadius, { -60.0f,0.0f,-30.0f }, { 60.0f,40.0f,30.0f });
+		}
+	}
+	ImGui::End();
+}
+
+size_t LightList::GetLightCount() const noexcept
+{
+	return lights.size() + scattered.size();
+}
+
+const LightBinner& LightList::GetBinner() const noexcept
+{
+	return binner;
+}
+
+float LightList::GetRadius(const PointLight& light) noexcept
+{
+	// intensity / (c + l*d + q*d^2) = cutoff
+	const auto c = light.attConst - light.diffuseIntensity / cutoff;
+	if (c >= 0.0f)
+	{
+		return 0.0f;
+	}
+	if (light.attQuad > 0.0f)
+	{
+		return (-light.attLin + std::sqrt(light.attLin * light.attLin - 4.0f * light.attQuad * c)) / (2.0f * light.attQuad);
+	}
+	if (light.attLin > 0.0f)
+	{
+		return -c / light.attLin;
+	}
+	// never falls off
+	return FLT_MAX;
+}
+
+void LightList::Upload(Graphics& gfx, StructuredArray& array, const void* pData, size_t count)
+{
+	INFOMAN(gfx);
+
+	// buffers can't be empty, and grow by doubling so a changing light count settles quickly
+	if (array.pBuffer == nullptr || count > array.capacity)
+	{
+		array.capacity = std::max({ array.capacity * 2u,(UINT)count,64u });
+		D3D11_BUFFER_DESC bd = {};
+		bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		bd.Usage = D3D11_USAGE_DYNAMIC;
+		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+		bd.ByteWidth = array.capacity * array.stride;
+		bd.StructureByteStride = array.stride;
+		GFX_THROW_INFO(GetDevice(gfx)->CreateBuffer(&bd, nullptr, &array.pBuffer));
+		gfx.CountResourceCreated();
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+		srvDesc.Buffer.FirstElement = 0u;
+		srvDesc.Buffer.NumElements = array.capacity;
+		GFX_THROW_INFO(GetDevice(gfx)->CreateShaderResourceView(array.pBuffer.Get(), &srvDesc, &array.pView));
+	}
+	if (count == 0u)
+	{
+		return;
+	}
+	const auto bytes = count * array.stride;
+	D3D11_MAPPED_SUBRESOURCE msr;
+	GFX_THROW_INFO(GetContext(gfx)->Map(
+		array.pBuffer.Get(), 0u,
+		D3D11_MAP_WRITE_DISCARD, 0u,
+		&msr
+	));
+	memcpy(msr.pData, pData, bytes);
+	GetContext(gfx)->Unmap(array.pBuffer.Get(), 0u);
+	gfx.CountUpload(bytes);
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "GraphicsResource.h"
+#include "ConstantBuffers.h"
+#include "LightBinner.h"
+#include <wrl.h>
+#include <vector>
+
+// Every point light of the frame, shaded forward+. Lights go into a structured buffer in
+// view space and a LightBinner sorts them into screen tiles, whose ranges into a light
+// index buffer the phong pixel shaders walk (PointLight.hlsl). The buffers are bound to
+// pixel shader slots t8-t10 with the tile grid constants at b0 for the whole frame.
+class LightList : public GraphicsResource
+{
+public:
+	struct PointLight
+	{
+		DirectX::XMFLOAT3 pos;
+		DirectX::XMFLOAT3 diffuseColor;
+		float diffuseIntensity;
+		float attConst;
+		float attLin;
+		float attQuad;
+	};
+	// contribution below which a light is treated as not reaching a pixel, sets the radii
+	static constexpr float cutoff = 1.0f / 256.0f;
+	static constexpr UINT tileSize = 16u;
+	static constexpr UINT lightSlot = 8u;
+	static constexpr UINT tileRangeSlot = 9u;
+	static constexpr UINT tileIndexSlot = 10u;
+public:
+	LightList(Graphics& gfx);
+	// lights are submitted every frame, scattered lights stay until rescattered
+	void Clear() noexcept;
+	void Add(const PointLight& light);
+	void SetAmbient(const DirectX::XMFLOAT3& ambient) noexcept;
+	// fills the box with count lights of the given radius, for stress testing
+	void Scatter(size_t count, float radius, const DirectX::XMFLOAT3& boxMin, const DirectX::XMFLOAT3& boxMax, unsigned int seed = 0u);
+	// bins this frame's lights for the current camera and binds them for the phong shaders
+	void Bind(Graphics& gfx);
+	void SpawnWindow();
+	size_t GetLightCount() const noexcept;
+	const LightBinner& GetBinner() const noexcept;
+	// distance at which the light's contribution falls below the cutoff
+	static float GetRadius(const PointLight& light) noexcept;
+private:
+	// matches PointLight in PointLight.hlsl
+	struct ViewLight
+	{
+		DirectX::XMFLOAT3 viewPos;
+		float radius;
+		DirectX::XMFLOAT3 diffuseColor;
+		float diffuseIntensity;
+		float attConst;
+		float attLin;
+		float attQuad;
+		float padding;
+	};
+	struct GridCBuf
+	{
+		DirectX::XMFLOAT3 ambient;
+		UINT tileSize;
+		UINT tilesX;
+		UINT lightCount;
+		UINT padding[2];
+	};
+	struct StructuredArray
+	{
+		UINT stride;
+		UINT capacity = 0u;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> pBuffer;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> pView;
+	};
+private:
+	void Upload(Graphics& gfx, StructuredArray& array, const void* pData, size_t count);
+private:
+	std::vector<PointLight> lights;
+	std::vector<PointLight> scattered;
+	DirectX::XMFLOAT3 ambient = { 0.0f,0.0f,0.0f };
+	// this frame's lights in view space and their bounding spheres
+	std::vector<ViewLight> viewLights;
+	std::vector<LightBinner::Sphere> spheres;
+	LightBinner binner;
+	StructuredArray lightArray{ sizeof(ViewLight) };
+	StructuredArray rangeArray{ sizeof(LightBinner::TileRange) };
+	StructuredArray indexArray{ sizeof(uint32_t) };
+	Bind::PixelConstantBuffer<GridCBuf> gridCbuf;
+	float binMs = 0.0f;
+	// scatter controls
+	int scatterCount = 0;
+	float scatterRadius = 8.0f;
+};
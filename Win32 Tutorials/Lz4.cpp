@@ -0,0 +1,176 @@
+#include "Lz4.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+	constexpr size_t minMatch = 4u;
+	// the format requires the block to end in literals, and no match to start this close to the end
+	constexpr size_t lastLiterals = 5u;
+	constexpr size_t matchStartLimit = 12u;
+	constexpr size_t maxOffset = 65535u;
+	constexpr int hashBits = 16;
+
+	uint32_t Read32(const unsigned char* p) noexcept
+	{
+		uint32_t v;
+		std::memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	uint32_t Hash(uint32_t sequence) noexcept
+	{
+		return (sequence * 2654435761u) >> (32 - hashBits);
+	}
+
+	// lengths past a token's 15 continue in bytes of 255 and a final smaller byte
+	void PutLength(std::vector<char>& out, size_t length)
+	{
+		for (; length >= 255u; length -= 255u)
+		{
+			out.push_back(char(255));
+		}
+		out.push_back(char(length));
+	}
+
+	bool GetLength(const unsigned char*& p, const unsigned char* end, size_t& length) noexcept
+	{
+		unsigned char b;
+		do
+		{
+			if (p == end)
+			{
+				return false;
+			}
+			b = *p++;
+			length += b;
+		} while (b == 255u);
+		return true;
+	}
+}
+
+size_t Lz4::GetBound(size_t size) noexcept
+{
+	return size + size / 255u + 16u;
+}
+
+std::vector<char> Lz4::Compress(const char* pSrc, size_t size)
+{
+	const auto src = reinterpret_cast<const unsigned char*>(pSrc);
+	std::vector<char> out;
+	out.reserve(GetBound(size));
+	// last position + 1 each hashed sequence was seen at, 0 for never
+	std::vector<uint32_t> table(size_t(1u) << hashBits, 0u);
+	size_t anchor = 0u;
+	const auto putSequence = [&](size_t literalEnd, size_t matchLength)
+	{
+		const auto literals = literalEnd - anchor;
+		const auto matchCode = matchLength - minMatch;
+		out.push_back(char(std::min(literals, size_t(15u)) << 4 | std::min(matchCode, size_t(15u))));
+		if (literals >= 15u)
+		{
+			PutLength(out, literals - 15u);
+		}
+		out.insert(out.end(), pSrc + anchor, pSrc + literalEnd);
+		return matchCode;
+	};
+	if (size > matchStartLimit)
+	{
+		const auto limit = size - matchStartLimit;
+		for (size_t i = 0u; i < limit;)
+		{
+			const auto sequence = Read32(src + i);
+			auto& slot = table[Hash(sequence)];
+			const size_t candidate = slot;
+			slot = uint32_t(i + 1u);
+			if (candidate == 0u || i + 1u - candidate > maxOffset || Read32(src + candidate - 1u) != sequence)
+			{
+				i++;
+				continue;
+			}
+			const auto ref = candidate - 1u;
+			size_t length = minMatch;
+			const auto maxLength = size - lastLiterals - i;
+			while (length < maxLength && src[ref + length] == src[i + length])
+			{
+				length++;
+			}
+			const auto matchCode = putSequence(i, length);
+			const auto offset = i - ref;
+			out.push_back(char(offset & 0xffu));
+			out.push_back(char(offset >> 8));
+			if (matchCode >= 15u)
+			{
+				PutLength(out, matchCode - 15u);
+			}
+			i += length;
+			anchor = i;
+		}
+	}
+	// match code of the final literal run is unused
+	putSequence(size, minMatch);
+	return out;
+}
+
+bool Lz4::Decompress(const char* pSrc, size_t srcSize, char* pDst, size_t size) noexcept
+{
+	auto p = reinterpret_cast<const unsigned char*>(pSrc);
+	const auto end = p + srcSize;
+	size_t written = 0u;
+	while (p != end)
+	{
+		const auto token = *p++;
+		size_t literals = token >> 4;
+		if (literals == 15u && !GetLength(p, end, literals))
+		{
+			return false;
+		}
+		if (literals > size_t(end - p) || literals > size - written)
+		{
+			return false;
+		}
+		if (literals != 0u)
+		{
+			std::memcpy(pDst + written, p, literals);
+			p += literals;
+			written += literals;
+		}
+		// the last sequence is literals only
+		if (p == end)
+		{
+			break;
+		}
+		if (end - p < 2)
+		{
+			return false;
+		}
+		const size_t offset = p[0] | size_t(p[1]) << 8;
+		p += 2;
+		size_t length = token & 15u;
+		if (length == 15u && !GetLength(p, end, length))
+		{
+			return false;
+		}
+		length += minMatch;
+		if (offset == 0u || offset > written || length > size - written)
+		{
+			return false;
+		}
+		// matches may overlap what they write, which repeats the last offset bytes
+		const auto pMatch = pDst + written - offset;
+		if (offset >= length)
+		{
+			std::memcpy(pDst + written, pMatch, length);
+		}
+		else
+		{
+			for (size_t i = 0u; i < length; i++)
+			{
+				pDst[written + i] = pMatch[i];
+			}
+		}
+		written += length;
+	}
+	return written == size;
+}
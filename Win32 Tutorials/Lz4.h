@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// LZ4 block format (no frame header or checksums), compatible with the reference
+// LZ4_decompress_safe. The compressor is the plain greedy single hash table one: fast and
+// good enough for geometry and uncompressed textures, where the archive gets its gains
+class Lz4
+{
+public:
+	// worst case compressed size of size bytes
+	static size_t GetBound(size_t size) noexcept;
+	static std::vector<char> Compress(const char* pSrc, size_t size);
+	// false when the block is malformed or doesn't decompress to exactly size bytes
+	static bool Decompress(const char* pSrc, size_t srcSize, char* pDst, size_t size) noexcept;
+};
@@ -0,0 +1,62 @@
+#include "MappedFile.h"
+#include "RedSkyWin.h"
+#include "RedSkyUtility.h"
+
+MappedFile::MappedFile(const std::string& path)
+	:
+	hFile(CreateFileW(ToWide(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr))
+{
+	LARGE_INTEGER fileSize;
+	if (hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(hFile, &fileSize))
+	{
+		return;
+	}
+	// empty files can't be mapped
+	if (fileSize.QuadPart == 0)
+	{
+		open = true;
+		return;
+	}
+	hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+	if (hMapping == nullptr)
+	{
+		return;
+	}
+	pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0u, 0u, 0u);
+	if (pView)
+	{
+		size = size_t(fileSize.QuadPart);
+		open = true;
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if (pView)
+	{
+		UnmapViewOfFile(pView);
+	}
+	if (hMapping)
+	{
+		CloseHandle(hMapping);
+	}
+	if (hFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(hFile);
+	}
+}
+
+bool MappedFile::IsOpen() const noexcept
+{
+	return open;
+}
+
+const char* MappedFile::GetData() const noexcept
+{
+	return static_cast<const char*>(pView);
+}
+
+size_t MappedFile::GetSize() const noexcept
+{
+	return size;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read only view of a whole file. A file that can't be opened maps nothing, an empty one
+// is open with no data.
+class MappedFile
+{
+public:
+	MappedFile(const std::string& path);
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	bool IsOpen() const noexcept;
+	const char* GetData() const noexcept;
+	size_t GetSize() const noexcept;
+private:
+	// win32 handles
+	void* hFile;
+	void* hMapping = nullptr;
+	const void* pView = nullptr;
+	size_t size = 0u;
+	bool open = false;
+};
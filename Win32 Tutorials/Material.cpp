@@ -1,23 +1,32 @@
 #include "Material.h"
 #include "DynamicConstant.h"
 #include "ConstantBuffersEx.h"
+#include "TextureArray.h"
+#include "TexturePack.h"
+#include "ShaderPermutation.h"
 
 Material::Material(Graphics& gfx, const aiMaterial& material, const std::filesystem::path& path) noxnd
 	:
 modelPath(path.string())
 {
 	using namespace Bind;
-	const auto rootPath = path.parent_path().string() + "\\";
+	const auto rootPath = path.parent_path();
 	{
 		aiString tempName;
 		material.Get(AI_MATKEY_NAME, tempName);
 		name = tempName.C_Str();
 	}
+	// maps packed offline are bound from shared arrays instead of their own textures
+	const auto pPack = TexturePack::Load(modelPath);
+	const TexturePack::Entry* pPacked = pPack ? pPack->Find(name) : nullptr;
+	// alpha tested surfaces need their diffuse texture to know where they are opaque
+	bool masked = false;
 	// phong technique
 	{
 		Technique phong{ "Phong" };
 		Step step(0);
-		std::string shaderCode = "Phong";
+		// ShaderPermutation::Feature bits picking the phong shaders
+		uint32_t features = 0u;
 		aiString texFileName;
 
 		// common (pre)
@@ -33,15 +42,24 @@ modelPath(path.string())
 			if (material.GetTexture(aiTextureType_DIFFUSE, 0, &texFileName) == aiReturn_SUCCESS)
 			{
 				hasTexture = true;
-				shaderCode += "Dif";
+				features |= ShaderPermutation::DiffuseMap;
 				vtxLayout.Append(rsexp::VertexLayout::Texture2D);
-				auto tex = Texture::Resolve(gfx, rootPath + texFileName.C_Str());
-				if (tex->HasAlpha())
+				if (pPacked && !pPacked->diffusePath.empty())
 				{
-					hasAlpha = true;
-					shaderCode += "Msk";
+					hasAlpha = pPacked->diffuseAlpha;
+					step.AddBindable(TextureArray::Resolve(gfx, pPacked->diffusePath));
 				}
-				step.AddBindable(std::move(tex));
+				else
+				{
+					auto tex = Texture::Resolve(gfx, (rootPath / texFileName.C_Str()).string());
+					hasAlpha = tex->HasAlpha();
+					step.AddBindable(std::move(tex));
+				}
+				if (hasAlpha)
+				{
+					features |= ShaderPermutation::Mask;
+				}
+				masked = hasAlpha;
 			}
 			else
 			{
@@ -54,11 +72,19 @@ modelPath(path.string())
 			if (material.GetTexture(aiTextureType_SPECULAR, 0, &texFileName) == aiReturn_SUCCESS)
 			{
 				hasTexture = true;
-				shaderCode += "Spc";
+				features |= ShaderPermutation::SpecularMap;
 				vtxLayout.Append(rsexp::VertexLayout::Texture2D);
-				auto tex = Texture::Resolve(gfx, rootPath + texFileName.C_Str(), 1);
-				hasGlossAlpha = tex->HasAlpha();
-				step.AddBindable(std::move(tex));
+				if (pPacked && !pPacked->specularPath.empty())
+				{
+					hasGlossAlpha = pPacked->glossAlpha;
+					step.AddBindable(TextureArray::Resolve(gfx, pPacked->specularPath, 1));
+				}
+				else
+				{
+					auto tex = Texture::Resolve(gfx, (rootPath / texFileName.C_Str()).string(), 1);
+					hasGlossAlpha = tex->HasAlpha();
+					step.AddBindable(std::move(tex));
+				}
 				pscLayout.Add<Dcb::Bool>("useGlossAlpha");
 				pscLayout.Add<Dcb::Bool>("useSpecularMap");
 			}
@@ -71,23 +97,36 @@ modelPath(path.string())
 			if (material.GetTexture(aiTextureType_NORMALS, 0, &texFileName) == aiReturn_SUCCESS)
 			{
 				hasTexture = true;
-				shaderCode += "Nrm";
+				features |= ShaderPermutation::NormalMap;
 				vtxLayout.Append(rsexp::VertexLayout::Texture2D);
 				vtxLayout.Append(rsexp::VertexLayout::Tangent);
 				vtxLayout.Append(rsexp::VertexLayout::Bitangent);
-				step.AddBindable(Texture::Resolve(gfx, rootPath + texFileName.C_Str(), 2));
+				if (pPacked && !pPacked->normalPath.empty())
+				{
+					step.AddBindable(TextureArray::Resolve(gfx, pPacked->normalPath, 2));
+				}
+				else
+				{
+					step.AddBindable(Texture::Resolve(gfx, (rootPath / texFileName.C_Str()).string(), 2));
+				}
 				pscLayout.Add<Dcb::Bool>("useNormalMap");
 				pscLayout.Add<Dcb::Float>("normalMapWeight");
 			}
 		}
+		// packed location, identity for maps bound from their own textures
+		if (hasTexture)
+		{
+			pscLayout.Add<Dcb::Float4>("texTransform");
+			pscLayout.Add<Dcb::Float>("texLayer");
+		}
 		// common (post)
 		{
 			step.AddBindable(std::make_shared<TransformCbuf>(gfx, 0u));
 			step.AddBindable(Blender::Resolve(gfx, false));
-			auto pvs = VertexShader::Resolve(gfx, shaderCode + "_VS.cso");
+			auto pvs = VertexShader::Resolve(gfx, "Phong", features);
 			auto pvsbc = pvs->GetBytecode();
 			step.AddBindable(std::move(pvs));
-			step.AddBindable(PixelShader::Resolve(gfx, shaderCode + "_PS.cso"));
+			step.AddBindable(PixelShader::Resolve(gfx, "Phong", features));
 			step.AddBindable(InputLayout::Resolve(gfx, vtxLayout, pvsbc));
 			if (hasTexture)
 			{
@@ -118,11 +157,33 @@ modelPath(path.string())
 			}
 			buf["useNormalMap"].SetIfExists(true);
 			buf["normalMapWeight"].SetIfExists(1.0f);
+			buf["texTransform"].SetIfExists(pPacked ? pPacked->transform : DirectX::XMFLOAT4{ 1.0f,1.0f,0.0f,0.0f });
+			buf["texLayer"].SetIfExists(pPacked ? pPacked->layer : 0.0f);
 			step.AddBindable(std::make_unique<Bind::CachingPixelConstantBufferEx>(gfx, std::move(buf), 1u));
 		}
 		phong.AddStep(std::move(step));
 		techniques.push_back(std::move(phong));
 	}
+	// depth pre-pass technique, masked surfaces are left to write their own depth
+	if (!masked)
+	{
+		Technique depth("Depth");
+		{
+			Step only(3);
+
+			// positions are read out of the mesh's own buffer, the layout keeps only those
+			auto pvs = VertexShader::Resolve(gfx, "Solid_VS.cso");
+			auto pvsbc = pvs->GetBytecode();
+			only.AddBindable(std::move(pvs));
+			only.AddBindable(NullPixelShader::Resolve(gfx));
+			only.AddBindable(InputLayout::Resolve(gfx, vtxLayout, pvsbc));
+			only.AddBindable(std::make_shared<TransformCbuf>(gfx));
+			only.AddBindable(Rasterizer::Resolve(gfx, false));
+
+			depth.AddStep(std::move(only));
+		}
+		techniques.push_back(std::move(depth));
+	}
 	// outline technique
 	{
 		Technique outline("Outline", false);
@@ -133,7 +194,7 @@ modelPath(path.string())
 			auto pvsbc = pvs->GetBytecode();
 			mask.AddBindable(std::move(pvs));
 
-			// TODO: better sub-layout generation tech for future consideration maybe
+			// the same position-only layout for every mesh
 			mask.AddBindable(InputLayout::Resolve(gfx, vtxLayout, pvsbc));
 
 			mask.AddBindable(std::make_shared<TransformCbuf>(gfx));
@@ -163,7 +224,6 @@ modelPath(path.string())
 				draw.AddBindable(std::make_shared<Bind::CachingPixelConstantBufferEx>(gfx, buf, 1u));
 			}
 
-			// TODO: better sub-layout generation tech for future consideration maybe
 			draw.AddBindable(InputLayout::Resolve(gfx, vtxLayout, pvsbc));
 
 
@@ -194,7 +254,7 @@ std::vector<unsigned short> Material::ExtractIndices(const aiMesh& mesh) const n
 	}
 	return indices;
 }
-std::shared_ptr<Bind::VertexBuffer> Material::MakeVertexBindable(Graphics& gfx, const aiMesh& mesh, float scale) const noxnd
+rsexp::VertexBuffer Material::ExtractVertices(const aiMesh& mesh, float scale) const noexcept
 {
 	auto vtc = ExtractVertices(mesh);
 	if (scale != 1.0f) {
@@ -205,7 +265,11 @@ std::shared_ptr<Bind::VertexBuffer> Material::MakeVertexBindable(Graphics& gfx,
 			pos.z *= scale;
 		}
 	}
-	return Bind::VertexBuffer::Resolve(gfx, MakeMeshTag(mesh), std::move(vtc));
+	return vtc;
+}
+std::shared_ptr<Bind::VertexBuffer> Material::MakeVertexBindable(Graphics& gfx, const aiMesh& mesh, float scale) const noxnd
+{
+	return Bind::VertexBuffer::Resolve(gfx, MakeMeshTag(mesh), ExtractVertices(mesh, scale));
 }
 std::shared_ptr<Bind::IndexBuffer> Material::MakeIndexBindable(Graphics& gfx, const aiMesh& mesh) const noxnd
 {
@@ -13,6 +13,7 @@ class Material
 public:
 	Material(Graphics& gfx, const aiMaterial& material, const std::filesystem::path& path) noxnd;
 	rsexp::VertexBuffer ExtractVertices(const aiMesh& mesh) const noexcept;
+	rsexp::VertexBuffer ExtractVertices(const aiMesh& mesh, float scale) const noexcept;
 	std::vector<unsigned short> ExtractIndices(const aiMesh& mesh) const noexcept;
 	std::shared_ptr<Bind::VertexBuffer> MakeVertexBindable(Graphics& gfx, const aiMesh& mesh, float scale = 1.0f) const noxnd;
 	std::shared_ptr<Bind::IndexBuffer> MakeIndexBindable(Graphics& gfx, const aiMesh& mesh) const noxnd;
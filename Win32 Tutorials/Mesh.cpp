@@ -19,6 +19,11 @@ Mesh::Mesh(Graphics& gfx, const Material& mat, const aiMesh& mesh, float scale)
 Drawable(gfx, mat, mesh, scale)
 {}
 
+Mesh::Mesh(Graphics& gfx, const Material& mat, const aiMesh& mesh, float scale, SharedGeometry geometry) noxnd
+	:
+	Drawable(gfx, mat, mesh, scale, std::move(geometry))
+{}
+
 void Mesh::Submit(FrameCommander& frame, dx::FXMMATRIX accumulatedTranform) const noxnd
 {
 	dx::XMStoreFloat4x4(&transform, accumulatedTranform);
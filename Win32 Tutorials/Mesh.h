@@ -12,6 +12,7 @@ class Mesh : public Drawable
 {
 public:
 	Mesh(Graphics& gfx, const Material& mat, const aiMesh& mesh, float scale = 1.0f) noxnd;
+	Mesh(Graphics& gfx, const Material& mat, const aiMesh& mesh, float scale, SharedGeometry geometry) noxnd;
 	DirectX::XMMATRIX GetTransformXM() const noexcept override;
 	void Submit(FrameCommander& frame, DirectX::FXMMATRIX accumulatedTranform) const noxnd;
 private:
@@ -0,0 +1,28 @@
+#include "MeshBatcher.h"
+
+MeshBatcher::Range MeshBatcher::Add(const rsexp::VertexBuffer& vertices, const std::vector<unsigned short>& indices)
+{
+	const auto code = vertices.GetLayout().GetCode();
+	auto i = batchIndices.find(code);
+	if (i == batchIndices.end())
+	{
+		i = batchIndices.emplace(code, batches.size()).first;
+		batches.push_back({ rsexp::VertexBuffer{ vertices.GetLayout() },{},0u });
+	}
+	auto& batch = batches[i->second];
+	const Range range = {
+		i->second,
+		(UINT)batch.indices.size(),
+		(UINT)indices.size(),
+		(INT)batch.vertices.Size()
+	};
+	batch.vertices.Append(vertices);
+	batch.indices.insert(batch.indices.end(), indices.begin(), indices.end());
+	batch.meshCount++;
+	return range;
+}
+
+const std::vector<MeshBatcher::Batch>& MeshBatcher::GetBatches() const noexcept
+{
+	return batches;
+}
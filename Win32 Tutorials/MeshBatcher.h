@@ -0,0 +1,34 @@
+#pragma once
+#include "Vertex.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Merges the geometry of static meshes into one vertex/index buffer pair per vertex layout
+// at load time. Each mesh gets back the range it occupies and is drawn from it with a start
+// index and base vertex, so its 16 bit indices stay relative to its own vertices and a batch
+// may hold any number of vertices in total.
+class MeshBatcher
+{
+public:
+	struct Range
+	{
+		size_t batch;
+		UINT startIndex;
+		UINT indexCount;
+		INT baseVertex;
+	};
+	struct Batch
+	{
+		rsexp::VertexBuffer vertices;
+		std::vector<unsigned short> indices;
+		size_t meshCount;
+	};
+public:
+	Range Add(const rsexp::VertexBuffer& vertices, const std::vector<unsigned short>& indices);
+	const std::vector<Batch>& GetBatches() const noexcept;
+private:
+	std::vector<Batch> batches;
+	// layout code to batch
+	std::unordered_map<std::string, size_t> batchIndices;
+};
@@ -8,14 +8,20 @@
 #include "Material.h"
 #include "ModelProbe.h"
 #include "RedSkyXM.h"
+#include "PerformanceLog.h"
+#include "MeshBatcher.h"
+#include "VfsIOSystem.h"
 
 namespace dx = DirectX;
 
-Model::Model(Graphics& gfx, const std::string& pathString, const float scale)
+Model::Model(Graphics& gfx, const std::string& pathString, const float scale, bool mergeMeshes)
 //:
 //pWindow( std::make_unique<ModelWindow>() )
 {
+	PROFILE_ZONE("Model::Model");
 	Assimp::Importer imp;
+	// the importer owns the handler
+	imp.SetIOHandler(new VfsIOSystem);
 	const auto pScene = imp.ReadFile(pathString.c_str(),
 		aiProcess_Triangulate |
 		aiProcess_JoinIdenticalVertices |
@@ -37,10 +43,44 @@ Model::Model(Graphics& gfx, const std::string& pathString, const float scale)
 		materials.emplace_back(gfx, *pScene->mMaterials[i], pathString);
 	}
 
-	for (size_t i = 0; i < pScene->mNumMeshes; i++)
+	if (mergeMeshes)
 	{
-		const auto& mesh = *pScene->mMeshes[i];
-		meshPtrs.push_back(std::make_unique<Mesh>(gfx, materials[mesh.mMaterialIndex], mesh, scale));
+		PROFILE_ZONE("Merge meshes");
+		MeshBatcher batcher;
+		std::vector<MeshBatcher::Range> ranges;
+		ranges.reserve(pScene->mNumMeshes);
+		for (size_t i = 0; i < pScene->mNumMeshes; i++)
+		{
+			const auto& mesh = *pScene->mMeshes[i];
+			const auto& mat = materials[mesh.mMaterialIndex];
+			ranges.push_back(batcher.Add(mat.ExtractVertices(mesh, scale), mat.ExtractIndices(mesh)));
+		}
+		std::vector<std::pair<std::shared_ptr<Bind::VertexBuffer>, std::shared_ptr<Bind::IndexBuffer>>> buffers;
+		for (const auto& b : batcher.GetBatches())
+		{
+			// vertices are scaled before merging, so the scale is part of what is shared
+			const auto tag = pathString + "%batch." + b.vertices.GetLayout().GetCode() + "." + std::to_string(scale);
+			buffers.emplace_back(
+				Bind::VertexBuffer::Resolve(gfx, tag, b.vertices),
+				Bind::IndexBuffer::Resolve(gfx, tag, b.indices)
+			);
+		}
+		for (size_t i = 0; i < pScene->mNumMeshes; i++)
+		{
+			const auto& mesh = *pScene->mMeshes[i];
+			const auto& r = ranges[i];
+			meshPtrs.push_back(std::make_unique<Mesh>(gfx, materials[mesh.mMaterialIndex], mesh, scale, Drawable::SharedGeometry{
+				buffers[r.batch].first,buffers[r.batch].second,r.startIndex,r.indexCount,r.baseVertex
+			}));
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < pScene->mNumMeshes; i++)
+		{
+			const auto& mesh = *pScene->mMeshes[i];
+			meshPtrs.push_back(std::make_unique<Mesh>(gfx, materials[mesh.mMaterialIndex], mesh, scale));
+		}
 	}
 
 	int nextId = 0;
@@ -15,7 +15,8 @@ struct aiNode;
 class Model
 {
 public:
-	Model(Graphics& gfx, const std::string& pathString, float scale = 1.0f);
+	// mergeMeshes puts meshes sharing a vertex layout into shared buffers, see MeshBatcher
+	Model(Graphics& gfx, const std::string& pathString, float scale = 1.0f, bool mergeMeshes = true);
 	void Submit(FrameCommander& frame) const noxnd;
 	void SetRootTransform(DirectX::FXMMATRIX tf) noexcept;
 
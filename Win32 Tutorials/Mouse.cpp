@@ -5,59 +5,77 @@
 
 std::pair<int, int> Mouse::GetPos() const noexcept
 {
-	return { x,y };
+	return { GetPosX(),GetPosY() };
 }
 
 std::optional<Mouse::RawDelta> Mouse::ReadRawDelta() noexcept
 {
-	if (rawDeltaBuffer.empty())
+	if (heldCarry)
+	{
+		if (heldBehind == 0u)
+		{
+			const auto d = *heldCarry;
+			heldCarry.reset();
+			return d;
+		}
+		heldBehind--;
+		return rawDeltaBuffer.Pop();
+	}
+	if (const auto d = rawDeltaBuffer.Pop())
+	{
+		return d;
+	}
+	// a push takes the carry along, so seen after the queue ran empty the carry is the oldest
+	// motion pending. Unless the queue filled right back up before it was taken (the carry only
+	// grows while the queue is full), then the whole queue is older and the carry waits behind it
+	const auto carried = rawCarry.exchange(0u, std::memory_order_acq_rel);
+	if (carried == 0u)
 	{
 		return std::nullopt;
 	}
-	const RawDelta d = rawDeltaBuffer.front();
-	rawDeltaBuffer.pop();
+	const auto d = Unpack(carried, rawCarryTime.load(std::memory_order_relaxed));
+	if (const auto behind = rawDeltaBuffer.Size(); behind != 0u)
+	{
+		heldCarry = d;
+		heldBehind = behind - 1u;
+		return rawDeltaBuffer.Pop();
+	}
 	return d;
 }
 
 int Mouse::GetPosX() const noexcept
 {
-	return x;
+	return x.load(std::memory_order_relaxed);
 }
 
 int Mouse::GetPosY() const noexcept
 {
-	return y;
+	return y.load(std::memory_order_relaxed);
 }
 
 bool Mouse::IsInWindow() const noexcept
 {
-	return isInWindow;
+	return isInWindow.load(std::memory_order_relaxed);
 }
 
 bool Mouse::LeftIsPressed() const noexcept
 {
-	return leftIsPressed;
+	return leftIsPressed.load(std::memory_order_relaxed);
 }
 
 bool Mouse::RightIsPressed() const noexcept
 {
-	return rightIsPressed;
+	return rightIsPressed.load(std::memory_order_relaxed);
 }
 
 std::optional<Mouse::Event> Mouse::Read() noexcept
 {
-	if (buffer.size() > 0u)
-	{
-		Mouse::Event e = buffer.front();
-		buffer.pop();
-		return e;
-	}
-	return {};
+	return buffer.Pop();
 }
 
 void Mouse::Flush() noexcept
 {
-	buffer = std::queue<Event>();
+	buffer.Clear();
 }
 
 void Mouse::EnableRaw() noexcept
@@ -75,92 +93,87 @@ bool Mouse::RawEnabled() const noexcept
 	return rawEnabled;
 }
 
+size_t Mouse::GetDroppedCount() const noexcept
+{
+	return dropped.load(std::memory_order_relaxed);
+}
+
 void Mouse::OnMouseMove(int newx, int newy) noexcept
 {
 	x = newx;
 	y = newy;
 
-	buffer.push(Mouse::Event(Mouse::Event::Type::Move, *this));
-	TrimBuffer();
+	Push(Mouse::Event::Type::Move);
 }
 
 void Mouse::OnMouseLeave() noexcept
 {
 	isInWindow = false;
-	buffer.push(Mouse::Event(Mouse::Event::Type::Leave, *this));
-	TrimBuffer();
+	Push(Mouse::Event::Type::Leave);
 }
 
 void Mouse::OnMouseEnter() noexcept
 {
 	isInWindow = true;
-	buffer.push(Mouse::Event(Mouse::Event::Type::Enter, *this));
-	TrimBuffer();
+	Push(Mouse::Event::Type::Enter);
 }
 
-void Mouse::OnRawDelta(int dx, int dy) noexcept
+void Mouse::OnRawDelta(int dx, int dy, Clock::time_point timestamp) noexcept
 {
-	rawDeltaBuffer.push({ dx,dy });
-	TrimBuffer();
+	// motion carried from when the queue was full came before this, so it goes out with it
+	const auto carried = Unpack(rawCarry.exchange(0u, std::memory_order_acq_rel), 0);
+	const RawDelta d = { dx + carried.x,dy + carried.y,timestamp };
+	if (rawDeltaBuffer.Push(d))
+	{
+		return;
+	}
+	rawCarryTime.store(timestamp.time_since_epoch().count(), std::memory_order_relaxed);
+	Carry(d.x, d.y);
 }
 
 void Mouse::OnLeftPressed(int x, int y) noexcept
 {
 	leftIsPressed = true;
 
-	buffer.push(Mouse::Event(Mouse::Event::Type::LPress, *this));
-	TrimBuffer();
+	Push(Mouse::Event::Type::LPress);
 }
 
 void Mouse::OnLeftReleased(int x, int y) noexcept
 {
 	leftIsPressed = false;
 
-	buffer.push(Mouse::Event(Mouse::Event::Type::LRelease, *this));
-	TrimBuffer();
+	Push(Mouse::Event::Type::LRelease);
 }
 
 void Mouse::OnRightPressed(int x, int y) noexcept
 {
 	rightIsPressed = true;
 
-	buffer.push(Mouse::Event(Mouse::Event::Type::RPress, *this));
-	TrimBuffer();
+	Push(Mouse::Event::Type::RPress);
 }
 
 void Mouse::OnRightReleased(int x, int y) noexcept
 {
 	rightIsPressed = false;
 
-	buffer.push(Mouse::Event(Mouse::Event::Type::RRelease, *this));
-	TrimBuffer();
+	Push(Mouse::Event::Type::RRelease);
 }
 
 void Mouse::OnWheelUp(int x, int y) noexcept
 {
-	buffer.push(Mouse::Event(Mouse::Event::Type::WheelUp, *this));
-	TrimBuffer();
+	Push(Mouse::Event::Type::WheelUp);
 }
 
 void Mouse::OnWheelDown(int x, int y) noexcept
 {
-	buffer.push(Mouse::Event(Mouse::Event::Type::WheelDown, *this));
-	TrimBuffer();
+	Push(Mouse::Event::Type::WheelDown);
 }
 
-void Mouse::TrimBuffer() noexcept
+void Mouse::Push(Event::Type type) noexcept
 {
-	while (buffer.size() > bufferSize)
+	if (!buffer.Push(Mouse::Event(type, *this, Clock::now())))
 	{
-		buffer.pop();
-	}
-}
-
-void Mouse::TrimRawInputBuffer() noexcept
-{
-	while (rawDeltaBuffer.size() > bufferSize)
-	{
-		rawDeltaBuffer.pop();
+		dropped.fetch_add(1u, std::memory_order_relaxed);
 	}
 }
 
@@ -179,3 +192,26 @@ void Mouse::OnWheelDelta(int x, int y, int delta) noexcept
 		OnWheelDown(x, y);
 	}
 }
+
+void Mouse::Carry(int dx, int dy) noexcept
+{
+	auto expected = rawCarry.load(std::memory_order_relaxed);
+	while (true)
+	{
+		const auto sum = Unpack(expected, 0);
+		if (rawCarry.compare_exchange_weak(expected, Pack(sum.x + dx, sum.y + dy), std::memory_order_acq_rel))
+		{
+			return;
+		}
+	}
+}
+
+uint64_t Mouse::Pack(int dx, int dy) noexcept
+{
+	return uint64_t(uint32_t(dx)) | uint64_t(uint32_t(dy)) << 32;
+}
+
+Mouse::RawDelta Mouse::Unpack(uint64_t packed, Clock::rep timestamp) noexcept
+{
+	return { int(uint32_t(packed)),int(uint32_t(packed >> 32)),Clock::time_point(Clock::duration(timestamp)) };
+}
@@ -1,15 +1,28 @@
 
 #pragma once
-#include <queue>
+#include "SpscQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <optional>
+#include <utility>
 
+// Events are queued by the thread pumping window messages and read by the one running the
+// frame, which can be different threads. Queues are fixed size lock free rings: events that
+// arrive while one is full are dropped and counted, except raw deltas, which are carried
+// into the next one that fits so their sum is always exact and they are read in order.
 class Mouse
 {
 	friend class Window;
+	friend void TestInputQueues();
 public:
+	using Clock = std::chrono::steady_clock;
 	struct RawDelta
 	{
 		int x, y;
+		// of the motion, for a delta summing motion carried past a full queue that of the
+		// newest motion carried when it was read
+		Clock::time_point timestamp;
 	};
 	class Event
 	{
@@ -32,14 +45,16 @@ public:
 		bool rightIsPressed;
 		int x;
 		int y;
+		Clock::time_point timestamp;
 	public:
-		Event(Type type, const Mouse& parent) noexcept
+		Event(Type type, const Mouse& parent, Clock::time_point timestamp) noexcept
 			:
 			type(type),
-			leftIsPressed(parent.leftIsPressed),
-			rightIsPressed(parent.rightIsPressed),
-			x(parent.x),
-			y(parent.y)
+			leftIsPressed(parent.leftIsPressed.load(std::memory_order_relaxed)),
+			rightIsPressed(parent.rightIsPressed.load(std::memory_order_relaxed)),
+			x(parent.x.load(std::memory_order_relaxed)),
+			y(parent.y.load(std::memory_order_relaxed)),
+			timestamp(timestamp)
 		{}
 		Type GetType() const noexcept
 		{
@@ -65,6 +80,11 @@ public:
 		{
 			return rightIsPressed;
 		}
+		// when the message was handled, input latency is measured from here
+		Clock::time_point GetTimestamp() const noexcept
+		{
+			return timestamp;
+		}
 	};
 public:
 	Mouse() = default;
@@ -80,35 +100,48 @@ public:
 	std::optional<Mouse::Event> Read() noexcept;
 	bool IsEmpty() const noexcept
 	{
-		return buffer.empty();
+		return buffer.IsEmpty();
 	}
 	void Flush() noexcept;
 	void EnableRaw() noexcept;
 	void DisableRaw() noexcept;
 	bool RawEnabled() const noexcept;
+	size_t GetDroppedCount() const noexcept;
 private:
 	void OnMouseMove(int x, int y) noexcept;
 	void OnMouseLeave() noexcept;
 	void OnMouseEnter() noexcept;
-	void OnRawDelta(int dx, int dy) noexcept;
+	void OnRawDelta(int dx, int dy, Clock::time_point timestamp = Clock::now()) noexcept;
 	void OnLeftPressed(int x, int y) noexcept;
 	void OnLeftReleased(int x, int y) noexcept;
 	void OnRightPressed(int x, int y) noexcept;
 	void OnRightReleased(int x, int y) noexcept;
 	void OnWheelUp(int x, int y) noexcept;
 	void OnWheelDown(int x, int y) noexcept;
-	void TrimBuffer() noexcept;
-	void TrimRawInputBuffer() noexcept;
+	void Push(Event::Type type) noexcept;
 	void OnWheelDelta(int x, int y, int delta) noexcept;
+	// adds to the raw motion carried, from either side
+	void Carry(int dx, int dy) noexcept;
+	// a raw delta packed into one word so it can be exchanged as a whole
+	static uint64_t Pack(int dx, int dy) noexcept;
+	static RawDelta Unpack(uint64_t packed, Clock::rep timestamp) noexcept;
 private:
-	static constexpr unsigned int bufferSize = 16u;
-	int x;
-	int y;
-	bool leftIsPressed = false;
-	bool rightIsPressed = false;
-	bool isInWindow = false;
+	static constexpr unsigned int bufferSize = 1024u;
+	std::atomic<int> x = 0;
+	std::atomic<int> y = 0;
+	std::atomic<bool> leftIsPressed = false;
+	std::atomic<bool> rightIsPressed = false;
+	std::atomic<bool> isInWindow = false;
 	int wheelDeltaCarry = 0;
-	bool rawEnabled = false;
-	std::queue<Event> buffer;
-	std::queue<RawDelta> rawDeltaBuffer;
+	std::atomic<bool> rawEnabled = false;
+	SpscQueue<Event, bufferSize> buffer;
+	SpscQueue<RawDelta, bufferSize> rawDeltaBuffer;
+	// raw motion that didn't fit in the queue, taken by the next delta pushed or read once
+	// the queue has been emptied
+	std::atomic<uint64_t> rawCarry = 0u;
+	std::atomic<Clock::rep> rawCarryTime = 0;
+	// reader only, a carry taken while older deltas were queued and how many of them are left
+	std::optional<RawDelta> heldCarry;
+	size_t heldBehind = 0u;
+	std::atomic<size_t> dropped = 0u;
 };
\ No newline at end of file
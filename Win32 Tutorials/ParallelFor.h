@@ -0,0 +1,62 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Calls f(i) for every i below count. Work is handed out grain indices at a time to worker
+// threads started for the call, with the calling thread working too, so it only pays off for
+// jobs of a millisecond or more. With a single grain's worth (or threads = 1) everything runs
+// on the calling thread. f must be safe to call concurrently for different i and not throw.
+template<typename F>
+void ParallelFor(size_t count, size_t grain, F&& f, unsigned int threads = 0u)
+{
+	grain = std::max(grain, size_t(1u));
+	const auto chunks = (count + grain - 1u) / grain;
+	if (threads == 0u)
+	{
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	threads = (unsigned int)std::min(size_t(threads), chunks);
+	if (threads <= 1u)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			f(i);
+		}
+		return;
+	}
+	std::atomic<size_t> next{ 0u };
+	const auto work = [&]()
+	{
+		for (auto c = next.fetch_add(1u, std::memory_order_relaxed); c < chunks; c = next.fetch_add(1u, std::memory_order_relaxed))
+		{
+			const auto end = std::min(count, (c + 1u) * grain);
+			for (auto i = c * grain; i < end; i++)
+			{
+				f(i);
+			}
+		}
+	};
+	std::vector<std::thread> workers;
+	workers.reserve(threads - 1u);
+	for (unsigned int t = 1u; t < threads; t++)
+	{
+		workers.emplace_back(work);
+	}
+	work();
+	for (auto& w : workers)
+	{
+		w.join();
+	}
+}
+
+// Grain for jobs handed out a row at a time, such as generated geometry: rows of rowSize
+// items are grouped until a grain covers about rowGrainItems, roughly where the per vertex
+// work outweighs waking another thread for it.
+constexpr size_t rowGrainItems = 16384u;
+
+inline size_t RowGrain(size_t rowSize) noexcept
+{
+	return std::max(rowGrainItems / std::max(rowSize, size_t(1u)), size_t(1u));
+}
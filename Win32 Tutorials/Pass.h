@@ -1,6 +1,13 @@
 #pragma once
 #include "Graphics.h"
 #include "Job.h"
+#include "InstanceBuffer.h"
+#include "PerformanceLog.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 class Pass
@@ -10,12 +17,78 @@ public:
 	{
 		jobs.push_back(job);
 	}
+	// nearest jobs first by the view depth of their bounds, so early depth testing rejects
+	// what they cover. Otherwise jobs run in submission order
+	void SetFrontToBack(bool enabled) noexcept
+	{
+		frontToBack = enabled;
+	}
 	void Execute(Graphics& gfx) const noxnd
 	{
+		PROFILE_ZONE("Pass::Execute");
+		order.clear();
 		for (const auto& j : jobs)
 		{
-			j.Execute(gfx);
+			order.emplace_back(frontToBack ? j.GetViewDepth(gfx) : 0.0f, &j);
+		}
+		if (frontToBack)
+		{
+			// stable so equal depths keep submission order and runs stay repeatable
+			std::stable_sort(order.begin(), order.end(),
+				[](const auto& a, const auto& b) { return a.first < b.first; });
+		}
+		if (!gfx.IsInstancingEnabled())
+		{
+			for (const auto& o : order)
+			{
+				o.second->Execute(gfx);
+			}
+			return;
+		}
+
+		// jobs with equal batch keys are gathered into one group, groups run in the order
+		// their first job comes in
+		size_t groupCount = 0u;
+		batchGroups.clear();
+		for (const auto& o : order)
+		{
+			const auto& j = *o.second;
+			batchKey.clear();
+			if (j.AppendBatchKey(batchKey))
+			{
+				if (const auto i = batchGroups.find(batchKey); i != batchGroups.end())
+				{
+					groups[i->second].push_back(&j);
+					continue;
+				}
+				batchGroups.emplace(batchKey, groupCount);
+			}
+			// group vectors are kept between frames so they don't reallocate
+			if (groupCount == groups.size())
+			{
+				groups.emplace_back();
+			}
+			groups[groupCount].clear();
+			groups[groupCount++].push_back(&j);
 		}
+
+		for (size_t i = 0; i < groupCount; i++)
+		{
+			if (groups[i].size() == 1u)
+			{
+				groups[i].front()->Execute(gfx);
+				continue;
+			}
+			if (!pInstances)
+			{
+				pInstances = std::make_unique<Bind::InstanceBuffer>(gfx);
+			}
+			Job::ExecuteInstanced(gfx, groups[i], *pInstances);
+		}
+	}
+	size_t GetJobCount() const noexcept
+	{
+		return jobs.size();
 	}
 	void Reset() noexcept
 	{
@@ -23,4 +96,11 @@ public:
 	}
 private:
 	std::vector<Job> jobs;
+	bool frontToBack = false;
+	// per frame scratch for ordering and batching
+	mutable std::vector<std::pair<float, const Job*>> order;
+	mutable std::string batchKey;
+	mutable std::unordered_map<std::string, size_t> batchGroups;
+	mutable std::vector<std::vector<const Job*>> groups;
+	mutable std::unique_ptr<Bind::InstanceBuffer> pInstances;
 };
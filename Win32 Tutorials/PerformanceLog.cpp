@@ -0,0 +1,344 @@
+#include "PerformanceLog.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <string>
+
+Profiler::ThreadRing::ThreadRing(uint32_t index) noexcept
+	:
+	index(index)
+{}
+
+void Profiler::ThreadRing::Push(const Event& e) noexcept
+{
+	const auto h = head.load(std::memory_order_relaxed);
+	if (h - tail.load(std::memory_order_acquire) >= capacity)
+	{
+		dropped.fetch_add(1u, std::memory_order_relaxed);
+		return;
+	}
+	events[h & (capacity - 1u)] = e;
+	head.store(h + 1u, std::memory_order_release);
+}
+
+uint32_t Profiler::ThreadRing::GetIndex() const noexcept
+{
+	return index;
+}
+
+Profiler::ThreadRingOwner::ThreadRingOwner(ThreadRing& ring) noexcept
+	:
+	ring(ring)
+{}
+
+Profiler::ThreadRingOwner::~ThreadRingOwner()
+{
+	Get().ReleaseThread(ring);
+}
+
+Profiler::ThreadRing& Profiler::ThreadRingOwner::GetRing() const noexcept
+{
+	return ring;
+}
+
+Profiler::Scope::Scope(const ProfileZone& zone) noexcept
+	:
+	ring(GetThreadRing()),
+	zone(zone),
+	parent(ring.current),
+	start(Now())
+{
+	ring.current = &zone;
+	ring.depth++;
+}
+
+Profiler::Scope::~Scope()
+{
+	const auto end = Now();
+	ring.depth--;
+	ring.current = parent;
+	ring.Push({ &zone,parent,start,end,ring.depth,Event::Type::Zone,0 });
+}
+
+void Profiler::EndFrame()
+{
+	Get().EndFrame_();
+}
+
+std::vector<Profiler::ZoneStats> Profiler::GetStats()
+{
+	return Get().GetStats_();
+}
+
+void Profiler::WriteReport(std::ostream& out)
+{
+	const auto stats = GetStats();
+	out << std::setprecision(3) << std::fixed;
+	out << "[Profiler] " << GetFrameCount() << " frames, " << GetDroppedCount() << " zones dropped\n";
+	for (const auto& s : stats)
+	{
+		out << "T" << s.thread << " " << std::string(s.depth * 2u, ' ') << s.zone->name
+			<< " calls " << s.calls
+			<< " min " << s.minMs << "ms avg " << s.avgMs << "ms p95 " << s.p95Ms << "ms max " << s.maxMs << "ms\n";
+	}
+}
+
+uint64_t Profiler::GetFrameCount() noexcept
+{
+	return Get().frameCount;
+}
+
+uint64_t Profiler::GetDroppedCount() noexcept
+{
+	auto& p = Get();
+	std::lock_guard<std::mutex> lock{ p.mutex };
+	uint64_t dropped = 0u;
+	for (const auto& r : p.rings)
+	{
+		dropped += r->dropped.load(std::memory_order_relaxed);
+	}
+	return dropped;
+}
+
+Profiler::ThreadRing& Profiler::GetThreadRing()
+{
+	// registration locks once per thread, every zone after that is lock free
+	thread_local const ThreadRingOwner owner{ Get().RegisterThread() };
+	return owner.GetRing();
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	auto& ring = GetThreadRing();
+	std::lock_guard<std::mutex> lock{ Get().mutex };
+	ring.name = name;
+}
+
+Profiler::ThreadRing& Profiler::RegisterTrack(const std::string& name)
+{
+	auto& p = Get();
+	{
+		// tracks outlive whoever registered them, so a recreated timer picks up its old one
+		std::lock_guard<std::mutex> lock{ p.mutex };
+		for (auto& pRing : p.rings)
+		{
+			if (pRing->name == name)
+			{
+				return *pRing;
+			}
+		}
+	}
+	auto& ring = p.RegisterThread();
+	std::lock_guard<std::mutex> lock{ p.mutex };
+	ring.name = name;
+	return ring;
+}
+
+void Profiler::Counter(const ProfileZone& zone, int64_t value) noexcept
+{
+	auto& ring = GetThreadRing();
+	const auto t = Now();
+	ring.Push({ &zone,ring.current,t,t,ring.depth,Event::Type::Counter,value });
+}
+
+bool Profiler::BeginTrace(const std::string& path, uint64_t frames)
+{
+	auto& p = Get();
+	std::lock_guard<std::mutex> lock{ p.mutex };
+	p.EndTrace_();
+	p.traceOrigin = Now();
+	p.pTrace = std::make_unique<TraceWriter>(path, p.traceOrigin);
+	p.traceEndFrame = frames > 0u ? p.frameCount + frames : 0u;
+	if (!p.pTrace->IsOpen())
+	{
+		p.pTrace.reset();
+		return false;
+	}
+	return true;
+}
+
+void Profiler::EndTrace()
+{
+	auto& p = Get();
+	std::lock_guard<std::mutex> lock{ p.mutex };
+	p.EndTrace_();
+}
+
+bool Profiler::IsTracing()
+{
+	auto& p = Get();
+	std::lock_guard<std::mutex> lock{ p.mutex };
+	return p.pTrace != nullptr;
+}
+
+Profiler& Profiler::Get()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::~Profiler()
+{
+	EndTrace_();
+	if (frameCount > 0u)
+	{
+		std::ofstream file("perf.txt");
+		WriteReport(file);
+	}
+}
+
+Profiler::ThreadRing& Profiler::RegisterThread()
+{
+	std::lock_guard<std::mutex> lock{ mutex };
+	// an exited thread's ring is taken over once EndFrame has drained it, under the same
+	// index so its zones land on the same track. Latest first, so a thread started over
+	// and over keeps to one track
+	for (auto i = freeRings.rbegin(); i != freeRings.rend(); ++i)
+	{
+		auto& ring = **i;
+		if (ring.tail.load(std::memory_order_relaxed) == ring.head.load(std::memory_order_acquire))
+		{
+			freeRings.erase(std::next(i).base());
+			ring.current = nullptr;
+			ring.depth = 0u;
+			ring.name.clear();
+			return ring;
+		}
+	}
+	rings.push_back(std::make_unique<ThreadRing>((uint32_t)rings.size()));
+	return *rings.back();
+}
+
+void Profiler::ReleaseThread(ThreadRing& ring)
+{
+	std::lock_guard<std::mutex> lock{ mutex };
+	freeRings.push_back(&ring);
+}
+
+void Profiler::EndFrame_()
+{
+	std::lock_guard<std::mutex> lock{ mutex };
+	for (auto& pRing : rings)
+	{
+		const auto thread = pRing->GetIndex();
+		pRing->Drain([this, thread](const Event& e)
+			{
+				if (pTrace && e.end >= traceOrigin)
+				{
+					if (e.type == Event::Type::Counter)
+					{
+						traceBatch.push_back({ TraceWriter::Record::Phase::Counter,e.zone->name,thread,e.start,0,e.value });
+					}
+					else
+					{
+						traceBatch.push_back({ TraceWriter::Record::Phase::Complete,e.zone->name,thread,e.start,e.end - e.start,0 });
+					}
+				}
+				if (e.type == Event::Type::Zone)
+				{
+					auto& n = nodes[{ thread,e.zone,e.parent,e.depth }];
+					n.frameTicks += e.end - e.start;
+					n.frameCalls++;
+				}
+			}
+		);
+	}
+	for (auto& [key, n] : nodes)
+	{
+		if (n.frameCalls == 0u)
+		{
+			continue;
+		}
+		const auto ms = ToMilliseconds(n.frameTicks);
+		if (n.ms.size() < historyFrames)
+		{
+			n.ms.push_back(ms);
+			n.calls.push_back(n.frameCalls);
+		}
+		else
+		{
+			n.ms[n.next] = ms;
+			n.calls[n.next] = n.frameCalls;
+		}
+		n.next = (n.next + 1u) % historyFrames;
+		n.frameTicks = 0;
+		n.frameCalls = 0u;
+	}
+	frameCount++;
+	if (pTrace)
+	{
+		traceBatch.push_back({ TraceWriter::Record::Phase::Instant,"Frame",0u,Now(),0,(int64_t)frameCount });
+		pTrace->Submit(std::move(traceBatch));
+		traceBatch.clear();
+		if (traceEndFrame > 0u && frameCount >= traceEndFrame)
+		{
+			EndTrace_();
+		}
+	}
+}
+
+void Profiler::EndTrace_()
+{
+	if (!pTrace)
+	{
+		return;
+	}
+	// thread names go last so renames during the capture are picked up, viewers don't mind the order
+	for (const auto& pRing : rings)
+	{
+		const auto index = pRing->GetIndex();
+		if (pRing->name.empty())
+		{
+			pRing->name = "Thread " + std::to_string(index);
+		}
+		traceBatch.push_back({ TraceWriter::Record::Phase::Metadata,pRing->name.c_str(),index,0,0,0 });
+	}
+	pTrace->Submit(std::move(traceBatch));
+	traceBatch.clear();
+	// joins the writer, so the file is complete when this returns
+	pTrace.reset();
+}
+
+std::vector<Profiler::ZoneStats> Profiler::GetStats_() const
+{
+	std::lock_guard<std::mutex> lock{ mutex };
+	std::vector<ZoneStats> stats;
+	for (const auto& r : rings)
+	{
+		EmitChildren(stats, r->GetIndex(), nullptr, 0u);
+	}
+	return stats;
+}
+
+void Profiler::EmitChildren(std::vector<ZoneStats>& out, uint32_t thread, const ProfileZone* parent, uint32_t depth) const
+{
+	for (const auto& [key, n] : nodes)
+	{
+		const auto& [t, zone, p, d] = key;
+		if (t != thread || p != parent || d != depth || n.ms.empty())
+		{
+			continue;
+		}
+		auto sorted = n.ms;
+		std::sort(sorted.begin(), sorted.end());
+		float sum = 0.0f;
+		for (auto ms : sorted)
+		{
+			sum += ms;
+		}
+		size_t calls = 0u;
+		for (auto c : n.calls)
+		{
+			calls += c;
+		}
+		const auto p95 = (size_t)std::ceil(0.95 * double(sorted.size())) - 1u;
+		out.push_back({
+			zone,parent,depth,thread,sorted.size(),
+			float(calls) / float(sorted.size()),
+			sorted.front(),sum / float(sorted.size()),sorted[p95],sorted.back()
+		});
+		EmitChildren(out, thread, zone, depth + 1u);
+	}
+}
@@ -1,62 +1,199 @@
 #pragma once
-#include <fstream>
-#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
 #include <string>
-#include <iomanip>
-#include "RedSkyTimer.h"
-
-class PerfLog {
-private:
-	struct Entry {
-		Entry(std::string s, float t) : label(std::move(s)), time(t) {}
+#include <tuple>
+#include <vector>
+#include "TraceWriter.h"
 
-		std::string label;
-		float time;
+// static description of a profiled scope, one per call site
+struct ProfileZone
+{
+	const char* name;
+	const char* file;
+	int line;
+};
 
-		void WriteTo(std::ostream& out) const noexcept {
-			if (label.empty()) {
-				out << time * 1000.0f << "ms\n";
-			}
-			else
+// Hierarchical scoped cpu profiler. Zones write into a lock free ring owned by the
+// calling thread, so recording never allocates or locks. EndFrame drains every ring
+// and folds the samples into per frame totals for each zone under each parent, from
+// which min/avg/p95/max over the recent frames are reported. A thread's ring is handed
+// back when it exits and given to the next thread to start recording once drained, so
+// short lived threads share a track instead of each keeping a ring alive.
+class Profiler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	struct Event
+	{
+		enum class Type : uint32_t
+		{
+			Zone,
+			// a sampled value, start and end are both the sample time
+			Counter,
+		};
+		const ProfileZone* zone;
+		const ProfileZone* parent;
+		int64_t start;
+		int64_t end;
+		uint32_t depth;
+		Type type;
+		int64_t value;
+	};
+	// single producer (the owning thread) single consumer (EndFrame) ring of finished zones
+	class ThreadRing
+	{
+		friend class Profiler;
+	public:
+		// deep enough to hold a whole model load between two frames
+		static constexpr uint32_t capacity = 1u << 16;
+	public:
+		ThreadRing(uint32_t index) noexcept;
+		void Push(const Event& e) noexcept;
+		template<typename F>
+		void Drain(F&& f) noexcept
+		{
+			auto t = tail.load(std::memory_order_relaxed);
+			const auto h = head.load(std::memory_order_acquire);
+			for (; t != h; t++)
 			{
-				out << "[" << label << "]" << time * 1000.0f << "ms\n";
+				f(events[t & (capacity - 1u)]);
 			}
+			tail.store(t, std::memory_order_release);
 		}
+		uint32_t GetIndex() const noexcept;
+	private:
+		std::atomic<uint32_t> head = 0u;
+		std::atomic<uint32_t> tail = 0u;
+		std::atomic<uint64_t> dropped = 0u;
+		uint32_t index;
+		// open zone stack, only touched by the owning thread
+		const ProfileZone* current = nullptr;
+		uint32_t depth = 0u;
+		// track name in traces, guarded by the profiler mutex
+		std::string name;
+		Event events[capacity];
+	};
+	// a thread's hold on its ring, returning it for reuse when the thread exits
+	class ThreadRingOwner
+	{
+	public:
+		ThreadRingOwner(ThreadRing& ring) noexcept;
+		~ThreadRingOwner();
+		ThreadRingOwner(const ThreadRingOwner&) = delete;
+		ThreadRingOwner& operator=(const ThreadRingOwner&) = delete;
+		ThreadRing& GetRing() const noexcept;
+	private:
+		ThreadRing& ring;
+	};
+	class Scope
+	{
+	public:
+		Scope(const ProfileZone& zone) noexcept;
+		~Scope();
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	private:
+		ThreadRing& ring;
+		const ProfileZone& zone;
+		const ProfileZone* parent;
+		int64_t start;
+	};
+	struct ZoneStats
+	{
+		const ProfileZone* zone;
+		const ProfileZone* parent;
+		uint32_t depth;
+		uint32_t thread;
+		// frames in the window the zone ran in, and its average calls in those frames
+		size_t frames;
+		float calls;
+		// time per frame summed over every call
+		float minMs;
+		float avgMs;
+		float p95Ms;
+		float maxMs;
 	};
-	static PerfLog& Get_() noexcept {
-		static PerfLog log;
-		return log;
-	}
-	PerfLog() noexcept {
-		entries.reserve(3000);
-	}
-	~PerfLog() {
-		Flush_();
-	}
-	void Start_(const std::string& label = "") noexcept {
-		entries.emplace_back(label, 0.0f);
-		timer.Mark();
-	}
-	void Mark_(const std::string& label = "") noexcept {
-		float t = timer.Peek();
-		entries.emplace_back(label, t);
-	}
-	void Flush_() {
-		std::ofstream file("perf.txt");
-		file << std::setprecision(3) << std::fixed;
-		for (const auto& e : entries) {
-			e.WriteTo(file);
-		}
-	}
 public:
-	static void Start(const std::string& label = "") noexcept {
-		Get_().Start_(label);
+	// frames of history the statistics are computed over
+	static constexpr size_t historyFrames = 240u;
+public:
+	// drains the thread rings and closes the frame, call once per frame outside any zone
+	static void EndFrame();
+	// zones in depth first order, children following their parent
+	static std::vector<ZoneStats> GetStats();
+	static void WriteReport(std::ostream& out);
+	static uint64_t GetFrameCount() noexcept;
+	// zones lost because a ring filled up between two EndFrame calls
+	static uint64_t GetDroppedCount() noexcept;
+	static ThreadRing& GetThreadRing();
+	// names the calling thread's track in traces
+	static void SetThreadName(const std::string& name);
+	// a named track for timings that don't come from a cpu thread (gpu queries), registered
+	// once per name. Its ring must only be pushed to by one thread at a time
+	static ThreadRing& RegisterTrack(const std::string& name);
+	// records a sampled value, shown as a counter track in traces
+	static void Counter(const ProfileZone& zone, int64_t value) noexcept;
+	// streams every zone, counter and frame boundary to a chrome trace json file, for the
+	// given number of frames or until EndTrace when frames is 0. false if the file can't be created
+	static bool BeginTrace(const std::string& path, uint64_t frames = 0u);
+	static void EndTrace();
+	static bool IsTracing();
+	static int64_t Now() noexcept
+	{
+		return Clock::now().time_since_epoch().count();
 	}
-	static void Mark(const std::string& label = "") noexcept {
-		Get_().Mark_(label);
+	static float ToMilliseconds(int64_t ticks) noexcept
+	{
+		return float(double(ticks) * Clock::period::num * 1000.0 / Clock::period::den);
 	}
-
 private:
-	RedSkyTimer timer;
-	std::vector<Entry> entries;
+	struct Node
+	{
+		// ring of per frame totals, only frames where the zone ran are recorded
+		std::vector<float> ms;
+		std::vector<uint32_t> calls;
+		size_t next = 0u;
+		int64_t frameTicks = 0;
+		uint32_t frameCalls = 0u;
+	};
+	// thread, zone, parent, depth
+	using NodeKey = std::tuple<uint32_t, const ProfileZone*, const ProfileZone*, uint32_t>;
+private:
+	static Profiler& Get();
+	Profiler() = default;
+	~Profiler();
+	ThreadRing& RegisterThread();
+	void ReleaseThread(ThreadRing& ring);
+	void EndFrame_();
+	std::vector<ZoneStats> GetStats_() const;
+	void EndTrace_();
+	void EmitChildren(std::vector<ZoneStats>& out, uint32_t thread, const ProfileZone* parent, uint32_t depth) const;
+private:
+	mutable std::mutex mutex;
+	std::vector<std::unique_ptr<ThreadRing>> rings;
+	// rings of exited threads, possibly still holding events for EndFrame
+	std::vector<ThreadRing*> freeRings;
+	std::map<NodeKey, Node> nodes;
+	uint64_t frameCount = 0u;
+	std::unique_ptr<TraceWriter> pTrace;
+	int64_t traceOrigin = 0;
+	uint64_t traceEndFrame = 0u;
+	std::vector<TraceWriter::Record> traceBatch;
 };
+
+#define PROFILE_CONCAT_(a,b) a##b
+#define PROFILE_CONCAT(a,b) PROFILE_CONCAT_(a,b)
+// times the rest of the enclosing scope under the given name (a string literal)
+#define PROFILE_ZONE(name) \
+	static constexpr ProfileZone PROFILE_CONCAT(profileZone_,__LINE__){ name,__FILE__,__LINE__ }; \
+	const Profiler::Scope PROFILE_CONCAT(profileScope_,__LINE__){ PROFILE_CONCAT(profileZone_,__LINE__) }
+// samples a value under the given name (a string literal)
+#define PROFILE_COUNTER(name,value) do { \
+	static constexpr ProfileZone PROFILE_CONCAT(profileCounter_,__LINE__){ name,__FILE__,__LINE__ }; \
+	Profiler::Counter(PROFILE_CONCAT(profileCounter_,__LINE__),int64_t(value)); } while(false)
@@ -0,0 +1,30 @@
+// Transform.hlsl only for ToClip, its TransformCBuf goes unused and takes no slot
+#include "Transform.hlsl"
+
+cbuffer ProjectionCBuf : register(b0)
+{
+    matrix proj;
+};
+
+struct VSOut
+{
+    float3 viewPos : Position;
+    float3 viewNormal : Normal;
+    float2 tc : Texcoord;
+    float4 pos : SV_Position;
+};
+
+// instanced Phong_VS with DIFFUSE_MAP, the model view transform comes from the instance buffer
+VSOut main(float3 pos : Position, float3 n : Normal, float2 tc : Texcoord,
+    float4 mv0 : InstanceTransform0, float4 mv1 : InstanceTransform1, float4 mv2 : InstanceTransform2, float4 mv3 : InstanceTransform3)
+{
+    const float4x4 instanceModelView = float4x4(mv0, mv1, mv2, mv3);
+    VSOut vso;
+    vso.viewPos = (float3) mul(float4(pos, 1.0f), instanceModelView);
+    vso.viewNormal = mul(n, (float3x3) instanceModelView);
+    // bit for bit the depth SolidInst_VS lays down in the pre-pass
+    precise float4 clip = ToClip(pos, instanceModelView, proj);
+    vso.pos = clip;
+    vso.tc = tc;
+    return vso;
+}
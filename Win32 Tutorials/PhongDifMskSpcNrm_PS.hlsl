@@ -1,2 +0,0 @@
-#define MASK_BOI
-#include "PhongDifSpcNrm_PS.hlsl"
\ No newline at end of file
@@ -1,44 +0,0 @@
-#include "ShaderOps.hlsl"
-#include "LightVectorData.hlsl"
-
-#include "PointLight.hlsl"
-
-cbuffer ObjectCBuf
-{
-    float3 specularColor;
-    float specularWeight;
-    float specularGloss;
-    bool useNormalMap;
-    float normalMapWeight;
-};
-
-Texture2D tex;
-Texture2D nmap : register(t2);
-
-SamplerState splr;
-
-
-float4 main(float3 viewFragPos : Position, float3 viewNormal : Normal, float3 viewTan : Tangent, float3 viewBitan : Bitangent, float2 tc : Texcoord) : SV_Target
-{
-    // normalize the mesh normal
-    viewNormal = normalize(viewNormal);
-    // replace normal with mapped if normal mapping enabled
-    if (useNormalMap)
-    {
-        const float3 mappedNormal = MapNormal(normalize(viewTan), normalize(viewBitan), viewNormal, tc, nmap, splr);
-        viewNormal = lerp(viewNormal, mappedNormal, normalMapWeight);
-    }
-	// fragment to light vector data
-    const LightVectorData lv = CalculateLightVectorData(viewLightPos, viewFragPos);
-	// attenuation
-    const float att = Attenuate(attConst, attLin, attQuad, lv.distToL);
-	// diffuse
-    const float3 diffuse = Diffuse(diffuseColor, diffuseIntensity, att, lv.dirToL, viewNormal);
-    // specular
-    const float3 specular = Speculate(
-        diffuseColor * diffuseIntensity * specularColor, specularWeight, viewNormal,
-        lv.vToL, viewFragPos, att, specularGloss
-    );
-	// final color
-    return float4(saturate((diffuse + ambient) * tex.Sample(splr, tc).rgb + specular), 1.0f);
-}
\ No newline at end of file
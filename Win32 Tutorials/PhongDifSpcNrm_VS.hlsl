@@ -1 +0,0 @@
-#include "PhongDifNrm_VS.hlsl"
\ No newline at end of file
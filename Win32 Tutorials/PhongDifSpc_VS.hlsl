@@ -1 +0,0 @@
-#include "PhongDif_VS.hlsl"
\ No newline at end of file
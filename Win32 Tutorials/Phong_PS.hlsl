@@ -3,30 +3,122 @@
 
 #include "PointLight.hlsl"
 
+// compiled per material by ShaderCache with DIFFUSE_MAP, MASK, SPECULAR_MAP and NORMAL_MAP
+// defined for the maps it has. Fields stay in the order Material lays out its cbuffer
+#if defined(DIFFUSE_MAP) || defined(SPECULAR_MAP) || defined(NORMAL_MAP)
+#define TEXCOORD
+#endif
+
 cbuffer ObjectCBuf
 {
+#ifndef DIFFUSE_MAP
     float3 materialColor;
+#endif
+#ifdef SPECULAR_MAP
+    bool useGlossAlpha;
+    bool useSpecularMap;
+#endif
     float3 specularColor;
     float specularWeight;
     float specularGloss;
+#ifdef NORMAL_MAP
+    bool useNormalMap;
+    float normalMapWeight;
+#endif
+#ifdef TEXCOORD
+    float4 texTransform;
+    float texLayer;
+#endif
 };
 
+Texture2DArray tex : register(t0);
+Texture2DArray spec : register(t1);
+Texture2DArray nmap : register(t2);
+
+SamplerState splr;
+
+struct PSIn
+{
+    float3 viewFragPos : Position;
+    float3 viewNormal : Normal;
+#ifdef NORMAL_MAP
+    float3 viewTan : Tangent;
+    float3 viewBitan : Bitangent;
+#endif
+#ifdef TEXCOORD
+    float2 tc : Texcoord;
+#endif
+    float4 screenPos : SV_Position;
+};
+
+
+float4 main(PSIn i) : SV_Target
+{
+    float3 viewNormal = i.viewNormal;
+#ifdef TEXCOORD
+    // packed texture coordinate shared by every map of this material
+    const float3 ptc = PackedTexcoord(i.tc, texTransform, texLayer);
+#endif
+#ifdef DIFFUSE_MAP
+    const float4 dtex = tex.Sample(splr, ptc);
+    const float3 albedo = dtex.rgb;
+#else
+    const float3 albedo = materialColor;
+#endif
+
+#ifdef MASK
+    // bail if highly translucent
+    clip(dtex.a < 0.1f ? -1 : 1);
+    // flip normal when backface
+    if (dot(viewNormal, i.viewFragPos) >= 0.0f)
+    {
+        viewNormal = -viewNormal;
+    }
+#endif
 
-float4 main(float3 viewFragPos : Position, float3 viewNormal : Normal) : SV_Target
-{    
     // normalize the mesh normal
     viewNormal = normalize(viewNormal);
-	// fragment to light vector data
-    const LightVectorData lv = CalculateLightVectorData(viewLightPos, viewFragPos);
-	// attenuation
-    const float att = Attenuate(attConst, attLin, attQuad, lv.distToL);
-	// diffuse
-    const float3 diffuse = Diffuse(diffuseColor, diffuseIntensity, att, lv.dirToL, viewNormal);
-    // specular
-    const float3 specular = Speculate(
-        diffuseColor * diffuseIntensity * specularColor, specularWeight, viewNormal,
-        lv.vToL, viewFragPos, att, specularGloss
-    );
-	// final color
-    return float4(saturate((diffuse + ambient) * materialColor + specular), 1.0f);
+#ifdef NORMAL_MAP
+    // replace normal with mapped if normal mapping enabled
+    if (useNormalMap)
+    {
+        const float3 mappedNormal = MapNormal(normalize(i.viewTan), normalize(i.viewBitan), viewNormal, ptc, nmap, splr);
+        viewNormal = lerp(viewNormal, mappedNormal, normalMapWeight);
+    }
+#endif
+    // specular parameter determination (mapped or uniform)
+    float3 specularReflectionColor = specularColor;
+    float specularPower = specularGloss;
+#ifdef SPECULAR_MAP
+    const float4 specularSample = spec.Sample(splr, ptc);
+    if (useSpecularMap)
+    {
+        specularReflectionColor = specularSample.rgb;
+    }
+    if (useGlossAlpha)
+    {
+        specularPower = pow(2.0f, specularSample.a * 13.0f);
+    }
+#endif
+    // sum the lights reaching this pixel's tile
+    float3 diffuse = 0.0f;
+    float3 specularReflected = 0.0f;
+    const uint2 range = TileLightRange(i.screenPos);
+    for (uint l = 0; l < range.y; l++)
+    {
+        const PointLight light = TileLight(range, l);
+        // fragment to light vector data
+        const LightVectorData lv = CalculateLightVectorData(light.viewLightPos, i.viewFragPos);
+        // attenuation
+        const float att = Attenuate(light.attConst, light.attLin, light.attQuad, lv.distToL);
+        // diffuse light
+        diffuse += Diffuse(light.diffuseColor, light.diffuseIntensity, att, lv.dirToL, viewNormal);
+        // specular reflected
+        specularReflected += Speculate(
+            light.diffuseColor * light.diffuseIntensity * specularReflectionColor, specularWeight, viewNormal,
+            lv.vToL, i.viewFragPos, att, specularPower
+        );
+    }
+	// final color = attenuate diffuse & ambient by diffuse color and add specular reflected
+    return float4(saturate((diffuse + ambient) * albedo + specularReflected), 1.0f);
 }
\ No newline at end of file
@@ -1,17 +1,49 @@
 #include "Transform.hlsl"
 
+// permutations of Phong_PS need no more than texture coordinates (DIFFUSE_MAP stands for any
+// map here) and a tangent frame (NORMAL_MAP) from the vertex shader
+struct VSIn
+{
+    float3 pos : Position;
+    float3 n : Normal;
+#ifdef DIFFUSE_MAP
+    float2 tc : Texcoord;
+#endif
+#ifdef NORMAL_MAP
+    float3 tan : Tangent;
+    float3 bitan : Bitangent;
+#endif
+};
+
+// same order as Phong_PS reads them
 struct VSOut
 {
     float3 viewPos : Position;
     float3 viewNormal : Normal;
+#ifdef NORMAL_MAP
+    float3 tan : Tangent;
+    float3 bitan : Bitangent;
+#endif
+#ifdef DIFFUSE_MAP
+    float2 tc : Texcoord;
+#endif
     float4 pos : SV_Position;
 };
 
-VSOut main(float3 pos : Position, float3 n : Normal)
+VSOut main(VSIn v)
 {
     VSOut vso;
-    vso.viewPos = (float3) mul(float4(pos, 1.0f), modelView);
-    vso.viewNormal = mul(n, (float3x3) modelView);
-    vso.pos = mul(float4(pos, 1.0f), modelViewProj);
+    vso.viewPos = (float3) mul(float4(v.pos, 1.0f), modelView);
+    vso.viewNormal = mul(v.n, (float3x3) modelView);
+#ifdef NORMAL_MAP
+    vso.tan = mul(v.tan, (float3x3) modelView);
+    vso.bitan = mul(v.bitan, (float3x3) modelView);
+#endif
+#ifdef DIFFUSE_MAP
+    vso.tc = v.tc;
+#endif
+    // bit for bit the depth Solid_VS lays down in the pre-pass
+    precise float4 clip = ToClip(v.pos, modelViewProj);
+    vso.pos = clip;
     return vso;
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include "PixelShader.h"
 #include "GraphicsThrowMacros.h"
 #include "BindableCodex.h"
-#include "RedSkyUtility.h"
+#include "ShaderCache.h"
+#include "ShaderPack.h"
+#include "Vfs.h"
 
 namespace Bind
 {
@@ -11,9 +13,33 @@ namespace Bind
 	{
 		INFOMAN(gfx);
 
-		Microsoft::WRL::ComPtr<ID3DBlob> pBlob;
-		GFX_THROW_INFO(D3DReadFileToBlob(ToWide(path).c_str(), &pBlob));
-		GFX_THROW_INFO(GetDevice(gfx)->CreatePixelShader(pBlob->GetBufferPointer(), pBlob->GetBufferSize(), nullptr, &pPixelShader));
+		if (const auto pPack = ShaderPack::Get())
+		{
+			if (const auto code = pPack->Find(path); code.pData)
+			{
+				GFX_THROW_INFO(GetDevice(gfx)->CreatePixelShader(code.pData, code.size, nullptr, &pPixelShader));
+				gfx.CountResourceCreated();
+				return;
+			}
+		}
+		const auto file = Vfs::Get().Read(path);
+		if (!file.IsOpen())
+		{
+			GFX_THROW_INFO(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+		}
+		GFX_THROW_INFO(GetDevice(gfx)->CreatePixelShader(file.GetData(), file.GetSize(), nullptr, &pPixelShader));
+		gfx.CountResourceCreated();
+	}
+
+	PixelShader::PixelShader(Graphics& gfx, const std::string& family, uint32_t features)
+		:
+		path(ShaderPermutation::GetName(ShaderPermutation::Canonical({ family,ShaderPermutation::Stage::Pixel,features })))
+	{
+		INFOMAN(gfx);
+
+		const auto pCode = ShaderCache::Get().Load({ family,ShaderPermutation::Stage::Pixel,features });
+		GFX_THROW_INFO(GetDevice(gfx)->CreatePixelShader(pCode->data(), pCode->size(), nullptr, &pPixelShader));
+		gfx.CountResourceCreated();
 	}
 
 	void PixelShader::Bind(Graphics& gfx) noexcept
@@ -24,11 +50,19 @@ namespace Bind
 	{
 		return Codex::Resolve<PixelShader>(gfx, path);
 	}
+	std::shared_ptr<PixelShader> PixelShader::Resolve(Graphics& gfx, const std::string& family, uint32_t features)
+	{
+		return Codex::Resolve<PixelShader>(gfx, family, features);
+	}
 	std::string PixelShader::GenerateUID(const std::string& path)
 	{
 		using namespace std::string_literals;
 		return typeid(PixelShader).name() + "#"s + path;
 	}
+	std::string PixelShader::GenerateUID(const std::string& family, uint32_t features)
+	{
+		return GenerateUID(ShaderPermutation::GetName(ShaderPermutation::Canonical({ family,ShaderPermutation::Stage::Pixel,features })));
+	}
 	std::string PixelShader::GetUID() const noexcept
 	{
 		return GenerateUID(path);
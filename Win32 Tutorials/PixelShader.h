@@ -1,15 +1,21 @@
 #pragma once
 #include "Bindable.h"
+#include <cstdint>
 
 namespace Bind
 {
 	class PixelShader : public Bindable
 	{
 	public:
+		// from the shader pack when it has path, otherwise read through the Vfs
 		PixelShader(Graphics& gfx, const std::string& path);
+		// a permutation of a shader family from ShaderCache, features are ShaderPermutation::Feature bits
+		PixelShader(Graphics& gfx, const std::string& family, uint32_t features);
 		void Bind(Graphics& gfx) noexcept override;
 		static std::shared_ptr<PixelShader> Resolve(Graphics& gfx, const std::string& path);
+		static std::shared_ptr<PixelShader> Resolve(Graphics& gfx, const std::string& family, uint32_t features);
 		static std::string GenerateUID(const std::string& path);
+		static std::string GenerateUID(const std::string& family, uint32_t features);
 		std::string GetUID() const noexcept override;
 	protected:
 		std::string path;
@@ -1,5 +1,4 @@
 #pragma once
-#pragma once
 
 #include <optional>
 #include "Vertex.h"
@@ -7,21 +6,28 @@
 #include <DirectXMath.h>
 #include "RedSkyMath.h"
 #include <array>
+#include <limits>
+#include "ParallelFor.h"
 
 class Plane
 {
 public:
-	static IndexedTriangleList MakeTesselatedTextured( rsexp::VertexLayout layout,int divisions_x,int divisions_y )
+	// a 2x2 grid facing -z, positions, normals and texture coordinates are written for the
+	// ones the layout has. Pick 32 bit indices past 65536 vertices
+	template<typename Index = unsigned short>
+	static BasicIndexedTriangleList<Index> MakeTesselatedTextured( rsexp::VertexLayout layout,int divisions_x,int divisions_y )
 	{
-		namespace dx = DirectX;
+		using Type = rsexp::VertexLayout::ElementType;
 		assert( divisions_x >= 1 );
 		assert( divisions_y >= 1 );
 
 		constexpr float width = 2.0f;
 		constexpr float height = 2.0f;
-		const int nVertices_x = divisions_x + 1;
-		const int nVertices_y = divisions_y + 1;
-		rsexp::VertexBuffer vb{ std::move( layout ) };
+		const size_t nVertices_x = size_t( divisions_x ) + 1u;
+		const size_t nVertices_y = size_t( divisions_y ) + 1u;
+		assert( nVertices_x * nVertices_y - 1u <= std::numeric_limits<Index>::max() && "Too many vertices for the index type" );
+		const size_t grain = RowGrain( nVertices_x );
+		rsexp::VertexBuffer vb{ std::move( layout ),nVertices_x * nVertices_y };
 
 		{
 			const float side_x = width / 2.0f;
@@ -31,44 +37,52 @@ public:
 			const float divisionSize_x_tc = 1.0f / float( divisions_x );
 			const float divisionSize_y_tc = 1.0f / float( divisions_y );
 
-			for( int y = 0,i = 0; y < nVertices_y; y++ )
+			const rsexp::ElementView<Type::Position3D> positions{ vb };
+			const rsexp::ElementView<Type::Normal> normals{ vb };
+			const rsexp::ElementView<Type::Texture2D> texcoords{ vb };
+			ParallelFor( nVertices_y,grain,[&]( size_t y )
 			{
 				const float y_pos = float( y ) * divisionSize_y - side_y;
 				const float y_pos_tc = 1.0f - float( y ) * divisionSize_y_tc;
-				for( int x = 0; x < nVertices_x; x++,i++ )
+				for( size_t x = 0,i = y * nVertices_x; x < nVertices_x; x++,i++ )
 				{
-					const float x_pos = float( x ) * divisionSize_x - side_x;
-					const float x_pos_tc = float( x ) * divisionSize_x_tc;
-					vb.EmplaceBack(
-						dx::XMFLOAT3{ x_pos,y_pos,0.0f },
-						dx::XMFLOAT3{ 0.0f,0.0f,-1.0f },
-						dx::XMFLOAT2{ x_pos_tc,y_pos_tc }
-					);
+					if( positions.IsValid() )
+					{
+						positions[i] = { float( x ) * divisionSize_x - side_x,y_pos,0.0f };
+					}
+					if( normals.IsValid() )
+					{
+						normals[i] = { 0.0f,0.0f,-1.0f };
+					}
+					if( texcoords.IsValid() )
+					{
+						texcoords[i] = { float( x ) * divisionSize_x_tc,y_pos_tc };
+					}
 				}
-			}
+			} );
 		}
 
-		std::vector<unsigned short> indices;
-		indices.reserve( sq( divisions_x * divisions_y ) * 6 );
+		std::vector<Index> indices( size_t( divisions_x ) * size_t( divisions_y ) * 6u );
 		{
 			const auto vxy2i = [nVertices_x]( size_t x,size_t y )
 			{
-				return (unsigned short)(y * nVertices_x + x);
+				return Index( y * nVertices_x + x );
 			};
-			for( size_t y = 0; y < divisions_y; y++ )
+			ParallelFor( size_t( divisions_y ),grain,[&]( size_t y )
 			{
-				for( size_t x = 0; x < divisions_x; x++ )
+				auto pOut = indices.data() + y * size_t( divisions_x ) * 6u;
+				for( size_t x = 0; x < size_t( divisions_x ); x++ )
 				{
-					const std::array<unsigned short,4> indexArray =
+					const std::array<Index,4> indexArray =
 					{ vxy2i( x,y ),vxy2i( x + 1,y ),vxy2i( x,y + 1 ),vxy2i( x + 1,y + 1 ) };
-					indices.push_back( indexArray[0] );
-					indices.push_back( indexArray[2] );
-					indices.push_back( indexArray[1] );
-					indices.push_back( indexArray[1] );
-					indices.push_back( indexArray[2] );
-					indices.push_back( indexArray[3] );
+					*pOut++ = indexArray[0];
+					*pOut++ = indexArray[2];
+					*pOut++ = indexArray[1];
+					*pOut++ = indexArray[1];
+					*pOut++ = indexArray[2];
+					*pOut++ = indexArray[3];
 				}
-			}
+			} );
 		}
 
 		return{ std::move( vb ),std::move( indices ) };
@@ -4,8 +4,7 @@
 
 PointLight::PointLight(Graphics& gfx, float radius)
 	:
-	mesh(gfx, radius),
-	cbuf(gfx)
+	mesh(gfx, radius)
 {
 	Reset();
 }
@@ -15,19 +14,19 @@ void PointLight::SpawnControlWindow() noexcept
 	if (ImGui::Begin("Light"))
 	{
 		ImGui::Text("Position");
-		ImGui::SliderFloat("X", &cbData.pos.x, -60.0f, 60.0f, "%.1f");
-		ImGui::SliderFloat("Y", &cbData.pos.y, -60.0f, 60.0f, "%.1f");
-		ImGui::SliderFloat("Z", &cbData.pos.z, -60.0f, 60.0f, "%.1f");
+		ImGui::SliderFloat("X", &data.pos.x, -60.0f, 60.0f, "%.1f");
+		ImGui::SliderFloat("Y", &data.pos.y, -60.0f, 60.0f, "%.1f");
+		ImGui::SliderFloat("Z", &data.pos.z, -60.0f, 60.0f, "%.1f");
 
 		ImGui::Text("Intensity/Color");
-		ImGui::SliderFloat("Intensity", &cbData.diffuseIntensity, 0.01f, 2.0f, "%.2f", 2);
-		ImGui::ColorEdit3("Diffuse Color", &cbData.diffuseColor.x);
-		ImGui::ColorEdit3("Ambient", &cbData.ambient.x);
+		ImGui::SliderFloat("Intensity", &data.diffuseIntensity, 0.01f, 2.0f, "%.2f", 2);
+		ImGui::ColorEdit3("Diffuse Color", &data.diffuseColor.x);
+		ImGui::ColorEdit3("Ambient", &ambient.x);
 
 		ImGui::Text("Falloff");
-		ImGui::SliderFloat("Constant", &cbData.attConst, 0.05f, 10.0f, "%.2f", 4);
-		ImGui::SliderFloat("Linear", &cbData.attLin, 0.0001f, 4.0f, "%.4f", 8);
-		ImGui::SliderFloat("Quadratic", &cbData.attQuad, 0.0000001f, 10.0f, "%.7f", 10);
+		ImGui::SliderFloat("Constant", &data.attConst, 0.05f, 10.0f, "%.2f", 4);
+		ImGui::SliderFloat("Linear", &data.attLin, 0.0001f, 4.0f, "%.4f", 8);
+		ImGui::SliderFloat("Quadratic", &data.attQuad, 0.0000001f, 10.0f, "%.7f", 10);
 
 		if (ImGui::Button("Reset"))
 		{
@@ -39,9 +38,9 @@ void PointLight::SpawnControlWindow() noexcept
 
 void PointLight::Reset() noexcept
 {
-	cbData = {
+	ambient = { 0.15f,0.15f,0.15f };
+	data = {
 		{-14.5f,32.5f,0.0f},		//Position ,	
-		{0.15f,0.15f,0.15f},	//Ambient
 		{1.0f,1.0f,1.0f},		//Diffuse 
 		2.0f,					//Diffuse Intensity
 		1.0f,					//Attenuation Constant
@@ -52,15 +51,8 @@ void PointLight::Reset() noexcept
 
 void PointLight::Submit(FrameCommander& frame) const noxnd
 {
-	mesh.SetPos(cbData.pos);
+	frame.GetLights().Add(data);
+	frame.GetLights().SetAmbient(ambient);
+	mesh.SetPos(data.pos);
 	mesh.Submit(frame);
 }
-
-void PointLight::Bind(Graphics& gfx, DirectX::FXMMATRIX view) const noexcept
-{
-	auto dataCopy = cbData;
-	const auto pos = DirectX::XMLoadFloat3(&cbData.pos);
-	DirectX::XMStoreFloat3(&dataCopy.pos, DirectX::XMVector3Transform(pos, view));
-	cbuf.Update(gfx, dataCopy);
-	cbuf.Bind(gfx);
-}
@@ -1,7 +1,7 @@
 #pragma once
 #include "Graphics.h"
 #include "SolidSphere.h"
-#include "ConstantBuffers.h"
+#include "LightList.h"
 #include "ConditionalNoexcept.h"
 
 class PointLight
@@ -10,21 +10,10 @@ public:
 	PointLight( Graphics& gfx,float radius = 0.5f );
 	void SpawnControlWindow() noexcept;
 	void Reset() noexcept;
+	// adds the light to the frame's light list along with its sphere
 	void Submit( class FrameCommander& frame ) const noxnd;
-	void Bind( Graphics& gfx,DirectX::FXMMATRIX view ) const noexcept;
 private:
-	struct PointLightCBuf
-	{
-		alignas(16) DirectX::XMFLOAT3 pos;
-		alignas(16) DirectX::XMFLOAT3 ambient;
-		alignas(16) DirectX::XMFLOAT3 diffuseColor;
-		float diffuseIntensity;
-		float attConst;
-		float attLin;
-		float attQuad;
-	};
-private:
-	PointLightCBuf cbData;
+	LightList::PointLight data;
+	DirectX::XMFLOAT3 ambient;
 	mutable SolidSphere mesh;
-	mutable Bind::PixelConstantBuffer<PointLightCBuf> cbuf;
 };
\ No newline at end of file
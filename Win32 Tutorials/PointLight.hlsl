@@ -1,10 +1,37 @@
-cbuffer PointLightCBuf
+// forward+ light list (LightList.h), lights are in view space and each 16 pixel screen
+// tile has a range into the index list of the lights reaching it
+struct PointLight
 {
     float3 viewLightPos;
-    float3 ambient;
+    float radius;
     float3 diffuseColor;
     float diffuseIntensity;
     float attConst;
     float attLin;
     float attQuad;
-};
\ No newline at end of file
+    float padding;
+};
+
+cbuffer LightGridCBuf : register(b0)
+{
+    float3 ambient;
+    uint tileSize;
+    uint tilesX;
+    uint lightCount;
+};
+
+StructuredBuffer<PointLight> lights : register(t8);
+StructuredBuffer<uint2> tileRanges : register(t9);
+StructuredBuffer<uint> tileLightIndices : register(t10);
+
+// offset and count of the lights in the tile under the pixel
+uint2 TileLightRange(const in float4 screenPos)
+{
+    const uint2 tile = uint2(screenPos.xy) / tileSize;
+    return tileRanges[tile.y * tilesX + tile.x];
+}
+
+PointLight TileLight(const in uint2 range, const in uint i)
+{
+    return lights[tileLightIndices[range.x + i]];
+}
\ No newline at end of file
@@ -14,6 +14,7 @@ namespace Bind
 		rasterDesc.CullMode = twoSided ? D3D11_CULL_NONE : D3D11_CULL_BACK;
 
 		GFX_THROW_INFO(GetDevice(gfx)->CreateRasterizerState(&rasterDesc, &pRasterizer));
+		gfx.CountResourceCreated();
 	}
 
 	void Rasterizer::Bind(Graphics& gfx) noexcept
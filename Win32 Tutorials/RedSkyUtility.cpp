@@ -1,6 +1,7 @@
 #include "RedSkyUtility.h"
 #include <sstream>
 #include <iomanip>
+#include <cstdlib>
 
 std::vector<std::string> TokenizeQuoted(const std::string& input)
 {
@@ -18,14 +19,19 @@ std::vector<std::string> TokenizeQuoted(const std::string& input)
 
 std::wstring ToWide(const std::string& narrow)
 {
-	wchar_t wide[512];
-	mbstowcs_s(nullptr, wide, narrow.c_str(), _TRUNCATE);
+	// a multibyte character never widens to more than one wchar_t, so size + 1 always fits
+	std::wstring wide(narrow.size() + 1u, L'\0');
+	size_t converted = 0u;
+	mbstowcs_s(&converted, wide.data(), wide.size(), narrow.c_str(), _TRUNCATE);
+	wide.resize(converted > 0u ? converted - 1u : 0u);
 	return wide;
 }
 
 std::string ToNarrow(const std::wstring& wide)
 {
-	char narrow[512];
-	wcstombs_s(nullptr, narrow, wide.c_str(), _TRUNCATE);
+	std::string narrow(wide.size() * MB_CUR_MAX + 1u, '\0');
+	size_t converted = 0u;
+	wcstombs_s(&converted, narrow.data(), narrow.size(), wide.c_str(), _TRUNCATE);
+	narrow.resize(converted > 0u ? converted - 1u : 0u);
 	return narrow;
 }
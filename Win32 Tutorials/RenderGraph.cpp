@@ -0,0 +1,402 @@
+#include "RenderGraph.h"
+#include "RenderTarget.h"
+#include "DepthStencil.h"
+#include "PerformanceLog.h"
+#include "imgui/imgui.h"
+#include <algorithm>
+#include <cassert>
+
+bool RenderGraph::TextureDesc::operator==(const TextureDesc& rhs) const noexcept
+{
+	return type == rhs.type && width == rhs.width && height == rhs.height;
+}
+
+size_t RenderGraph::TextureDesc::GetBytes() const noexcept
+{
+	// B8G8R8A8 color and D24S8 depth are both 4 bytes a texel
+	return size_t(width) * height * 4u;
+}
+
+RenderGraph::Resources::Resources(const RenderGraph& graph) noexcept
+	:
+	graph(graph)
+{}
+
+const RenderTarget& RenderGraph::Resources::GetTarget(ResourceId id) const noexcept
+{
+	const auto index = graph.resources[id].physical;
+	assert(index != npos && graph.physical[index].pTarget);
+	return *graph.physical[index].pTarget;
+}
+
+const DepthStencil& RenderGraph::Resources::GetDepth(ResourceId id) const noexcept
+{
+	const auto index = graph.resources[id].physical;
+	assert(index != npos && graph.physical[index].pDepth);
+	return *graph.physical[index].pDepth;
+}
+
+RenderGraph::PassBuilder::PassBuilder(RenderGraph& graph, PassId pass) noexcept
+	:
+	graph(graph),
+	pass(pass)
+{}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(ResourceId id)
+{
+	assert(id < graph.resources.size());
+	graph.passes[pass].reads.push_back(id);
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(ResourceId id)
+{
+	assert(id < graph.resources.size());
+	graph.passes[pass].writes.push_back(id);
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Execute(ExecuteFunction execute)
+{
+	graph.passes[pass].execute = std::move(execute);
+	return *this;
+}
+
+RenderGraph::RenderGraph() = default;
+
+RenderGraph::~RenderGraph() = default;
+
+void RenderGraph::Clear() noexcept
+{
+	resources.clear();
+	passes.clear();
+	order.clear();
+	groups.clear();
+	physicalDescs.clear();
+	compiled = false;
+}
+
+RenderGraph::ResourceId RenderGraph::CreateTexture(std::string name, const TextureDesc& desc)
+{
+	resources.push_back({ std::move(name),desc,false });
+	compiled = false;
+	return resources.size() - 1u;
+}
+
+RenderGraph::ResourceId RenderGraph::Import(std::string name)
+{
+	resources.push_back({ std::move(name),{ TextureDesc::Type::Color,0u,0u },true });
+	compiled = false;
+	return resources.size() - 1u;
+}
+
+RenderGraph::PassBuilder RenderGraph::AddPass(std::string name)
+{
+	passes.push_back({ std::move(name) });
+	compiled = false;
+	return { *this,passes.size() - 1u };
+}
+
+void RenderGraph::Compile()
+{
+	PROFILE_ZONE("RenderGraph::Compile");
+	// a read depends on the resource's last writer, a write on its last writer too (the
+	// target keeps what was drawn) and on every pass that read it since, so it can't run
+	// over a texture still being sampled. Only the first two carry data that keeps passes alive
+	std::vector<std::vector<PassId>> producers(passes.size());
+	std::vector<std::vector<PassId>> dependencies(passes.size());
+	std::vector<PassId> lastWriter(resources.size(), npos);
+	std::vector<std::vector<PassId>> readers(resources.size());
+	for (PassId p = 0; p < passes.size(); p++)
+	{
+		for (const auto r : passes[p].reads)
+		{
+			if (lastWriter[r] != npos)
+			{
+				producers[p].push_back(lastWriter[r]);
+			}
+			readers[r].push_back(p);
+		}
+		for (const auto w : passes[p].writes)
+		{
+			if (lastWriter[w] != npos && lastWriter[w] != p)
+			{
+				producers[p].push_back(lastWriter[w]);
+			}
+			for (const auto reader : readers[w])
+			{
+				if (reader != p)
+				{
+					dependencies[p].push_back(reader);
+				}
+			}
+			readers[w].clear();
+			lastWriter[w] = p;
+		}
+		dependencies[p].insert(dependencies[p].end(), producers[p].begin(), producers[p].end());
+	}
+
+	// passes writing an imported resource are kept, then everything they draw on
+	std::vector<PassId> live;
+	for (PassId p = 0; p < passes.size(); p++)
+	{
+		auto& pass = passes[p];
+		pass.culled = std::none_of(pass.writes.begin(), pass.writes.end(), [this](ResourceId w)
+		{
+			return resources[w].imported;
+		});
+		if (!pass.culled)
+		{
+			live.push_back(p);
+		}
+	}
+	while (!live.empty())
+	{
+		const auto p = live.back();
+		live.pop_back();
+		for (const auto q : producers[p])
+		{
+			if (passes[q].culled)
+			{
+				passes[q].culled = false;
+				live.push_back(q);
+			}
+		}
+	}
+
+	// dependencies always point at passes added earlier, so one sweep finds every pass's
+	// longest chain. Passes with equal chains can't depend on each other
+	groups.clear();
+	for (PassId p = 0; p < passes.size(); p++)
+	{
+		auto& pass = passes[p];
+		if (pass.culled)
+		{
+			continue;
+		}
+		pass.group = 0u;
+		for (const auto q : dependencies[p])
+		{
+			if (!passes[q].culled)
+			{
+				pass.group = std::max(pass.group, passes[q].group + 1u);
+			}
+		}
+		if (groups.size() <= pass.group)
+		{
+			groups.resize(pass.group + 1u);
+		}
+		groups[pass.group].push_back(p);
+	}
+	order.clear();
+	for (const auto& g : groups)
+	{
+		order.insert(order.end(), g.begin(), g.end());
+	}
+
+	// transient resources live from the first to the last group using them. Measuring in
+	// groups rather than passes keeps aliasing safe when a group is recorded in parallel
+	constexpr auto unused = npos;
+	std::vector<size_t> first(resources.size(), unused);
+	std::vector<size_t> last(resources.size(), 0u);
+	for (const auto p : order)
+	{
+		const auto& pass = passes[p];
+		const auto use = [&](ResourceId id)
+		{
+			first[id] = std::min(first[id], pass.group);
+			last[id] = std::max(last[id], pass.group);
+		};
+		std::for_each(pass.reads.begin(), pass.reads.end(), use);
+		std::for_each(pass.writes.begin(), pass.writes.end(), use);
+	}
+	std::vector<ResourceId> transients;
+	for (ResourceId id = 0; id < resources.size(); id++)
+	{
+		resources[id].physical = npos;
+		if (!resources[id].imported && first[id] != unused)
+		{
+			transients.push_back(id);
+		}
+	}
+	std::stable_sort(transients.begin(), transients.end(), [&first](ResourceId a, ResourceId b)
+	{
+		return first[a] < first[b];
+	});
+	// a physical texture is free for a resource of the same desc once its last user is done
+	physicalDescs.clear();
+	std::vector<size_t> busyUntil;
+	for (const auto id : transients)
+	{
+		auto& res = resources[id];
+		for (size_t i = 0; i < physicalDescs.size(); i++)
+		{
+			if (physicalDescs[i] == res.desc && busyUntil[i] < first[id])
+			{
+				res.physical = i;
+				break;
+			}
+		}
+		if (res.physical == npos)
+		{
+			res.physical = physicalDescs.size();
+			physicalDescs.push_back(res.desc);
+			busyUntil.push_back(0u);
+		}
+		busyUntil[res.physical] = last[id];
+	}
+	compiled = true;
+}
+
+void RenderGraph::Realize(Graphics& gfx)
+{
+	assert(compiled);
+	auto old = std::move(physical);
+	physical.clear();
+	for (const auto& desc : physicalDescs)
+	{
+		const auto i = std::find_if(old.begin(), old.end(), [&desc](const Physical& p)
+		{
+			return p.desc == desc && (p.pTarget || p.pDepth);
+		});
+		if (i != old.end())
+		{
+			physical.push_back(std::move(*i));
+			old.erase(i);
+			continue;
+		}
+		Physical p{ desc };
+		if (desc.type == TextureDesc::Type::Color)
+		{
+			p.pTarget = std::make_unique<RenderTarget>(gfx, desc.width, desc.height);
+		}
+		else
+		{
+			p.pDepth = std::make_unique<DepthStencil>(gfx, desc.width, desc.height);
+		}
+		physical.push_back(std::move(p));
+	}
+}
+
+void RenderGraph::Execute(Graphics& gfx) const
+{
+	assert(compiled && physical.size() == physicalDescs.size());
+	const Resources res{ *this };
+	for (const auto p : order)
+	{
+		if (passes[p].execute)
+		{
+			passes[p].execute(gfx, res);
+			gfx.DrainDebugMessages(passes[p].name.c_str());
+		}
+	}
+}
+
+const std::vector<RenderGraph::PassId>& RenderGraph::GetOrder() const noexcept
+{
+	return order;
+}
+
+const std::vector<std::vector<RenderGraph::PassId>>& RenderGraph::GetParallelGroups() const noexcept
+{
+	return groups;
+}
+
+bool RenderGraph::IsCulled(PassId pass) const noexcept
+{
+	return passes[pass].culled;
+}
+
+size_t RenderGraph::GetPhysicalIndex(ResourceId id) const noexcept
+{
+	return resources[id].physical;
+}
+
+const std::vector<RenderGraph::TextureDesc>& RenderGraph::GetPhysicalDescs() const noexcept
+{
+	return physicalDescs;
+}
+
+size_t RenderGraph::GetTransientBytes() const noexcept
+{
+	size_t bytes = 0u;
+	for (const auto& r : resources)
+	{
+		if (r.physical != npos)
+		{
+			bytes += r.desc.GetBytes();
+		}
+	}
+	return bytes;
+}
+
+size_t RenderGraph::GetPhysicalBytes() const noexcept
+{
+	size_t bytes = 0u;
+	for (const auto& d : physicalDescs)
+	{
+		bytes += d.GetBytes();
+	}
+	return bytes;
+}
+
+size_t RenderGraph::GetPassCount() const noexcept
+{
+	return passes.size();
+}
+
+const std::string& RenderGraph::GetPassName(PassId pass) const noexcept
+{
+	return passes[pass].name;
+}
+
+size_t RenderGraph::GetResourceCount() const noexcept
+{
+	return resources.size();
+}
+
+const std::string& RenderGraph::GetResourceName(ResourceId id) const noexcept
+{
+	return resources[id].name;
+}
+
+void RenderGraph::SpawnWindow() const
+{
+	if (ImGui::Begin("Render Graph"))
+	{
+		for (size_t g = 0; g < groups.size(); g++)
+		{
+			ImGui::Text("Group %zu", g);
+			for (const auto p : groups[g])
+			{
+				ImGui::BulletText("%s", passes[p].name.c_str());
+			}
+		}
+		for (const auto& pass : passes)
+		{
+			if (pass.culled)
+			{
+				ImGui::Text("Culled: %s", pass.name.c_str());
+			}
+		}
+		ImGui::Separator();
+		for (const auto& r : resources)
+		{
+			if (r.imported)
+			{
+				ImGui::Text("%s: imported", r.name.c_str());
+			}
+			else if (r.physical == npos)
+			{
+				ImGui::Text("%s: unused", r.name.c_str());
+			}
+			else
+			{
+				ImGui::Text("%s: texture %zu (%ux%u)", r.name.c_str(), r.physical, r.desc.width, r.desc.height);
+			}
+		}
+		ImGui::Text("Transient memory: %.2fMB aliased into %.2fMB",
+			float(GetTransientBytes()) / (1024.0f * 1024.0f), float(GetPhysicalBytes()) / (1024.0f * 1024.0f));
+	}
+	ImGui::End();
+}
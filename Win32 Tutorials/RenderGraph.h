@@ -0,0 +1,130 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Graphics;
+class RenderTarget;
+class DepthStencil;
+
+// The passes of a frame, each declaring the textures it samples and the targets it draws
+// into. Compile orders the passes by those declarations, culls the ones nothing reaching an
+// imported resource (the swap buffer) depends on, and lets transient targets that are never
+// alive at the same time share one texture. Compiling creates no gpu objects, so the result
+// can be checked headless; Realize then makes the shared textures and Execute runs the live
+// passes. Passes in the same parallel group don't depend on each other.
+class RenderGraph
+{
+public:
+	using ResourceId = size_t;
+	using PassId = size_t;
+	struct TextureDesc
+	{
+		enum class Type
+		{
+			Color,
+			Depth,
+		};
+		Type type;
+		unsigned int width;
+		unsigned int height;
+		bool operator==(const TextureDesc& rhs) const noexcept;
+		size_t GetBytes() const noexcept;
+	};
+	// gives passes the textures their resources were realized as
+	class Resources
+	{
+		friend class RenderGraph;
+	public:
+		const RenderTarget& GetTarget(ResourceId id) const noexcept;
+		const DepthStencil& GetDepth(ResourceId id) const noexcept;
+	private:
+		Resources(const RenderGraph& graph) noexcept;
+	private:
+		const RenderGraph& graph;
+	};
+	using ExecuteFunction = std::function<void(Graphics&, const Resources&)>;
+	class PassBuilder
+	{
+		friend class RenderGraph;
+	public:
+		// sampled as a texture
+		PassBuilder& Read(ResourceId id);
+		// bound as a render target or depth buffer, drawing over what earlier writers left
+		PassBuilder& Write(ResourceId id);
+		PassBuilder& Execute(ExecuteFunction execute);
+	private:
+		PassBuilder(RenderGraph& graph, PassId pass) noexcept;
+	private:
+		RenderGraph& graph;
+		PassId pass;
+	};
+	static constexpr size_t npos = ~size_t(0);
+public:
+	RenderGraph();
+	~RenderGraph();
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+	// forgets every pass and resource, realized textures are kept for the next Realize
+	void Clear() noexcept;
+	// created by the graph, contents don't survive the frame. The first pass writing it
+	// must fully overwrite or clear it, another resource may have used the texture before
+	ResourceId CreateTexture(std::string name, const TextureDesc& desc);
+	// owned outside the graph, passes writing it are what the frame is for
+	ResourceId Import(std::string name);
+	// passes are ordered by their reads and writes, and otherwise keep the order they were
+	// added in. A read sees the writes of passes added before the reader
+	PassBuilder AddPass(std::string name);
+	void Compile();
+	// makes a texture for every physical slot, reusing ones from the last Realize that match
+	void Realize(Graphics& gfx);
+	void Execute(Graphics& gfx) const;
+	// live passes in execution order
+	const std::vector<PassId>& GetOrder() const noexcept;
+	const std::vector<std::vector<PassId>>& GetParallelGroups() const noexcept;
+	bool IsCulled(PassId pass) const noexcept;
+	// physical texture a transient resource was given, npos for imported or unused resources
+	size_t GetPhysicalIndex(ResourceId id) const noexcept;
+	const std::vector<TextureDesc>& GetPhysicalDescs() const noexcept;
+	// memory of the live transient resources without aliasing, and of the physical textures
+	size_t GetTransientBytes() const noexcept;
+	size_t GetPhysicalBytes() const noexcept;
+	size_t GetPassCount() const noexcept;
+	const std::string& GetPassName(PassId pass) const noexcept;
+	size_t GetResourceCount() const noexcept;
+	const std::string& GetResourceName(ResourceId id) const noexcept;
+	void SpawnWindow() const;
+private:
+	struct Resource
+	{
+		std::string name;
+		TextureDesc desc;
+		bool imported;
+		size_t physical = npos;
+	};
+	struct Pass
+	{
+		std::string name;
+		std::vector<ResourceId> reads;
+		std::vector<ResourceId> writes;
+		ExecuteFunction execute;
+		bool culled = false;
+		// index of the parallel group, by the longest chain of dependencies leading to it
+		size_t group = 0u;
+	};
+	struct Physical
+	{
+		TextureDesc desc;
+		std::unique_ptr<RenderTarget> pTarget;
+		std::unique_ptr<DepthStencil> pDepth;
+	};
+private:
+	std::vector<Resource> resources;
+	std::vector<Pass> passes;
+	std::vector<PassId> order;
+	std::vector<std::vector<PassId>> groups;
+	std::vector<TextureDesc> physicalDescs;
+	std::vector<Physical> physical;
+	bool compiled = false;
+};
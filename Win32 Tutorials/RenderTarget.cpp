@@ -6,6 +6,9 @@
 namespace wrl = Microsoft::WRL;
 
 RenderTarget::RenderTarget(Graphics& gfx, UINT width, UINT height)
+	:
+	width(width),
+	height(height)
 {
 	INFOMAN(gfx);
 
@@ -26,6 +29,7 @@ RenderTarget::RenderTarget(Graphics& gfx, UINT width, UINT height)
 	GFX_THROW_INFO(GetDevice(gfx)->CreateTexture2D(
 		&textureDesc, nullptr, &pTexture
 	));
+	gfx.CountResourceCreated();
 
 	// create the resource view on the texture
 	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
@@ -49,17 +53,21 @@ RenderTarget::RenderTarget(Graphics& gfx, UINT width, UINT height)
 
 void RenderTarget::BindAsTexture(Graphics& gfx, UINT slot) const noexcept
 {
-	GetContext(gfx)->PSSetShaderResources(slot, 1, pTextureView.GetAddressOf());
+	gfx.BindPixelShaderResource(slot, pTextureView.Get());
 }
 
 void RenderTarget::BindAsTarget(Graphics& gfx) const noexcept
 {
+	gfx.UnbindPixelShaderResource(pTextureView.Get());
 	GetContext(gfx)->OMSetRenderTargets(1, pTargetView.GetAddressOf(), nullptr);
+	BindViewport(gfx);
 }
 
 void RenderTarget::BindAsTarget(Graphics& gfx, const DepthStencil& depthStencil) const noexcept
 {
+	gfx.UnbindPixelShaderResource(pTextureView.Get());
 	GetContext(gfx)->OMSetRenderTargets(1, pTargetView.GetAddressOf(), depthStencil.pDepthStencilView.Get());
+	BindViewport(gfx);
 }
 
 void RenderTarget::Clear(Graphics& gfx, const std::array<float, 4>& color) const noexcept
@@ -71,3 +79,26 @@ void RenderTarget::Clear(Graphics& gfx) const noexcept
 {
 	Clear(gfx, { 0.0f,0.0f,0.0f,0.0f });
 }
+
+UINT RenderTarget::GetWidth() const noexcept
+{
+	return width;
+}
+
+UINT RenderTarget::GetHeight() const noexcept
+{
+	return height;
+}
+
+void RenderTarget::BindViewport(Graphics& gfx) const noexcept
+{
+	// targets can be smaller than the swap chain (downsampled post passes)
+	D3D11_VIEWPORT vp;
+	vp.Width = (float)width;
+	vp.Height = (float)height;
+	vp.MinDepth = 0.0f;
+	vp.MaxDepth = 1.0f;
+	vp.TopLeftX = 0.0f;
+	vp.TopLeftY = 0.0f;
+	GetContext(gfx)->RSSetViewports(1u, &vp);
+}
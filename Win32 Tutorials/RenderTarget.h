@@ -13,7 +13,13 @@ public:
 	void BindAsTarget(Graphics& gfx, const DepthStencil& depthStencil) const noexcept;
 	void Clear(Graphics& gfx, const std::array<float, 4>& color) const noexcept;
 	void Clear(Graphics& gfx) const noexcept;
+	UINT GetWidth() const noexcept;
+	UINT GetHeight() const noexcept;
 private:
+	void BindViewport(Graphics& gfx) const noexcept;
+private:
+	UINT width;
+	UINT height;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> pTextureView;
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> pTargetView;
 };
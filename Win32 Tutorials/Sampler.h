@@ -6,14 +6,24 @@ namespace Bind
 	class Sampler : public Bindable
 	{
 	public:
-		Sampler(Graphics& gfx, bool anisoEnable, bool reflect);
+		enum class Type
+		{
+			Anisotropic,
+			// linear minification, point magnification and mips
+			MinLinear,
+			// linear minification and magnification, for fullscreen passes whose taps land
+			// between texels at 1:1, like the blur's folded taps
+			Bilinear,
+		};
+	public:
+		Sampler(Graphics& gfx, Type type, bool reflect);
 		void Bind(Graphics& gfx) noexcept override;
-		static std::shared_ptr<Sampler> Resolve(Graphics& gfx, bool anisoEnable = true, bool reflect = false);
-		static std::string GenerateUID(bool anisoEnable, bool reflect);
+		static std::shared_ptr<Sampler> Resolve(Graphics& gfx, Type type = Type::Anisotropic, bool reflect = false);
+		static std::string GenerateUID(Type type, bool reflect);
 		std::string GetUID() const noexcept override;
 	protected:
 		Microsoft::WRL::ComPtr<ID3D11SamplerState> pSampler;
-		bool anisoEnable;
+		Type type;
 		bool reflect;
 	};
 }
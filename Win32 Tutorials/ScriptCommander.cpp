@@ -1,8 +1,16 @@
 #include "ScriptCommander.h"
 #include <sstream>
 #include <fstream>
+#include <filesystem>
 #include "json.hpp"
 #include "TexturePreprocessor.h"
+#include "TexturePacker.h"
+#include "PerformanceLog.h"
+#include "HeadlessBenchmark.h"
+#include "ShaderCache.h"
+#include "ShaderPack.h"
+#include "AssetArchive.h"
+#include "Vfs.h"
 
 namespace jso = nlohmann;
 using namespace std::string_literals;
@@ -11,16 +19,25 @@ using namespace std::string_literals;
 
 ScriptCommander::ScriptCommander(const std::vector<std::string>& args)
 {
-	if (args.size() >= 2 && args[0] == "--commands")
+	// --trace <file> [frames] captures a chrome trace from before the models load
+	if (args.size() >= 2 && args[0] == "--trace")
+	{
+		const auto frames = args.size() >= 3 ? std::stoull(args[2]) : 0ull;
+		if (!Profiler::BeginTrace(args[1], frames))
+		{
+			throw Exception(__LINE__, __FILE__, args[1], "Unable to create trace file");
+		}
+	}
+	else if (args.size() >= 2 && args[0] == "--commands")
 	{
 		const auto scriptPath = args[1];
-		std::ifstream script(scriptPath);
-		if (!script.is_open())
+		// through the Vfs, so a script packed into an archive runs like a loose one
+		const auto script = Vfs::Get().Read(scriptPath);
+		if (!script.IsOpen())
 		{
 			throw SCRIPT_ERROR("Unable to open script file"s);
 		}
-		jso::json top;
-		script >> top;
+		const auto top = jso::json::parse(script.GetData(), script.GetData() + script.GetSize());
 
 		if (top.at("enabled"))
 		{
@@ -50,6 +67,72 @@ ScriptCommander::ScriptCommander(const std::vector<std::string>& args)
 					TexturePreprocessor::MakeStripes(params.at("dest"), params.at("size"), params.at("stripeWidth"));
 					abort = true;
 				}
+				else if (commandName == "make-mips")
+				{
+					const auto source = params.at("source").get<std::string>();
+					TexturePreprocessor::MakeMipChain(source, params.value("dest", std::filesystem::path{ source }.replace_extension(".dds").string()));
+					abort = true;
+				}
+				else if (commandName == "make-mips-obj")
+				{
+					TexturePreprocessor::MakeMipChainsInObj(params.at("source"));
+					abort = true;
+				}
+				else if (commandName == "blur")
+				{
+					const auto source = params.at("source").get<std::string>();
+					TexturePreprocessor::BlurFile(source, params.value("dest", source), params.at("radius"), params.at("sigma"));
+					abort = true;
+				}
+				else if (commandName == "pack-textures-obj")
+				{
+					TexturePacker::PackObj(params.at("source"), params.value("pageSize", 2048u), params.value("padding", 16u));
+					abort = true;
+				}
+				else if (commandName == "cook-shaders")
+				{
+					// every permutation of the family into the shader cache, so none compile at runtime
+					const auto family = params.value("family", "Phong"s);
+					ShaderCache::Get().Cook(ShaderPermutation::Enumerate(family), params.value("threads", 0u));
+					abort = true;
+				}
+				else if (commandName == "pack-shaders")
+				{
+					// picked up on the next run instead of the loose .cso files
+					ShaderPack::PackDirectory(params.value("source", "."s), params.value("dest", "Shaders.pack"s));
+					abort = true;
+				}
+				else if (commandName == "pack-assets")
+				{
+					// mounted by the Vfs on the next run, sources are files or directories
+					std::vector<std::string> sources;
+					const auto source = params.value("sources", jso::json::array({ "Models"s,"Images"s }));
+					if (source.is_array())
+					{
+						sources = source.get<std::vector<std::string>>();
+					}
+					else
+					{
+						sources.push_back(source.get<std::string>());
+					}
+					AssetArchive::Write(sources, params.value("dest", "Assets.archive"s), params.value("compress", true));
+					abort = true;
+				}
+				else if (commandName == "benchmark")
+				{
+					const auto settings = HeadlessBenchmark::ParseSettings(params.dump());
+					const auto result = HeadlessBenchmark::Run(settings);
+					HeadlessBenchmark::WriteReport(result, settings);
+					if (!settings.baselinePath.empty())
+					{
+						const auto regression = HeadlessBenchmark::CompareToBaseline(result, settings.baselinePath, settings.tolerance);
+						if (!regression.empty())
+						{
+							throw SCRIPT_ERROR("Benchmark regressed against "s + settings.baselinePath + "\n" + regression);
+						}
+					}
+					abort = true;
+				}
 				else
 				{
 					throw SCRIPT_ERROR("Unknown command: "s + commandName);
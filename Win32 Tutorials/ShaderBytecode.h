@@ -0,0 +1,9 @@
+#pragma once
+#include <cstddef>
+
+// compiled shader code owned elsewhere, in a shader pack mapping, the shader cache or a blob
+struct ShaderBytecode
+{
+	const void* pData = nullptr;
+	size_t size = 0u;
+};
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "ShaderCache.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	// bump when the layout of cache files or what goes into their hash changes
+	constexpr const char* cacheVersion = "1";
+
+	class Fnv1a
+	{
+	public:
+		void Add(const void* data, size_t size) noexcept
+		{
+			const auto bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; i++)
+			{
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+			}
+		}
+		// strings are terminated so neighbouring ones can't trade characters
+		void Add(const std::string& s) noexcept
+		{
+			Add(s.c_str(), s.size() + 1u);
+		}
+		uint64_t Get() const noexcept
+		{
+			return hash;
+		}
+	private:
+		uint64_t hash = 14695981039346656037ull;
+	};
+
+	std::string ReadFile(const fs::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return { std::istreambuf_iterator<char>(file),std::istreambuf_iterator<char>() };
+	}
+
+	// hashes a source and, depth first, every file it pulls in with #include "file". Includes
+	// are found relative to the including file like the standard d3d include handler does,
+	// each file counts once. Missing files are left for the compiler to report
+	void HashSource(Fnv1a& hash, const fs::path& path, std::set<fs::path>& visited)
+	{
+		if (!visited.insert(path.lexically_normal()).second)
+		{
+			return;
+		}
+		const auto source = ReadFile(path);
+		hash.Add(path.filename().string());
+		hash.Add(source);
+		std::istringstream lines(source);
+		for (std::string line; std::getline(lines, line);)
+		{
+			const auto directive = line.find_first_not_of(" \t");
+			if (directive == std::string::npos || line.compare(directive, 8u, "#include") != 0)
+			{
+				continue;
+			}
+			const auto open = line.find('"', directive);
+			const auto close = open == std::string::npos ? open : line.find('"', open + 1u);
+			if (close != std::string::npos)
+			{
+				HashSource(hash, path.parent_path() / line.substr(open + 1u, close - open - 1u), visited);
+			}
+		}
+	}
+}
+
+ShaderCache::ShaderCache(std::string sourceDir, std::string cacheDir, CompileFunction compile, std::string compilerTag)
+	:
+	sourceDir(std::move(sourceDir)),
+	cacheDir(std::move(cacheDir)),
+	compile(std::move(compile)),
+	compilerTag(std::move(compilerTag))
+{}
+
+std::shared_ptr<const ShaderCache::Bytecode> ShaderCache::Load(const ShaderPermutation::Key& key_in)
+{
+	const auto key = ShaderPermutation::Canonical(key_in);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (const auto i = loaded.find(key); i != loaded.end())
+		{
+			stats.memoryHits++;
+			return i->second;
+		}
+	}
+	// two threads missing the same key both load it, the second one's copy is dropped
+	const auto cachePath = GetCachePath(key);
+	auto pCode = LoadFromDisk(cachePath);
+	const bool compiled = !pCode;
+	if (compiled)
+	{
+		const auto sourcePath = (fs::path{ sourceDir } / ShaderPermutation::GetSourceFile(key)).string();
+		pCode = std::make_shared<const Bytecode>(compile(sourcePath, ShaderPermutation::GetDefines(key), ShaderPermutation::GetProfile(key.stage)));
+		StoreToDisk(cachePath, *pCode);
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	(compiled ? stats.compiles : stats.diskHits)++;
+	return loaded.emplace(key, std::move(pCode)).first->second;
+}
+
+size_t ShaderCache::Cook(const std::vector<ShaderPermutation::Key>& keys, unsigned int threads)
+{
+	std::vector<ShaderPermutation::Key> unique;
+	for (const auto& k : keys)
+	{
+		unique.push_back(ShaderPermutation::Canonical(k));
+	}
+	std::sort(unique.begin(), unique.end());
+	unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+	if (threads == 0u)
+	{
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	threads = std::min(threads, unsigned(std::max(unique.size(), size_t(1u))));
+	const auto compilesBefore = GetStats().compiles;
+	// workers pull keys until none are left, the first error is rethrown once all are done
+	std::atomic<size_t> next = 0u;
+	std::exception_ptr error;
+	std::mutex errorMutex;
+	const auto work = [&]()
+	{
+		for (size_t i = next++; i < unique.size(); i = next++)
+		{
+			try
+			{
+				Load(unique[i]);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(errorMutex);
+				if (!error)
+				{
+					error = std::current_exception();
+				}
+			}
+		}
+	};
+	std::vector<std::thread> workers;
+	for (unsigned int t = 1u; t < threads; t++)
+	{
+		workers.emplace_back(work);
+	}
+	work();
+	for (auto& w : workers)
+	{
+		w.join();
+	}
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+	return GetStats().compiles - compilesBefore;
+}
+
+uint64_t ShaderCache::HashInputs(const ShaderPermutation::Key& key_in) const
+{
+	const auto key = ShaderPermutation::Canonical(key_in);
+	Fnv1a hash;
+	hash.Add(cacheVersion);
+	hash.Add(compilerTag);
+	hash.Add(ShaderPermutation::GetProfile(key.stage));
+	for (const auto& d : ShaderPermutation::GetDefines(key))
+	{
+		hash.Add(d.first);
+		hash.Add(d.second);
+	}
+	std::set<fs::path> visited;
+	HashSource(hash, fs::path{ sourceDir } / ShaderPermutation::GetSourceFile(key), visited);
+	return hash.Get();
+}
+
+std::string ShaderCache::GetCachePath(const ShaderPermutation::Key& key_in) const
+{
+	const auto key = ShaderPermutation::Canonical(key_in);
+	char suffix[40];
+	std::snprintf(suffix, sizeof(suffix), "_%02x_%016llx.cso", unsigned(key.features), (unsigned long long)HashInputs(key));
+	return (fs::path{ cacheDir } / (key.family + (key.stage == ShaderPermutation::Stage::Vertex ? "_VS" : "_PS") + suffix)).string();
+}
+
+ShaderCache::Stats ShaderCache::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
+
+void ShaderCache::ClearMemory() noexcept
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	loaded.clear();
+}
+
+std::shared_ptr<const ShaderCache::Bytecode> ShaderCache::LoadFromDisk(const std::string& path) const
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return nullptr;
+	}
+	auto pCode = std::make_shared<Bytecode>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return pCode->empty() ? nullptr : std::move(pCode);
+}
+
+void ShaderCache::StoreToDisk(const std::string& path, const Bytecode& code) const
+{
+	// written aside and renamed into place, so a reader never sees a partial file. A cache
+	// that can't be written only costs compiling again next run
+	std::error_code ec;
+	fs::create_directories(cacheDir, ec);
+	const auto temp = path + ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+	{
+		std::ofstream file(temp, std::ios::binary);
+		file.write(code.data(), std::streamsize(code.size()));
+		if (!file)
+		{
+			return;
+		}
+	}
+	fs::rename(temp, path, ec);
+	if (ec)
+	{
+		fs::remove(temp, ec);
+	}
+}
+
+ShaderCache::Exception::Exception(int line, const char* file, std::string note) noexcept
+	:
+	RedSkyException(line, file),
+	note(std::move(note))
+{}
+
+const char* ShaderCache::Exception::what() const noexcept
+{
+	std::ostringstream oss;
+	oss << RedSkyException::what() << std::endl
+		<< "[Note] " << GetNote();
+	whatBuffer = oss.str();
+	return whatBuffer.c_str();
+}
+
+const char* ShaderCache::Exception::GetType() const noexcept
+{
+	return "RedSky Shader Exception";
+}
+
+const std::string& ShaderCache::Exception::GetNote() const noexcept
+{
+	return note;
+}
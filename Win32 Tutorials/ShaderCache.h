@@ -0,0 +1,65 @@
+#pragma once
+#include "RedSkyException.h"
+#include "ShaderPermutation.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Compiled bytecode of shader permutations. A permutation is looked up in memory, then on
+// disk under a hash of everything that went into compiling it (its source, every file that
+// source includes, the defines, profile and compiler settings), and only compiled when both
+// miss. Editing any of those gives new bytecode under a new name, stale files are never read.
+// Cook compiles a family's permutations up front on several threads, so the runtime only
+// ever reads them. Compiling is injected so the cache itself needs no d3d.
+class ShaderCache
+{
+public:
+	using Bytecode = std::vector<char>;
+	// compiles the file at path for profile, throwing with the compiler's output on failure
+	using CompileFunction = std::function<Bytecode(const std::string& path, const ShaderPermutation::Defines& defines, const char* profile)>;
+	class Exception : public RedSkyException
+	{
+	public:
+		Exception(int line, const char* file, std::string note) noexcept;
+		const char* what() const noexcept override;
+		const char* GetType() const noexcept override;
+		const std::string& GetNote() const noexcept;
+	private:
+		std::string note;
+	};
+	struct Stats
+	{
+		size_t memoryHits = 0u;
+		size_t diskHits = 0u;
+		size_t compiles = 0u;
+	};
+public:
+	// compilerTag names settings of compile that change its output (e.g. debug/release flags)
+	ShaderCache(std::string sourceDir, std::string cacheDir, CompileFunction compile, std::string compilerTag = "");
+	// key is made canonical first
+	std::shared_ptr<const Bytecode> Load(const ShaderPermutation::Key& key);
+	// makes sure every key is compiled to disk, returns how many had to be compiled
+	size_t Cook(const std::vector<ShaderPermutation::Key>& keys, unsigned int threads = 0u);
+	uint64_t HashInputs(const ShaderPermutation::Key& key) const;
+	std::string GetCachePath(const ShaderPermutation::Key& key) const;
+	Stats GetStats() const;
+	// later loads go to disk again, stats are kept
+	void ClearMemory() noexcept;
+	// compiles with the d3d compiler into ShaderCache next to the shader sources, defined in ShaderCompiler.cpp
+	static ShaderCache& Get();
+private:
+	std::shared_ptr<const Bytecode> LoadFromDisk(const std::string& path) const;
+	void StoreToDisk(const std::string& path, const Bytecode& code) const;
+private:
+	std::string sourceDir;
+	std::string cacheDir;
+	CompileFunction compile;
+	std::string compilerTag;
+	mutable std::mutex mutex;
+	std::map<ShaderPermutation::Key, std::shared_ptr<const Bytecode>> loaded;
+	Stats stats;
+};
@@ -0,0 +1,55 @@
+#include "ShaderCache.h"
+#include "RedSkyWin.h"
+#include "RedSkyUtility.h"
+#include <d3dcompiler.h>
+#include <wrl.h>
+
+namespace
+{
+	// same settings the project's fxc step uses for its configuration
+#ifndef NDEBUG
+	constexpr UINT compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+	constexpr const char* compileTag = "d3dcompiler debug";
+#else
+	constexpr UINT compileFlags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+	constexpr const char* compileTag = "d3dcompiler release";
+#endif
+
+	ShaderCache::Bytecode Compile(const std::string& path, const ShaderPermutation::Defines& defines, const char* profile)
+	{
+		std::vector<D3D_SHADER_MACRO> macros;
+		for (const auto& d : defines)
+		{
+			macros.push_back({ d.first.c_str(),d.second.c_str() });
+		}
+		macros.push_back({ nullptr,nullptr });
+
+		Microsoft::WRL::ComPtr<ID3DBlob> pCode;
+		Microsoft::WRL::ComPtr<ID3DBlob> pErrors;
+		const auto hr = D3DCompileFromFile(
+			ToWide(path).c_str(), macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE,
+			"main", profile, compileFlags, 0u, &pCode, &pErrors
+		);
+		if (FAILED(hr))
+		{
+			auto note = "Failed to compile " + path;
+			for (const auto& d : defines)
+			{
+				note += " " + d.first;
+			}
+			if (pErrors)
+			{
+				note += "\n" + std::string(static_cast<const char*>(pErrors->GetBufferPointer()), pErrors->GetBufferSize());
+			}
+			throw ShaderCache::Exception(__LINE__, __FILE__, std::move(note));
+		}
+		const auto bytes = static_cast<const char*>(pCode->GetBufferPointer());
+		return { bytes,bytes + pCode->GetBufferSize() };
+	}
+}
+
+ShaderCache& ShaderCache::Get()
+{
+	static ShaderCache cache{ "","ShaderCache",Compile,compileTag };
+	return cache;
+}
@@ -1,9 +1,16 @@
+// material textures may be packed into a shared array or atlas, the material
+// supplies a uv scale (xy) / offset (zw) and the array layer to sample from
+float3 PackedTexcoord(const in float2 tc, uniform float4 transform, uniform float layer)
+{
+    return float3(tc * transform.xy + transform.zw, layer);
+}
+
 float3 MapNormal(
     const in float3 tan,
     const in float3 bitan,
     const in float3 normal,
-    const in float2 tc,
-    uniform Texture2D nmap,
+    const in float3 tc,
+    uniform Texture2DArray nmap,
     uniform SamplerState splr)
 {
     // build the tranform (rotation) into same space as tan/bitan/normal (target space)
@@ -15,14 +22,14 @@ float3 MapNormal(
     return normalize(mul(tanNormal, tanToTarget));
 }
 
-float Attenuate(uniform float attConst, uniform float attLin, uniform float attQuad, const in float distFragToL)
+float Attenuate(const in float attConst, const in float attLin, const in float attQuad, const in float distFragToL)
 {
     return 1.0f / (attConst + attLin * distFragToL + attQuad * (distFragToL * distFragToL));
 }
 
 float3 Diffuse(
-    uniform float3 diffuseColor,
-    uniform float diffuseIntensity,
+    const in float3 diffuseColor,
+    const in float diffuseIntensity,
     const in float att,
     const in float3 viewDirFragToL,
     const in float3 viewNormal)
@@ -32,7 +39,7 @@ float3 Diffuse(
 
 float3 Speculate(
     const in float3 specularColor,
-    uniform float specularIntensity,
+    const in float specularIntensity,
     const in float3 viewNormal,
     const in float3 viewFragToL,
     const in float3 viewPos,
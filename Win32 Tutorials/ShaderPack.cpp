@@ -0,0 +1,199 @@
+#include "ShaderPack.h"
+#include "Vfs.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace
+{
+	constexpr char magic[4] = { 'R','S','S','P' };
+	constexpr size_t headerSize = 16u;
+	constexpr size_t entrySize = 16u;
+	constexpr size_t dataAlignment = 16u;
+
+	void WriteU32(std::vector<char>& out, size_t offset, uint32_t value) noexcept
+	{
+		const unsigned char bytes[4] = {
+			(unsigned char)value,(unsigned char)(value >> 8),(unsigned char)(value >> 16),(unsigned char)(value >> 24)
+		};
+		std::memcpy(out.data() + offset, bytes, 4u);
+	}
+}
+
+ShaderPack::ShaderPack(const char* pData, size_t size, std::shared_ptr<const void> pStorage)
+	:
+	pData(pData),
+	size(size),
+	pStorage(std::move(pStorage))
+{
+	if (size < headerSize || std::memcmp(pData, magic, 4u) != 0)
+	{
+		throw Exception(__LINE__, __FILE__, "Not a shader pack");
+	}
+	if (ReadU32(4u) != version)
+	{
+		throw Exception(__LINE__, __FILE__, "Shader pack version " + std::to_string(ReadU32(4u)) + ", expected " + std::to_string(version));
+	}
+	count = ReadU32(8u);
+	if ((size - headerSize) / entrySize < count)
+	{
+		throw Exception(__LINE__, __FILE__, "Shader pack entry table is truncated");
+	}
+	// checked once here so lookups can trust the table
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const size_t e = headerSize + i * entrySize;
+		const size_t nameOffset = ReadU32(e), nameSize = ReadU32(e + 4u);
+		const size_t dataOffset = ReadU32(e + 8u), dataSize = ReadU32(e + 12u);
+		if (nameOffset + nameSize > size || dataOffset + dataSize > size)
+		{
+			throw Exception(__LINE__, __FILE__, "Shader pack entry " + std::to_string(i) + " is out of bounds");
+		}
+		if (i > 0u && !(GetName(i - 1u) < GetName(i)))
+		{
+			throw Exception(__LINE__, __FILE__, "Shader pack entries are not sorted at " + std::string(GetName(i)));
+		}
+	}
+}
+
+ShaderBytecode ShaderPack::Find(std::string_view name) const noexcept
+{
+	size_t lo = 0u;
+	size_t hi = count;
+	while (lo < hi)
+	{
+		const auto mid = (lo + hi) / 2u;
+		const auto cmp = GetName(mid).compare(name);
+		if (cmp == 0)
+		{
+			const size_t e = headerSize + mid * entrySize;
+			return { pData + ReadU32(e + 8u),ReadU32(e + 12u) };
+		}
+		if (cmp < 0)
+		{
+			lo = mid + 1u;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return {};
+}
+
+size_t ShaderPack::GetCount() const noexcept
+{
+	return count;
+}
+
+std::string_view ShaderPack::GetName(size_t i) const noexcept
+{
+	const size_t e = headerSize + i * entrySize;
+	return { pData + ReadU32(e),ReadU32(e + 4u) };
+}
+
+std::vector<char> ShaderPack::Build(std::vector<Entry> entries)
+{
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+	{
+		return a.first < b.first;
+	});
+	const auto dupe = std::adjacent_find(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+	{
+		return a.first == b.first;
+	});
+	if (dupe != entries.end())
+	{
+		throw Exception(__LINE__, __FILE__, "Shader packed twice: " + dupe->first);
+	}
+	std::vector<char> out(headerSize + entries.size() * entrySize);
+	std::memcpy(out.data(), magic, 4u);
+	WriteU32(out, 4u, version);
+	WriteU32(out, 8u, uint32_t(entries.size()));
+	WriteU32(out, 12u, 0u);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		WriteU32(out, headerSize + i * entrySize, uint32_t(out.size()));
+		WriteU32(out, headerSize + i * entrySize + 4u, uint32_t(entries[i].first.size()));
+		out.insert(out.end(), entries[i].first.begin(), entries[i].first.end());
+	}
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		out.resize((out.size() + dataAlignment - 1u) / dataAlignment * dataAlignment);
+		WriteU32(out, headerSize + i * entrySize + 8u, uint32_t(out.size()));
+		WriteU32(out, headerSize + i * entrySize + 12u, uint32_t(entries[i].second.size()));
+		out.insert(out.end(), entries[i].second.begin(), entries[i].second.end());
+	}
+	return out;
+}
+
+size_t ShaderPack::PackDirectory(const std::string& dir, const std::string& packPath)
+{
+	std::vector<Entry> entries;
+	for (const auto& file : std::filesystem::directory_iterator(dir))
+	{
+		if (file.is_regular_file() && file.path().extension() == ".cso")
+		{
+			std::ifstream in(file.path(), std::ios::binary);
+			entries.emplace_back(file.path().filename().string(),
+				std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()));
+		}
+	}
+	const auto packed = entries.size();
+	const auto image = Build(std::move(entries));
+	std::ofstream out(packPath, std::ios::binary);
+	out.write(image.data(), std::streamsize(image.size()));
+	if (!out)
+	{
+		throw Exception(__LINE__, __FILE__, "Unable to write " + packPath);
+	}
+	return packed;
+}
+
+const ShaderPack* ShaderPack::Get()
+{
+	static const auto pPack = []() -> std::unique_ptr<const ShaderPack>
+	{
+		const auto file = Vfs::Get().Read("Shaders.pack");
+		if (!file.IsOpen())
+		{
+			return nullptr;
+		}
+		return std::make_unique<const ShaderPack>(file.GetData(), file.GetSize(), file.GetStorage());
+	}();
+	return pPack.get();
+}
+
+uint32_t ShaderPack::ReadU32(size_t offset) const noexcept
+{
+	const auto bytes = reinterpret_cast<const unsigned char*>(pData + offset);
+	return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+}
+
+ShaderPack::Exception::Exception(int line, const char* file, std::string note) noexcept
+	:
+	RedSkyException(line, file),
+	note(std::move(note))
+{}
+
+const char* ShaderPack::Exception::what() const noexcept
+{
+	std::ostringstream oss;
+	oss << RedSkyException::what() << std::endl
+		<< "[Note] " << GetNote();
+	whatBuffer = oss.str();
+	return whatBuffer.c_str();
+}
+
+const char* ShaderPack::Exception::GetType() const noexcept
+{
+	return "RedSky Shader Pack Exception";
+}
+
+const std::string& ShaderPack::Exception::GetNote() const noexcept
+{
+	return note;
+}
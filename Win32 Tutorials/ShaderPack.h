@@ -0,0 +1,54 @@
+#pragma once
+#include "RedSkyException.h"
+#include "ShaderBytecode.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Every .cso of the working directory in one file, mapped into memory once at startup so a
+// shader resolve is a binary search and a pointer into the mapping rather than a file read.
+// Layout, all little endian uint32:
+//   header  'RSSP' version count 0
+//   entries count x { nameOffset nameSize dataOffset dataSize }, sorted by name
+//   names, then bytecode with each blob 16 byte aligned
+// Offsets are from the start of the file. The pack is written by the pack-shaders script
+// command; without one shaders are read from their own files as before.
+class ShaderPack
+{
+public:
+	class Exception : public RedSkyException
+	{
+	public:
+		Exception(int line, const char* file, std::string note) noexcept;
+		const char* what() const noexcept override;
+		const char* GetType() const noexcept override;
+		const std::string& GetNote() const noexcept;
+	private:
+		std::string note;
+	};
+	using Entry = std::pair<std::string, std::vector<char>>;
+	static constexpr uint32_t version = 1u;
+public:
+	// validates a pack in memory that pStorage (if any) keeps alive, throws when malformed
+	ShaderPack(const char* pData, size_t size, std::shared_ptr<const void> pStorage = nullptr);
+	// empty bytecode when name isn't packed
+	ShaderBytecode Find(std::string_view name) const noexcept;
+	size_t GetCount() const noexcept;
+	std::string_view GetName(size_t i) const noexcept;
+	// the file image of a pack holding entries, names must be unique
+	static std::vector<char> Build(std::vector<Entry> entries);
+	// packs every .cso in dir into packPath, returns how many
+	static size_t PackDirectory(const std::string& dir, const std::string& packPath);
+	// Shaders.pack of the working directory read through the Vfs, nullptr when there is none
+	static const ShaderPack* Get();
+private:
+	uint32_t ReadU32(size_t offset) const noexcept;
+private:
+	const char* pData;
+	size_t size;
+	uint32_t count = 0u;
+	std::shared_ptr<const void> pStorage;
+};
@@ -0,0 +1,96 @@
+#include "ShaderPermutation.h"
+#include <tuple>
+
+bool ShaderPermutation::Key::operator==(const Key& rhs) const noexcept
+{
+	return family == rhs.family && stage == rhs.stage && features == rhs.features;
+}
+
+bool ShaderPermutation::Key::operator<(const Key& rhs) const noexcept
+{
+	return std::tie(family, stage, features) < std::tie(rhs.family, rhs.stage, rhs.features);
+}
+
+ShaderPermutation::Key ShaderPermutation::Canonical(Key key) noexcept
+{
+	key.features &= (1u << featureCount) - 1u;
+	// the mask is the diffuse map's alpha
+	if (!(key.features & DiffuseMap))
+	{
+		key.features &= ~uint32_t(Mask);
+	}
+	// vertex shaders only pass texture coordinates on for any map, and tangents for normal maps
+	if (key.stage == Stage::Vertex)
+	{
+		const bool texcoord = (key.features & (DiffuseMap | SpecularMap | NormalMap)) != 0u;
+		key.features = (texcoord ? uint32_t(DiffuseMap) : 0u) | (key.features & NormalMap);
+	}
+	return key;
+}
+
+std::vector<ShaderPermutation::Key> ShaderPermutation::Enumerate(const std::string& family)
+{
+	std::vector<Key> keys;
+	for (const auto stage : { Stage::Vertex,Stage::Pixel })
+	{
+		for (uint32_t features = 0u; features < (1u << featureCount); features++)
+		{
+			if (Canonical({ family,stage,features }).features == features)
+			{
+				keys.push_back({ family,stage,features });
+			}
+		}
+	}
+	return keys;
+}
+
+ShaderPermutation::Defines ShaderPermutation::GetDefines(const Key& key)
+{
+	Defines defines;
+	for (uint32_t i = 0u; i < featureCount; i++)
+	{
+		if (key.features & (1u << i))
+		{
+			defines.emplace_back(GetFeatureDefine(1u << i), "1");
+		}
+	}
+	return defines;
+}
+
+const char* ShaderPermutation::GetFeatureDefine(uint32_t bit) noexcept
+{
+	switch (bit)
+	{
+	case DiffuseMap:
+		return "DIFFUSE_MAP";
+	case Mask:
+		return "MASK";
+	case SpecularMap:
+		return "SPECULAR_MAP";
+	case NormalMap:
+		return "NORMAL_MAP";
+	default:
+		return "";
+	}
+}
+
+std::string ShaderPermutation::GetSourceFile(const Key& key)
+{
+	return key.family + (key.stage == Stage::Vertex ? "_VS.hlsl" : "_PS.hlsl");
+}
+
+const char* ShaderPermutation::GetProfile(Stage stage) noexcept
+{
+	return stage == Stage::Vertex ? "vs_5_0" : "ps_5_0";
+}
+
+std::string ShaderPermutation::GetName(const Key& key)
+{
+	auto name = key.family + (key.stage == Stage::Vertex ? "_VS[" : "_PS[");
+	const auto defines = GetDefines(key);
+	for (size_t i = 0; i < defines.size(); i++)
+	{
+		name += (i == 0u ? "" : ",") + defines[i].first;
+	}
+	return name + "]";
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Names one variant of a shader family: the family's source (Phong_VS.hlsl / Phong_PS.hlsl)
+// compiled with a preprocessor define for each feature bit that is set. Keys are made
+// canonical per stage, so materials asking for features a stage doesn't use share its
+// shader instead of compiling a copy.
+class ShaderPermutation
+{
+public:
+	enum class Stage
+	{
+		Vertex,
+		Pixel,
+	};
+	// features of the phong family, each sets the define of the same name in upper case
+	enum Feature : uint32_t
+	{
+		DiffuseMap = 1u << 0,
+		// alpha tested against the diffuse map's alpha
+		Mask = 1u << 1,
+		SpecularMap = 1u << 2,
+		NormalMap = 1u << 3,
+	};
+	static constexpr uint32_t featureCount = 4u;
+	struct Key
+	{
+		std::string family;
+		Stage stage;
+		uint32_t features;
+		bool operator==(const Key& rhs) const noexcept;
+		bool operator<(const Key& rhs) const noexcept;
+	};
+	using Defines = std::vector<std::pair<std::string, std::string>>;
+public:
+	// drops features the stage can't tell apart and ones missing what they depend on
+	static Key Canonical(Key key) noexcept;
+	// every distinct canonical key of the family for both stages
+	static std::vector<Key> Enumerate(const std::string& family);
+	static Defines GetDefines(const Key& key);
+	static const char* GetFeatureDefine(uint32_t bit) noexcept;
+	static std::string GetSourceFile(const Key& key);
+	static const char* GetProfile(Stage stage) noexcept;
+	// readable and unique, e.g. Phong_PS[DIFFUSE_MAP,NORMAL_MAP]
+	static std::string GetName(const Key& key);
+};
@@ -0,0 +1,16 @@
+// Transform.hlsl only for ToClip, its TransformCBuf goes unused and takes no slot
+#include "Transform.hlsl"
+
+cbuffer ProjectionCBuf : register(b0)
+{
+    matrix proj;
+};
+
+// instanced Solid_VS, the model view transform comes from the instance buffer
+float4 main(float3 pos : Position,
+    float4 mv0 : InstanceTransform0, float4 mv1 : InstanceTransform1, float4 mv2 : InstanceTransform2, float4 mv3 : InstanceTransform3) : SV_Position
+{
+    const float4x4 instanceModelView = float4x4(mv0, mv1, mv2, mv3);
+    precise float4 clip = ToClip(pos, instanceModelView, proj);
+    return clip;
+}
@@ -13,6 +13,7 @@ SolidSphere::SolidSphere(Graphics& gfx, float radius)
 
 	auto model = Sphere::Make();
 	model.Transform(dx::XMMatrixScaling(radius, radius, radius));
+	SetBounds(model);
 	const auto geometryTag = "$sphere." + std::to_string(radius);
 	pVertices = VertexBuffer::Resolve(gfx, geometryTag, model.vertices);
 	pIndices = IndexBuffer::Resolve(gfx, geometryTag, model.indices);
@@ -43,6 +44,10 @@ SolidSphere::SolidSphere(Graphics& gfx, float radius)
 
 		only.AddBindable(Rasterizer::Resolve(gfx, false));
 
+		auto pivs = VertexShader::Resolve(gfx, "SolidInst_VS.cso");
+		only.AddInstancedBindable(InputLayout::Resolve(gfx, model.vertices.GetLayout(), InstanceBuffer::GetLayout(), pivs->GetBytecode()));
+		only.AddInstancedBindable(std::move(pivs));
+
 		solid.AddStep(std::move(only));
 		AddTechnique(std::move(solid));
 	}
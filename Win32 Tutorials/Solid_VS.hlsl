@@ -2,5 +2,6 @@
 
 float4 main( float3 pos : Position ) : SV_Position
 {
-	return mul( float4(pos,1.0f),modelViewProj );
+	precise float4 clip = ToClip( pos,modelViewProj );
+	return clip;
 }
\ No newline at end of file
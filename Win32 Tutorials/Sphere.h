@@ -1,101 +1,100 @@
 #pragma once
 #include <optional>
+#include <limits>
+#include <cmath>
 #include "Vertex.h"
 #include "IndexedTriangleList.h"
+#include "ParallelFor.h"
 #include <DirectXMath.h>
 #include "RedSkyMath.h"
 
 class Sphere
 {
 public:
-	static IndexedTriangleList MakeTesselated( rsexp::VertexLayout layout,int latDiv,int longDiv )
+	// unit sphere from latDiv - 1 rings of longDiv vertices plus the poles, normals are
+	// written too when the layout has them. Pick 32 bit indices past 65536 vertices
+	template<typename Index = unsigned short>
+	static BasicIndexedTriangleList<Index> MakeTesselated( rsexp::VertexLayout layout,int latDiv,int longDiv )
 	{
-		namespace dx = DirectX;
+		using Type = rsexp::VertexLayout::ElementType;
 		assert( latDiv >= 3 );
 		assert( longDiv >= 3 );
 
-		constexpr float radius = 1.0f;
-		const auto base = dx::XMVectorSet( 0.0f,0.0f,radius,0.0f );
-		const float lattitudeAngle = PI / latDiv;
-		const float longitudeAngle = 2.0f * PI / longDiv;
+		const size_t rings = size_t( latDiv - 1 );
+		const size_t ringSize = size_t( longDiv );
+		const size_t iNorthPole = rings * ringSize;
+		const size_t iSouthPole = iNorthPole + 1u;
+		assert( iSouthPole <= std::numeric_limits<Index>::max() && "Too many vertices for the index type" );
+		const size_t grain = RowGrain( ringSize );
 
-		rsexp::VertexBuffer vb{ std::move( layout ) };
-		for( int iLat = 1; iLat < latDiv; iLat++ )
+		// a vertex is the north pole turned about x by its latitude, then about z by its
+		// longitude. Every angle's sine and cosine is taken once here rather than per vertex
+		std::vector<float> latSin( rings ),latCos( rings ),longSin( ringSize ),longCos( ringSize );
+		for( size_t i = 0; i < rings; i++ )
 		{
-			const auto latBase = dx::XMVector3Transform( 
-				base,
-				dx::XMMatrixRotationX( lattitudeAngle * iLat ) 
-			);
-			for( int iLong = 0; iLong < longDiv; iLong++ )
-			{
-				dx::XMFLOAT3 calculatedPos;
-				auto v = dx::XMVector3Transform( 
-					latBase,
-					dx::XMMatrixRotationZ( longitudeAngle * iLong )
-				);
-				dx::XMStoreFloat3( &calculatedPos,v );
-				vb.EmplaceBack( calculatedPos );
-			}
-		}
-
-		// add the cap vertices
-		const auto iNorthPole = (unsigned short)vb.Size();
-		{
-			dx::XMFLOAT3 northPos;
-			dx::XMStoreFloat3( &northPos,base );
-			vb.EmplaceBack( northPos );
+			const float angle = PI / float( latDiv ) * float( i + 1u );
+			latSin[i] = std::sin( angle );
+			latCos[i] = std::cos( angle );
 		}
-		const auto iSouthPole = (unsigned short)vb.Size();
+		for( size_t i = 0; i < ringSize; i++ )
 		{
-			dx::XMFLOAT3 southPos;
-			dx::XMStoreFloat3( &southPos,dx::XMVectorNegate( base ) );
-			vb.EmplaceBack( southPos );
+			const float angle = 2.0f * PI / float( longDiv ) * float( i );
+			longSin[i] = std::sin( angle );
+			longCos[i] = std::cos( angle );
 		}
-		
-		const auto calcIdx = [latDiv,longDiv]( unsigned short iLat,unsigned short iLong )
-			{ return iLat * longDiv + iLong; };
-		std::vector<unsigned short> indices;
-		for( unsigned short iLat = 0; iLat < latDiv - 2; iLat++ )
+
+		rsexp::VertexBuffer vb{ std::move( layout ),iSouthPole + 1u };
+		const rsexp::ElementView<Type::Position3D> positions{ vb };
+		const rsexp::ElementView<Type::Normal> normals{ vb };
+		ParallelFor( rings,grain,[&]( size_t iLat )
 		{
-			for( unsigned short iLong = 0; iLong < longDiv - 1; iLong++ )
+			for( size_t iLong = 0; iLong < ringSize; iLong++ )
 			{
-				indices.push_back( calcIdx( iLat,iLong ) );
-				indices.push_back( calcIdx( iLat + 1,iLong ) );
-				indices.push_back( calcIdx( iLat,iLong + 1 ) );
-				indices.push_back( calcIdx( iLat,iLong + 1 ) );
-				indices.push_back( calcIdx( iLat + 1,iLong ) );
-				indices.push_back( calcIdx( iLat + 1,iLong + 1 ) );
+				const size_t i = iLat * ringSize + iLong;
+				positions[i] = { latSin[iLat] * longSin[iLong],-latSin[iLat] * longCos[iLong],latCos[iLat] };
+				if( normals.IsValid() )
+				{
+					normals[i] = positions[i];
+				}
 			}
-			// wrap band
-			indices.push_back( calcIdx( iLat,longDiv - 1 ) );
-			indices.push_back( calcIdx( iLat + 1,longDiv - 1 ) );
-			indices.push_back( calcIdx( iLat,0 ) );
-			indices.push_back( calcIdx( iLat,0 ) );
-			indices.push_back( calcIdx( iLat + 1,longDiv - 1 ) );
-			indices.push_back( calcIdx( iLat + 1,0 ) );			
+		} );
+		positions[iNorthPole] = { 0.0f,0.0f,1.0f };
+		positions[iSouthPole] = { 0.0f,0.0f,-1.0f };
+		if( normals.IsValid() )
+		{
+			normals[iNorthPole] = positions[iNorthPole];
+			normals[iSouthPole] = positions[iSouthPole];
 		}
 
-		// cap fans
-		for( unsigned short iLong = 0; iLong < longDiv - 1; iLong++ )
+		// a band of two triangles per quad between each pair of rings, then a fan for each cap
+		std::vector<Index> indices( rings * ringSize * 6u );
+		const auto calcIdx = [ringSize]( size_t iLat,size_t iLong )
+			{ return Index( iLat * ringSize + iLong % ringSize ); };
+		ParallelFor( rings - 1u,grain,[&]( size_t iLat )
+		{
+			auto pOut = indices.data() + iLat * ringSize * 6u;
+			for( size_t iLong = 0; iLong < ringSize; iLong++ )
+			{
+				*pOut++ = calcIdx( iLat,iLong );
+				*pOut++ = calcIdx( iLat + 1u,iLong );
+				*pOut++ = calcIdx( iLat,iLong + 1u );
+				*pOut++ = calcIdx( iLat,iLong + 1u );
+				*pOut++ = calcIdx( iLat + 1u,iLong );
+				*pOut++ = calcIdx( iLat + 1u,iLong + 1u );
+			}
+		} );
+		auto pCaps = indices.data() + ( rings - 1u ) * ringSize * 6u;
+		for( size_t iLong = 0; iLong < ringSize; iLong++ )
 		{
 			// north
-			indices.push_back( iNorthPole );
-			indices.push_back( calcIdx( 0,iLong ) );
-			indices.push_back( calcIdx( 0,iLong + 1 ) );
+			*pCaps++ = Index( iNorthPole );
+			*pCaps++ = calcIdx( 0u,iLong );
+			*pCaps++ = calcIdx( 0u,iLong + 1u );
 			// south
-			indices.push_back( calcIdx( latDiv - 2,iLong + 1 ) );
-			indices.push_back( calcIdx( latDiv - 2,iLong ) );
-			indices.push_back( iSouthPole );
+			*pCaps++ = calcIdx( rings - 1u,iLong + 1u );
+			*pCaps++ = calcIdx( rings - 1u,iLong );
+			*pCaps++ = Index( iSouthPole );
 		}
-		// wrap triangles
-		// north
-		indices.push_back( iNorthPole );
-		indices.push_back( calcIdx( 0,longDiv - 1 ) );
-		indices.push_back( calcIdx( 0,0 ) );
-		// south
-		indices.push_back( calcIdx( latDiv - 2,0 ) );
-		indices.push_back( calcIdx( latDiv - 2,longDiv - 1 ) );
-		indices.push_back( iSouthPole );
 
 		return { std::move( vb ),std::move( indices ) };
 	}
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+// Fixed capacity ring buffer between one producer thread and one consumer thread, without
+// locks and without allocating after construction. Only the consumer moves the read end,
+// so a push to a full queue fails instead of overwriting the oldest item. Each side keeps
+// its own copy of the other's index and only reloads it when the ring looks full or empty.
+template<typename T, size_t Capacity>
+class SpscQueue
+{
+	static_assert(Capacity > 0u && (Capacity & (Capacity - 1u)) == 0u, "Capacity must be a power of two");
+	static_assert(std::is_trivially_copyable_v<T>, "Items are copied in and out as bytes");
+public:
+	SpscQueue() = default;
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+	// producer only
+	bool Push(const T& item) noexcept
+	{
+		const auto write = writeIndex.load(std::memory_order_relaxed);
+		if (write - cachedRead == Capacity)
+		{
+			cachedRead = readIndex.load(std::memory_order_acquire);
+			if (write - cachedRead == Capacity)
+			{
+				return false;
+			}
+		}
+		new(&slots[write & (Capacity - 1u)]) T(item);
+		writeIndex.store(write + 1u, std::memory_order_release);
+		return true;
+	}
+	// consumer only
+	std::optional<T> Pop() noexcept
+	{
+		const auto read = readIndex.load(std::memory_order_relaxed);
+		if (read == cachedWrite)
+		{
+			cachedWrite = writeIndex.load(std::memory_order_acquire);
+			if (read == cachedWrite)
+			{
+				return std::nullopt;
+			}
+		}
+		const T item = *std::launder(reinterpret_cast<const T*>(&slots[read & (Capacity - 1u)]));
+		readIndex.store(read + 1u, std::memory_order_release);
+		return item;
+	}
+	// consumer only, drops everything pushed so far
+	void Clear() noexcept
+	{
+		cachedWrite = writeIndex.load(std::memory_order_acquire);
+		readIndex.store(cachedWrite, std::memory_order_release);
+	}
+	// exact from the consumer, a snapshot from anywhere else
+	bool IsEmpty() const noexcept
+	{
+		return Size() == 0u;
+	}
+	size_t Size() const noexcept
+	{
+		const auto read = readIndex.load(std::memory_order_acquire);
+		return writeIndex.load(std::memory_order_acquire) - read;
+	}
+	static constexpr size_t GetCapacity() noexcept
+	{
+		return Capacity;
+	}
+private:
+	// the indices only ever count up, wrapping is left to the mask. Each side's lives on its
+	// own cache line with the copy it keeps of the other's
+	alignas(64) std::atomic<size_t> writeIndex{ 0u };
+	size_t cachedRead = 0u;
+	alignas(64) std::atomic<size_t> readIndex{ 0u };
+	size_t cachedWrite = 0u;
+	alignas(64) std::aligned_storage_t<sizeof(T), alignof(T)> slots[Capacity];
+};
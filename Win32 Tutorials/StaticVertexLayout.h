@@ -0,0 +1,130 @@
+#pragma once
+#include "Vertex.h"
+#include <array>
+#include <vector>
+
+namespace rsexp
+{
+	// A vertex of a layout fixed at compile time, one member per element in order with
+	// nothing between them. Get compiles down to the member, no layout is searched.
+	template<VertexLayout::ElementType... Types>
+	struct StaticVertex;
+	template<VertexLayout::ElementType Type>
+	struct StaticVertex<Type>
+	{
+		template<VertexLayout::ElementType T>
+		auto& Get() noexcept
+		{
+			static_assert(T == Type, "Element is not in the layout");
+			return value;
+		}
+		template<VertexLayout::ElementType T>
+		const auto& Get() const noexcept
+		{
+			return const_cast<StaticVertex&>(*this).Get<T>();
+		}
+		typename VertexLayout::Map<Type>::SysType value;
+	};
+	template<VertexLayout::ElementType Type, VertexLayout::ElementType... Rest>
+	struct StaticVertex<Type, Rest...>
+	{
+		template<VertexLayout::ElementType T>
+		auto& Get() noexcept
+		{
+			if constexpr (T == Type)
+			{
+				return value;
+			}
+			else
+			{
+				return rest.template Get<T>();
+			}
+		}
+		template<VertexLayout::ElementType T>
+		const auto& Get() const noexcept
+		{
+			return const_cast<StaticVertex&>(*this).Get<T>();
+		}
+		typename VertexLayout::Map<Type>::SysType value;
+		StaticVertex<Rest...> rest;
+	};
+
+	// The compile time counterpart of VertexLayout: offsets and stride are constants and
+	// vertices are StaticVertex structs, which can be filled directly and then handed to a
+	// VertexBuffer (or read back out of one) of the matching dynamic layout.
+	template<VertexLayout::ElementType... Types>
+	class StaticVertexLayout
+	{
+	public:
+		using Vertex = StaticVertex<Types...>;
+		static constexpr size_t count = sizeof...(Types);
+		static constexpr std::array<VertexLayout::ElementType, count> types = { Types... };
+		static constexpr std::array<size_t, count> sizes = { sizeof(typename VertexLayout::Map<Types>::SysType)... };
+		static constexpr size_t stride = []()
+		{
+			size_t size = 0u;
+			for (const auto s : sizes)
+			{
+				size += s;
+			}
+			return size;
+		}();
+		static constexpr size_t Size() noexcept
+		{
+			return stride;
+		}
+		template<VertexLayout::ElementType Type>
+		static constexpr size_t OffsetOf() noexcept
+		{
+			static_assert(((Types == Type) || ...), "Element is not in the layout");
+			size_t offset = 0u;
+			for (size_t i = 0; i < count && types[i] != Type; i++)
+			{
+				offset += sizes[i];
+			}
+			return offset;
+		}
+		// the same layout built at runtime, for InputLayout and anything else taking one
+		static const VertexLayout& GetLayout()
+		{
+			static const VertexLayout layout = []()
+			{
+				VertexLayout l;
+				(l.Append(Types), ...);
+				return l;
+			}();
+			return layout;
+		}
+		static VertexBuffer MakeBuffer(const std::vector<Vertex>& vertices)
+		{
+			return { GetLayout(),reinterpret_cast<const char*>(vertices.data()),vertices.size() };
+		}
+		// the buffer's vertices in place, it must have this layout
+		static Vertex* GetVertices(VertexBuffer& vb) noxnd
+		{
+			assert(vb.GetLayout().GetCode() == GetLayout().GetCode() && "Vertex buffer has a different layout");
+			return reinterpret_cast<Vertex*>(vb.GetData());
+		}
+		static const Vertex* GetVertices(const VertexBuffer& vb) noxnd
+		{
+			return GetVertices(const_cast<VertexBuffer&>(vb));
+		}
+	private:
+		// VertexLayout::Append skips repeats, which would move every offset after one
+		static_assert([]()
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				for (size_t j = i + 1u; j < count; j++)
+				{
+					if (types[i] == types[j])
+					{
+						return false;
+					}
+				}
+			}
+			return true;
+		}(), "Elements of a layout must be unique");
+		static_assert(sizeof(Vertex) == stride, "Vertex members must be tightly packed");
+	};
+}
@@ -11,7 +11,12 @@ namespace Bind
 		{
 			Off,
 			Write,
-			Mask
+			Mask,
+			// after a depth pre-pass, surfaces it laid down pass on equal depth. Less-equal and
+			// still writing, so draws that had no pre-pass depth test as usual. Equal only holds
+			// while both vertex shaders of a pair compute their position through ToClip into a
+			// precise output (Transform.hlsl), a depth one ulp further is rejected
+			DepthLessEqual,
 		};
 		Stencil( Graphics& gfx,Mode mode )
 			:
@@ -37,8 +42,13 @@ namespace Bind
 				dsDesc.FrontFace.StencilFunc = D3D11_COMPARISON_NOT_EQUAL;
 				dsDesc.FrontFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
 			}
+			else if( mode == Mode::DepthLessEqual )
+			{
+				dsDesc.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
+			}
 
 			GetDevice( gfx )->CreateDepthStencilState( &dsDesc,&pStencil );
+			gfx.CountResourceCreated();
 		}
 		void Bind( Graphics& gfx ) noexcept override
 		{
@@ -59,6 +69,8 @@ namespace Bind
 					return "write"s;
 				case Mode::Mask:
 					return "mask"s;
+				case Mode::DepthLessEqual:
+					return "depth-less-equal"s;
 				}
 				return "ERROR"s;
 			};
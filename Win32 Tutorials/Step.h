@@ -15,7 +15,8 @@ public:
 	Step(Step&&) = default;
 	Step(const Step& src) noexcept
 		:
-		targetPass(src.targetPass)
+		targetPass(src.targetPass),
+		instancedBindables(src.instancedBindables)
 	{
 		bindables.reserve(src.bindables.size());
 		for (auto& pb : src.bindables)
@@ -36,14 +37,55 @@ public:
 	{
 		bindables.push_back(std::move(bind_in));
 	}
+	// bound after the step's own bindables when its jobs are drawn instanced, typically an
+	// instanced vertex shader and an input layout with per instance elements
+	void AddInstancedBindable(std::shared_ptr<Bind::Bindable> bind_in) noexcept
+	{
+		instancedBindables.push_back(std::move(bind_in));
+	}
 	void Submit(class FrameCommander& frame, const class Drawable& drawable) const;
 	void Bind(Graphics& gfx) const
 	{
+		gfx.CountBindableBinds(bindables.size());
 		for (const auto& b : bindables)
 		{
 			b->Bind(gfx);
 		}
 	}
+	void BindInstanced(Graphics& gfx) const
+	{
+		size_t count = instancedBindables.size();
+		for (const auto& b : bindables)
+		{
+			if (!b->IsPerInstance())
+			{
+				b->Bind(gfx);
+				count++;
+			}
+		}
+		for (const auto& b : instancedBindables)
+		{
+			b->Bind(gfx);
+		}
+		gfx.CountBindableBinds(count);
+	}
+	// false when the step has no instanced form, otherwise appends the state its draws set
+	bool AppendBatchKey(std::string& key) const noexcept
+	{
+		if (instancedBindables.empty())
+		{
+			return false;
+		}
+		for (const auto& b : bindables)
+		{
+			b->AppendBatchKey(key);
+		}
+		for (const auto& b : instancedBindables)
+		{
+			b->AppendBatchKey(key);
+		}
+		return true;
+	}
 	void InitializeParentReferences(const class Drawable& parent) noexcept;
 	void Accept(TechniqueProbe& probe)
 	{
@@ -56,4 +98,5 @@ public:
 private:
 	size_t targetPass;
 	std::vector<std::shared_ptr<Bind::Bindable>> bindables;
+	std::vector<std::shared_ptr<Bind::Bindable>> instancedBindables;
 };
\ No newline at end of file
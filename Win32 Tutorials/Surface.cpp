@@ -6,6 +6,7 @@
 #include <sstream>
 #include <filesystem>
 #include "RedSkyUtility.h"
+#include "SurfaceStream.h"
 
 
 Surface::Surface(unsigned int width, unsigned int height)
@@ -79,34 +80,8 @@ const Surface::Color* Surface::GetBufferPtrConst() const noexcept
 
 Surface Surface::FromFile(const std::string& name)
 {
-	DirectX::ScratchImage scratch;
-	HRESULT hr = DirectX::LoadFromWICFile(ToWide(name).c_str(), DirectX::WIC_FLAGS_IGNORE_SRGB, nullptr, scratch);
-
-	if (FAILED(hr))
-	{
-		throw Surface::Exception(__LINE__, __FILE__, name, "Failed to load image", hr);
-	}
-
-	if (scratch.GetImage(0, 0, 0)->format != format)
-	{
-		DirectX::ScratchImage converted;
-		hr = DirectX::Convert(
-			*scratch.GetImage(0, 0, 0),
-			format,
-			DirectX::TEX_FILTER_DEFAULT,
-			DirectX::TEX_THRESHOLD_DEFAULT,
-			converted
-		);
-
-		if (FAILED(hr))
-		{
-			throw Surface::Exception(__LINE__, __FILE__, name, "Failed to convert image", hr);
-		}
-
-		return Surface(std::move(converted));
-	}
-
-	return Surface(std::move(scratch));
+	// decoded and converted to BGRA strip by strip, straight into the final surface
+	return SurfaceReader{ name }.ReadAll();
 }
 
 void Surface::Save(const std::string& filename) const
@@ -0,0 +1,314 @@
+#include "SurfaceStream.h"
+#include "RedSkyUtility.h"
+#include <wincodec.h>
+#include <dxtex/DDS.h>
+#include <filesystem>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace wrl = Microsoft::WRL;
+
+// SurfaceReader
+SurfaceReader::SurfaceReader(const std::string& filename, unsigned int stripHeight)
+	:
+	filename(filename),
+	stripHeight(stripHeight)
+{
+	assert(stripHeight > 0u);
+	file = Vfs::Get().Read(filename);
+	if (!file.IsOpen())
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to open image");
+	}
+	const auto ext = std::filesystem::path{ filename }.extension().string();
+	if (ext == ".dds" || ext == ".DDS")
+	{
+		OpenMapped();
+	}
+	else
+	{
+		OpenWic();
+	}
+}
+
+SurfaceReader::~SurfaceReader() = default;
+
+void SurfaceReader::OpenWic()
+{
+	bool iswic2 = false;
+	const auto pFactory = DirectX::GetWICFactory(iswic2);
+	if (pFactory == nullptr)
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to get WIC factory");
+	}
+
+	// decoded from the file's bytes, which stay alive as long as the reader
+	HRESULT hr = pFactory->CreateStream(&pStream);
+	if (SUCCEEDED(hr))
+	{
+		hr = pStream->InitializeFromMemory(
+			reinterpret_cast<BYTE*>(const_cast<char*>(file.GetData())), (DWORD)file.GetSize()
+		);
+	}
+	wrl::ComPtr<IWICBitmapDecoder> pDecoder;
+	if (SUCCEEDED(hr))
+	{
+		hr = pFactory->CreateDecoderFromStream(pStream.Get(), nullptr, WICDecodeMetadataCacheOnDemand, &pDecoder);
+	}
+	if (FAILED(hr))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to load image", hr);
+	}
+
+	wrl::ComPtr<IWICBitmapFrameDecode> pFrame;
+	if (FAILED(hr = pDecoder->GetFrame(0u, &pFrame)))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to decode image frame", hr);
+	}
+	pFrame->GetSize(&width, &height);
+
+	WICPixelFormatGUID pixelFormat;
+	pFrame->GetPixelFormat(&pixelFormat);
+	if (pixelFormat == GUID_WICPixelFormat32bppBGRA)
+	{
+		pSource = pFrame;
+		return;
+	}
+
+	// the converter only converts the rectangle requested by each CopyPixels call,
+	// so conversion happens strip by strip instead of on a second full size image
+	wrl::ComPtr<IWICFormatConverter> pConverter;
+	if (FAILED(hr = pFactory->CreateFormatConverter(&pConverter)))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to create format converter", hr);
+	}
+	hr = pConverter->Initialize(
+		pFrame.Get(), GUID_WICPixelFormat32bppBGRA,
+		WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeMedianCut
+	);
+	if (FAILED(hr))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to convert image", hr);
+	}
+	pSource = pConverter;
+}
+
+void SurfaceReader::OpenMapped()
+{
+	const auto pMapped = reinterpret_cast<const unsigned char*>(file.GetData());
+	const auto fileSize = file.GetSize();
+	DirectX::TexMetadata meta;
+	HRESULT hr = DirectX::GetMetadataFromDDSMemory(pMapped, fileSize, DirectX::DDS_FLAGS_NONE, meta);
+	if (FAILED(hr))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to read dds header", hr);
+	}
+	switch (meta.format)
+	{
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+		swizzleRB = false;
+		break;
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+		swizzleRB = true;
+		break;
+	default:
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Only uncompressed 32bpp dds images can be streamed");
+	}
+	if (meta.dimension != DirectX::TEX_DIMENSION_TEXTURE2D)
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Only 2D dds images can be streamed");
+	}
+
+	width = (unsigned int)meta.width;
+	height = (unsigned int)meta.height;
+	mappedPitch = size_t(width) * sizeof(Surface::Color);
+
+	// pixels of the top mip start right after the magic, the header and the optional dx10 header
+	const auto pHeader = reinterpret_cast<const DirectX::DDS_HEADER*>(pMapped + sizeof(uint32_t));
+	size_t offset = sizeof(uint32_t) + sizeof(DirectX::DDS_HEADER);
+	if ((pHeader->ddspf.flags & DDS_FOURCC) && pHeader->ddspf.fourCC == MAKEFOURCC('D', 'X', '1', '0'))
+	{
+		offset += sizeof(DirectX::DDS_HEADER_DXT10);
+	}
+	if (offset + mappedPitch * height > fileSize)
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Dds image is truncated");
+	}
+	pMappedPixels = pMapped + offset;
+}
+
+unsigned int SurfaceReader::GetWidth() const noexcept
+{
+	return width;
+}
+
+unsigned int SurfaceReader::GetHeight() const noexcept
+{
+	return height;
+}
+
+unsigned int SurfaceReader::GetStripHeight() const noexcept
+{
+	return stripHeight;
+}
+
+unsigned int SurfaceReader::GetNextRow() const noexcept
+{
+	return nextRow;
+}
+
+bool SurfaceReader::IsMapped() const noexcept
+{
+	return pMappedPixels != nullptr;
+}
+
+Surface SurfaceReader::MakeStrip() const
+{
+	return Surface(width, std::min(stripHeight, height));
+}
+
+unsigned int SurfaceReader::ReadStrip(Surface& strip)
+{
+	assert(strip.GetWidth() == width);
+	const auto nRows = std::min({ stripHeight, strip.GetHeight(), height - nextRow });
+	if (nRows == 0u)
+	{
+		return 0u;
+	}
+	ReadRows(nextRow, nRows, strip.GetBufferPtr());
+	nextRow += nRows;
+	return nRows;
+}
+
+Surface SurfaceReader::ReadAll()
+{
+	assert(nextRow == 0u);
+	Surface s(width, height);
+	auto pDest = s.GetBufferPtr();
+	while (nextRow < height)
+	{
+		const auto nRows = std::min(stripHeight, height - nextRow);
+		ReadRows(nextRow, nRows, pDest + size_t(nextRow) * width);
+		nextRow += nRows;
+	}
+	return s;
+}
+
+void SurfaceReader::ReadRows(unsigned int firstRow, unsigned int nRows, Surface::Color* pDest)
+{
+	const size_t pitch = size_t(width) * sizeof(Surface::Color);
+	if (IsMapped())
+	{
+		const auto pSrc = pMappedPixels + mappedPitch * firstRow;
+		std::memcpy(pDest, pSrc, pitch * nRows);
+		if (swizzleRB)
+		{
+			for (auto p = pDest, end = pDest + size_t(width) * nRows; p < end; p++)
+			{
+				const auto c = *p;
+				*p = { c.GetA(),c.GetB(),c.GetG(),c.GetR() };
+			}
+		}
+		return;
+	}
+
+	const WICRect rect = { 0,(INT)firstRow,(INT)width,(INT)nRows };
+	const HRESULT hr = pSource->CopyPixels(&rect, (UINT)pitch, (UINT)(pitch * nRows), reinterpret_cast<BYTE*>(pDest));
+	if (FAILED(hr))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to decode image strip", hr);
+	}
+}
+
+
+// SurfaceWriter
+SurfaceWriter::SurfaceWriter(const std::string& filename, unsigned int width, unsigned int height)
+	:
+	filename(filename),
+	width(width),
+	height(height)
+{
+	const auto ext = std::filesystem::path{ filename }.extension().string();
+	DirectX::WICCodecs codec;
+	if (ext == ".png")
+	{
+		codec = DirectX::WIC_CODEC_PNG;
+	}
+	else if (ext == ".jpg")
+	{
+		codec = DirectX::WIC_CODEC_JPEG;
+	}
+	else if (ext == ".bmp")
+	{
+		codec = DirectX::WIC_CODEC_BMP;
+	}
+	else
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Image format not supported");
+	}
+
+	bool iswic2 = false;
+	const auto pFactory = DirectX::GetWICFactory(iswic2);
+	HRESULT hr;
+	if (pFactory == nullptr || FAILED(hr = pFactory->CreateStream(&pStream)))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to create WIC stream");
+	}
+	if (FAILED(hr = pStream->InitializeFromFilename(ToWide(filename).c_str(), GENERIC_WRITE)))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to open image for writing", hr);
+	}
+	if (FAILED(hr = pFactory->CreateEncoder(DirectX::GetWICCodec(codec), nullptr, &pEncoder)) ||
+		FAILED(hr = pEncoder->Initialize(pStream.Get(), WICBitmapEncoderNoCache)))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to create image encoder", hr);
+	}
+	wrl::ComPtr<IPropertyBag2> pProps;
+	if (FAILED(hr = pEncoder->CreateNewFrame(&pFrame, &pProps)) ||
+		FAILED(hr = pFrame->Initialize(pProps.Get())) ||
+		FAILED(hr = pFrame->SetSize(width, height)))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to create image frame", hr);
+	}
+	WICPixelFormatGUID pixelFormat = GUID_WICPixelFormat32bppBGRA;
+	pFrame->SetPixelFormat(&pixelFormat);
+}
+
+SurfaceWriter::~SurfaceWriter()
+{}
+
+void SurfaceWriter::WriteStrip(const Surface& strip, unsigned int nRows)
+{
+	assert(strip.GetWidth() == width);
+	assert(nRows <= strip.GetHeight());
+	assert(nextRow + nRows <= height);
+
+	const UINT pitch = width * sizeof(Surface::Color);
+	auto pPixels = reinterpret_cast<BYTE*>(const_cast<Surface::Color*>(strip.GetBufferPtrConst()));
+
+	// WriteSource converts to whatever pixel format the encoder settled on (e.g. 24bpp for jpeg)
+	bool iswic2 = false;
+	wrl::ComPtr<IWICBitmap> pBitmap;
+	HRESULT hr = DirectX::GetWICFactory(iswic2)->CreateBitmapFromMemory(
+		width, nRows, GUID_WICPixelFormat32bppBGRA, pitch, pitch * nRows, pPixels, &pBitmap
+	);
+	if (FAILED(hr) || FAILED(hr = pFrame->WriteSource(pBitmap.Get(), nullptr)))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to write image strip", hr);
+	}
+	nextRow += nRows;
+}
+
+void SurfaceWriter::Commit()
+{
+	assert(!committed);
+	assert(nextRow == height);
+	HRESULT hr;
+	if (FAILED(hr = pFrame->Commit()) || FAILED(hr = pEncoder->Commit()))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, filename, "Failed to save image", hr);
+	}
+	committed = true;
+}
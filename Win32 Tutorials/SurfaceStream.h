@@ -0,0 +1,79 @@
+#pragma once
+#include "Surface.h"
+#include "Vfs.h"
+#include <wrl.h>
+#include <string>
+
+struct IWICBitmapSource;
+struct IWICBitmapEncoder;
+struct IWICBitmapFrameEncode;
+struct IWICStream;
+
+// Reads an image as strips of scanlines, converting each strip to BGRA as it is
+// decoded so that no second full size copy of the image is ever held in memory.
+// Images are read through the Vfs, uncompressed 32bpp .dds files are copied straight out of
+// the file's mapping.
+class SurfaceReader
+{
+public:
+	SurfaceReader(const std::string& filename, unsigned int stripHeight = defaultStripHeight);
+	SurfaceReader(const SurfaceReader&) = delete;
+	SurfaceReader& operator=(const SurfaceReader&) = delete;
+	~SurfaceReader();
+	unsigned int GetWidth() const noexcept;
+	unsigned int GetHeight() const noexcept;
+	unsigned int GetStripHeight() const noexcept;
+	// row in the image that the next call to ReadStrip will start at
+	unsigned int GetNextRow() const noexcept;
+	bool IsMapped() const noexcept;
+	// surface sized to hold one strip of this image
+	Surface MakeStrip() const;
+	// fills the top rows of the strip, returns the number of rows read (0 when finished)
+	unsigned int ReadStrip(Surface& strip);
+	// reads every remaining row into a single surface, without an intermediate copy
+	Surface ReadAll();
+public:
+	static constexpr unsigned int defaultStripHeight = 64u;
+private:
+	void OpenMapped();
+	void OpenWic();
+	void ReadRows(unsigned int firstRow, unsigned int nRows, Surface::Color* pDest);
+private:
+	std::string filename;
+	unsigned int width = 0u;
+	unsigned int height = 0u;
+	unsigned int stripHeight;
+	unsigned int nextRow = 0u;
+	// declared ahead of the decoder so it outlives it
+	Vfs::File file;
+	// wic path
+	Microsoft::WRL::ComPtr<IWICStream> pStream;
+	Microsoft::WRL::ComPtr<IWICBitmapSource> pSource;
+	// mapped path
+	const unsigned char* pMappedPixels = nullptr;
+	size_t mappedPitch = 0u;
+	bool swizzleRB = false;
+};
+
+// Encodes an image strip by strip, so the whole image never needs to be resident.
+class SurfaceWriter
+{
+public:
+	SurfaceWriter(const std::string& filename, unsigned int width, unsigned int height);
+	SurfaceWriter(const SurfaceWriter&) = delete;
+	SurfaceWriter& operator=(const SurfaceWriter&) = delete;
+	~SurfaceWriter();
+	// writes the top rows of the strip, strips must arrive in order
+	void WriteStrip(const Surface& strip, unsigned int nRows);
+	// finalizes the file, must be called once all rows have been written
+	void Commit();
+private:
+	std::string filename;
+	unsigned int width;
+	unsigned int height;
+	unsigned int nextRow = 0u;
+	bool committed = false;
+	Microsoft::WRL::ComPtr<IWICStream> pStream;
+	Microsoft::WRL::ComPtr<IWICBitmapEncoder> pEncoder;
+	Microsoft::WRL::ComPtr<IWICBitmapFrameEncode> pFrame;
+};
@@ -5,6 +5,7 @@
 #include "TransformCbufDoubleSlot.h"
 #include "imgui/imgui.h"
 #include "DynamicConstant.h"
+#include "ShaderPermutation.h"
 #include "TechniqueProbe.h"
 
 TestCube::TestCube(Graphics& gfx, float size)
@@ -15,6 +16,7 @@ TestCube::TestCube(Graphics& gfx, float size)
 	auto model = Cube::MakeIndependentTextured();
 	model.Transform(dx::XMMatrixScaling(size, size, size));
 	model.SetNormalsIndependentFlat();
+	SetBounds(model);
 	const auto geometryTag = "$cube." + std::to_string(size);
 	pVertices = VertexBuffer::Resolve(gfx, geometryTag, model.vertices);
 	pIndices = IndexBuffer::Resolve(gfx, geometryTag, model.indices);
@@ -28,20 +30,24 @@ TestCube::TestCube(Graphics& gfx, float size)
 			only.AddBindable(Texture::Resolve(gfx, "Images\\brickwall.jpg"));
 			only.AddBindable(Sampler::Resolve(gfx));
 
-			auto pvs = VertexShader::Resolve(gfx, "PhongDif_VS.cso");
+			auto pvs = VertexShader::Resolve(gfx, "Phong", ShaderPermutation::DiffuseMap);
 			auto pvsbc = pvs->GetBytecode();
 			only.AddBindable(std::move(pvs));
 
-			only.AddBindable(PixelShader::Resolve(gfx, "PhongDif_PS.cso"));
+			only.AddBindable(PixelShader::Resolve(gfx, "Phong", ShaderPermutation::DiffuseMap));
 
 			Dcb::RawLayout lay;
 			lay.Add<Dcb::Float3>("specularColor");
 			lay.Add<Dcb::Float>("specularWeight");
 			lay.Add<Dcb::Float>("specularGloss");
+			lay.Add<Dcb::Float4>("texTransform");
+			lay.Add<Dcb::Float>("texLayer");
 			auto buf = Dcb::Buffer(std::move(lay));
 			buf["specularColor"] = dx::XMFLOAT3{ 1.0f,1.0f,1.0f };
 			buf["specularWeight"] = 0.1f;
 			buf["specularGloss"] = 20.0f;
+			buf["texTransform"] = dx::XMFLOAT4{ 1.0f,1.0f,0.0f,0.0f };
+			buf["texLayer"] = 0.0f;
 
 			only.AddBindable(std::make_shared<Bind::CachingPixelConstantBufferEx>(gfx, buf, 1u));
 
@@ -49,11 +55,41 @@ TestCube::TestCube(Graphics& gfx, float size)
 
 			only.AddBindable(std::make_shared<TransformCbuf>(gfx));
 
+			// cubes of the same size and material share one instanced draw
+			auto pivs = VertexShader::Resolve(gfx, "PhongDifInst_VS.cso");
+			only.AddInstancedBindable(InputLayout::Resolve(gfx, model.vertices.GetLayout(), InstanceBuffer::GetLayout(), pivs->GetBytecode()));
+			only.AddInstancedBindable(std::move(pivs));
+
 			shade.AddStep(std::move(only));
 		}
 		AddTechnique(std::move(shade));
 	}
 
+	{
+		Technique depth("Depth");
+		{
+			Step only(3);
+
+			auto pvs = VertexShader::Resolve(gfx, "Solid_VS.cso");
+			auto pvsbc = pvs->GetBytecode();
+			only.AddBindable(std::move(pvs));
+
+			only.AddBindable(NullPixelShader::Resolve(gfx));
+
+			only.AddBindable(InputLayout::Resolve(gfx, model.vertices.GetLayout(), pvsbc));
+
+			only.AddBindable(std::make_shared<TransformCbuf>(gfx));
+
+			// drawn instanced alongside the shade step, so both place vertices the same way
+			auto pivs = VertexShader::Resolve(gfx, "SolidInst_VS.cso");
+			only.AddInstancedBindable(InputLayout::Resolve(gfx, model.vertices.GetLayout(), InstanceBuffer::GetLayout(), pivs->GetBytecode()));
+			only.AddInstancedBindable(std::move(pivs));
+
+			depth.AddStep(std::move(only));
+		}
+		AddTechnique(std::move(depth));
+	}
+
 	{
 		Technique outline("Outline");
 		{
@@ -63,7 +99,6 @@ TestCube::TestCube(Graphics& gfx, float size)
 			auto pvsbc = pvs->GetBytecode();
 			mask.AddBindable(std::move(pvs));
 
-			// TODO: better sub-layout generation tech for future consideration maybe
 			mask.AddBindable(InputLayout::Resolve(gfx, model.vertices.GetLayout(), pvsbc));
 
 			mask.AddBindable(std::make_shared<TransformCbuf>(gfx));
@@ -89,7 +124,6 @@ TestCube::TestCube(Graphics& gfx, float size)
 			buf["color"] = DirectX::XMFLOAT4{ 1.0f,0.4f,0.4f,1.0f };
 			draw.AddBindable(std::make_shared<Bind::CachingPixelConstantBufferEx>(gfx, buf, 1u));
 
-			// TODO: better sub-layout generation tech for future consideration maybe
 			draw.AddBindable(InputLayout::Resolve(gfx, model.vertices.GetLayout(), pvsbc));
 
 			draw.AddBindable(std::make_shared<TransformCbuf>(gfx));
@@ -9,6 +9,54 @@
 #include "Mesh.h"
 #include "Testing.h"
 #include "RedSkyXM.h"
+#include "RedSkyMath.h"
+#include "Surface.h"
+#include "SurfaceStream.h"
+#include <dxtex/DirectXTex.h>
+#include <psapi.h>
+#include <chrono>
+#include <sstream>
+#include "RedSkyUtility.h"
+#include "TextureResidency.h"
+#include "TexturePacker.h"
+#include "TexturePack.h"
+#include "Model.h"
+#include "FrameCommander.h"
+#include "GaussKernel.h"
+#include "TexturePreprocessor.h"
+#include <random>
+#include <thread>
+#include <iomanip>
+#include <algorithm>
+#include "PerformanceLog.h"
+#include "GpuTimerRing.h"
+#include "HeadlessBenchmark.h"
+#include "MeshBatcher.h"
+#include "LightBinner.h"
+#include "RenderGraph.h"
+#include "RenderTarget.h"
+#include "FramePacer.h"
+#include "ShaderCache.h"
+#include "ShaderPack.h"
+#include "Lz4.h"
+#include "AssetArchive.h"
+#include "Vfs.h"
+#include "InputSignature.h"
+#include "InputLayout.h"
+#include "StaticVertexLayout.h"
+#include "Sphere.h"
+#include "Plane.h"
+#include "Cube.h"
+#include "GeometryProcessor.h"
+#include "SpscQueue.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <cmath>
+#include <tuple>
+#include <type_traits>
 
 namespace dx = DirectX;
 
@@ -295,4 +343,1790 @@ void TestDynamicConstant()
 		auto buf = Dcb::Buffer(std::move(lay));
 		assert(buf.GetSizeInBytes() == 32u);
 	}
-}
\ No newline at end of file
+}
+
+void TestSurfaceStreaming(const std::string& path)
+{
+	using namespace std::chrono;
+	const auto PrivateBytes = []()
+	{
+		PROCESS_MEMORY_COUNTERS_EX pmc = {};
+		GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof(pmc));
+		return pmc.PrivateUsage;
+	};
+	// runs the path in its own scope and returns its peak committed memory above what was
+	// committed going in. The process peak counters only ever grow, so a sampler polls the
+	// current commit instead, every image buffer stays alive long enough to be seen
+	const auto MeasurePeak = [&PrivateBytes](auto&& run, float& seconds)
+	{
+		const auto baseline = PrivateBytes();
+		std::atomic<size_t> peak{ baseline };
+		std::atomic<bool> running{ true };
+		const auto sample = [&peak, &PrivateBytes]()
+		{
+			const auto bytes = PrivateBytes();
+			auto seen = peak.load();
+			while (seen < bytes && !peak.compare_exchange_weak(seen, bytes));
+		};
+		std::thread sampler{ [&running, &sample]()
+			{
+				while (running.load(std::memory_order_relaxed))
+				{
+					sample();
+					std::this_thread::sleep_for(milliseconds(1));
+				}
+			}
+		};
+		const auto t0 = steady_clock::now();
+		run(sample);
+		seconds = duration<float>(steady_clock::now() - t0).count();
+		running = false;
+		sampler.join();
+		return peak.load() - baseline;
+	};
+	const auto LoadLegacy = [&path](DirectX::ScratchImage& scratch, DirectX::ScratchImage& converted)
+	{
+		HRESULT hr = DirectX::LoadFromWICFile(ToWide(path).c_str(), DirectX::WIC_FLAGS_IGNORE_SRGB, nullptr, scratch);
+		assert(SUCCEEDED(hr));
+		const DirectX::Image* pImage = scratch.GetImage(0, 0, 0);
+		if (pImage->format != DXGI_FORMAT_B8G8R8A8_UNORM)
+		{
+			hr = DirectX::Convert(*pImage, DXGI_FORMAT_B8G8R8A8_UNORM, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, converted);
+			assert(SUCCEEDED(hr));
+			pImage = converted.GetImage(0, 0, 0);
+		}
+		return pImage;
+	};
+
+	// each path is measured with nothing left over from the other, the streamed one first
+	float streamedTime = 0.0f;
+	const auto streamedPeak = MeasurePeak([&path](auto&& sample)
+		{
+			const auto streamed = Surface::FromFile(path);
+			sample();
+		}, streamedTime
+	);
+	// previous path, full decode into one scratch then full conversion into a second
+	float legacyTime = 0.0f;
+	bool legacyConverted = false;
+	const auto legacyPeak = MeasurePeak([&LoadLegacy, &legacyConverted](auto&& sample)
+		{
+			DirectX::ScratchImage scratch;
+			DirectX::ScratchImage converted;
+			LoadLegacy(scratch, converted);
+			legacyConverted = converted.GetImageCount() != 0u;
+			sample();
+		}, legacyTime
+	);
+	// without a conversion both paths hold one full image, with one the streamed path must
+	// stay well clear of the two the previous path held
+	if (legacyConverted)
+	{
+		assert(streamedPeak * 4u < legacyPeak * 3u);
+	}
+
+	// both paths must produce the same pixels
+	const auto streamed = Surface::FromFile(path);
+	DirectX::ScratchImage scratch;
+	DirectX::ScratchImage converted;
+	const DirectX::Image* pLegacy = LoadLegacy(scratch, converted);
+	assert(pLegacy->width == streamed.GetWidth() && pLegacy->height == streamed.GetHeight());
+	for (unsigned int y = 0; y < streamed.GetHeight(); y++)
+	{
+		assert(std::memcmp(
+			pLegacy->pixels + pLegacy->rowPitch * y,
+			streamed.GetBufferPtrConst() + size_t(y) * streamed.GetWidth(),
+			size_t(streamed.GetWidth()) * sizeof(Surface::Color)
+		) == 0);
+	}
+
+	// strip reader must visit every row exactly once
+	{
+		SurfaceReader reader{ path,32u };
+		auto strip = reader.MakeStrip();
+		unsigned int rows = 0u;
+		while (const auto n = reader.ReadStrip(strip))
+		{
+			assert(strip.GetPixel(0u, 0u).dword == streamed.GetPixel(0u, rows).dword);
+			rows += n;
+		}
+		assert(rows == streamed.GetHeight());
+	}
+
+	const auto mpix = float(streamed.GetWidth()) * float(streamed.GetHeight()) / 1000000.0f;
+	std::ostringstream oss;
+	oss << "[Surface Streaming] " << path << "\n"
+		<< "streamed: " << mpix / streamedTime << " MPix/s, peak +" << streamedPeak / 1024u << " KiB\n"
+		<< "legacy:   " << mpix / legacyTime << " MPix/s, peak +" << legacyPeak / 1024u << " KiB\n";
+	OutputDebugStringA(oss.str().c_str());
+}
+
+void TestMipResidency()
+{
+	// records decisions instead of touching files or the gpu
+	class MockUploader : public TextureUploader
+	{
+	public:
+		void BeginUpload(size_t id, unsigned int firstMip) override
+		{
+			uploads.push_back({ id,firstMip });
+		}
+		void Evict(size_t id, unsigned int firstMip) override
+		{
+			evictions.push_back({ id,firstMip });
+		}
+		// completes every upload in flight
+		void Finish(MipResidency& res)
+		{
+			for (const auto& u : uploads)
+			{
+				res.OnUploadComplete(u.first, u.second);
+			}
+			uploads.clear();
+		}
+	public:
+		std::vector<std::pair<size_t, unsigned int>> uploads;
+		std::vector<std::pair<size_t, unsigned int>> evictions;
+	};
+
+	// required mip follows texel density
+	{
+		assert(MipResidency::ComputeRequiredMip(1024u, 1024u, 11u, 0.0f) == 0u);
+		assert(MipResidency::ComputeRequiredMip(1024u, 1024u, 11u, 2048.0f) == 0u);
+		assert(MipResidency::ComputeRequiredMip(1024u, 1024u, 11u, 1024.0f) == 0u);
+		assert(MipResidency::ComputeRequiredMip(1024u, 1024u, 11u, 256.0f) == 2u);
+		assert(MipResidency::ComputeRequiredMip(1024u, 512u, 11u, 100.0f) == 3u);
+		assert(MipResidency::ComputeRequiredMip(1024u, 1024u, 11u, 0.01f) == 10u);
+	}
+	// textures start with only their small mips and stream one level at a time
+	{
+		MockUploader up;
+		MipResidency res{ up };
+		const auto id = res.Register(1024u, 1024u, 11u, 4u);
+		assert(res.GetInitialMip(id) == 4u);
+		assert(res.GetResidentBytes() == MipResidency::ComputeResidentBytes(1024u, 1024u, 11u, 4u, 4u));
+		// no request, no upload
+		res.Update();
+		assert(up.uploads.empty());
+		for (unsigned int expected = 3u; ; expected--)
+		{
+			res.Request(id, 2u);
+			res.Update();
+			if (expected < 2u)
+			{
+				assert(up.uploads.empty());
+				break;
+			}
+			assert(up.uploads.size() == 1u && up.uploads[0].second == expected);
+			assert(res.IsUploading(id) && res.GetPendingBytes() > 0u);
+			// nothing new is issued while the level is in flight
+			res.Request(id, 0u);
+			res.Update();
+			assert(up.uploads.size() == 1u);
+			up.Finish(res);
+			assert(res.GetResidentMip(id) == expected && res.GetPendingBytes() == 0u);
+		}
+		assert(res.GetResidentBytes() == MipResidency::ComputeResidentBytes(1024u, 1024u, 11u, 4u, 2u));
+	}
+	// over budget, detail no longer requested is evicted to make room
+	{
+		MipResidency::Settings settings;
+		settings.framesUntilStale = 2u;
+		settings.budgetBytes = MipResidency::ComputeResidentBytes(256u, 256u, 9u, 4u, 0u) +
+			MipResidency::ComputeResidentBytes(256u, 256u, 9u, 4u, 2u);
+		MockUploader up;
+		MipResidency res{ up,settings };
+		const auto a = res.Register(256u, 256u, 9u, 4u);
+		const auto b = res.Register(256u, 256u, 9u, 4u);
+		while (res.GetResidentMip(a) != 0u)
+		{
+			res.Request(a, 0u);
+			res.Update();
+			up.Finish(res);
+		}
+		assert(up.evictions.empty());
+		// b alone fits up to mip 2 beside a, going further needs a to give up detail
+		for (int frame = 0; frame < 8; frame++)
+		{
+			res.Request(b, 0u);
+			res.Update();
+			up.Finish(res);
+			assert(res.GetResidentBytes() + res.GetPendingBytes() <= settings.budgetBytes);
+		}
+		assert(!up.evictions.empty() && up.evictions.front().first == a);
+		assert(res.GetResidentMip(b) == 0u && res.GetResidentMip(a) > 0u);
+	}
+	// requested textures are never evicted for others
+	{
+		MipResidency::Settings settings;
+		settings.budgetBytes = MipResidency::ComputeResidentBytes(256u, 256u, 9u, 4u, 0u) +
+			MipResidency::ComputeResidentBytes(256u, 256u, 9u, 4u, 2u);
+		MockUploader up;
+		MipResidency res{ up,settings };
+		const auto a = res.Register(256u, 256u, 9u, 4u);
+		const auto b = res.Register(256u, 256u, 9u, 4u);
+		for (int frame = 0; frame < 16; frame++)
+		{
+			res.Request(a, 0u);
+			res.Request(b, 0u);
+			res.Update();
+			up.Finish(res);
+		}
+		assert(up.evictions.empty());
+		assert(res.GetResidentBytes() <= settings.budgetBytes);
+	}
+}
+
+
+void TestRectPacking()
+{
+	const unsigned int pageSize = 1024u;
+	const unsigned int padding = 8u;
+	std::vector<TexturePacker::Rect> rects;
+	for (unsigned int i = 0; i < 40u; i++)
+	{
+		rects.push_back({ 64u << (i % 4u),64u << ((i / 4u) % 4u) });
+	}
+	const auto placements = TexturePacker::PackRects(rects, pageSize, padding);
+	assert(placements.size() == rects.size());
+	for (size_t i = 0; i < rects.size(); i++)
+	{
+		const auto& a = placements[i];
+		// padding stays inside the page
+		assert(a.x >= padding && a.y >= padding);
+		assert(a.x + rects[i].width + padding <= pageSize && a.y + rects[i].height + padding <= pageSize);
+		// padded rects on the same page never overlap
+		for (size_t j = 0; j < i; j++)
+		{
+			const auto& b = placements[j];
+			if (a.page != b.page)
+			{
+				continue;
+			}
+			assert(
+				a.x + rects[i].width + padding <= b.x - padding || b.x + rects[j].width + padding <= a.x - padding ||
+				a.y + rects[i].height + padding <= b.y - padding || b.y + rects[j].height + padding <= a.y - padding
+			);
+		}
+	}
+}
+
+void BenchmarkSrvBinds(Graphics& gfx, const std::string& objPath, float scale)
+{
+	// one frame of the model with its own textures, then with the packed arrays
+	std::ostringstream oss;
+	oss << "[SRV Binds] " << objPath << "\n";
+	for (const bool packed : { false,true })
+	{
+		TexturePack::SetEnabled(packed);
+		Model model{ gfx,objPath,scale };
+		FrameCommander fc{ gfx };
+		model.Submit(fc);
+		gfx.ResetBindState();
+		fc.Execute(gfx);
+		const auto& stats = gfx.GetBindStats();
+		oss << (packed ? "packed:   " : "unpacked: ") << stats.srvBinds << " binds, "
+			<< stats.srvBindsSkipped << " skipped as redundant\n";
+	}
+	TexturePack::SetEnabled(true);
+	OutputDebugStringA(oss.str().c_str());
+}
+
+
+void TestGaussKernel()
+{
+	// discrete and folded forms carry the same total weight
+	for (int radius : { 0,1,2,7,8,30 })
+	{
+		const GaussKernel k{ radius,float(radius) / 2.5f + 0.5f };
+		float sum = 0.0f;
+		for (auto w : k.GetWeights())
+		{
+			sum += w;
+		}
+		assert(std::abs(sum - 1.0f) < 0.0001f);
+		const auto& taps = k.GetFoldedTaps();
+		float foldedSum = taps[0].weight;
+		for (size_t i = 1; i < taps.size(); i++)
+		{
+			foldedSum += 2.0f * taps[i].weight;
+			// folded samples always land between the two texels they merge
+			assert(taps[i].offset >= float(2 * i - 1) && taps[i].offset <= float(2 * i));
+		}
+		assert(std::abs(foldedSum - 1.0f) < 0.0001f);
+		assert(k.GetDiscreteFetchCount() == (unsigned int)(2 * radius + 1));
+		assert(k.GetFoldedFetchCount() == (unsigned int)(2 * ((radius + 1) / 2) + 1));
+	}
+	// folded taps under linear filtering reproduce the discrete convolution
+	{
+		std::mt19937 rng{ 69 };
+		std::uniform_int_distribution<unsigned int> dist{ 0u,255u };
+		Surface reference{ 61u,47u };
+		for (unsigned int y = 0; y < reference.GetHeight(); y++)
+		{
+			for (unsigned int x = 0; x < reference.GetWidth(); x++)
+			{
+				reference.PutPixel(x, y, { (unsigned char)dist(rng),(unsigned char)dist(rng),(unsigned char)dist(rng),(unsigned char)dist(rng) });
+			}
+		}
+		Surface folded{ reference.GetWidth(),reference.GetHeight() };
+		std::memcpy(folded.GetBufferPtr(), reference.GetBufferPtrConst(), size_t(reference.GetWidth()) * reference.GetHeight() * sizeof(Surface::Color));
+		const GaussKernel k{ 11,4.0f };
+		TexturePreprocessor::GaussianBlur(reference, k, false);
+		TexturePreprocessor::GaussianBlur(folded, k, true);
+		for (unsigned int y = 0; y < reference.GetHeight(); y++)
+		{
+			for (unsigned int x = 0; x < reference.GetWidth(); x++)
+			{
+				const auto a = reference.GetPixel(x, y);
+				const auto b = folded.GetPixel(x, y);
+				for (unsigned int shift = 0u; shift < 32u; shift += 8u)
+				{
+					assert(std::abs(int((a.dword >> shift) & 0xFFu) - int((b.dword >> shift) & 0xFFu)) <= 1);
+				}
+			}
+		}
+	}
+}
+
+void TestBlurCostModel()
+{
+	// cost per frame of the outline blur at 1080p for each downsample factor
+	std::ostringstream oss;
+	oss << "[Blur Cost] 1920x1080 radius 7 sigma 2.6\n";
+	size_t lastFetches = 0u;
+	for (int factor : { 8,4,2,1 })
+	{
+		const auto cost = BlurPack::EstimateCost(1920u, 1080u, 7, 2.6f, factor);
+		const auto blended = BlurPack::EstimateCost(1920u, 1080u, 7, 2.6f, factor, true);
+		// every halving must pay for itself, even with the extra copy and upsample passes
+		assert(cost.fetches > lastFetches);
+		assert(blended.fetches == cost.fetches + 1920u * 1080u);
+		lastFetches = cost.fetches;
+		oss << "1/" << factor << ": " << cost.fetches << " fetches, " << cost.pixels << " pixels ("
+			<< blended.fetches << " fetches with blend upsample)\n";
+	}
+	// full resolution is exactly two folded passes over the frame
+	assert(BlurPack::EstimateCost(1920u, 1080u, 7, 2.6f, 1).fetches == 2u * 1920u * 1080u * GaussKernel{ 7,2.6f }.GetFoldedFetchCount());
+	OutputDebugStringA(oss.str().c_str());
+}
+
+void TestProfiler()
+{
+	// zones nest under their parent and aggregate per frame, worker threads report separately
+	const auto framesBefore = Profiler::GetFrameCount();
+	for (int frame = 0; frame < 10; frame++)
+	{
+		{
+			PROFILE_ZONE("Test outer");
+			for (int i = 0; i < 3; i++)
+			{
+				PROFILE_ZONE("Test inner");
+				std::this_thread::sleep_for(std::chrono::microseconds{ 200 });
+			}
+		}
+		std::thread{ []() { PROFILE_ZONE("Test worker"); } }.join();
+		Profiler::EndFrame();
+	}
+	assert(Profiler::GetFrameCount() == framesBefore + 10u);
+	const auto stats = Profiler::GetStats();
+	const auto find = [&stats](const char* name)
+	{
+		return std::find_if(stats.begin(), stats.end(), [name](const Profiler::ZoneStats& s) { return std::string{ s.zone->name } == name; });
+	};
+	const auto outer = find("Test outer");
+	const auto inner = find("Test inner");
+	const auto worker = find("Test worker");
+	assert(outer != stats.end() && inner != stats.end() && worker != stats.end());
+	assert(inner == outer + 1 && inner->parent == outer->zone && inner->depth == outer->depth + 1u);
+	assert(outer->calls == 1.0f && inner->calls == 3.0f);
+	assert(inner->minMs >= 0.6f && inner->minMs <= inner->avgMs && inner->avgMs <= inner->p95Ms && inner->p95Ms <= inner->maxMs);
+	assert(outer->minMs >= inner->minMs);
+	assert(worker->thread != outer->thread);
+	// each worker exited before the next started, so all of them recorded into one ring
+	assert(std::count_if(stats.begin(), stats.end(), [](const Profiler::ZoneStats& s) { return std::string{ s.zone->name } == "Test worker"; }) == 1);
+	assert(worker->frames == 10u);
+}
+
+void BenchmarkProfiler()
+{
+	// cost of recording a zone, relative to an empty loop, flat and nested
+	constexpr int count = 1000000;
+	constexpr int framesEvery = Profiler::ThreadRing::capacity / 4;
+	using Clock = std::chrono::steady_clock;
+	std::ostringstream oss;
+	oss << "[Profiler Overhead] " << count << " zones\n";
+
+	volatile int sink = 0;
+	auto start = Clock::now();
+	for (int i = 0; i < count; i++)
+	{
+		sink = i;
+	}
+	const auto baseline = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+	start = Clock::now();
+	for (int i = 0; i < count; i++)
+	{
+		PROFILE_ZONE("Benchmark flat");
+		sink = i;
+		if (i % framesEvery == 0)
+		{
+			Profiler::EndFrame();
+		}
+	}
+	const auto flat = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+	start = Clock::now();
+	for (int i = 0; i < count / 4; i++)
+	{
+		PROFILE_ZONE("Benchmark nest 0");
+		{
+			PROFILE_ZONE("Benchmark nest 1");
+			{
+				PROFILE_ZONE("Benchmark nest 2");
+				{
+					PROFILE_ZONE("Benchmark nest 3");
+					sink = i;
+				}
+			}
+		}
+		if (i % (framesEvery / 4) == 0)
+		{
+			Profiler::EndFrame();
+		}
+	}
+	const auto nested = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+	Profiler::EndFrame();
+
+	oss << std::fixed << std::setprecision(1)
+		<< "flat:   " << (flat - baseline) / count << "ns per zone (including EndFrame drains)\n"
+		<< "nested: " << (nested - baseline / 4.0) / count << "ns per zone at depth 4\n"
+		<< "dropped: " << Profiler::GetDroppedCount() << "\n";
+	OutputDebugStringA(oss.str().c_str());
+}
+
+void TestGpuTimerRing()
+{
+	// a gpu that finishes frames a fixed number of frames after they were recorded
+	class MockQuerySource : public GpuQuerySource
+	{
+	public:
+		MockQuerySource(size_t slots, size_t queries, uint64_t latency)
+			:
+			latency(latency),
+			timestamps(slots * queries),
+			queriesPerSlot(queries),
+			issuedFrame(slots)
+		{}
+		void BeginDisjoint(size_t slot) override
+		{
+			issuedFrame[slot] = frame;
+		}
+		void EndDisjoint(size_t) override {}
+		void Timestamp(size_t slot, size_t query) override
+		{
+			// each query lands 1000 ticks after the previous one, 1us at 1GHz
+			clock += 1000u;
+			timestamps[slot * queriesPerSlot + query] = clock;
+			writes++;
+		}
+		bool ReadDisjoint(size_t slot, uint64_t& frequency, bool& disjoint) override
+		{
+			reads++;
+			if (frame < issuedFrame[slot] + latency)
+			{
+				return false;
+			}
+			frequency = 1000000000u;
+			disjoint = issuedFrame[slot] == disjointFrame;
+			return true;
+		}
+		bool ReadTimestamp(size_t slot, size_t query, uint64_t& ticks) override
+		{
+			ticks = timestamps[slot * queriesPerSlot + query];
+			return true;
+		}
+	public:
+		uint64_t frame = 0u;
+		uint64_t latency;
+		uint64_t disjointFrame = ~uint64_t(0);
+		size_t writes = 0u;
+		size_t reads = 0u;
+	private:
+		uint64_t clock = 0u;
+		std::vector<uint64_t> timestamps;
+		size_t queriesPerSlot;
+		std::vector<uint64_t> issuedFrame;
+	};
+	static constexpr ProfileZone outer{ "Test gpu outer",__FILE__,__LINE__ };
+	static constexpr ProfileZone inner{ "Test gpu inner",__FILE__,__LINE__ };
+	const auto runFrame = [](GpuTimerRing& ring, MockQuerySource& src, std::vector<GpuTimerRing::FrameTimings>& out)
+	{
+		for (auto& f : ring.Collect())
+		{
+			out.push_back(std::move(f));
+		}
+		ring.BeginFrame(int64_t(src.frame));
+		const auto o = ring.Begin(outer);
+		const auto i = ring.Begin(inner);
+		ring.End(i);
+		ring.End(o);
+		ring.EndFrame();
+		src.frame++;
+	};
+
+	// results arrive in order, latency frames late, with nesting and durations intact
+	{
+		MockQuerySource src{ 4u,1u + 2u * 4u,2u };
+		GpuTimerRing ring{ src,4u,4u };
+		std::vector<GpuTimerRing::FrameTimings> frames;
+		for (int i = 0; i < 10; i++)
+		{
+			runFrame(ring, src, frames);
+		}
+		assert(ring.GetSkippedFrames() == 0u);
+		assert(frames.size() == 8u);
+		for (size_t i = 0; i < frames.size(); i++)
+		{
+			const auto& f = frames[i];
+			assert(f.frame == i + 1u && f.cpuStart == int64_t(i));
+			assert(f.stages.size() == 2u);
+			assert(f.stages[0].zone == &outer && f.stages[0].parent == nullptr && f.stages[0].depth == 0u);
+			assert(f.stages[1].zone == &inner && f.stages[1].parent == &outer && f.stages[1].depth == 1u);
+			// begin outer, begin inner, end inner, end outer, one microsecond apart
+			assert(std::abs(f.stages[0].startMs - 0.001f) < 1e-6f && std::abs(f.stages[0].ms - 0.003f) < 1e-6f);
+			assert(std::abs(f.stages[1].startMs - 0.002f) < 1e-6f && std::abs(f.stages[1].ms - 0.001f) < 1e-6f);
+		}
+	}
+	// a gpu further behind than the ring skips frames instead of waiting or overwriting queries
+	{
+		MockQuerySource src{ 2u,1u + 2u * 4u,5u };
+		GpuTimerRing ring{ src,2u,4u };
+		std::vector<GpuTimerRing::FrameTimings> frames;
+		for (int i = 0; i < 12; i++)
+		{
+			runFrame(ring, src, frames);
+		}
+		assert(ring.GetSkippedFrames() > 0u);
+		assert(!frames.empty());
+		for (size_t i = 1; i < frames.size(); i++)
+		{
+			assert(frames[i].frame > frames[i - 1u].frame);
+		}
+		// only timed frames write queries, 5 per frame
+		assert(src.writes == (12u - size_t(ring.GetSkippedFrames())) * 5u);
+	}
+	// disjoint frames are dropped, too many stages are ignored
+	{
+		MockQuerySource src{ 2u,1u + 2u * 1u,1u };
+		GpuTimerRing ring{ src,2u,1u };
+		src.disjointFrame = 1u;
+		std::vector<GpuTimerRing::FrameTimings> frames;
+		for (int i = 0; i < 4; i++)
+		{
+			runFrame(ring, src, frames);
+		}
+		assert(ring.GetDisjointFrames() == 1u);
+		assert(frames.size() == 2u && frames[0].frame == 1u);
+		assert(frames[0].stages.size() == 1u && frames[0].stages[0].zone == &outer);
+	}
+}
+
+void BenchmarkInstancing(unsigned int cubeCount)
+{
+	// the same grid of cubes drawn one job per draw and merged into instanced draws
+	std::ostringstream oss;
+	oss << "[Instancing] " << cubeCount << " cubes\n";
+	for (bool instancing : { false,true })
+	{
+		HeadlessBenchmark::Settings settings;
+		settings.scene = "cubes";
+		settings.cubeCount = cubeCount;
+		settings.frames = 120u;
+		settings.instancing = instancing;
+		const auto r = HeadlessBenchmark::Run(settings);
+		const auto frames = float(settings.frames);
+		oss << (instancing ? "instanced:  " : "individual: ")
+			<< r.avgFrameMs << "ms/frame, "
+			<< float(r.drawCalls) / frames << " draws, "
+			<< float(r.instancedJobs) / frames << " of " << float(r.jobs) / frames << " jobs collapsed, "
+			<< float(r.bindableBinds) / frames << " binds per frame\n";
+	}
+	OutputDebugStringA(oss.str().c_str());
+}
+
+void TestMeshBatcher()
+{
+	using rsexp::VertexLayout;
+	namespace dx = DirectX;
+	VertexLayout pn;
+	pn.Append(VertexLayout::Position3D).Append(VertexLayout::Normal);
+	VertexLayout pt;
+	pt.Append(VertexLayout::Position3D).Append(VertexLayout::Texture2D);
+	const auto makeQuad = [](const VertexLayout& layout, float z)
+	{
+		rsexp::VertexBuffer vb{ layout,4u };
+		for (size_t i = 0; i < 4u; i++)
+		{
+			vb[i].Attr<VertexLayout::Position3D>() = { float(i & 1u),float(i >> 1u),z };
+		}
+		return vb;
+	};
+	const std::vector<unsigned short> quad = { 0,1,2,1,3,2 };
+
+	MeshBatcher batcher;
+	const auto a = batcher.Add(makeQuad(pn, 0.0f), quad);
+	const auto b = batcher.Add(makeQuad(pt, 1.0f), quad);
+	const auto c = batcher.Add(makeQuad(pn, 2.0f), quad);
+	// meshes are grouped by layout, ranges follow one another within a batch
+	assert(batcher.GetBatches().size() == 2u);
+	assert(a.batch == c.batch && a.batch != b.batch);
+	assert(a.startIndex == 0u && a.baseVertex == 0 && a.indexCount == 6u);
+	assert(c.startIndex == 6u && c.baseVertex == 4 && c.indexCount == 6u);
+	assert(b.startIndex == 0u && b.baseVertex == 0);
+	const auto& merged = batcher.GetBatches()[a.batch];
+	assert(merged.meshCount == 2u);
+	assert(merged.vertices.Size() == 8u && merged.indices.size() == 12u);
+	// indices stay local, the base vertex finds the mesh's own vertices
+	for (size_t i = 0; i < c.indexCount; i++)
+	{
+		const auto v = merged.vertices[c.baseVertex + merged.indices[c.startIndex + i]];
+		assert(v.Attr<VertexLayout::Position3D>().z == 2.0f);
+	}
+	assert(merged.indices[c.startIndex] == quad[0]);
+}
+
+void BenchmarkMeshBatcher(const std::string& path, float scale)
+{
+	// cpu cost of merging a scene at load, relative to extracting its meshes separately
+	using Clock = std::chrono::steady_clock;
+	Assimp::Importer imp;
+	const auto pScene = imp.ReadFile(path.c_str(),
+		aiProcess_Triangulate |
+		aiProcess_JoinIdenticalVertices |
+		aiProcess_ConvertToLeftHanded |
+		aiProcess_GenNormals |
+		aiProcess_CalcTangentSpace
+	);
+	if (pScene == nullptr)
+	{
+		return;
+	}
+	const auto extract = [scale](const aiMesh& mesh)
+	{
+		rsexp::VertexLayout layout;
+		layout.Append(rsexp::VertexLayout::Position3D).Append(rsexp::VertexLayout::Normal);
+		if (mesh.HasTextureCoords(0))
+		{
+			layout.Append(rsexp::VertexLayout::Texture2D);
+		}
+		rsexp::VertexBuffer vb{ std::move(layout),mesh };
+		for (size_t i = 0; i < vb.Size(); i++)
+		{
+			auto& pos = vb[i].Attr<rsexp::VertexLayout::Position3D>();
+			pos = { pos.x * scale,pos.y * scale,pos.z * scale };
+		}
+		std::vector<unsigned short> indices;
+		indices.reserve(mesh.mNumFaces * 3u);
+		for (unsigned int f = 0; f < mesh.mNumFaces; f++)
+		{
+			for (unsigned int k = 0; k < 3u; k++)
+			{
+				indices.push_back((unsigned short)mesh.mFaces[f].mIndices[k]);
+			}
+		}
+		return std::make_pair(std::move(vb), std::move(indices));
+	};
+
+	auto start = Clock::now();
+	size_t bytes = 0u;
+	for (unsigned int i = 0; i < pScene->mNumMeshes; i++)
+	{
+		bytes += extract(*pScene->mMeshes[i]).first.SizeBytes();
+	}
+	const auto separateMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+	start = Clock::now();
+	MeshBatcher batcher;
+	for (unsigned int i = 0; i < pScene->mNumMeshes; i++)
+	{
+		const auto geometry = extract(*pScene->mMeshes[i]);
+		batcher.Add(geometry.first, geometry.second);
+	}
+	const auto mergedMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+	std::ostringstream oss;
+	oss << "[Mesh Batching] " << path << "\n"
+		<< pScene->mNumMeshes << " meshes, " << bytes / 1024u << " KiB of vertices into " << batcher.GetBatches().size() << " buffer pairs\n"
+		<< "separate: " << separateMs << "ms, merged: " << mergedMs << "ms\n";
+	OutputDebugStringA(oss.str().c_str());
+}
+
+void TestLightBinner()
+{
+	const auto proj = dx::XMMatrixPerspectiveLH(1.0f, 9.0f / 16.0f, 0.5f, 400.0f);
+	LightBinner binner{ 0u };
+	binner.SetView(proj, 1280u, 720u, 16u);
+	assert(binner.GetTilesX() == 80u && binner.GetTilesY() == 45u);
+	const auto contains = [](const LightBinner& b, uint32_t x, uint32_t y, uint32_t light)
+	{
+		const auto& t = b.GetTileRanges()[size_t(y) * b.GetTilesX() + x];
+		const auto first = b.GetLightIndices().begin() + t.offset;
+		return std::find(first, first + t.count, light) != first + t.count;
+	};
+	// small light dead ahead, one behind the eye, one larger than the view
+	binner.Bin({
+		{ { 0.0f,0.0f,10.0f },0.1f },
+		{ { 0.0f,0.0f,-10.0f },1.0f },
+		{ { 0.0f,0.0f,10.0f },1000.0f },
+	});
+	assert(contains(binner, 40u, 22u, 0u) && contains(binner, 39u, 22u, 0u));
+	assert(!contains(binner, 0u, 0u, 0u) && !contains(binner, 79u, 44u, 0u));
+	for (uint32_t y = 0; y < binner.GetTilesY(); y++)
+	{
+		for (uint32_t x = 0; x < binner.GetTilesX(); x++)
+		{
+			assert(!contains(binner, x, y, 1u));
+			assert(contains(binner, x, y, 2u));
+		}
+	}
+
+	// threads only change who bins which row, and the tile under a light's center has it
+	std::mt19937 rng{ 7u };
+	std::uniform_real_distribution<float> xy{ -60.0f,60.0f };
+	std::uniform_real_distribution<float> z{ 0.5f,120.0f };
+	std::uniform_real_distribution<float> r{ 0.5f,5.0f };
+	std::vector<LightBinner::Sphere> lights;
+	for (int i = 0; i < 4096; i++)
+	{
+		lights.push_back({ { xy(rng),xy(rng) * 0.5f,z(rng) },r(rng) });
+	}
+	LightBinner threaded{ 3u };
+	threaded.SetView(proj, 1280u, 720u, 16u);
+	binner.Bin(lights);
+	threaded.Bin(lights);
+	assert(binner.GetLightIndices() == threaded.GetLightIndices());
+	dx::XMFLOAT4X4 p;
+	dx::XMStoreFloat4x4(&p, proj);
+	for (uint32_t i = 0; i < lights.size(); i++)
+	{
+		const auto& c = lights[i].center;
+		const auto ndcX = c.x * p._11 / c.z;
+		const auto ndcY = c.y * p._22 / c.z;
+		if (std::abs(ndcX) < 1.0f && std::abs(ndcY) < 1.0f)
+		{
+			const auto px = uint32_t((ndcX * 0.5f + 0.5f) * 1280.0f);
+			const auto py = uint32_t((0.5f - ndcY * 0.5f) * 720.0f);
+			assert(contains(binner, px / 16u, py / 16u, i));
+		}
+	}
+}
+
+void BenchmarkLightBinning(unsigned int lightCount)
+{
+	// lights spread through the view volume at 720p, single threaded and on the worker pool
+	using Clock = std::chrono::steady_clock;
+	constexpr int iterations = 100;
+	const auto proj = dx::XMMatrixPerspectiveLH(1.0f, 9.0f / 16.0f, 0.5f, 400.0f);
+	std::mt19937 rng{ 7u };
+	std::uniform_real_distribution<float> xy{ -80.0f,80.0f };
+	std::uniform_real_distribution<float> z{ 1.0f,150.0f };
+	std::uniform_real_distribution<float> r{ 2.0f,10.0f };
+	std::vector<LightBinner::Sphere> lights;
+	for (unsigned int i = 0; i < lightCount; i++)
+	{
+		lights.push_back({ { xy(rng),xy(rng) * 0.5f,z(rng) },r(rng) });
+	}
+
+	std::ostringstream oss;
+	oss << "[Light Binning] " << lightCount << " lights, 1280x720 in 16px tiles\n";
+	for (const auto workers : { 0u,LightBinner::DefaultWorkerCount() })
+	{
+		LightBinner binner{ workers };
+		binner.SetView(proj, 1280u, 720u, 16u);
+		binner.Bin(lights);
+		const auto start = Clock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			binner.Bin(lights);
+			Profiler::EndFrame();
+		}
+		const auto ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+		const auto tiles = binner.GetTileRanges().size();
+		oss << std::fixed << std::setprecision(3)
+			<< workers + 1u << " threads: " << ms << "ms, "
+			<< float(binner.GetLightIndices().size()) / float(tiles) << " avg / "
+			<< binner.GetMaxLightsPerTile() << " max lights per tile\n";
+	}
+	OutputDebugStringA(oss.str().c_str());
+}
+
+void BenchmarkDepthPrepass(Graphics::Backend backend)
+{
+	// sponza shaded after a depth pre-pass and front to back without one, the gpu stages
+	// only mean something on a real device
+	std::ostringstream oss;
+	oss << "[Depth Pre-pass] sponza\n" << std::fixed << std::setprecision(3);
+	for (bool prepass : { false,true })
+	{
+		HeadlessBenchmark::Settings settings;
+		settings.frames = 300u;
+		settings.depthPrepass = prepass;
+		settings.backend = backend;
+		const auto r = HeadlessBenchmark::Run(settings);
+		const auto frames = float(settings.frames);
+		oss << (prepass ? "pre-pass:      " : "front to back: ")
+			<< r.avgFrameMs << "ms/frame, " << float(r.drawCalls) / frames << " draws";
+		for (const auto& s : r.stages)
+		{
+			if (std::string{ s.zone->name } == "Depth pre-pass" || std::string{ s.zone->name } == "Phong pass")
+			{
+				oss << ", " << s.zone->name << " " << s.avgMs << "ms";
+			}
+		}
+		oss << "\n";
+	}
+	OutputDebugStringA(oss.str().c_str());
+}
+
+void TestRenderGraph()
+{
+	using Desc = RenderGraph::TextureDesc;
+	// the frame's shape, plus a pass nothing visible depends on
+	RenderGraph graph;
+	const auto depth = graph.CreateTexture("Depth", { Desc::Type::Depth,1280u,720u });
+	const auto scene = graph.CreateTexture("Scene", { Desc::Type::Color,1280u,720u });
+	const auto half = graph.CreateTexture("Half", { Desc::Type::Color,640u,360u });
+	const auto horizontal = graph.CreateTexture("Horizontal", { Desc::Type::Color,640u,360u });
+	const auto vertical = graph.CreateTexture("Vertical", { Desc::Type::Color,640u,360u });
+	const auto debug = graph.CreateTexture("Debug", { Desc::Type::Color,1280u,720u });
+	const auto swap = graph.Import("Swap");
+	graph.AddPass("Prepass").Write(depth);
+	graph.AddPass("Phong").Write(depth).Write(scene);
+	graph.AddPass("Debug view").Read(depth).Write(debug);
+	graph.AddPass("Down").Read(scene).Write(half);
+	graph.AddPass("Horizontal").Read(half).Write(horizontal);
+	graph.AddPass("Vertical").Read(horizontal).Write(vertical);
+	graph.AddPass("Composite").Read(vertical).Write(swap);
+	graph.Compile();
+
+	assert(graph.IsCulled(2u) && !graph.IsCulled(0u) && !graph.IsCulled(6u));
+	const std::vector<RenderGraph::PassId> expected = { 0u,1u,3u,4u,5u,6u };
+	assert(graph.GetOrder() == expected);
+	assert(graph.GetPhysicalIndex(debug) == RenderGraph::npos);
+	assert(graph.GetPhysicalIndex(swap) == RenderGraph::npos);
+	// the half size level is done once the horizontal pass read it
+	assert(graph.GetPhysicalIndex(vertical) == graph.GetPhysicalIndex(half));
+	assert(graph.GetPhysicalIndex(horizontal) != graph.GetPhysicalIndex(half));
+	assert(graph.GetPhysicalDescs().size() == 4u);
+	assert(graph.GetPhysicalBytes() < graph.GetTransientBytes());
+
+	// independent passes share a group, and a write waits for earlier readers
+	graph.Clear();
+	const auto a = graph.CreateTexture("A", { Desc::Type::Color,64u,64u });
+	const auto b = graph.CreateTexture("B", { Desc::Type::Color,64u,64u });
+	const auto out = graph.Import("Out");
+	graph.AddPass("Fill A").Write(a);
+	graph.AddPass("Fill B").Write(b);
+	graph.AddPass("Combine").Read(a).Read(b).Write(out);
+	graph.AddPass("Refill A").Write(a);
+	graph.AddPass("Show A").Read(a).Write(out);
+	graph.Compile();
+	const auto& groups = graph.GetParallelGroups();
+	assert(groups.size() == 4u);
+	assert((groups[0] == std::vector<RenderGraph::PassId>{ 0u,1u }));
+	assert((groups[1] == std::vector<RenderGraph::PassId>{ 2u }));
+	assert((groups[2] == std::vector<RenderGraph::PassId>{ 3u }));
+	// both of A's lifetimes overlap B's, so nothing is shared
+	assert(graph.GetPhysicalDescs().size() == 2u);
+}
+
+void TestFramePacer()
+{
+	// steady 60hz with one present two refreshes late
+	FramePacer pacer{ 60.0f,8u };
+	const double period = 1000.0 / 60.0;
+	double t = 0.0;
+	for (int i = 0; i < 6; i++)
+	{
+		pacer.OnPresent(t);
+		t += i == 3 ? period * 3.0 : period;
+	}
+	auto stats = pacer.GetStats();
+	assert(stats.presents == 6u && stats.dropped == 2u);
+	assert(std::abs(stats.maxMs - float(period * 3.0)) < 0.01f);
+	assert(std::abs(stats.lastMs - float(period)) < 0.01f);
+	// jitter under half a refresh isn't a drop
+	pacer.OnPresent(t + period * 0.4);
+	assert(pacer.GetStats().dropped == 2u);
+
+	// with frame statistics, drops come from vblanks that repeated a frame
+	pacer.OnFrameStatistics(100u, 1000u);
+	pacer.OnFrameStatistics(110u, 1010u);
+	assert(pacer.GetStats().dropped == 2u);
+	pacer.OnFrameStatistics(115u, 1018u);
+	assert(pacer.GetStats().dropped == 5u);
+	// timing no longer counts once statistics arrive
+	pacer.OnPresent(t + period * 10.0);
+	assert(pacer.GetStats().dropped == 5u);
+	// counts wrapping around
+	pacer.OnFrameStatistics(0xfffffff0u, 0xfffffff8u);
+	pacer.OnFrameStatistics(0x10u, 0x19u);
+	assert(pacer.GetStats().dropped == 6u);
+
+	// nothing is due with vsync off
+	FramePacer unsynced{ 60.0f };
+	unsynced.SetSyncInterval(0u);
+	unsynced.OnPresent(0.0);
+	unsynced.OnPresent(100.0);
+	assert(unsynced.GetStats().dropped == 0u && unsynced.GetStats().avgMs == 100.0f);
+}
+
+void TestShaderPermutations()
+{
+	using Perm = ShaderPermutation;
+	// keys collapse to what each stage can tell apart
+	assert(Perm::Canonical({ "Phong",Perm::Stage::Pixel,Perm::Mask }).features == 0u);
+	assert(Perm::Canonical({ "Phong",Perm::Stage::Vertex,Perm::SpecularMap | Perm::NormalMap }).features == (Perm::DiffuseMap | Perm::NormalMap));
+	assert(Perm::GetName({ "Phong",Perm::Stage::Pixel,Perm::DiffuseMap | Perm::NormalMap }) == "Phong_PS[DIFFUSE_MAP,NORMAL_MAP]");
+	const auto keys = Perm::Enumerate("Phong");
+	// 3 vertex shaders, 16 pixel keys less the 4 masks without a diffuse map
+	assert(keys.size() == 15u);
+
+	// a fake compiler whose bytecode is the file name and defines
+	const auto root = std::filesystem::temp_directory_path() / "redsky-shader-test";
+	std::filesystem::remove_all(root);
+	std::filesystem::create_directories(root / "src");
+	const auto write = [&root](const char* name, const char* text)
+	{
+		std::ofstream{ root / "src" / name } << text;
+	};
+	write("Phong_PS.hlsl", "#include \"Common.hlsl\"\nfloat4 main() : SV_Target;");
+	write("Phong_VS.hlsl", "float4 main() : SV_Position;");
+	write("Common.hlsl", "float3 ambient;");
+	std::atomic<size_t> compiles = 0u;
+	const auto compile = [&compiles](const std::string& path, const Perm::Defines& defines, const char* profile)
+	{
+		compiles++;
+		auto text = std::filesystem::path{ path }.filename().string() + profile;
+		for (const auto& d : defines)
+		{
+			text += " " + d.first;
+		}
+		return ShaderCache::Bytecode(text.begin(), text.end());
+	};
+	const auto src = (root / "src").string();
+	const auto dst = (root / "cache").string();
+	const Perm::Key dif{ "Phong",Perm::Stage::Pixel,Perm::DiffuseMap };
+	{
+		ShaderCache cache{ src,dst,compile };
+		const auto pCode = cache.Load(dif);
+		assert(std::string(pCode->begin(), pCode->end()) == "Phong_PS.hlslps_5_0 DIFFUSE_MAP");
+		assert(cache.Load(dif) == pCode);
+		// cooking compiles what's missing on several threads
+		assert(cache.Cook(keys, 4u) == keys.size() - 1u);
+		const auto stats = cache.GetStats();
+		assert(stats.compiles == keys.size() && stats.memoryHits == 2u && stats.diskHits == 0u);
+	}
+	// a new run reads everything from disk
+	{
+		ShaderCache cache{ src,dst,compile };
+		assert(cache.Cook(keys, 2u) == 0u);
+		assert(cache.GetStats().diskHits == keys.size() && compiles == keys.size());
+	}
+	// editing an include changes the pixel shaders' hash only
+	{
+		ShaderCache cache{ src,dst,compile };
+		const auto before = cache.GetCachePath(dif);
+		const auto vertex = cache.GetCachePath({ "Phong",Perm::Stage::Vertex,0u });
+		write("Common.hlsl", "float3 ambient;\nfloat exposure;");
+		assert(cache.GetCachePath(dif) != before);
+		assert(cache.GetCachePath({ "Phong",Perm::Stage::Vertex,0u }) == vertex);
+		cache.Load(dif);
+		assert(cache.GetStats().compiles == 1u);
+		// different compiler settings never share bytecode
+		ShaderCache debug{ src,dst,compile,"debug" };
+		assert(debug.GetCachePath(dif) != cache.GetCachePath(dif));
+	}
+	std::filesystem::remove_all(root);
+}
+
+void TestShaderPack()
+{
+	const auto bytes = [](const char* text)
+	{
+		return std::vector<char>(text, text + std::strlen(text));
+	};
+	const auto image = ShaderPack::Build({
+		{ "Solid_VS.cso",bytes("solid vertex") },
+		{ "Blur_PS.cso",bytes("blur") },
+		{ "Solid_PS.cso",bytes("solid pixel") },
+	});
+	const ShaderPack pack{ image.data(),image.size() };
+	assert(pack.GetCount() == 3u && pack.GetName(0u) == "Blur_PS.cso");
+	const auto code = pack.Find("Solid_PS.cso");
+	assert(std::string(static_cast<const char*>(code.pData), code.size) == "solid pixel");
+	// blobs point into the image, aligned for the runtime to read in place
+	assert(static_cast<const char*>(code.pData) > image.data() && static_cast<const char*>(code.pData) < image.data() + image.size());
+	assert((static_cast<const char*>(code.pData) - image.data()) % 16 == 0);
+	assert(pack.Find("Phong_PS.cso").pData == nullptr);
+
+	// malformed packs are refused up front
+	const auto refused = [](std::vector<char> image)
+	{
+		try
+		{
+			ShaderPack{ image.data(),image.size() };
+		}
+		catch (const ShaderPack::Exception&)
+		{
+			return true;
+		}
+		return false;
+	};
+	assert(refused({ 'R','S' }));
+	assert(refused(std::vector<char>(image.begin(), image.begin() + 40)));
+	auto wrongVersion = image;
+	wrongVersion[4]++;
+	assert(refused(wrongVersion));
+
+	// packing a directory takes its .cso files only
+	const auto root = std::filesystem::temp_directory_path() / "redsky-pack-test";
+	std::filesystem::remove_all(root);
+	std::filesystem::create_directories(root);
+	std::ofstream{ root / "A_VS.cso",std::ios::binary } << "vertex";
+	std::ofstream{ root / "A_PS.cso",std::ios::binary } << "pixel";
+	std::ofstream{ root / "A_PS.hlsl" } << "float4 main() : SV_Target;";
+	assert(ShaderPack::PackDirectory(root.string(), (root / "Shaders.pack").string()) == 2u);
+	std::ifstream file(root / "Shaders.pack", std::ios::binary);
+	const std::vector<char> packed{ std::istreambuf_iterator<char>(file),std::istreambuf_iterator<char>() };
+	const ShaderPack reread{ packed.data(),packed.size() };
+	assert(reread.GetCount() == 2u && reread.Find("A_VS.cso").size == 6u);
+	file.close();
+	std::filesystem::remove_all(root);
+}
+
+void TestAssetArchive()
+{
+	// lz4 blocks round trip, repetitive data shrinks and truncated input is refused
+	{
+		std::mt19937 rng{ 69 };
+		for (const size_t size : { 0u,1u,15u,4096u,100000u })
+		{
+			std::vector<char> data(size);
+			for (size_t i = 0; i < size; i++)
+			{
+				data[i] = char(i % 97u < 60u ? 'a' + i % 7u : rng());
+			}
+			const auto block = Lz4::Compress(data.data(), data.size());
+			assert(block.size() <= Lz4::GetBound(size));
+			std::vector<char> out(size);
+			assert(Lz4::Decompress(block.data(), block.size(), out.data(), out.size()));
+			assert(out == data);
+			if (size > 16u)
+			{
+				assert(block.size() < size);
+				assert(!Lz4::Decompress(block.data(), block.size() / 2u, out.data(), out.size()));
+			}
+		}
+	}
+	assert(AssetArchive::Normalize("Models\\Sponza\\./textures/../Sponza.OBJ") == "models/sponza/sponza.obj");
+
+	const auto root = std::filesystem::temp_directory_path() / "redsky-archive-test";
+	std::filesystem::remove_all(root);
+	std::filesystem::create_directories(root / "assets" / "sub");
+	const auto write = [](const std::filesystem::path& path, const std::string& text)
+	{
+		std::ofstream{ path,std::ios::binary } << text;
+	};
+	const std::string repeated(4096u, 'x');
+	write(root / "assets" / "Packed.txt", repeated);
+	write(root / "assets" / "sub" / "tiny.txt", "tiny");
+	write(root / "loose.txt", "loose");
+	const auto oldPath = std::filesystem::current_path();
+	std::filesystem::current_path(root);
+	assert(AssetArchive::Write({ "assets" }, "first.archive", true) == 2u);
+
+	// mappings are released before the files are deleted
+	{
+		// compressible entries are stored as lz4, the rest raw and readable in place
+		const auto pArchive = Vfs::OpenArchive("first.archive");
+		assert(pArchive && pArchive->GetRecords().size() == 2u);
+		const auto pPacked = pArchive->Find("assets/packed.txt");
+		assert(pPacked && pPacked->compressed && pPacked->size == repeated.size() && pPacked->storedSize < pPacked->size);
+		const auto pTiny = pArchive->Find("assets/sub/tiny.txt");
+		assert(pTiny && !pTiny->compressed && std::string(pTiny->pStored, size_t(pTiny->size)) == "tiny");
+		assert(pArchive->Find("assets/missing.txt") == nullptr);
+
+		// lookups normalize, newer mounts win and anything else falls back to loose files
+		write(root / "assets" / "sub" / "tiny.txt", "newer");
+		assert(AssetArchive::Write({ "assets/sub/tiny.txt" }, "second.archive", false) == 1u);
+		Vfs vfs;
+		vfs.Mount(pArchive);
+		vfs.Mount(Vfs::OpenArchive("second.archive"));
+		const auto packed = vfs.Read("Assets\\Packed.txt");
+		assert(packed.IsOpen() && std::string(packed.GetData(), packed.GetSize()) == repeated);
+		const auto tiny = vfs.Read("assets/sub/tiny.txt");
+		assert(std::string(tiny.GetData(), tiny.GetSize()) == "newer");
+		const auto loose = vfs.Read("loose.txt");
+		assert(loose.IsOpen() && std::string(loose.GetData(), loose.GetSize()) == "loose");
+		assert(!vfs.Read("nowhere.txt").IsOpen() && !vfs.Exists("nowhere.txt") && vfs.Exists("ASSETS/packed.txt"));
+		const auto stats = vfs.GetStats();
+		assert(stats.archiveReads == 2u && stats.looseReads == 1u && stats.decompressedBytes == repeated.size());
+
+		// files read out of an archive outlive its unmounting
+		vfs.UnmountAll();
+		assert(std::string(tiny.GetData(), tiny.GetSize()) == "newer");
+	}
+	std::filesystem::current_path(oldPath);
+	std::filesystem::remove_all(root);
+}
+
+void BenchmarkVfs(const std::string& dir)
+{
+	// every file under dir read loose, then out of a stored and a compressed archive of it
+	using Clock = std::chrono::steady_clock;
+	std::vector<std::string> paths;
+	for (const auto& file : std::filesystem::recursive_directory_iterator(dir))
+	{
+		if (file.is_regular_file())
+		{
+			paths.push_back(file.path().string());
+		}
+	}
+	std::ostringstream oss;
+	oss << "[Vfs] " << dir << ", " << paths.size() << " files\n";
+	const auto temp = std::filesystem::temp_directory_path();
+	const auto run = [&](const char* label, const Vfs& vfs)
+	{
+		size_t bytes = 0u;
+		auto start = Clock::now();
+		for (const auto& path : paths)
+		{
+			bytes += vfs.Read(path).GetSize();
+		}
+		const auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		// random single reads, what a streamer asking for one file at a time sees
+		std::mt19937 rng{ 69 };
+		std::vector<double> latencies;
+		for (size_t i = 0; i < std::min<size_t>(paths.size() * 4u, 1000u); i++)
+		{
+			const auto& path = paths[rng() % paths.size()];
+			start = Clock::now();
+			const auto file = vfs.Read(path);
+			latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+		}
+		std::sort(latencies.begin(), latencies.end());
+		oss << std::fixed << std::setprecision(1) << label << double(bytes) / (1024.0 * 1024.0) / seconds << "MB/s, "
+			<< "read median " << latencies[latencies.size() / 2u] << "us p99 " << latencies[latencies.size() * 99u / 100u] << "us\n";
+	};
+	if (paths.empty())
+	{
+		return;
+	}
+	run("loose:      ", Vfs{});
+	for (const bool compress : { false,true })
+	{
+		const auto archivePath = (temp / (compress ? "redsky-bench-lz4.archive" : "redsky-bench.archive")).string();
+		AssetArchive::Write({ dir }, archivePath, compress);
+		{
+			Vfs vfs;
+			vfs.Mount(Vfs::OpenArchive(archivePath));
+			oss << "  " << std::filesystem::file_size(archivePath) / 1024u << "KB archive\n";
+			run(compress ? "lz4:        " : "stored:     ", vfs);
+		}
+		std::filesystem::remove(archivePath);
+	}
+	OutputDebugStringA(oss.str().c_str());
+}
+
+void TestInputSignature()
+{
+	const auto put = [](std::vector<char>& out, uint32_t value)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			out.push_back(char(value >> (8 * i)));
+		}
+	};
+	// a DXBC container holding only an ISGN chunk, inputs are { semantic,index,system value }
+	const auto makeBytecode = [&put](const std::vector<std::tuple<const char*, uint32_t, uint32_t>>& inputs)
+	{
+		std::vector<char> chunk;
+		put(chunk, uint32_t(inputs.size()));
+		put(chunk, 8u);
+		std::string names;
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			const auto& [semantic, index, systemValue] = inputs[i];
+			put(chunk, uint32_t(8u + inputs.size() * 24u + names.size()));
+			put(chunk, index);
+			put(chunk, systemValue);
+			put(chunk, 3u);
+			put(chunk, uint32_t(i));
+			put(chunk, 0x0707u);
+			names += semantic;
+			names += '\0';
+		}
+		chunk.insert(chunk.end(), names.begin(), names.end());
+		std::vector<char> code{ 'D','X','B','C' };
+		code.resize(20u);
+		put(code, 1u);
+		put(code, uint32_t(44u + chunk.size()));
+		put(code, 1u);
+		put(code, 36u);
+		code.insert(code.end(), { 'I','S','G','N' });
+		put(code, uint32_t(chunk.size()));
+		code.insert(code.end(), chunk.begin(), chunk.end());
+		return code;
+	};
+
+	// system values are the input assembler's own, semantics match regardless of case
+	const auto phong = makeBytecode({ { "POSITION",0u,0u },{ "Normal",0u,0u },{ "SV_VertexID",0u,6u } });
+	const InputSignature signature{ { phong.data(),phong.size() } };
+	assert(signature.IsKnown() && signature.GetElements().size() == 2u);
+	assert(signature.Reads("Position", 0u) && signature.Reads("NORMAL", 0u));
+	assert(!signature.Reads("Position", 1u) && !signature.Reads("SV_VertexID", 0u));
+	const std::vector<InputSignature::Semantic> offered = { { "Position",0u },{ "Normal",0u },{ "Texcoord",0u } };
+	assert(signature.GetUsedMask(offered) == 0b011u && signature.IsSatisfiedBy(offered));
+	assert(!signature.IsSatisfiedBy({ { "Position",0u },{ "Texcoord",0u } }));
+
+	// anything unreadable is unknown, which reads whatever is offered
+	assert(!InputSignature{}.IsKnown() && InputSignature{}.GetUsedMask(offered) == 0b111u);
+	for (size_t size = 0; size < phong.size(); size++)
+	{
+		assert(!InputSignature({ phong.data(),size }).IsKnown());
+	}
+
+	// sub-layouts: a position-only shader keys the same whatever else the vertices carry
+	using Type = rsexp::VertexLayout::ElementType;
+	const auto solid = makeBytecode({ { "Position",0u,0u } });
+	rsexp::VertexLayout normals;
+	normals.Append(Type::Position3D).Append(Type::Normal);
+	rsexp::VertexLayout textured;
+	textured.Append(Type::Position3D).Append(Type::Texture2D).Append(Type::Normal);
+	const ShaderBytecode solidCode{ solid.data(),solid.size() };
+	assert(Bind::InputLayout::GenerateKey(normals, {}, solidCode) == "P3@0");
+	assert(Bind::InputLayout::GenerateKey(textured, {}, solidCode) == "P3@0");
+	assert(Bind::InputLayout::GenerateKey(normals, {}, { phong.data(),phong.size() }) == "P3@0N@12");
+	assert(Bind::InputLayout::GenerateKey(textured, {}, { phong.data(),phong.size() }) == "P3@0N@20");
+	assert(Bind::InputLayout::GenerateKey(textured, {}, {}) == "P3@0T2@12N@20");
+	// instance transforms go in as four rows of slot 1
+	const auto instanced = makeBytecode({ { "Position",0u,0u },{ "InstanceTransform",0u,0u },{ "InstanceTransform",1u,0u },
+		{ "InstanceTransform",2u,0u },{ "InstanceTransform",3u,0u } });
+	rsexp::VertexLayout transforms;
+	transforms.Append(Type::InstanceTransform);
+	assert(Bind::InputLayout::GenerateKey(textured, transforms, { instanced.data(),instanced.size() }) == "P3@0|M4@0|M4@16|M4@32|M4@48");
+}
+
+void TestStaticVertexLayout()
+{
+	using Type = rsexp::VertexLayout::ElementType;
+	using Layout = rsexp::StaticVertexLayout<Type::Position3D, Type::Normal, Type::Texture2D>;
+	static_assert(Layout::Size() == 32u && sizeof(Layout::Vertex) == 32u);
+	static_assert(Layout::OffsetOf<Type::Normal>() == 12u && Layout::OffsetOf<Type::Texture2D>() == 24u);
+	static_assert(rsexp::StaticVertexLayout<Type::BGRAColor, Type::Position3D>::OffsetOf<Type::Position3D>() == 4u);
+	static_assert(std::is_trivially_copyable_v<Layout::Vertex> && std::is_standard_layout_v<Layout::Vertex>);
+
+	// offsets agree with the dynamic layout
+	const auto& layout = Layout::GetLayout();
+	assert(layout.GetCode() == "P3NT2" && layout.Size() == Layout::Size());
+	assert(layout.Resolve<Type::Normal>().GetOffset() == Layout::OffsetOf<Type::Normal>());
+	assert(layout.Resolve<Type::Texture2D>().GetOffset() == Layout::OffsetOf<Type::Texture2D>());
+
+	// vertices written either way read back the other way
+	std::vector<Layout::Vertex> vertices(3u);
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		vertices[i].Get<Type::Position3D>() = { float(i),1.0f,2.0f };
+		vertices[i].Get<Type::Normal>() = { 0.0f,0.0f,-1.0f };
+		vertices[i].Get<Type::Texture2D>() = { 0.5f,float(i) };
+	}
+	auto vb = Layout::MakeBuffer(vertices);
+	assert(vb.Size() == 3u && vb.SizeBytes() == 3u * Layout::Size());
+	assert(vb[2].Attr<Type::Position3D>().x == 2.0f && vb[1].Attr<Type::Texture2D>().y == 1.0f);
+	assert(vb[0].Attr<Type::Normal>().z == -1.0f);
+	vb[1].Attr<Type::Normal>() = { 1.0f,0.0f,0.0f };
+	const auto pInPlace = Layout::GetVertices(vb);
+	assert(pInPlace[1].Get<Type::Normal>().x == 1.0f && pInPlace[2].Get<Type::Texture2D>().x == 0.5f);
+}
+
+void BenchmarkStaticVertexLayout(unsigned int latDiv, unsigned int longDiv)
+{
+	// the rings of a dense sphere with normals written through the dynamic layout (EmplaceBack
+	// and Attr) and through a static one. Points are computed up front so only the writes count
+	namespace dx = DirectX;
+	using Type = rsexp::VertexLayout::ElementType;
+	using Layout = rsexp::StaticVertexLayout<Type::Position3D, Type::Normal>;
+	using Clock = std::chrono::steady_clock;
+	std::vector<dx::XMFLOAT3> points;
+	points.reserve(size_t(latDiv - 1u) * longDiv);
+	for (unsigned int iLat = 1; iLat < latDiv; iLat++)
+	{
+		const float lat = PI * float(iLat) / float(latDiv);
+		for (unsigned int iLong = 0; iLong < longDiv; iLong++)
+		{
+			const float lon = 2.0f * PI * float(iLong) / float(longDiv);
+			points.push_back({ std::sin(lat) * std::cos(lon),std::sin(lat) * std::sin(lon),std::cos(lat) });
+		}
+	}
+	const auto time = [](auto&& generate)
+	{
+		const auto start = Clock::now();
+		const auto vb = generate();
+		const auto ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		// touched after the clock stops so the work can't be dropped
+		volatile auto sink = vb.GetData()[vb.SizeBytes() - 1u];
+		(void)sink;
+		return ms;
+	};
+	const auto emplaced = time([&]()
+	{
+		rsexp::VertexBuffer vb{ Layout::GetLayout() };
+		for (const auto& p : points)
+		{
+			vb.EmplaceBack(p, p);
+		}
+		return vb;
+	});
+	const auto attributes = time([&]()
+	{
+		rsexp::VertexBuffer vb{ Layout::GetLayout(),points.size() };
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			auto v = vb[i];
+			v.Attr<Type::Position3D>() = points[i];
+			v.Attr<Type::Normal>() = points[i];
+		}
+		return vb;
+	});
+	const auto typed = time([&]()
+	{
+		rsexp::VertexBuffer vb{ Layout::GetLayout(),points.size() };
+		const auto pVertices = Layout::GetVertices(vb);
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			pVertices[i].Get<Type::Position3D>() = points[i];
+			pVertices[i].Get<Type::Normal>() = points[i];
+		}
+		return vb;
+	});
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(2) << "[Vertex Layouts] sphere of " << points.size() << " vertices\n"
+		<< "dynamic EmplaceBack: " << emplaced << "ms\n"
+		<< "dynamic Attr:        " << attributes << "ms\n"
+		<< "static:              " << typed << "ms\n";
+	OutputDebugStringA(oss.str().c_str());
+}
+
+void TestGeometryGenerators()
+{
+	namespace dx = DirectX;
+	using Type = rsexp::VertexLayout::ElementType;
+	const auto approx = [](float a, float b)
+	{
+		return std::abs(a - b) < 0.0001f;
+	};
+	// every triangle faces away from the origin, front faces wind clockwise
+	const auto facesOut = [](const auto& itl, size_t i)
+	{
+		const rsexp::ElementView<Type::Position3D> pos{ const_cast<rsexp::VertexBuffer&>(itl.vertices) };
+		const auto p0 = dx::XMLoadFloat3(&pos[itl.indices[i]]);
+		const auto p1 = dx::XMLoadFloat3(&pos[itl.indices[i + 1u]]);
+		const auto p2 = dx::XMLoadFloat3(&pos[itl.indices[i + 2u]]);
+		const auto n = dx::XMVector3Cross(p1 - p0, p2 - p0);
+		return dx::XMVectorGetX(dx::XMVector3Dot(n, p0 + p1 + p2)) > 0.0f;
+	};
+
+	// sphere: exact counts, points on the unit sphere with matching normals, poles last
+	{
+		const auto itl = Sphere::MakeTesselated(rsexp::VertexLayout{}
+			.Append(Type::Position3D)
+			.Append(Type::Normal), 12, 24);
+		assert(itl.vertices.Size() == 11u * 24u + 2u);
+		assert(itl.indices.size() == 11u * 24u * 6u);
+		for (size_t i = 0; i < itl.vertices.Size(); i++)
+		{
+			const auto& p = itl.vertices[i].Attr<Type::Position3D>();
+			const auto& n = itl.vertices[i].Attr<Type::Normal>();
+			assert(approx(p.x * p.x + p.y * p.y + p.z * p.z, 1.0f));
+			assert(p.x == n.x && p.y == n.y && p.z == n.z);
+		}
+		assert(itl.vertices[264u].Attr<Type::Position3D>().z == 1.0f);
+		assert(itl.vertices[265u].Attr<Type::Position3D>().z == -1.0f);
+		for (size_t i = 0; i < itl.indices.size(); i += 3u)
+		{
+			assert(itl.indices[i] < itl.vertices.Size());
+			assert(facesOut(itl, i));
+		}
+	}
+	// past 16 bit indices
+	{
+		const auto itl = Sphere::MakeTesselated<uint32_t>(rsexp::VertexLayout{}.Append(Type::Position3D), 300, 400);
+		assert(itl.vertices.Size() == 299u * 400u + 2u);
+		assert(*std::max_element(itl.indices.begin(), itl.indices.end()) == itl.vertices.Size() - 1u);
+		for (size_t i = 0; i < itl.indices.size(); i += 997u * 3u)
+		{
+			assert(facesOut(itl, i));
+		}
+	}
+
+	// plane: every element of a vertex follows from its grid position
+	{
+		constexpr int div = 400;
+		const auto itl = Plane::MakeTesselatedTextured<uint32_t>(rsexp::VertexLayout{}
+			.Append(Type::Position3D)
+			.Append(Type::Normal)
+			.Append(Type::Texture2D), div, div);
+		assert(itl.vertices.Size() == size_t(div + 1) * size_t(div + 1));
+		assert(itl.indices.size() == size_t(div) * size_t(div) * 6u);
+		for (size_t i = 0; i < itl.vertices.Size(); i += 331u)
+		{
+			const auto x = float(i % (div + 1u)), y = float(i / (div + 1u));
+			const auto v = itl.vertices[i];
+			assert(approx(v.Attr<Type::Position3D>().x, x * 2.0f / div - 1.0f));
+			assert(approx(v.Attr<Type::Position3D>().y, y * 2.0f / div - 1.0f));
+			assert(v.Attr<Type::Normal>().z == -1.0f);
+			assert(approx(v.Attr<Type::Texture2D>().x, x / div) && approx(v.Attr<Type::Texture2D>().y, 1.0f - y / div));
+		}
+		assert(itl.indices.back() == itl.vertices.Size() - 1u);
+		// a position only layout is fine too
+		const auto bare = Plane::MakeTesselatedTextured(rsexp::VertexLayout{}.Append(Type::Position3D), 3, 2);
+		assert(bare.vertices.Size() == 12u && bare.indices.size() == 36u);
+		assert(approx(bare.vertices[11].Attr<Type::Position3D>().x, 1.0f));
+	}
+}
+
+void BenchmarkGeometry()
+{
+	// a sphere's vertices built the old way, per vertex rotations and EmplaceBack, against the
+	// whole generated mesh (indices included), then large meshes that need 32 bit indices
+	namespace dx = DirectX;
+	using Type = rsexp::VertexLayout::ElementType;
+	using Clock = std::chrono::steady_clock;
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(2) << "[Geometry]\n";
+	const auto time = [&oss](const char* name, auto&& generate)
+	{
+		const auto start = Clock::now();
+		const auto itl = generate();
+		const auto ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		oss << name << ": " << itl.vertices.Size() << " vertices " << ms << "ms ("
+			<< double(itl.vertices.Size()) / (ms * 1000.0) << " Mverts/s)\n";
+	};
+	const auto layout = rsexp::VertexLayout{}.Append(Type::Position3D).Append(Type::Normal);
+	time("sphere 180x360 rotations", [&]()
+	{
+		constexpr int latDiv = 180, longDiv = 360;
+		const auto base = dx::XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
+		rsexp::VertexBuffer vb{ layout };
+		for (int iLat = 1; iLat < latDiv; iLat++)
+		{
+			const auto latBase = dx::XMVector3Transform(base, dx::XMMatrixRotationX(PI / latDiv * iLat));
+			for (int iLong = 0; iLong < longDiv; iLong++)
+			{
+				dx::XMFLOAT3 pos;
+				dx::XMStoreFloat3(&pos, dx::XMVector3Transform(latBase, dx::XMMatrixRotationZ(2.0f * PI / longDiv * iLong)));
+				vb.EmplaceBack(pos, pos);
+			}
+		}
+		return IndexedTriangleList32{ std::move(vb),{ 0u,1u,2u } };
+	});
+	time("sphere 180x360", [&]() { return Sphere::MakeTesselated(layout, 180, 360); });
+	time("sphere 1000x2000", [&]() { return Sphere::MakeTesselated<uint32_t>(layout, 1000, 2000); });
+	time("plane 2000x2000", [&]()
+	{
+		return Plane::MakeTesselatedTextured<uint32_t>(rsexp::VertexLayout{}
+			.Append(Type::Position3D)
+			.Append(Type::Normal)
+			.Append(Type::Texture2D), 2000, 2000);
+	});
+	OutputDebugStringA(oss.str().c_str());
+}
+
+void TestGeometryProcessor()
+{
+	using Type = rsexp::VertexLayout::ElementType;
+	using Weighting = GeometryProcessor::NormalWeighting;
+	const auto dot = [](const dx::XMFLOAT3& a, const dx::XMFLOAT3& b)
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	};
+	const auto layout = rsexp::VertexLayout{}.Append(Type::Position3D).Append(Type::Normal);
+
+	// a sphere's smooth normals point out from the center
+	{
+		auto itl = Sphere::MakeTesselated(layout, 12, 24);
+		for (size_t i = 0; i < itl.vertices.Size(); i++)
+		{
+			itl.vertices[i].Attr<Type::Normal>() = {};
+		}
+		itl.SetNormalsSmooth();
+		assert(itl.vertices.Size() == 11u * 24u + 2u);
+		for (size_t i = 0; i < itl.vertices.Size(); i++)
+		{
+			auto v = itl.vertices[i];
+			assert(dot(v.Attr<Type::Normal>(), v.Attr<Type::Position3D>()) > 0.999f);
+		}
+	}
+
+	// cube corners: by angle every face counts the same however it is split into triangles
+	{
+		auto itl = Cube::MakeIndependent(layout);
+		itl.SetNormalsSmooth(Weighting::Angle);
+		for (size_t i = 0; i < itl.vertices.Size(); i++)
+		{
+			auto v = itl.vertices[i];
+			const auto& p = v.Attr<Type::Position3D>();
+			const auto& n = v.Attr<Type::Normal>();
+			assert(std::abs(n.x * p.x * 2.0f - 0.57735f) < 0.001f);
+			assert(std::abs(n.y * p.y * 2.0f - 0.57735f) < 0.001f);
+			assert(std::abs(n.z * p.z * 2.0f - 0.57735f) < 0.001f);
+		}
+		itl.SetNormalsSmooth(Weighting::Area);
+		for (size_t i = 0; i < itl.vertices.Size(); i++)
+		{
+			auto v = itl.vertices[i];
+			assert(dot(v.Attr<Type::Normal>(), v.Attr<Type::Position3D>()) > 0.0f);
+		}
+	}
+
+	// the same cube on 8 shared vertices splits each into one per face at a 60 degree crease
+	{
+		const auto independent = Cube::MakeIndependent(layout);
+		rsexp::VertexBuffer shared{ layout };
+		std::vector<unsigned short> indices;
+		shared.Resize(8u);
+		for (const auto i : independent.indices)
+		{
+			const auto& p = independent.vertices[i].Attr<Type::Position3D>();
+			const auto corner = (unsigned short)((p.x > 0.0f ? 1u : 0u) | (p.y > 0.0f ? 2u : 0u) | (p.z > 0.0f ? 4u : 0u));
+			shared[corner].Attr<Type::Position3D>() = p;
+			indices.push_back(corner);
+		}
+		IndexedTriangleList itl{ std::move(shared),std::move(indices) };
+		itl.SetNormalsSmooth(Weighting::Angle, to_rad(60.0f));
+		assert(itl.vertices.Size() == 24u && itl.indices.size() == 36u);
+		for (size_t i = 0; i < itl.indices.size(); i += 3u)
+		{
+			const auto& n = itl.vertices[itl.indices[i]].Attr<Type::Normal>();
+			assert(std::abs(n.x) + std::abs(n.y) + std::abs(n.z) == 1.0f);
+			for (size_t j = 1u; j < 3u; j++)
+			{
+				assert(dot(itl.vertices[itl.indices[i + j]].Attr<Type::Normal>(), n) == 1.0f);
+			}
+		}
+	}
+
+	// plane facing -z with u along x and v down y, then the right half mirrored in u, which
+	// splits the middle column
+	{
+		auto itl = Plane::MakeTesselatedTextured(rsexp::VertexLayout{}
+			.Append(Type::Position3D)
+			.Append(Type::Normal)
+			.Append(Type::Texture2D)
+			.Append(Type::Tangent)
+			.Append(Type::Bitangent), 4, 4);
+		itl.SetTangentSpace();
+		assert(itl.vertices.Size() == 25u);
+		for (size_t i = 0; i < itl.vertices.Size(); i++)
+		{
+			auto v = itl.vertices[i];
+			assert(dot(v.Attr<Type::Tangent>(), { 1.0f,0.0f,0.0f }) > 0.999f);
+			assert(dot(v.Attr<Type::Bitangent>(), { 0.0f,1.0f,0.0f }) > 0.999f);
+		}
+		std::vector<bool> mirrored(itl.indices.size());
+		for (size_t i = 0; i < itl.indices.size(); i++)
+		{
+			const auto t = i / 3u * 3u;
+			for (size_t j = 0; j < 3u; j++)
+			{
+				mirrored[i] = mirrored[i] || itl.vertices[itl.indices[t + j]].Attr<Type::Position3D>().x > 0.0f;
+			}
+		}
+		for (size_t i = 0; i < itl.vertices.Size(); i++)
+		{
+			auto& tc = itl.vertices[i].Attr<Type::Texture2D>();
+			tc.x = 1.0f - std::abs(tc.x * 2.0f - 1.0f);
+		}
+		itl.SetTangentSpace();
+		assert(itl.vertices.Size() == 30u);
+		for (size_t i = 0; i < itl.indices.size(); i++)
+		{
+			auto v = itl.vertices[itl.indices[i]];
+			assert(dot(v.Attr<Type::Tangent>(), { mirrored[i] ? -1.0f : 1.0f,0.0f,0.0f }) > 0.999f);
+			assert(dot(v.Attr<Type::Bitangent>(), { 0.0f,1.0f,0.0f }) > 0.999f);
+		}
+	}
+
+	// the tangent frame Assimp gives the brick wall, which the normal mapped shaders expect
+	{
+		Assimp::Importer imp;
+		const auto pScene = imp.ReadFile("Models\\brick_wall\\brick_wall.obj",
+			aiProcess_Triangulate |
+			aiProcess_JoinIdenticalVertices |
+			aiProcess_ConvertToLeftHanded |
+			aiProcess_GenNormals |
+			aiProcess_CalcTangentSpace
+		);
+		const auto& mesh = *pScene->mMeshes[0];
+		rsexp::VertexBuffer vb{ rsexp::VertexLayout{}
+			.Append(Type::Position3D)
+			.Append(Type::Normal)
+			.Append(Type::Texture2D)
+			.Append(Type::Tangent)
+			.Append(Type::Bitangent),mesh };
+		std::vector<unsigned short> indices;
+		for (unsigned int f = 0; f < mesh.mNumFaces; f++)
+		{
+			const auto& face = mesh.mFaces[f];
+			assert(face.mNumIndices == 3u);
+			indices.insert(indices.end(), face.mIndices, face.mIndices + 3u);
+		}
+		for (size_t i = 0; i < vb.Size(); i++)
+		{
+			vb[i].Attr<Type::Tangent>() = {};
+			vb[i].Attr<Type::Bitangent>() = {};
+		}
+		GeometryProcessor::SetTangents(vb, indices);
+		assert(vb.Size() == mesh.mNumVertices);
+		for (size_t i = 0; i < vb.Size(); i++)
+		{
+			const auto& t = mesh.mTangents[i];
+			const auto& b = mesh.mBitangents[i];
+			assert(dot(vb[i].Attr<Type::Tangent>(), { t.x,t.y,t.z }) > 0.999f);
+			assert(dot(vb[i].Attr<Type::Bitangent>(), { b.x,b.y,b.z }) > 0.999f);
+		}
+	}
+}
+
+void TestInputQueues()
+{
+	using namespace std::chrono_literals;
+	// first in first out across the wrap, pushing to a full ring fails
+	{
+		SpscQueue<int, 4u> q;
+		for (int round = 0; round < 3; round++)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				assert(q.Push(round * 4 + i));
+			}
+			assert(!q.Push(-1) && q.Size() == 4u);
+			for (int i = 0; i < 4; i++)
+			{
+				assert(*q.Pop() == round * 4 + i);
+			}
+			assert(!q.Pop() && q.IsEmpty());
+		}
+		q.Push(1);
+		q.Push(2);
+		q.Clear();
+		assert(q.IsEmpty() && !q.Pop());
+	}
+
+	// storms pumped from another thread while this one reads, timestamps stand in for the
+	// order events were sent in
+	constexpr size_t stormSize = 1000000u;
+	const auto drain = [](const std::atomic<bool>& done, auto&& read)
+	{
+		while (true)
+		{
+			// checked before reading so nothing pushed before it was set is missed
+			const bool finished = done;
+			while (read())
+			{}
+			if (finished)
+			{
+				return;
+			}
+		}
+	};
+	// keys: whatever isn't dropped arrives in order, and every drop is counted
+	{
+		Keyboard kbd;
+		std::atomic<bool> done = false;
+		std::thread pump([&]()
+		{
+			for (size_t i = 0; i < stormSize; i++)
+			{
+				kbd.OnKeyPressed((unsigned char)i, Keyboard::Clock::time_point(Keyboard::Clock::duration(i)));
+			}
+			done = true;
+		});
+		size_t received = 0u;
+		Keyboard::Clock::rep last = -1;
+		drain(done, [&]()
+		{
+			const auto e = kbd.ReadKey();
+			if (e)
+			{
+				const auto i = e->GetTimestamp().time_since_epoch().count();
+				assert(i > last && e->IsPress() && e->GetCode() == (unsigned char)i);
+				last = i;
+				received++;
+			}
+			return bool(e);
+		});
+		pump.join();
+		assert(received + kbd.GetDroppedCount() == stormSize);
+		assert(kbd.KeyIsPressed((unsigned char)(stormSize - 1u)));
+	}
+	// raw motion with a reader that keeps stalling: the queue overflows, yet every delta is
+	// read in order, merged into fewer
+	{
+		Mouse mouse;
+		std::atomic<bool> done = false;
+		std::thread pump([&]()
+		{
+			for (size_t i = 0; i < stormSize; i++)
+			{
+				mouse.OnRawDelta(1, -2, Mouse::Clock::time_point(Mouse::Clock::duration(i)));
+			}
+			done = true;
+		});
+		long long x = 0, y = 0;
+		size_t reads = 0u;
+		Mouse::Clock::time_point last = {};
+		drain(done, [&]()
+		{
+			const auto d = mouse.ReadRawDelta();
+			if (d)
+			{
+				assert(d->timestamp >= last);
+				last = d->timestamp;
+				x += d->x;
+				y += d->y;
+				if (++reads % 256u == 0u)
+				{
+					std::this_thread::sleep_for(1ms);
+				}
+			}
+			return bool(d);
+		});
+		pump.join();
+		assert(x == (long long)stormSize && y == -2ll * (long long)stormSize);
+		assert(reads < stormSize && mouse.GetDroppedCount() == 0u);
+	}
+}
+
+void TestBindStateAcrossFrames()
+{
+	// a view still bound as a texture when the frame starts must not be left on the device,
+	// or binding it as a target later trips the debug layer's hazard warning
+	Graphics gfx{ 320,240,Graphics::Backend::Warp };
+	RenderTarget rt{ gfx,64u,64u };
+	gfx.DrainDebugMessages("setup");
+	rt.BindAsTexture(gfx, 0u);
+	gfx.BeginFrame({ 0.0f,0.0f,0.0f,1.0f });
+	rt.BindAsTarget(gfx);
+	try
+	{
+		gfx.DrainDebugMessages("TestBindStateAcrossFrames");
+	}
+	catch (const Graphics::InfoException&)
+	{
+		assert(false && "Target was still bound as a shader resource");
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Graphics.h"
+#include <string>
 
 void TestDynamicConstant();
 
@@ -7,4 +8,62 @@ void TestDynamicMeshLoading();
 
 void TestMaterialSystemLoading( Graphics& gfx );
 
-void TestScaleMatrixTranslation();
\ No newline at end of file
+void TestScaleMatrixTranslation();
+
+void TestSurfaceStreaming(const std::string& path);
+
+void TestMipResidency();
+
+void TestRectPacking();
+
+void BenchmarkSrvBinds(Graphics& gfx, const std::string& objPath, float scale = 1.0f);
+
+void TestGaussKernel();
+
+void TestBlurCostModel();
+
+void TestProfiler();
+
+void BenchmarkProfiler();
+
+void TestGpuTimerRing();
+
+void BenchmarkInstancing(unsigned int cubeCount = 10000u);
+
+void TestMeshBatcher();
+
+void BenchmarkMeshBatcher(const std::string& path, float scale = 1.0f);
+
+void TestLightBinner();
+
+void BenchmarkLightBinning(unsigned int lightCount = 4096u);
+
+void BenchmarkDepthPrepass(Graphics::Backend backend = Graphics::Backend::Hardware);
+
+void TestRenderGraph();
+
+void TestFramePacer();
+
+void TestShaderPermutations();
+
+void TestShaderPack();
+
+void TestAssetArchive();
+
+void BenchmarkVfs(const std::string& dir = "Models");
+
+void TestInputSignature();
+
+void TestStaticVertexLayout();
+
+void BenchmarkStaticVertexLayout(unsigned int latDiv = 1000u, unsigned int longDiv = 2000u);
+
+void TestGeometryGenerators();
+
+void BenchmarkGeometry();
+
+void TestGeometryProcessor();
+
+void TestInputQueues();
+
+void TestBindStateAcrossFrames();
\ No newline at end of file
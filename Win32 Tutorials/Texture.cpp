@@ -2,6 +2,8 @@
 #include "Surface.h"
 #include "GraphicsThrowMacros.h"
 #include "BindableCodex.h"
+#include "TextureStreamer.h"
+#include <cassert>
 
 namespace Bind
 {
@@ -14,6 +16,14 @@ namespace Bind
 	{
 		INFOMAN(gfx);
 
+		// pre-mipped textures start with only their coarse mips and stream in the rest
+		streamPath = TextureStreamer::FindMippedFile(path);
+		if (!streamPath.empty())
+		{
+			LoadStreamed(gfx);
+			return;
+		}
+
 		// load surface
 		const auto s = Surface::FromFile(path);
 		hasAlpha = s.AlphaLoaded();
@@ -35,18 +45,22 @@ namespace Bind
 		GFX_THROW_INFO(GetDevice(gfx)->CreateTexture2D(
 			&textureDesc, nullptr, &pTexture
 		));
+		gfx.CountResourceCreated();
 
 		// write image data into top mip level
 		GetContext(gfx)->UpdateSubresource(
 			pTexture.Get(), 0u, nullptr, s.GetBufferPtrConst(), s.GetWidth() * sizeof(Surface::Color), 0u
 		);
 
-		// create the resource view on the texture
+		// create the resource view on the texture, viewed as a one layer array
+		// so it binds to the same shader slots as packed texture arrays
 		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 		srvDesc.Format = textureDesc.Format;
-		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-		srvDesc.Texture2D.MostDetailedMip = 0;
-		srvDesc.Texture2D.MipLevels = -1;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+		srvDesc.Texture2DArray.MostDetailedMip = 0;
+		srvDesc.Texture2DArray.MipLevels = -1;
+		srvDesc.Texture2DArray.FirstArraySlice = 0;
+		srvDesc.Texture2DArray.ArraySize = 1;
 		GFX_THROW_INFO(GetDevice(gfx)->CreateShaderResourceView(
 			pTexture.Get(), &srvDesc, &pTextureView
 		));
@@ -55,9 +69,23 @@ namespace Bind
 		GetContext(gfx)->GenerateMips(pTextureView.Get());
 	}
 
+	Texture::~Texture()
+	{
+		if (pStreamer)
+		{
+			pStreamer->Unregister(streamId);
+		}
+	}
+
 	void Texture::Bind(Graphics& gfx) noexcept
 	{
-		GetContext(gfx)->PSSetShaderResources(slot, 1u, pTextureView.GetAddressOf());
+		if (pStreamer)
+		{
+			pStreamer->GetResidency().Request(streamId, MipResidency::ComputeRequiredMip(
+				fullWidth, fullHeight, mipCount, gfx.GetTexelDemand()
+			));
+		}
+		gfx.BindPixelShaderResource(slot, pTextureView.Get());
 	}
 	std::shared_ptr<Texture> Texture::Resolve(Graphics& gfx, const std::string& path, UINT slot)
 	{
@@ -76,6 +104,107 @@ namespace Bind
 	{
 		return hasAlpha;
 	}
+	bool Texture::IsStreamed() const noexcept
+	{
+		return pStreamer != nullptr;
+	}
+	const std::string& Texture::GetStreamPath() const noexcept
+	{
+		return streamPath;
+	}
+	unsigned int Texture::GetResidentMip() const noexcept
+	{
+		return residentMip;
+	}
+	void Texture::LoadStreamed(Graphics& gfx)
+	{
+		const auto info = TextureStreamer::ReadFileInfo(streamPath);
+		fullWidth = info.width;
+		fullHeight = info.height;
+		mipCount = info.mipCount;
+		pStreamer = TextureStreamer::Get();
+		streamId = pStreamer->Register(*this, info);
+
+		// nothing resident yet, so the initial upload creates the texture from scratch
+		residentMip = mipCount;
+		const auto first = pStreamer->GetResidency().GetInitialMip(streamId);
+		const auto mips = TextureStreamer::ReadMips(streamPath, first, mipCount);
+
+		// averaged mips keep any transparency of the full image below 255
+		const auto& top = mips.front();
+		for (size_t i = 3u; i < top.size(); i += sizeof(Surface::Color))
+		{
+			if ((unsigned char)top[i] != 255u)
+			{
+				hasAlpha = true;
+				break;
+			}
+		}
+		ApplyMips(gfx, first, mips);
+	}
+	void Texture::ApplyMips(Graphics& gfx, unsigned int firstMip, const std::vector<std::vector<char>>& mips)
+	{
+		INFOMAN(gfx);
+		assert(firstMip + mips.size() == std::min(residentMip, mipCount) || firstMip > residentMip);
+
+		// d3d11 can't release part of a resource, so the resident set lives in a texture sized to it
+		D3D11_TEXTURE2D_DESC textureDesc = {};
+		textureDesc.Width = std::max(fullWidth >> firstMip, 1u);
+		textureDesc.Height = std::max(fullHeight >> firstMip, 1u);
+		textureDesc.MipLevels = mipCount - firstMip;
+		textureDesc.ArraySize = 1;
+		textureDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+		textureDesc.SampleDesc.Count = 1;
+		textureDesc.SampleDesc.Quality = 0;
+		textureDesc.Usage = D3D11_USAGE_DEFAULT;
+		textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		textureDesc.CPUAccessFlags = 0;
+		textureDesc.MiscFlags = 0;
+		wrl::ComPtr<ID3D11Texture2D> pNewTexture;
+		GFX_THROW_INFO(GetDevice(gfx)->CreateTexture2D(
+			&textureDesc, nullptr, &pNewTexture
+		));
+		gfx.CountResourceCreated();
+
+		// fresh levels come from the file, the ones already resident are copied across on the gpu
+		for (unsigned int i = 0u; i < mips.size(); i++)
+		{
+			const auto mip = firstMip + i;
+			GetContext(gfx)->UpdateSubresource(
+				pNewTexture.Get(), i, nullptr, mips[i].data(),
+				UINT(std::max(fullWidth >> mip, 1u) * sizeof(Surface::Color)), 0u
+			);
+			gfx.CountUpload(mips[i].size());
+		}
+		for (unsigned int mip = std::max(firstMip, residentMip); mip < mipCount; mip++)
+		{
+			GetContext(gfx)->CopySubresourceRegion(
+				pNewTexture.Get(), mip - firstMip, 0u, 0u, 0u,
+				pTexture.Get(), mip - residentMip, nullptr
+			);
+		}
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = textureDesc.Format;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+		srvDesc.Texture2DArray.MostDetailedMip = 0;
+		srvDesc.Texture2DArray.MipLevels = -1;
+		srvDesc.Texture2DArray.FirstArraySlice = 0;
+		srvDesc.Texture2DArray.ArraySize = 1;
+		wrl::ComPtr<ID3D11ShaderResourceView> pNewView;
+		GFX_THROW_INFO(GetDevice(gfx)->CreateShaderResourceView(
+			pNewTexture.Get(), &srvDesc, &pNewView
+		));
+
+		pTexture = std::move(pNewTexture);
+		pTextureView = std::move(pNewView);
+		residentMip = firstMip;
+	}
+	void Texture::DropMips(Graphics& gfx, unsigned int firstMip)
+	{
+		assert(firstMip > residentMip);
+		ApplyMips(gfx, firstMip, {});
+	}
 	UINT Texture::CalculateNumberOfMipLevels(UINT width, UINT height) noexcept
 	{
 		const float xSteps = std::ceil(log2((float)width));
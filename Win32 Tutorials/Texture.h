@@ -1,7 +1,9 @@
 #pragma once
 #include "Bindable.h"
+#include <vector>
 
 class Surface;
+class TextureStreamer;
 
 namespace Bind
 {
@@ -9,15 +11,32 @@ namespace Bind
 	{
 	public:
 		Texture(Graphics& gfx, const std::string& path, UINT slot = 0);
+		~Texture() override;
 		void Bind(Graphics& gfx) noexcept override;
 		static std::shared_ptr<Texture> Resolve(Graphics& gfx, const std::string& path, UINT slot = 0);
 		static std::string GenerateUID(const std::string& path, UINT slot = 0);
 		std::string GetUID() const noexcept override;
 		bool HasAlpha() const noexcept;
+		// streaming, only used by textures with a pre-mipped .dds alongside them
+		bool IsStreamed() const noexcept;
+		const std::string& GetStreamPath() const noexcept;
+		unsigned int GetResidentMip() const noexcept;
+		// makes [firstMip,end) resident, mips holds the levels finer than the current resident set
+		void ApplyMips(Graphics& gfx, unsigned int firstMip, const std::vector<std::vector<char>>& mips);
+		void DropMips(Graphics& gfx, unsigned int firstMip);
 	private:
 		static UINT CalculateNumberOfMipLevels(UINT width, UINT height) noexcept;
+		void LoadStreamed(Graphics& gfx);
 	private:
 		unsigned int slot;
+		std::shared_ptr<TextureStreamer> pStreamer;
+		std::string streamPath;
+		size_t streamId = 0u;
+		unsigned int fullWidth = 0u;
+		unsigned int fullHeight = 0u;
+		unsigned int mipCount = 0u;
+		unsigned int residentMip = 0u;
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> pTexture;
 	protected:
 		bool hasAlpha = false;
 		std::string path;
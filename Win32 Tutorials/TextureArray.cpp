@@ -0,0 +1,98 @@
+#include "TextureArray.h"
+#include "Surface.h"
+#include "GraphicsThrowMacros.h"
+#include "BindableCodex.h"
+#include "RedSkyUtility.h"
+#include "Vfs.h"
+#include <vector>
+
+namespace Bind
+{
+	namespace wrl = Microsoft::WRL;
+
+	TextureArray::TextureArray(Graphics& gfx, const std::string& path, UINT slot)
+		:
+		slot(slot),
+		path(path)
+	{
+		INFOMAN(gfx);
+
+		// load every layer and mip, the packer already generated the chain
+		DirectX::ScratchImage scratch;
+		const auto file = Vfs::Get().Read(path);
+		hr = file.IsOpen() ? DirectX::LoadFromDDSMemory(file.GetData(), file.GetSize(), DirectX::DDS_FLAGS_NONE, nullptr, scratch) : E_FAIL;
+		if (FAILED(hr))
+		{
+			throw Surface::Exception(__LINE__, __FILE__, path, "Failed to load texture array", hr);
+		}
+		const auto& meta = scratch.GetMetadata();
+		if (meta.format != DXGI_FORMAT_B8G8R8A8_UNORM || meta.dimension != DirectX::TEX_DIMENSION_TEXTURE2D)
+		{
+			throw Surface::Exception(__LINE__, __FILE__, path, "Texture arrays must be 2D bgra8 images");
+		}
+		layerCount = (UINT)meta.arraySize;
+
+		// create texture resource with every subresource filled in at creation
+		D3D11_TEXTURE2D_DESC textureDesc = {};
+		textureDesc.Width = (UINT)meta.width;
+		textureDesc.Height = (UINT)meta.height;
+		textureDesc.MipLevels = (UINT)meta.mipLevels;
+		textureDesc.ArraySize = layerCount;
+		textureDesc.Format = meta.format;
+		textureDesc.SampleDesc.Count = 1;
+		textureDesc.SampleDesc.Quality = 0;
+		textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+		textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		textureDesc.CPUAccessFlags = 0;
+		textureDesc.MiscFlags = 0;
+		std::vector<D3D11_SUBRESOURCE_DATA> initData;
+		initData.reserve(meta.arraySize * meta.mipLevels);
+		for (size_t layer = 0; layer < meta.arraySize; layer++)
+		{
+			for (size_t mip = 0; mip < meta.mipLevels; mip++)
+			{
+				const auto pImage = scratch.GetImage(mip, layer, 0);
+				initData.push_back({ pImage->pixels,(UINT)pImage->rowPitch,(UINT)pImage->slicePitch });
+			}
+		}
+		wrl::ComPtr<ID3D11Texture2D> pTexture;
+		GFX_THROW_INFO(GetDevice(gfx)->CreateTexture2D(
+			&textureDesc, initData.data(), &pTexture
+		));
+		gfx.CountResourceCreated();
+
+		// create the resource view on the texture
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = textureDesc.Format;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+		srvDesc.Texture2DArray.MostDetailedMip = 0;
+		srvDesc.Texture2DArray.MipLevels = -1;
+		srvDesc.Texture2DArray.FirstArraySlice = 0;
+		srvDesc.Texture2DArray.ArraySize = layerCount;
+		GFX_THROW_INFO(GetDevice(gfx)->CreateShaderResourceView(
+			pTexture.Get(), &srvDesc, &pTextureView
+		));
+	}
+
+	void TextureArray::Bind(Graphics& gfx) noexcept
+	{
+		gfx.BindPixelShaderResource(slot, pTextureView.Get());
+	}
+	std::shared_ptr<TextureArray> TextureArray::Resolve(Graphics& gfx, const std::string& path, UINT slot)
+	{
+		return Codex::Resolve<TextureArray>(gfx, path, slot);
+	}
+	std::string TextureArray::GenerateUID(const std::string& path, UINT slot)
+	{
+		using namespace std::string_literals;
+		return typeid(TextureArray).name() + "#"s + path + "#" + std::to_string(slot);
+	}
+	std::string TextureArray::GetUID() const noexcept
+	{
+		return GenerateUID(path, slot);
+	}
+	UINT TextureArray::GetLayerCount() const noexcept
+	{
+		return layerCount;
+	}
+}
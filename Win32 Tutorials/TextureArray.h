@@ -0,0 +1,22 @@
+#pragma once
+#include "Bindable.h"
+
+namespace Bind
+{
+	// All layers and mips of a packed .dds array, shared by every material packed into it.
+	class TextureArray : public Bindable
+	{
+	public:
+		TextureArray(Graphics& gfx, const std::string& path, UINT slot = 0);
+		void Bind(Graphics& gfx) noexcept override;
+		static std::shared_ptr<TextureArray> Resolve(Graphics& gfx, const std::string& path, UINT slot = 0);
+		static std::string GenerateUID(const std::string& path, UINT slot = 0);
+		std::string GetUID() const noexcept override;
+		UINT GetLayerCount() const noexcept;
+	private:
+		unsigned int slot;
+		UINT layerCount = 0u;
+		std::string path;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> pTextureView;
+	};
+}
@@ -0,0 +1,73 @@
+#include "TexturePack.h"
+#include "ModelException.h"
+#include "json.hpp"
+#include "Vfs.h"
+#include <filesystem>
+
+bool TexturePack::enabled = true;
+
+std::shared_ptr<const TexturePack> TexturePack::Load(const std::string& modelPath)
+{
+	// every material of a model asks, so parse each manifest once
+	static std::unordered_map<std::string, std::shared_ptr<const TexturePack>> cache;
+	if (!enabled)
+	{
+		return nullptr;
+	}
+	if (const auto i = cache.find(modelPath); i != cache.end())
+	{
+		return i->second;
+	}
+	auto& pPack = cache[modelPath];
+	const auto file = Vfs::Get().Read(MakeManifestPath(modelPath));
+	if (!file.IsOpen())
+	{
+		return pPack;
+	}
+
+	const auto rootPath = std::filesystem::path{ modelPath }.parent_path();
+	auto pNew = std::make_shared<TexturePack>();
+	try
+	{
+		const auto top = nlohmann::json::parse(file.GetData(), file.GetData() + file.GetSize());
+		for (const auto& [name, j] : top.at("materials").items())
+		{
+			Entry e;
+			const auto MapPath = [&j, &rootPath](const char* key) -> std::string
+			{
+				return j.contains(key) ? (rootPath / j.at(key).get<std::string>()).string() : std::string{};
+			};
+			e.diffusePath = MapPath("diffuse");
+			e.specularPath = MapPath("specular");
+			e.normalPath = MapPath("normal");
+			e.layer = j.at("layer").get<float>();
+			const auto& t = j.at("transform");
+			e.transform = { t.at(0).get<float>(),t.at(1).get<float>(),t.at(2).get<float>(),t.at(3).get<float>() };
+			e.diffuseAlpha = j.value("diffuseAlpha", false);
+			e.glossAlpha = j.value("glossAlpha", false);
+			pNew->entries.emplace(name, std::move(e));
+		}
+	}
+	catch (const nlohmann::json::exception& e)
+	{
+		throw ModelException(__LINE__, __FILE__, "Bad texture pack manifest for " + modelPath + ": " + e.what());
+	}
+	pPack = std::move(pNew);
+	return pPack;
+}
+
+std::string TexturePack::MakeManifestPath(const std::string& modelPath)
+{
+	return std::filesystem::path{ modelPath }.replace_extension(".pack.json").string();
+}
+
+void TexturePack::SetEnabled(bool enabled_in) noexcept
+{
+	enabled = enabled_in;
+}
+
+const TexturePack::Entry* TexturePack::Find(const std::string& materialName) const noexcept
+{
+	const auto i = entries.find(materialName);
+	return i != entries.end() ? &i->second : nullptr;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <DirectXMath.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Runtime side of texture packing: the manifest TexturePacker writes next to a model,
+// telling each material which shared array its maps live in and where.
+class TexturePack
+{
+public:
+	struct Entry
+	{
+		// packed .dds per map, empty where the material has no such map
+		std::string diffusePath;
+		std::string specularPath;
+		std::string normalPath;
+		// array layer and uv scale (xy) / offset (zw) shared by all maps of the material
+		float layer = 0.0f;
+		DirectX::XMFLOAT4 transform = { 1.0f,1.0f,0.0f,0.0f };
+		bool diffuseAlpha = false;
+		bool glossAlpha = false;
+	};
+public:
+	// nullptr when the model has no manifest or packing is disabled
+	static std::shared_ptr<const TexturePack> Load(const std::string& modelPath);
+	static std::string MakeManifestPath(const std::string& modelPath);
+	// lets benchmarks compare packed and unpacked loads of the same model
+	static void SetEnabled(bool enabled) noexcept;
+	const Entry* Find(const std::string& materialName) const noexcept;
+private:
+	std::unordered_map<std::string, Entry> entries;
+	static bool enabled;
+};
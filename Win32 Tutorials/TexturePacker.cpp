@@ -0,0 +1,319 @@
+#include "TexturePacker.h"
+#include "TexturePack.h"
+#include "Surface.h"
+#include "SurfaceStream.h"
+#include "ModelException.h"
+#include "RedSkyUtility.h"
+#include "json.hpp"
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <map>
+
+// imgui compiles its own static copy, this one stays private to the packer
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imgui/imstb_rectpack.h"
+
+namespace
+{
+	enum Role
+	{
+		Diffuse,
+		Specular,
+		Normal,
+		RoleCount
+	};
+	constexpr aiTextureType roleTypes[RoleCount] = { aiTextureType_DIFFUSE,aiTextureType_SPECULAR,aiTextureType_NORMALS };
+	constexpr const char* roleKeys[RoleCount] = { "diffuse","specular","normal" };
+	constexpr const char* roleCodes[RoleCount] = { "dif","spc","nrm" };
+
+	struct PackMaterial
+	{
+		std::string name;
+		std::string paths[RoleCount];
+		unsigned int width = 0u;
+		unsigned int height = 0u;
+		// uvs never leave [0,1], so the maps can sit in an atlas without wrapping
+		bool clamped = true;
+		size_t group = 0u;
+		unsigned int layer = 0u;
+		unsigned int x = 0u;
+		unsigned int y = 0u;
+		bool alpha[RoleCount] = {};
+	};
+	struct PackGroup
+	{
+		unsigned int width;
+		unsigned int height;
+		unsigned int layers;
+		unsigned int padding;
+		std::vector<size_t> members;
+	};
+
+	// copies src into dst at (x,y), repeating its edge texels into the padding around it
+	void Blit(const Surface& src, const DirectX::Image& dst, unsigned int x, unsigned int y, unsigned int padding)
+	{
+		const int w = (int)src.GetWidth();
+		const int h = (int)src.GetHeight();
+		const int p = (int)padding;
+		for (int ty = -p; ty < h + p; ty++)
+		{
+			const auto sy = std::clamp(ty, 0, h - 1);
+			auto pDst = reinterpret_cast<Surface::Color*>(dst.pixels + dst.rowPitch * size_t((int)y + ty)) + x;
+			const auto pSrc = src.GetBufferPtrConst() + size_t(sy) * w;
+			for (int tx = -p; tx < w + p; tx++)
+			{
+				pDst[tx] = pSrc[std::clamp(tx, 0, w - 1)];
+			}
+		}
+	}
+}
+
+std::vector<TexturePacker::Placement> TexturePacker::PackRects(const std::vector<Rect>& rects, unsigned int pageSize, unsigned int padding)
+{
+	std::vector<Placement> placements(rects.size());
+	std::vector<stbrp_rect> pending;
+	for (size_t i = 0; i < rects.size(); i++)
+	{
+		assert(rects[i].width + 2u * padding <= pageSize && rects[i].height + 2u * padding <= pageSize);
+		stbrp_rect r = {};
+		r.id = (int)i;
+		r.w = stbrp_coord(rects[i].width + 2u * padding);
+		r.h = stbrp_coord(rects[i].height + 2u * padding);
+		pending.push_back(r);
+	}
+
+	// fill a page, move whatever didn't fit on to the next one
+	std::vector<stbrp_node> nodes(pageSize);
+	for (unsigned int page = 0u; !pending.empty(); page++)
+	{
+		stbrp_context context;
+		stbrp_init_target(&context, (int)pageSize, (int)pageSize, nodes.data(), (int)nodes.size());
+		stbrp_pack_rects(&context, pending.data(), (int)pending.size());
+		std::vector<stbrp_rect> leftover;
+		for (const auto& r : pending)
+		{
+			if (r.was_packed)
+			{
+				placements[r.id] = { page,r.x + padding,r.y + padding };
+			}
+			else
+			{
+				leftover.push_back(r);
+			}
+		}
+		pending = std::move(leftover);
+	}
+	return placements;
+}
+
+void TexturePacker::PackObj(const std::string& objPath, unsigned int pageSize, unsigned int padding)
+{
+	const auto modelDir = std::filesystem::path{ objPath }.parent_path();
+	const auto rootPath = modelDir.string() + "/";
+	const auto stem = std::filesystem::path{ objPath }.stem().string();
+
+	Assimp::Importer imp;
+	const auto pScene = imp.ReadFile(objPath.c_str(), 0u);
+	if (pScene == nullptr)
+	{
+		throw ModelException(__LINE__, __FILE__, imp.GetErrorString());
+	}
+
+	// materials can only be packed when all of their maps agree on a size
+	std::vector<PackMaterial> materials;
+	for (auto i = 0u; i < pScene->mNumMaterials; i++)
+	{
+		const auto& mat = *pScene->mMaterials[i];
+		PackMaterial pm;
+		{
+			aiString tempName;
+			mat.Get(AI_MATKEY_NAME, tempName);
+			pm.name = tempName.C_Str();
+		}
+		bool packable = true;
+		bool hasMap = false;
+		for (int role = 0; role < RoleCount; role++)
+		{
+			aiString texFileName;
+			if (mat.GetTexture(roleTypes[role], 0, &texFileName) != aiReturn_SUCCESS)
+			{
+				continue;
+			}
+			pm.paths[role] = texFileName.C_Str();
+			// only the header is read here, the pixels are decoded when the group is written
+			SurfaceReader reader{ rootPath + pm.paths[role] };
+			if (!hasMap)
+			{
+				pm.width = reader.GetWidth();
+				pm.height = reader.GetHeight();
+				hasMap = true;
+			}
+			packable = packable && pm.width == reader.GetWidth() && pm.height == reader.GetHeight();
+		}
+		if (!hasMap || !packable)
+		{
+			continue;
+		}
+		for (auto m = 0u; m < pScene->mNumMeshes; m++)
+		{
+			const auto& mesh = *pScene->mMeshes[m];
+			if (mesh.mMaterialIndex != i || !mesh.HasTextureCoords(0))
+			{
+				continue;
+			}
+			for (auto v = 0u; v < mesh.mNumVertices && pm.clamped; v++)
+			{
+				const auto& tc = mesh.mTextureCoords[0][v];
+				pm.clamped = tc.x >= -0.001f && tc.x <= 1.001f && tc.y >= -0.001f && tc.y <= 1.001f;
+			}
+		}
+		materials.push_back(std::move(pm));
+	}
+
+	// clamped materials small enough to share a page go into the atlas
+	std::vector<PackGroup> groups;
+	std::vector<size_t> atlasMembers;
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		const auto& pm = materials[i];
+		if (pm.clamped && (pm.width + 2u * padding) * 2u <= pageSize && (pm.height + 2u * padding) * 2u <= pageSize)
+		{
+			atlasMembers.push_back(i);
+		}
+	}
+	if (atlasMembers.size() >= 2u)
+	{
+		std::vector<Rect> rects;
+		for (auto i : atlasMembers)
+		{
+			rects.push_back({ materials[i].width,materials[i].height });
+		}
+		const auto placements = PackRects(rects, pageSize, padding);
+		PackGroup atlas{ pageSize,pageSize,0u,padding,atlasMembers };
+		for (size_t n = 0; n < atlasMembers.size(); n++)
+		{
+			auto& pm = materials[atlasMembers[n]];
+			pm.group = groups.size();
+			pm.layer = placements[n].page;
+			pm.x = placements[n].x;
+			pm.y = placements[n].y;
+			atlas.layers = std::max(atlas.layers, pm.layer + 1u);
+		}
+		groups.push_back(std::move(atlas));
+	}
+	else
+	{
+		atlasMembers.clear();
+	}
+
+	// everything else shares an array with the materials of the same size
+	std::map<std::pair<unsigned int, unsigned int>, std::vector<size_t>> bySize;
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		if (std::find(atlasMembers.begin(), atlasMembers.end(), i) == atlasMembers.end())
+		{
+			bySize[{ materials[i].width, materials[i].height }].push_back(i);
+		}
+	}
+	for (auto& [size, members] : bySize)
+	{
+		// a group of one saves no binds
+		if (members.size() < 2u)
+		{
+			continue;
+		}
+		for (size_t n = 0; n < members.size(); n++)
+		{
+			materials[members[n]].group = groups.size();
+			materials[members[n]].layer = (unsigned int)n;
+		}
+		groups.push_back({ size.first,size.second,(unsigned int)members.size(),0u,std::move(members) });
+	}
+
+	// write one array per group and map, a map at a time to bound memory
+	nlohmann::json manifest;
+	manifest["materials"] = nlohmann::json::object();
+	for (size_t g = 0; g < groups.size(); g++)
+	{
+		const auto& group = groups[g];
+		for (int role = 0; role < RoleCount; role++)
+		{
+			if (std::none_of(group.members.begin(), group.members.end(), [&](size_t i) { return !materials[i].paths[role].empty(); }))
+			{
+				continue;
+			}
+			DirectX::ScratchImage layers;
+			HRESULT hr = layers.Initialize2D(DXGI_FORMAT_B8G8R8A8_UNORM, group.width, group.height, group.layers, 1u);
+			if (FAILED(hr))
+			{
+				throw Surface::Exception(__LINE__, __FILE__, objPath, "Failed to allocate texture array", hr);
+			}
+			std::memset(layers.GetPixels(), 0, layers.GetPixelsSize());
+			for (auto i : group.members)
+			{
+				auto& pm = materials[i];
+				if (pm.paths[role].empty())
+				{
+					continue;
+				}
+				const auto s = SurfaceReader{ rootPath + pm.paths[role] }.ReadAll();
+				pm.alpha[role] = s.AlphaLoaded();
+				Blit(s, *layers.GetImage(0u, pm.layer, 0u), pm.x, pm.y, group.padding);
+			}
+
+			// atlas mips stop once the padding would no longer cover a texel of bleed
+			size_t levels = 0u;
+			if (group.padding > 0u)
+			{
+				levels = 1u;
+				for (auto p = group.padding; p > 1u; p >>= 1u)
+				{
+					levels++;
+				}
+			}
+			DirectX::ScratchImage mipChain;
+			hr = DirectX::GenerateMipMaps(layers.GetImages(), layers.GetImageCount(), layers.GetMetadata(), DirectX::TEX_FILTER_DEFAULT, levels, mipChain);
+			if (FAILED(hr))
+			{
+				throw Surface::Exception(__LINE__, __FILE__, objPath, "Failed to generate texture array mips", hr);
+			}
+			const auto fileName = stem + "_pack" + std::to_string(g) + "_" + roleCodes[role] + ".dds";
+			hr = DirectX::SaveToDDSFile(
+				mipChain.GetImages(), mipChain.GetImageCount(), mipChain.GetMetadata(),
+				DirectX::DDS_FLAGS_NONE, ToWide(rootPath + fileName).c_str()
+			);
+			if (FAILED(hr))
+			{
+				throw Surface::Exception(__LINE__, __FILE__, fileName, "Failed to save texture array", hr);
+			}
+			for (auto i : group.members)
+			{
+				if (!materials[i].paths[role].empty())
+				{
+					manifest["materials"][materials[i].name][roleKeys[role]] = fileName;
+				}
+			}
+		}
+		for (auto i : group.members)
+		{
+			const auto& pm = materials[i];
+			auto& j = manifest["materials"][pm.name];
+			j["layer"] = pm.layer;
+			j["transform"] = {
+				float(pm.width) / float(group.width),float(pm.height) / float(group.height),
+				float(pm.x) / float(group.width),float(pm.y) / float(group.height)
+			};
+			j["diffuseAlpha"] = pm.alpha[Diffuse];
+			j["glossAlpha"] = pm.alpha[Specular];
+		}
+	}
+
+	std::ofstream file{ TexturePack::MakeManifestPath(objPath) };
+	file << manifest.dump(1, '\t');
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Offline packing of a model's material textures into shared .dds arrays, so that
+// draws of different materials can keep the same shader resources bound.
+// Materials whose maps are the same size share an array, one layer each. Materials
+// whose uvs stay inside [0,1] can also share a layer, rect packed as a padded atlas.
+class TexturePacker
+{
+public:
+	struct Rect
+	{
+		unsigned int width;
+		unsigned int height;
+	};
+	struct Placement
+	{
+		unsigned int page;
+		unsigned int x;
+		unsigned int y;
+	};
+public:
+	// places rects on as few square pages as needed, keeping padding clear on every side
+	static std::vector<Placement> PackRects(const std::vector<Rect>& rects, unsigned int pageSize, unsigned int padding);
+	// writes the arrays and the manifest that TexturePack reads next to the model
+	static void PackObj(const std::string& objPath, unsigned int pageSize = 2048u, unsigned int padding = 16u);
+};
@@ -6,34 +6,59 @@
 #include <assimp/postprocess.h>
 #include "RedSkyMath.h"
 #include "ModelException.h"
+#include "SurfaceStream.h"
+#include "RedSkyUtility.h"
+#include "GaussKernel.h"
+#include <DirectXPackedVector.h>
+#include <vector>
 
 
 template<typename F>
-inline void TexturePreprocessor::TransformSurface(Surface& surf, F&& func)
+inline void TexturePreprocessor::TransformSurface(Surface& surf, F&& func, unsigned int nRows, unsigned int rowOffset)
 {
 	const auto width = surf.GetWidth();
-	const auto height = surf.GetHeight();
-	for (unsigned int y = 0; y < height; y++)
+	for (unsigned int y = 0; y < nRows; y++)
 	{
 		for (unsigned int x = 0; x < width; x++)
 		{
 			const auto n = ColorToVector(surf.GetPixel(x, y));
-			surf.PutPixel(x, y, VectorToColor(func(n, x, y)));
+			surf.PutPixel(x, y, VectorToColor(func(n, x, y + rowOffset)));
 		}
 	}
 }
 
+template<typename F>
+inline void TexturePreprocessor::TransformSurface(Surface& surf, F&& func)
+{
+	TransformSurface(surf, func, surf.GetHeight(), 0u);
+}
+
 template<typename F>
 inline void TexturePreprocessor::TransformFile(const std::string& pathIn, const std::string& pathOut, F&& func)
 {
-	auto surf = Surface::FromFile(pathIn);
-	TransformSurface(surf, func);
-	surf.Save(pathOut);
+	// stream strips through the transform so that only one strip is ever resident
+	SurfaceReader reader{ pathIn };
+	auto strip = reader.MakeStrip();
+	// when transforming in place the source has to be fully read before the output is opened
+	if (pathIn == pathOut)
+	{
+		auto surf = reader.ReadAll();
+		TransformSurface(surf, func);
+		surf.Save(pathOut);
+		return;
+	}
+	SurfaceWriter writer{ pathOut,reader.GetWidth(),reader.GetHeight() };
+	for (unsigned int row = 0u, nRows; (nRows = reader.ReadStrip(strip)) != 0u; row += nRows)
+	{
+		TransformSurface(strip, func, nRows, row);
+		writer.WriteStrip(strip, nRows);
+	}
+	writer.Commit();
 }
 
 void TexturePreprocessor::FlipYAllNormalMapsInObj(const std::string& objPath)
 {
-	const auto rootPath = std::filesystem::path{ objPath }.parent_path().string() + "\\";
+	const auto rootPath = std::filesystem::path{ objPath }.parent_path().string() + "/";
 
 	// load scene from .obj file to get our list of normal maps in the materials
 	Assimp::Importer imp;
@@ -98,9 +123,13 @@ void TexturePreprocessor::ValidateNormalMap(const std::string& pathIn, float thr
 		sum = XMVectorAdd(sum, n);
 		return n;
 	};
-	// execute the validation for each texel
-	auto surf = Surface::FromFile(pathIn);
-	TransformSurface(surf, ProcessNormal);
+	// execute the validation for each texel, one strip at a time
+	SurfaceReader reader{ pathIn };
+	auto strip = reader.MakeStrip();
+	for (unsigned int row = 0u, nRows; (nRows = reader.ReadStrip(strip)) != 0u; row += nRows)
+	{
+		TransformSurface(strip, ProcessNormal, nRows, row);
+	}
 	// output bias
 	{
 		XMFLOAT2 sumv;
@@ -135,6 +164,141 @@ void TexturePreprocessor::MakeStripes(const std::string& pathOut, int size, int
 	s.Save(pathOut);
 }
 
+void TexturePreprocessor::MakeMipChain(const std::string& pathIn, const std::string& pathOut)
+{
+	const auto s = SurfaceReader{ pathIn }.ReadAll();
+	DirectX::Image image;
+	image.width = s.GetWidth();
+	image.height = s.GetHeight();
+	image.format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	image.rowPitch = image.width * sizeof(Surface::Color);
+	image.slicePitch = image.rowPitch * image.height;
+	image.pixels = reinterpret_cast<uint8_t*>(const_cast<Surface::Color*>(s.GetBufferPtrConst()));
+
+	DirectX::ScratchImage mipChain;
+	HRESULT hr = DirectX::GenerateMipMaps(image, DirectX::TEX_FILTER_DEFAULT, 0u, mipChain);
+	if (FAILED(hr))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, pathIn, "Failed to generate mip chain", hr);
+	}
+	hr = DirectX::SaveToDDSFile(
+		mipChain.GetImages(), mipChain.GetImageCount(), mipChain.GetMetadata(),
+		DirectX::DDS_FLAGS_NONE, ToWide(pathOut).c_str()
+	);
+	if (FAILED(hr))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, pathOut, "Failed to save mip chain", hr);
+	}
+}
+
+void TexturePreprocessor::MakeMipChainsInObj(const std::string& objPath)
+{
+	const auto rootPath = std::filesystem::path{ objPath }.parent_path().string() + "/";
+
+	Assimp::Importer imp;
+	const auto pScene = imp.ReadFile(objPath.c_str(), 0u);
+	if (pScene == nullptr)
+	{
+		throw ModelException(__LINE__, __FILE__, imp.GetErrorString());
+	}
+
+	// every texture a material can bind gets a .dds chain next to it
+	for (auto i = 0u; i < pScene->mNumMaterials; i++)
+	{
+		const auto& mat = *pScene->mMaterials[i];
+		for (auto type : { aiTextureType_DIFFUSE,aiTextureType_SPECULAR,aiTextureType_NORMALS })
+		{
+			aiString texFileName;
+			if (mat.GetTexture(type, 0, &texFileName) == aiReturn_SUCCESS)
+			{
+				const auto path = rootPath + texFileName.C_Str();
+				MakeMipChain(path, std::filesystem::path{ path }.replace_extension(".dds").string());
+			}
+		}
+	}
+}
+
+void TexturePreprocessor::GaussianBlur(Surface& surf, const GaussKernel& kernel, bool folded)
+{
+	using namespace DirectX;
+	using namespace DirectX::PackedVector;
+	const int width = (int)surf.GetWidth();
+	const int height = (int)surf.GetHeight();
+
+	// mirrored addressing, matching the sampler the gpu blur uses
+	const auto Mirror = [](int i, int n)
+	{
+		while (i < 0 || i >= n)
+		{
+			i = i < 0 ? -i - 1 : 2 * n - i - 1;
+		}
+		return i;
+	};
+	// one output texel of a pass along a line of n texels spaced stride apart
+	const auto& weights = kernel.GetWeights();
+	const auto& taps = kernel.GetFoldedTaps();
+	const int radius = kernel.GetRadius();
+	const auto Filter = [&](const XMVECTOR* pLine, int stride, int n, int i)
+	{
+		if (!folded)
+		{
+			XMVECTOR acc = XMVectorZero();
+			for (int k = -radius; k <= radius; k++)
+			{
+				acc = XMVectorMultiplyAdd(pLine[Mirror(i + k, n) * stride], XMVectorReplicate(weights[radius + k]), acc);
+			}
+			return acc;
+		}
+		const auto Sample = [&](float pos)
+		{
+			const auto i0 = (int)std::floor(pos);
+			const auto t = pos - float(i0);
+			return XMVectorLerp(pLine[Mirror(i0, n) * stride], pLine[Mirror(i0 + 1, n) * stride], t);
+		};
+		XMVECTOR acc = XMVectorScale(pLine[i * stride], taps[0].weight);
+		for (size_t k = 1; k < taps.size(); k++)
+		{
+			const auto pair = XMVectorAdd(Sample(float(i) + taps[k].offset), Sample(float(i) - taps[k].offset));
+			acc = XMVectorMultiplyAdd(pair, XMVectorReplicate(taps[k].weight), acc);
+		}
+		return acc;
+	};
+
+	// widen to floats once so both passes run on whole vectors
+	std::vector<XMVECTOR> a(size_t(width) * height);
+	std::vector<XMVECTOR> b(a.size());
+	const auto pPixels = surf.GetBufferPtr();
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		a[i] = XMLoadUByteN4(reinterpret_cast<const XMUBYTEN4*>(&pPixels[i]));
+	}
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			b[size_t(y) * width + x] = Filter(&a[size_t(y) * width], 1, width, x);
+		}
+	}
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			a[size_t(y) * width + x] = Filter(&b[x], width, height, y);
+		}
+	}
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(&pPixels[i]), a[i]);
+	}
+}
+
+void TexturePreprocessor::BlurFile(const std::string& pathIn, const std::string& pathOut, int radius, float sigma)
+{
+	auto s = SurfaceReader{ pathIn }.ReadAll();
+	GaussianBlur(s, GaussKernel{ radius,sigma });
+	s.Save(pathOut);
+}
+
 DirectX::XMVECTOR TexturePreprocessor::ColorToVector(Surface::Color c) noexcept
 {
 	using namespace DirectX;
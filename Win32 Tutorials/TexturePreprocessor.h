@@ -4,6 +4,8 @@
 #include <string>
 #include <DirectXMath.h>
 
+class GaussKernel;
+
 
 class TexturePreprocessor
 {
@@ -12,11 +14,19 @@ public:
 	static void FlipYNormalMap( const std::string& pathIn,const std::string& pathOut );
 	static void ValidateNormalMap( const std::string& pathIn,float thresholdMin,float thresholdMax );
 	static void MakeStripes( const std::string& pathOut,int size,int stripeWidth );
+	// writes a full bgra mip chain as .dds, textures with one alongside them are streamed
+	static void MakeMipChain( const std::string& pathIn,const std::string& pathOut );
+	static void MakeMipChainsInObj( const std::string& objPath );
+	// separable gaussian blur on the cpu, folded uses the same bilinear taps as Blur_PS
+	static void GaussianBlur( Surface& surf,const GaussKernel& kernel,bool folded = true );
+	static void BlurFile( const std::string& pathIn,const std::string& pathOut,int radius,float sigma );
 private:
 	template<typename F>
 	static void TransformFile( const std::string& pathIn,const std::string& pathOut,F&& func );
 	template<typename F>
 	static void TransformSurface( Surface& surf,F && func );
+	template<typename F>
+	static void TransformSurface( Surface& surf,F&& func,unsigned int nRows,unsigned int rowOffset );
 	static DirectX::XMVECTOR ColorToVector( Surface::Color c ) noexcept;
 	static Surface::Color VectorToColor( DirectX::FXMVECTOR n ) noexcept;
 };
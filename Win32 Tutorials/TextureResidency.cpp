@@ -0,0 +1,231 @@
+#include "TextureResidency.h"
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+MipResidency::MipResidency(TextureUploader& uploader) noexcept
+	:
+	MipResidency(uploader, Settings{})
+{}
+
+MipResidency::MipResidency(TextureUploader& uploader, Settings settings) noexcept
+	:
+	uploader(uploader),
+	settings(settings)
+{}
+
+size_t MipResidency::Register(unsigned int width, unsigned int height, unsigned int mipCount, unsigned int bytesPerTexel)
+{
+	assert(mipCount > 0u);
+	Entry e;
+	e.width = width;
+	e.height = height;
+	e.mipCount = mipCount;
+	e.bytesPerTexel = bytesPerTexel;
+	// coarsest level is always resident, finer ones only while small enough
+	e.initialMip = mipCount - 1u;
+	while (e.initialMip > 0u && std::max(width >> (e.initialMip - 1u), height >> (e.initialMip - 1u)) <= settings.initialDimension)
+	{
+		e.initialMip--;
+	}
+	e.residentMip = e.initialMip;
+	e.pendingMip = e.initialMip;
+	e.requestedMip = mipCount;
+	e.desiredMip = e.initialMip;
+	residentBytes += e.BytesAt(e.residentMip);
+	entries.push_back(e);
+	return entries.size() - 1u;
+}
+
+void MipResidency::Unregister(size_t id) noexcept
+{
+	auto& e = entries[id];
+	if (!e.live)
+	{
+		return;
+	}
+	// ids are never reused, so an upload still in flight completes harmlessly
+	residentBytes -= e.BytesAt(e.residentMip);
+	if (e.pendingMip != e.residentMip)
+	{
+		pendingBytes -= e.BytesAt(e.pendingMip) - e.BytesAt(e.residentMip);
+		uploadsInFlight--;
+	}
+	e.live = false;
+}
+
+void MipResidency::Request(size_t id, unsigned int mip) noexcept
+{
+	auto& e = entries[id];
+	e.requestedMip = std::min(e.requestedMip, std::min(mip, e.mipCount - 1u));
+}
+
+void MipResidency::Update()
+{
+	// fold this frame's requests into what each texture wants resident
+	std::vector<size_t> candidates;
+	for (size_t id = 0u; id < entries.size(); id++)
+	{
+		auto& e = entries[id];
+		if (!e.live)
+		{
+			continue;
+		}
+		if (e.requestedMip < e.mipCount)
+		{
+			e.desiredMip = std::min(e.requestedMip, e.initialMip);
+			e.framesSinceRequest = 0u;
+		}
+		else if (++e.framesSinceRequest >= settings.framesUntilStale)
+		{
+			e.desiredMip = e.initialMip;
+		}
+		e.requestedMip = e.mipCount;
+		if (e.desiredMip < e.residentMip && e.pendingMip == e.residentMip)
+		{
+			candidates.push_back(id);
+		}
+	}
+	// largest deficit first, cheapest upgrade breaks ties
+	std::sort(candidates.begin(), candidates.end(), [this](size_t a, size_t b)
+		{
+			const auto& ea = entries[a];
+			const auto& eb = entries[b];
+			const auto da = ea.residentMip - ea.desiredMip;
+			const auto db = eb.residentMip - eb.desiredMip;
+			if (da != db)
+			{
+				return da > db;
+			}
+			return ea.BytesAt(ea.residentMip - 1u) < eb.BytesAt(eb.residentMip - 1u);
+		}
+	);
+	for (auto id : candidates)
+	{
+		if (uploadsInFlight >= settings.maxUploadsInFlight)
+		{
+			break;
+		}
+		auto& e = entries[id];
+		// one level at a time keeps each upload small and the budget granular
+		const auto target = e.residentMip - 1u;
+		const auto cost = e.BytesAt(target) - e.BytesAt(e.residentMip);
+		if (!MakeRoom(cost, id))
+		{
+			continue;
+		}
+		e.pendingMip = target;
+		pendingBytes += cost;
+		uploadsInFlight++;
+		uploader.BeginUpload(id, target);
+	}
+}
+
+void MipResidency::OnUploadComplete(size_t id, unsigned int firstMip) noexcept
+{
+	auto& e = entries[id];
+	if (!e.live || e.pendingMip != firstMip)
+	{
+		return;
+	}
+	const auto cost = e.BytesAt(firstMip) - e.BytesAt(e.residentMip);
+	pendingBytes -= cost;
+	residentBytes += cost;
+	uploadsInFlight--;
+	e.residentMip = firstMip;
+}
+
+unsigned int MipResidency::GetInitialMip(size_t id) const noexcept
+{
+	return entries[id].initialMip;
+}
+
+unsigned int MipResidency::GetResidentMip(size_t id) const noexcept
+{
+	return entries[id].residentMip;
+}
+
+bool MipResidency::IsUploading(size_t id) const noexcept
+{
+	return entries[id].pendingMip != entries[id].residentMip;
+}
+
+size_t MipResidency::GetResidentBytes() const noexcept
+{
+	return residentBytes;
+}
+
+size_t MipResidency::GetPendingBytes() const noexcept
+{
+	return pendingBytes;
+}
+
+const MipResidency::Settings& MipResidency::GetSettings() const noexcept
+{
+	return settings;
+}
+
+unsigned int MipResidency::ComputeRequiredMip(unsigned int width, unsigned int height, unsigned int mipCount, float screenPixelsPerUv) noexcept
+{
+	// no estimate (or an infinitely close surface) means full detail
+	if (!(screenPixelsPerUv > 0.0f) || std::isinf(screenPixelsPerUv))
+	{
+		return 0u;
+	}
+	const float texelsPerPixel = float(std::max(width, height)) / screenPixelsPerUv;
+	if (texelsPerPixel <= 1.0f)
+	{
+		return 0u;
+	}
+	const auto mip = (unsigned int)std::floor(std::log2(texelsPerPixel));
+	return std::min(mip, mipCount - 1u);
+}
+
+size_t MipResidency::ComputeResidentBytes(unsigned int width, unsigned int height, unsigned int mipCount, unsigned int bytesPerTexel, unsigned int firstMip) noexcept
+{
+	size_t bytes = 0u;
+	for (unsigned int mip = firstMip; mip < mipCount; mip++)
+	{
+		bytes += size_t(std::max(width >> mip, 1u)) * std::max(height >> mip, 1u) * bytesPerTexel;
+	}
+	return bytes;
+}
+
+size_t MipResidency::Entry::BytesAt(unsigned int firstMip) const noexcept
+{
+	return ComputeResidentBytes(width, height, mipCount, bytesPerTexel, firstMip);
+}
+
+bool MipResidency::MakeRoom(size_t bytes, size_t exclude)
+{
+	while (residentBytes + pendingBytes + bytes > settings.budgetBytes)
+	{
+		// evict from whichever idle texture holds the most detail it no longer wants
+		size_t victim = entries.size();
+		unsigned int victimStaleness = 0u;
+		for (size_t id = 0u; id < entries.size(); id++)
+		{
+			const auto& e = entries[id];
+			if (id == exclude || !e.live || e.pendingMip != e.residentMip || e.desiredMip <= e.residentMip)
+			{
+				continue;
+			}
+			if (victim == entries.size() || e.framesSinceRequest > victimStaleness)
+			{
+				victim = id;
+				victimStaleness = e.framesSinceRequest;
+			}
+		}
+		if (victim == entries.size())
+		{
+			return false;
+		}
+		auto& v = entries[victim];
+		const auto newFirst = v.residentMip + 1u;
+		residentBytes -= v.BytesAt(v.residentMip) - v.BytesAt(newFirst);
+		v.residentMip = newFirst;
+		v.pendingMip = newFirst;
+		uploader.Evict(victim, newFirst);
+	}
+	return true;
+}
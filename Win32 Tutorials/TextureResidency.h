@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// Receives the residency decisions made by MipResidency. The d3d implementation
+// streams mips from disk on worker threads, tests can substitute a mock.
+class TextureUploader
+{
+public:
+	virtual ~TextureUploader() = default;
+	// start making mips [firstMip,end) resident, must be answered with MipResidency::OnUploadComplete
+	virtual void BeginUpload(size_t id, unsigned int firstMip) = 0;
+	// drop every mip finer than firstMip, takes effect immediately
+	virtual void Evict(size_t id, unsigned int firstMip) = 0;
+};
+
+// Decides which mip levels of each streamed texture should be resident. Draws request
+// the mip they need each frame, Update then streams textures one level at a time toward
+// their request while keeping resident + in flight bytes within the budget, evicting
+// detail that is no longer requested when space is needed.
+class MipResidency
+{
+public:
+	struct Settings
+	{
+		size_t budgetBytes = 512u * 1024u * 1024u;
+		unsigned int maxUploadsInFlight = 4u;
+		// textures start with only the mips no larger than this resident
+		unsigned int initialDimension = 64u;
+		// textures not requested for this many frames only need their initial mips
+		unsigned int framesUntilStale = 120u;
+	};
+public:
+	MipResidency(TextureUploader& uploader) noexcept;
+	MipResidency(TextureUploader& uploader, Settings settings) noexcept;
+	size_t Register(unsigned int width, unsigned int height, unsigned int mipCount, unsigned int bytesPerTexel);
+	void Unregister(size_t id) noexcept;
+	void Request(size_t id, unsigned int mip) noexcept;
+	void Update();
+	void OnUploadComplete(size_t id, unsigned int firstMip) noexcept;
+	unsigned int GetInitialMip(size_t id) const noexcept;
+	unsigned int GetResidentMip(size_t id) const noexcept;
+	bool IsUploading(size_t id) const noexcept;
+	size_t GetResidentBytes() const noexcept;
+	size_t GetPendingBytes() const noexcept;
+	const Settings& GetSettings() const noexcept;
+	// mip whose texel density matches the screen, given how many pixels one unit of uv spans
+	static unsigned int ComputeRequiredMip(unsigned int width, unsigned int height, unsigned int mipCount, float screenPixelsPerUv) noexcept;
+	// bytes used by mips [firstMip,mipCount)
+	static size_t ComputeResidentBytes(unsigned int width, unsigned int height, unsigned int mipCount, unsigned int bytesPerTexel, unsigned int firstMip) noexcept;
+private:
+	struct Entry
+	{
+		unsigned int width;
+		unsigned int height;
+		unsigned int mipCount;
+		unsigned int bytesPerTexel;
+		unsigned int initialMip;
+		unsigned int residentMip;
+		unsigned int pendingMip;
+		unsigned int requestedMip;
+		unsigned int desiredMip;
+		unsigned int framesSinceRequest = 0u;
+		bool live = true;
+		size_t BytesAt(unsigned int firstMip) const noexcept;
+	};
+private:
+	bool MakeRoom(size_t bytes, size_t exclude);
+private:
+	TextureUploader& uploader;
+	Settings settings;
+	std::vector<Entry> entries;
+	size_t residentBytes = 0u;
+	size_t pendingBytes = 0u;
+	unsigned int uploadsInFlight = 0u;
+};
@@ -0,0 +1,198 @@
+#include "TextureStreamer.h"
+#include "Texture.h"
+#include "Surface.h"
+#include "RedSkyUtility.h"
+#include "PerformanceLog.h"
+#include "Vfs.h"
+#include <dxtex/DDS.h>
+#include <filesystem>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+std::shared_ptr<TextureStreamer> TextureStreamer::Get()
+{
+	static std::shared_ptr<TextureStreamer> pStreamer{ new TextureStreamer };
+	return pStreamer;
+}
+
+TextureStreamer::TextureStreamer()
+	:
+	residency(*this)
+{}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		done = true;
+	}
+	cv.notify_one();
+	if (worker.joinable())
+	{
+		worker.join();
+	}
+}
+
+size_t TextureStreamer::Register(Bind::Texture& tex, const FileInfo& info)
+{
+	const auto id = residency.Register(info.width, info.height, info.mipCount, sizeof(Surface::Color));
+	textures.resize(id + 1u, nullptr);
+	textures[id] = &tex;
+	return id;
+}
+
+void TextureStreamer::Unregister(size_t id) noexcept
+{
+	residency.Unregister(id);
+	textures[id] = nullptr;
+}
+
+MipResidency& TextureStreamer::GetResidency() noexcept
+{
+	return residency;
+}
+
+void TextureStreamer::Update(Graphics& gfx)
+{
+	pGfx = &gfx;
+	for (auto i = uploads.begin(); i != uploads.end();)
+	{
+		if (i->data.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready)
+		{
+			++i;
+			continue;
+		}
+		// get rethrows any file error from the worker here on the render thread
+		const auto mips = i->data.get();
+		if (auto pTex = textures[i->id])
+		{
+			pTex->ApplyMips(gfx, i->firstMip, mips);
+		}
+		residency.OnUploadComplete(i->id, i->firstMip);
+		i = uploads.erase(i);
+	}
+	residency.Update();
+}
+
+void TextureStreamer::BeginUpload(size_t id, unsigned int firstMip)
+{
+	Read read{ textures[id]->GetStreamPath(),firstMip,residency.GetResidentMip(id) };
+	uploads.push_back({ id,firstMip,read.result.get_future() });
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		reads.push_back(std::move(read));
+	}
+	if (!worker.joinable())
+	{
+		worker = std::thread{ &TextureStreamer::Work,this };
+	}
+	cv.notify_one();
+}
+
+void TextureStreamer::Evict(size_t id, unsigned int firstMip)
+{
+	assert(pGfx != nullptr && "Evictions only happen inside Update");
+	textures[id]->DropMips(*pGfx, firstMip);
+}
+
+std::string TextureStreamer::FindMippedFile(const std::string& path)
+{
+	// a .dds source is loaded whole, only a cooked sibling of another image is streamed
+	auto ddsPath = std::filesystem::path{ path }.replace_extension(".dds");
+	if (ddsPath == std::filesystem::path{ path } || !Vfs::Get().Exists(ddsPath.string()))
+	{
+		return {};
+	}
+	return ddsPath.string();
+}
+
+TextureStreamer::FileInfo TextureStreamer::ReadFileInfo(const std::string& ddsPath)
+{
+	const auto file = Vfs::Get().Read(ddsPath);
+	DirectX::TexMetadata meta;
+	HRESULT hr = file.IsOpen() ? DirectX::GetMetadataFromDDSMemory(file.GetData(), file.GetSize(), DirectX::DDS_FLAGS_NONE, meta) : E_FAIL;
+	if (FAILED(hr))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, ddsPath, "Failed to read dds header", hr);
+	}
+	if (meta.format != DXGI_FORMAT_B8G8R8A8_UNORM || meta.dimension != DirectX::TEX_DIMENSION_TEXTURE2D || meta.arraySize != 1u)
+	{
+		throw Surface::Exception(__LINE__, __FILE__, ddsPath, "Streamed textures must be single 2D bgra8 images");
+	}
+	return { (unsigned int)meta.width,(unsigned int)meta.height,(unsigned int)meta.mipLevels };
+}
+
+TextureStreamer::MipChain TextureStreamer::ReadMips(const std::string& ddsPath, unsigned int firstMip, unsigned int endMip)
+{
+	PROFILE_ZONE("TextureStreamer::ReadMips");
+	const auto file = Vfs::Get().Read(ddsPath);
+	uint32_t magic = 0u;
+	DirectX::DDS_HEADER header = {};
+	if (file.GetSize() < sizeof(magic) + sizeof(header))
+	{
+		throw Surface::Exception(__LINE__, __FILE__, ddsPath, "Failed to read dds header");
+	}
+	std::memcpy(&magic, file.GetData(), sizeof(magic));
+	std::memcpy(&header, file.GetData() + sizeof(magic), sizeof(header));
+	if (magic != DirectX::DDS_MAGIC)
+	{
+		throw Surface::Exception(__LINE__, __FILE__, ddsPath, "Failed to read dds header");
+	}
+	// mips are stored finest first straight after the headers
+	size_t offset = sizeof(magic) + sizeof(header);
+	if ((header.ddspf.flags & DDS_FOURCC) && header.ddspf.fourCC == MAKEFOURCC('D', 'X', '1', '0'))
+	{
+		offset += sizeof(DirectX::DDS_HEADER_DXT10);
+	}
+	const auto mipBytes = [&header](unsigned int mip)
+	{
+		return size_t(std::max(header.width >> mip, 1u)) * std::max(header.height >> mip, 1u) * sizeof(Surface::Color);
+	};
+	for (unsigned int mip = 0u; mip < firstMip; mip++)
+	{
+		offset += mipBytes(mip);
+	}
+
+	MipChain mips;
+	for (unsigned int mip = firstMip; mip < endMip; mip++)
+	{
+		const auto bytes = mipBytes(mip);
+		if (offset + bytes > file.GetSize())
+		{
+			throw Surface::Exception(__LINE__, __FILE__, ddsPath, "Dds image is truncated");
+		}
+		mips.emplace_back(file.GetData() + offset, file.GetData() + offset + bytes);
+		offset += bytes;
+	}
+	return mips;
+}
+
+void TextureStreamer::Work()
+{
+	Profiler::SetThreadName("Texture streaming");
+	while (true)
+	{
+		Read read;
+		{
+			std::unique_lock<std::mutex> lock{ mutex };
+			cv.wait(lock, [this] { return done || !reads.empty(); });
+			// reads still queued at exit are abandoned, nobody is left to apply them
+			if (done)
+			{
+				return;
+			}
+			read = std::move(reads.front());
+			reads.pop_front();
+		}
+		// file errors are handed to Update through the future, to be rethrown there
+		try
+		{
+			read.result.set_value(ReadMips(read.path, read.firstMip, read.endMip));
+		}
+		catch (...)
+		{
+			read.result.set_exception(std::current_exception());
+		}
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "TextureResidency.h"
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Graphics;
+
+namespace Bind
+{
+	class Texture;
+}
+
+// Streams the finer mips of textures that have a pre-mipped .dds next to them.
+// Files are read in order on one streaming thread, the gpu side of each upload happens in Update.
+class TextureStreamer : public TextureUploader
+{
+public:
+	// tightly packed bgra rows for each mip, coarser mips follow finer ones
+	using MipChain = std::vector<std::vector<char>>;
+	struct FileInfo
+	{
+		unsigned int width;
+		unsigned int height;
+		unsigned int mipCount;
+	};
+public:
+	// shared so textures released by the codex at exit can still unregister
+	static std::shared_ptr<TextureStreamer> Get();
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+	~TextureStreamer();
+	size_t Register(Bind::Texture& tex, const FileInfo& info);
+	void Unregister(size_t id) noexcept;
+	MipResidency& GetResidency() noexcept;
+	// applies finished uploads then lets the residency policy issue new ones, once per frame
+	void Update(Graphics& gfx);
+	void BeginUpload(size_t id, unsigned int firstMip) override;
+	void Evict(size_t id, unsigned int firstMip) override;
+	// path of the pre-mipped file for a texture, empty when there is none
+	static std::string FindMippedFile(const std::string& path);
+	static FileInfo ReadFileInfo(const std::string& ddsPath);
+	// reads mips [firstMip,endMip)
+	static MipChain ReadMips(const std::string& ddsPath, unsigned int firstMip, unsigned int endMip);
+private:
+	TextureStreamer();
+	void Work();
+private:
+	struct Upload
+	{
+		size_t id;
+		unsigned int firstMip;
+		std::future<MipChain> data;
+	};
+	struct Read
+	{
+		std::string path;
+		unsigned int firstMip;
+		unsigned int endMip;
+		std::promise<MipChain> result;
+	};
+private:
+	MipResidency residency;
+	std::vector<Bind::Texture*> textures;
+	std::vector<Upload> uploads;
+	Graphics* pGfx = nullptr;
+	// reads waiting for the streaming thread, which is started on the first one
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<Read> reads;
+	bool done = false;
+	std::thread worker;
+};
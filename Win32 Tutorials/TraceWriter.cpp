@@ -0,0 +1,165 @@
+#include "TraceWriter.h"
+#include "PerformanceLog.h"
+#include <algorithm>
+#include <iomanip>
+
+TraceWriter::TraceWriter(const std::string& path, int64_t origin)
+	:
+	path(path),
+	origin(origin),
+	file(path, std::ios::binary)
+{
+	if (!file)
+	{
+		return;
+	}
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"RedSky\"}}";
+	worker = std::thread{ &TraceWriter::Run,this };
+}
+
+TraceWriter::~TraceWriter()
+{
+	if (!worker.joinable())
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		done = true;
+	}
+	cv.notify_one();
+	worker.join();
+	file << "\n],\"otherData\":{\"droppedRecords\":" << dropped << "}}\n";
+}
+
+bool TraceWriter::IsOpen() const noexcept
+{
+	return worker.joinable();
+}
+
+void TraceWriter::Submit(std::vector<Record>&& batch)
+{
+	if (batch.empty() || !IsOpen())
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		if (queued + batch.size() > maxQueuedRecords)
+		{
+			// the writer is behind, only thread names are kept so the tracks still read right
+			const auto kept = std::remove_if(batch.begin(), batch.end(),
+				[](const Record& r) { return r.phase != Record::Phase::Metadata; });
+			dropped += size_t(batch.end() - kept);
+			batch.erase(kept, batch.end());
+			if (batch.empty())
+			{
+				return;
+			}
+		}
+		queued += batch.size();
+		queue.push_back(std::move(batch));
+	}
+	cv.notify_one();
+}
+
+const std::string& TraceWriter::GetPath() const noexcept
+{
+	return path;
+}
+
+size_t TraceWriter::GetWrittenCount() const noexcept
+{
+	std::lock_guard<std::mutex> lock{ mutex };
+	return written;
+}
+
+size_t TraceWriter::GetDroppedCount() const noexcept
+{
+	std::lock_guard<std::mutex> lock{ mutex };
+	return dropped;
+}
+
+void TraceWriter::Run()
+{
+	std::vector<std::vector<Record>> batches;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock{ mutex };
+			cv.wait(lock, [this] { return done || !queue.empty(); });
+			if (queue.empty())
+			{
+				return;
+			}
+			batches.swap(queue);
+		}
+		size_t count = 0u;
+		for (const auto& b : batches)
+		{
+			for (const auto& r : b)
+			{
+				Write(r);
+			}
+			count += b.size();
+		}
+		batches.clear();
+		file.flush();
+		std::lock_guard<std::mutex> lock{ mutex };
+		written += count;
+		queued -= count;
+	}
+}
+
+void TraceWriter::Write(const Record& r)
+{
+	// the process name always comes first, so every record follows a comma
+	file << ",\n";
+	const auto name = [this](const char* s)
+	{
+		file << '"';
+		for (; *s != '\0'; s++)
+		{
+			if (*s == '"' || *s == '\\')
+			{
+				file << '\\';
+			}
+			file << *s;
+		}
+		file << '"';
+	};
+	switch (r.phase)
+	{
+	case Record::Phase::Complete:
+		file << "{\"name\":";
+		name(r.name);
+		file << ",\"cat\":\"zone\",\"ph\":\"X\",\"pid\":1,\"tid\":" << r.thread
+			<< ",\"ts\":" << ToMicroseconds(r.start - origin) << ",\"dur\":" << ToMicroseconds(r.duration) << "}";
+		break;
+	case Record::Phase::Counter:
+		file << "{\"name\":";
+		name(r.name);
+		file << ",\"ph\":\"C\",\"pid\":1,\"tid\":" << r.thread
+			<< ",\"ts\":" << ToMicroseconds(r.start - origin) << ",\"args\":{\"value\":" << r.value << "}}";
+		break;
+	case Record::Phase::Instant:
+		// global scope draws the frame boundary across every track
+		file << "{\"name\":";
+		name(r.name);
+		file << ",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":" << r.thread
+			<< ",\"ts\":" << ToMicroseconds(r.start - origin) << ",\"args\":{\"frame\":" << r.value << "}}";
+		break;
+	case Record::Phase::Metadata:
+		file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << r.thread << ",\"args\":{\"name\":";
+		name(r.name);
+		file << "}}";
+		break;
+	}
+}
+
+double TraceWriter::ToMicroseconds(int64_t ticks) const noexcept
+{
+	return double(ticks) * Profiler::Clock::period::num * 1000000.0 / Profiler::Clock::period::den;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streams Chrome Trace Event Format json (chrome://tracing, ui.perfetto.dev) to a file.
+// Batches are handed over once per frame and formatted and written on a background
+// thread, so neither the frame nor memory grows with the length of the capture. When the
+// writer falls behind by more than maxQueuedRecords, new batches are dropped (thread names
+// excepted) and the number lost is written at the end of the trace.
+class TraceWriter
+{
+public:
+	struct Record
+	{
+		enum class Phase : char
+		{
+			Complete = 'X',
+			Counter = 'C',
+			Instant = 'i',
+			Metadata = 'M',
+		};
+		Phase phase;
+		// must outlive the writer, zone names are literals and thread names live in their rings
+		const char* name;
+		uint32_t thread;
+		// profiler clock ticks
+		int64_t start;
+		int64_t duration;
+		// counter value, frame number for instants, unused otherwise
+		int64_t value;
+	};
+public:
+	// origin is the tick that becomes time zero in the trace
+	TraceWriter(const std::string& path, int64_t origin);
+	~TraceWriter();
+	TraceWriter(const TraceWriter&) = delete;
+	TraceWriter& operator=(const TraceWriter&) = delete;
+	// false when the file could not be created, batches are then discarded
+	bool IsOpen() const noexcept;
+	void Submit(std::vector<Record>&& batch);
+	const std::string& GetPath() const noexcept;
+	size_t GetWrittenCount() const noexcept;
+	size_t GetDroppedCount() const noexcept;
+public:
+	static constexpr size_t maxQueuedRecords = 1u << 18;
+private:
+	void Run();
+	void Write(const Record& r);
+	double ToMicroseconds(int64_t ticks) const noexcept;
+private:
+	std::string path;
+	int64_t origin;
+	std::ofstream file;
+	size_t written = 0u;
+	mutable std::mutex mutex;
+	std::condition_variable cv;
+	std::vector<std::vector<Record>> queue;
+	size_t queued = 0u;
+	size_t dropped = 0u;
+	bool done = false;
+	std::thread worker;
+};
@@ -2,4 +2,18 @@ cbuffer TransformCBuf
 {
     matrix modelView;
     matrix modelViewProj;
-};
\ No newline at end of file
+};
+
+// Clip space position of a model space vertex. Shaders whose depth must match a depth
+// pre-pass take SV_Position from here into a precise variable, so both shaders of a pair
+// run the same instructions and none are fused or reordered differently
+float4 ToClip(float3 pos, matrix modelViewProj)
+{
+    return mul(float4(pos, 1.0f), modelViewProj);
+}
+
+// instanced form, through the instance's model view and then the projection
+float4 ToClip(float3 pos, matrix modelView, matrix proj)
+{
+    return mul(mul(float4(pos, 1.0f), modelView), proj);
+}
\ No newline at end of file
@@ -18,6 +18,12 @@ namespace Bind
 		void Bind(Graphics& gfx) noexcept override;
 		void InitializeParentReference(const Drawable& parent) noexcept override;
 		std::unique_ptr<CloningBindable> Clone() const noexcept override;
+		// transforms come from the instance buffer when instanced, so they never split a batch
+		void AppendBatchKey(std::string&) const noexcept override {}
+		bool IsPerInstance() const noexcept override
+		{
+			return true;
+		}
 	protected:
 		void UpdateBindImpl(Graphics& gfx, const Transforms& tf) noexcept;
 		Transforms GetTransforms(Graphics& gfx) noexcept;
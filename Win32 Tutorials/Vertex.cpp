@@ -35,13 +35,30 @@ namespace rsexp
 	{
 		return elements.size();
 	}
-	std::vector<D3D11_INPUT_ELEMENT_DESC> VertexLayout::GetD3DLayout() const noxnd
+	std::vector<D3D11_INPUT_ELEMENT_DESC> VertexLayout::GetD3DLayout(UINT inputSlot, bool perInstance) const noxnd
 	{
 		std::vector<D3D11_INPUT_ELEMENT_DESC> desc;
 		desc.reserve(GetElementCount());
 		for (const auto& e : elements)
 		{
-			desc.push_back(e.GetDesc());
+			auto d = e.GetDesc();
+			d.InputSlot = inputSlot;
+			if (perInstance)
+			{
+				d.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+				d.InstanceDataStepRate = 1u;
+			}
+			desc.push_back(d);
+			// matrices go in as one float4 row per semantic index
+			if (e.GetType() == InstanceTransform)
+			{
+				for (UINT row = 1u; row < 4u; row++)
+				{
+					d.SemanticIndex = row;
+					d.AlignedByteOffset += sizeof(DirectX::XMFLOAT4);
+					desc.push_back(d);
+				}
+			}
 		}
 		return desc;
 	}
@@ -105,18 +122,22 @@ namespace rsexp
 		return Bridge<CodeLookup>(type);
 	}
 
-	template<VertexLayout::ElementType type> struct DescGenerate {
-		static constexpr D3D11_INPUT_ELEMENT_DESC Exec(size_t offset) noexcept {
-			return {
-				VertexLayout::Map<type>::semantic,0,
-				VertexLayout::Map<type>::dxgiFormat,
-				0,(UINT)offset,D3D11_INPUT_PER_VERTEX_DATA,0
-			};
-		}
+	// every element's desc at offset 0, built at compile time so making a layout is a lookup
+	static constexpr D3D11_INPUT_ELEMENT_DESC elementDescs[] = {
+#define X(el) { VertexLayout::Map<VertexLayout::el>::semantic,0,VertexLayout::Map<VertexLayout::el>::dxgiFormat,0,0,D3D11_INPUT_PER_VERTEX_DATA,0 },
+		LAYOUT_ELEMENT_TYPES
+#undef X
 	};
+	const D3D11_INPUT_ELEMENT_DESC& VertexLayout::GetElementDesc(ElementType type) noxnd
+	{
+		assert(type < Count);
+		return elementDescs[type];
+	}
 	D3D11_INPUT_ELEMENT_DESC VertexLayout::Element::GetDesc() const noxnd
 	{
-		return Bridge<DescGenerate>(type, GetOffset());
+		auto desc = GetElementDesc(type);
+		desc.AlignedByteOffset = (UINT)GetOffset();
+		return desc;
 	}
 
 
@@ -149,10 +170,24 @@ namespace rsexp
 			buffer.resize(buffer.size() + layout.Size() * (newSize - size));
 		}
 	}
+	void VertexBuffer::Append(const VertexBuffer& other) noxnd
+	{
+		assert(other.layout.GetCode() == layout.GetCode() && "Appending vertices of a different layout");
+		buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+	}
+	VertexBuffer::VertexBuffer(VertexLayout layout_in, const char* pData, size_t count) noxnd
+		:
+		buffer(pData, pData + layout_in.Size() * count),
+		layout(std::move(layout_in))
+	{}
 	const char* VertexBuffer::GetData() const noxnd
 	{
 		return buffer.data();
 	}
+	char* VertexBuffer::GetData() noxnd
+	{
+		return buffer.data();
+	}
 
 	template<VertexLayout::ElementType type>
 	struct AttributeAiMeshFill
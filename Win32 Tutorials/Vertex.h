@@ -19,6 +19,7 @@
 	X( Float3Color ) \
 	X( Float4Color ) \
 	X( BGRAColor ) \
+	X( InstanceTransform ) \
 	X( Count )
 
 namespace rsexp
@@ -106,6 +107,16 @@ namespace rsexp
 			static constexpr const char* code = "C8";
 			DVTX_ELEMENT_AI_EXTRACTOR(mColors[0])
 		};
+		// per instance model transform, spans one input element per row (semantic index 0-3)
+		template<> struct Map<InstanceTransform>
+		{
+			using SysType = DirectX::XMFLOAT4X4;
+			static constexpr DXGI_FORMAT dxgiFormat = DXGI_FORMAT_R32G32B32A32_FLOAT;
+			static constexpr const char* semantic = "InstanceTransform";
+			static constexpr const char* code = "M4";
+			// meshes don't carry instance data
+			static SysType Extract(const aiMesh&, size_t) noexcept { return {}; }
+		};
 		template<> struct Map<Count>
 		{
 			using SysType = long double;
@@ -161,9 +172,12 @@ namespace rsexp
 		VertexLayout& Append(ElementType type) noxnd;
 		size_t Size() const noxnd;
 		size_t GetElementCount() const noexcept;
-		std::vector<D3D11_INPUT_ELEMENT_DESC> GetD3DLayout() const noxnd;
+		// per instance layouts step once per instance instead of once per vertex
+		std::vector<D3D11_INPUT_ELEMENT_DESC> GetD3DLayout(UINT inputSlot = 0u, bool perInstance = false) const noxnd;
 		std::string GetCode() const noxnd;
 		bool Has(ElementType type) const noexcept;
+		// desc of an element of the type at offset 0 in slot 0
+		static const D3D11_INPUT_ELEMENT_DESC& GetElementDesc(ElementType type) noxnd;
 	private:
 		std::vector<Element> elements;
 	};
@@ -245,9 +259,14 @@ namespace rsexp
 	public:
 		VertexBuffer(VertexLayout layout, size_t size = 0u) noxnd;
 		VertexBuffer(VertexLayout layout, const aiMesh& mesh);
+		// count vertices already laid out as layout
+		VertexBuffer(VertexLayout layout, const char* pData, size_t count) noxnd;
 		const char* GetData() const noxnd;
+		char* GetData() noxnd;
 		const VertexLayout& GetLayout() const noexcept;
 		void Resize(size_t newSize) noxnd;
+		// appends every vertex of a buffer with the same layout
+		void Append(const VertexBuffer& other) noxnd;
 		size_t Size() const noxnd;
 		size_t SizeBytes() const noxnd;
 		template<typename ...Params>
@@ -267,6 +286,40 @@ namespace rsexp
 		std::vector<char> buffer;
 		VertexLayout layout;
 	};
+
+	// One element of every vertex in a buffer, located once rather than on every access like
+	// Vertex::Attr. Not valid when the layout lacks the element, or once the buffer resizes
+	template<VertexLayout::ElementType Type>
+	class ElementView
+	{
+	public:
+		using SysType = typename VertexLayout::Map<Type>::SysType;
+		ElementView(VertexBuffer& vb) noexcept
+			:
+			stride(vb.GetLayout().Size())
+		{
+			const auto& layout = vb.GetLayout();
+			for (size_t i = 0, end = layout.GetElementCount(); i < end; i++)
+			{
+				if (layout.ResolveByIndex(i).GetType() == Type)
+				{
+					pData = vb.GetData() + layout.ResolveByIndex(i).GetOffset();
+				}
+			}
+		}
+		bool IsValid() const noexcept
+		{
+			return pData != nullptr;
+		}
+		SysType& operator[](size_t i) const noxnd
+		{
+			assert(pData != nullptr);
+			return *reinterpret_cast<SysType*>(pData + stride * i);
+		}
+	private:
+		char* pData = nullptr;
+		size_t stride;
+	};
 }
 
 #undef DVTX_ELEMENT_AI_EXTRACTOR
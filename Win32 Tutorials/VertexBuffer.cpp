@@ -25,6 +25,7 @@ namespace Bind
 		D3D11_SUBRESOURCE_DATA sd = {};
 		sd.pSysMem = vbuf.GetData();
 		GFX_THROW_INFO(GetDevice(gfx)->CreateBuffer(&bd, &sd, &pVertexBuffer));
+		gfx.CountResourceCreated();
 	}
 
 	const rsexp::VertexLayout& VertexBuffer::GetLayout() const noexcept
@@ -34,8 +35,7 @@ namespace Bind
 
 	void VertexBuffer::Bind(Graphics& gfx) noexcept
 	{
-		const UINT offset = 0u;
-		GetContext(gfx)->IASetVertexBuffers(0u, 1u, pVertexBuffer.GetAddressOf(), &stride, &offset);
+		gfx.BindVertexBuffer(pVertexBuffer.Get(), stride);
 	}
 	std::shared_ptr<VertexBuffer> VertexBuffer::Resolve(Graphics& gfx, const std::string& tag,
 		const rsexp::VertexBuffer& vbuf)
@@ -2,7 +2,9 @@
 #include "GraphicsThrowMacros.h"
 #include "BindableCodex.h"
 #include <typeinfo>
-#include "RedSkyUtility.h"
+#include "ShaderCache.h"
+#include "ShaderPack.h"
+#include "Vfs.h"
 
 namespace Bind
 {
@@ -12,13 +14,46 @@ namespace Bind
 	{
 		INFOMAN(gfx);
 
-		GFX_THROW_INFO(D3DReadFileToBlob(ToWide(path).c_str(), &pBytecodeBlob));
+		if (const auto pPack = ShaderPack::Get())
+		{
+			bytecode = pPack->Find(path);
+		}
+		if (!bytecode.pData)
+		{
+			const auto file = Vfs::Get().Read(path);
+			if (!file.IsOpen())
+			{
+				GFX_THROW_INFO(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+			}
+			pCodeStorage = file.GetStorage();
+			bytecode = { file.GetData(),file.GetSize() };
+		}
 		GFX_THROW_INFO(GetDevice(gfx)->CreateVertexShader(
-			pBytecodeBlob->GetBufferPointer(),
-			pBytecodeBlob->GetBufferSize(),
+			bytecode.pData,
+			bytecode.size,
 			nullptr,
 			&pVertexShader
 		));
+		gfx.CountResourceCreated();
+	}
+
+	VertexShader::VertexShader(Graphics& gfx, const std::string& family, uint32_t features)
+		:
+		path(ShaderPermutation::GetName(ShaderPermutation::Canonical({ family,ShaderPermutation::Stage::Vertex,features })))
+	{
+		INFOMAN(gfx);
+
+		const auto pCode = ShaderCache::Get().Load({ family,ShaderPermutation::Stage::Vertex,features });
+		pCodeStorage = pCode;
+		bytecode = { pCode->data(),pCode->size() };
+
+		GFX_THROW_INFO(GetDevice(gfx)->CreateVertexShader(
+			bytecode.pData,
+			bytecode.size,
+			nullptr,
+			&pVertexShader
+		));
+		gfx.CountResourceCreated();
 	}
 
 	void VertexShader::Bind(Graphics& gfx) noexcept
@@ -26,19 +61,28 @@ namespace Bind
 		GetContext(gfx)->VSSetShader(pVertexShader.Get(), nullptr, 0u);
 	}
 
-	ID3DBlob* VertexShader::GetBytecode() const noexcept
+	ShaderBytecode VertexShader::GetBytecode() const noexcept
 	{
-		return pBytecodeBlob.Get();
+		return bytecode;
 	}
 	std::shared_ptr<VertexShader> VertexShader::Resolve(Graphics& gfx, const std::string& path)
 	{
 		return Codex::Resolve<VertexShader>(gfx, path);
 	}
+	std::shared_ptr<VertexShader> VertexShader::Resolve(Graphics& gfx, const std::string& family, uint32_t features)
+	{
+		return Codex::Resolve<VertexShader>(gfx, family, features);
+	}
 	std::string VertexShader::GenerateUID(const std::string& path)
 	{
 		using namespace std::string_literals;
 		return typeid(VertexShader).name() + "#"s + path;
 	}
+	std::string VertexShader::GenerateUID(const std::string& family, uint32_t features)
+	{
+		// permutations sharing a canonical key are one shader
+		return GenerateUID(ShaderPermutation::GetName(ShaderPermutation::Canonical({ family,ShaderPermutation::Stage::Vertex,features })));
+	}
 	std::string VertexShader::GetUID() const noexcept
 	{
 		return GenerateUID(path);
@@ -1,20 +1,30 @@
 #pragma once
 #include "Bindable.h"
+#include "ShaderBytecode.h"
+#include <cstdint>
 
 namespace Bind
 {
 	class VertexShader : public Bindable
 	{
 	public:
+		// from the shader pack when it has path, otherwise read through the Vfs
 		VertexShader(Graphics& gfx, const std::string& path);
+		// a permutation of a shader family from ShaderCache, features are ShaderPermutation::Feature bits
+		VertexShader(Graphics& gfx, const std::string& family, uint32_t features);
 		void Bind(Graphics& gfx) noexcept override;
-		ID3DBlob* GetBytecode() const noexcept;
+		// valid for the shader's lifetime
+		ShaderBytecode GetBytecode() const noexcept;
 		static std::shared_ptr<VertexShader> Resolve(Graphics& gfx, const std::string& path);
+		static std::shared_ptr<VertexShader> Resolve(Graphics& gfx, const std::string& family, uint32_t features);
 		static std::string GenerateUID(const std::string& path);
+		static std::string GenerateUID(const std::string& family, uint32_t features);
 		std::string GetUID() const noexcept override;
 	protected:
 		std::string path;
-		Microsoft::WRL::ComPtr<ID3DBlob> pBytecodeBlob;
+		// keeps what bytecode points into alive, a cache buffer or a file read through the Vfs
+		std::shared_ptr<const void> pCodeStorage;
+		ShaderBytecode bytecode;
 		Microsoft::WRL::ComPtr<ID3D11VertexShader> pVertexShader;
 	};
 }
\ No newline at end of file
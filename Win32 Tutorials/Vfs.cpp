@@ -0,0 +1,142 @@
+#include "Vfs.h"
+#include "Lz4.h"
+#include "MappedFile.h"
+#include "PerformanceLog.h"
+#include <filesystem>
+
+bool Vfs::File::IsOpen() const noexcept
+{
+	return pStorage != nullptr;
+}
+
+const char* Vfs::File::GetData() const noexcept
+{
+	return pData;
+}
+
+size_t Vfs::File::GetSize() const noexcept
+{
+	return size;
+}
+
+const std::shared_ptr<const void>& Vfs::File::GetStorage() const noexcept
+{
+	return pStorage;
+}
+
+Vfs::File::File(const char* pData, size_t size, std::shared_ptr<const void> pStorage) noexcept
+	:
+	pData(pData),
+	size(size),
+	pStorage(std::move(pStorage))
+{}
+
+void Vfs::Mount(std::shared_ptr<const AssetArchive> pArchive)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	archives.push_back(std::move(pArchive));
+}
+
+void Vfs::UnmountAll() noexcept
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	archives.clear();
+}
+
+bool Vfs::Exists(const std::string& path) const
+{
+	std::shared_ptr<const AssetArchive> pOwner;
+	if (Find(path, pOwner))
+	{
+		return true;
+	}
+	std::error_code ec;
+	return std::filesystem::is_regular_file(path, ec);
+}
+
+Vfs::File Vfs::Read(const std::string& path) const
+{
+	PROFILE_ZONE("Vfs::Read");
+	std::shared_ptr<const AssetArchive> pOwner;
+	if (const auto pRecord = Find(path, pOwner))
+	{
+		// stored entries are handed out in place, holding the archive keeps its mapping alive
+		if (!pRecord->compressed)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stats.archiveReads++;
+			return { pRecord->pStored,size_t(pRecord->size),std::move(pOwner) };
+		}
+		auto pData = std::make_shared<std::vector<char>>(size_t(pRecord->size));
+		if (!Lz4::Decompress(pRecord->pStored, size_t(pRecord->storedSize), pData->data(), pData->size()))
+		{
+			throw AssetArchive::Exception(__LINE__, __FILE__, "Corrupt archive entry " + std::string(pRecord->name));
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		stats.archiveReads++;
+		stats.decompressedBytes += pData->size();
+		const auto p = pData->data();
+		return { p,pData->size(),std::move(pData) };
+	}
+	auto pFile = std::make_shared<const MappedFile>(path);
+	if (!pFile->IsOpen())
+	{
+		return {};
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	stats.looseReads++;
+	const auto p = pFile->GetData();
+	const auto size = pFile->GetSize();
+	return { p,size,std::move(pFile) };
+}
+
+Vfs::Stats Vfs::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
+
+std::shared_ptr<const AssetArchive> Vfs::OpenArchive(const std::string& path)
+{
+	auto pFile = std::make_shared<const MappedFile>(path);
+	if (!pFile->IsOpen())
+	{
+		return nullptr;
+	}
+	const auto p = pFile->GetData();
+	const auto size = pFile->GetSize();
+	return std::make_shared<const AssetArchive>(p, size, std::move(pFile));
+}
+
+Vfs& Vfs::Get()
+{
+	static Vfs vfs;
+	static std::once_flag mounted;
+	std::call_once(mounted, []()
+	{
+		if (auto pArchive = OpenArchive("Assets.archive"))
+		{
+			vfs.Mount(std::move(pArchive));
+		}
+	});
+	return vfs;
+}
+
+const AssetArchive::Record* Vfs::Find(const std::string& path, std::shared_ptr<const AssetArchive>& pOwner) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (archives.empty())
+	{
+		return nullptr;
+	}
+	const auto name = AssetArchive::Normalize(path);
+	for (auto i = archives.rbegin(); i != archives.rend(); ++i)
+	{
+		if (const auto pRecord = (*i)->Find(name))
+		{
+			pOwner = *i;
+			return pRecord;
+		}
+	}
+	return nullptr;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "AssetArchive.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Where every loader reads its files from. Mounted archives are searched newest first, then
+// the path is read as a loose file, so an archive only needs the assets it ships and loose
+// files keep working while developing. Reads stay in the archive's mapping (or the loose
+// file's own) unless the entry had to be decompressed.
+class Vfs
+{
+public:
+	// contents of one file, valid while any copy of the File is
+	class File
+	{
+		friend class Vfs;
+	public:
+		File() = default;
+		bool IsOpen() const noexcept;
+		const char* GetData() const noexcept;
+		size_t GetSize() const noexcept;
+		// owner of the data, for handing it on to something that keeps it
+		const std::shared_ptr<const void>& GetStorage() const noexcept;
+	private:
+		File(const char* pData, size_t size, std::shared_ptr<const void> pStorage) noexcept;
+	private:
+		const char* pData = nullptr;
+		size_t size = 0u;
+		std::shared_ptr<const void> pStorage;
+	};
+	struct Stats
+	{
+		size_t archiveReads = 0u;
+		size_t looseReads = 0u;
+		size_t decompressedBytes = 0u;
+	};
+public:
+	void Mount(std::shared_ptr<const AssetArchive> pArchive);
+	void UnmountAll() noexcept;
+	bool Exists(const std::string& path) const;
+	// not open when the file is nowhere, callers report that their own way
+	File Read(const std::string& path) const;
+	Stats GetStats() const;
+	// maps the archive, nullptr when there is no such file
+	static std::shared_ptr<const AssetArchive> OpenArchive(const std::string& path);
+	// mounts Assets.archive of the working directory when there is one
+	static Vfs& Get();
+private:
+	const AssetArchive::Record* Find(const std::string& path, std::shared_ptr<const AssetArchive>& pOwner) const;
+private:
+	mutable std::mutex mutex;
+	std::vector<std::shared_ptr<const AssetArchive>> archives;
+	mutable Stats stats;
+};
@@ -0,0 +1,100 @@
+#include "VfsIOSystem.h"
+#include "Vfs.h"
+#include <assimp/IOStream.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	class VfsIOStream : public Assimp::IOStream
+	{
+	public:
+		VfsIOStream(Vfs::File file) noexcept
+			:
+			file(std::move(file))
+		{}
+		size_t Read(void* pvBuffer, size_t pSize, size_t pCount) override
+		{
+			if (pSize == 0u)
+			{
+				return 0u;
+			}
+			const auto count = std::min(pCount, (file.GetSize() - cursor) / pSize);
+			std::memcpy(pvBuffer, file.GetData() + cursor, count * pSize);
+			cursor += count * pSize;
+			return count;
+		}
+		size_t Write(const void*, size_t, size_t) override
+		{
+			return 0u;
+		}
+		aiReturn Seek(size_t pOffset, aiOrigin pOrigin) override
+		{
+			size_t target;
+			switch (pOrigin)
+			{
+			case aiOrigin_SET:
+				target = pOffset;
+				break;
+			case aiOrigin_CUR:
+				target = cursor + pOffset;
+				break;
+			case aiOrigin_END:
+				// the offset is negative, wrapped around
+				target = file.GetSize() + pOffset;
+				break;
+			default:
+				return aiReturn_FAILURE;
+			}
+			if (target > file.GetSize())
+			{
+				return aiReturn_FAILURE;
+			}
+			cursor = target;
+			return aiReturn_SUCCESS;
+		}
+		size_t Tell() const override
+		{
+			return cursor;
+		}
+		size_t FileSize() const override
+		{
+			return file.GetSize();
+		}
+		void Flush() override
+		{}
+	private:
+		Vfs::File file;
+		size_t cursor = 0u;
+	};
+}
+
+bool VfsIOSystem::Exists(const char* pFile) const
+{
+	return Vfs::Get().Exists(pFile);
+}
+
+char VfsIOSystem::getOsSeparator() const
+{
+	// both work for loose files on windows, and archive paths are normalized to it
+	return '/';
+}
+
+Assimp::IOStream* VfsIOSystem::Open(const char* pFile, const char* pMode)
+{
+	if (std::strpbrk(pMode, "wa+") != nullptr)
+	{
+		return nullptr;
+	}
+	auto file = Vfs::Get().Read(pFile);
+	if (!file.IsOpen())
+	{
+		return nullptr;
+	}
+	return new VfsIOStream(std::move(file));
+}
+
+void VfsIOSystem::Close(Assimp::IOStream* pFile)
+{
+	delete pFile;
+}
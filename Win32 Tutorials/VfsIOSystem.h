@@ -0,0 +1,13 @@
+#pragma once
+#include <assimp/IOSystem.hpp>
+
+// Lets assimp read a model and the files it references (.mtl and the like) through the Vfs
+class VfsIOSystem : public Assimp::IOSystem
+{
+public:
+	bool Exists(const char* pFile) const override;
+	char getOsSeparator() const override;
+	// read modes only, writing returns nullptr
+	Assimp::IOStream* Open(const char* pFile, const char* pMode = "rb") override;
+	void Close(Assimp::IOStream* pFile) override;
+};
@@ -1,4 +1,6 @@
 #include "App.h"
+#include "HeadlessBenchmark.h"
+#include "RedSkyUtility.h"
 
 #include <sstream>
 
@@ -10,6 +12,11 @@ int CALLBACK WinMain( //CALLBACK is a modifier which edits how the parameters ar
 	_In_ int nShowCmd					//how the window should be shown for you on startup
 	){
 
+	//headless runs have nobody to click a message box, they report to files instead
+	if (const auto args = TokenizeQuoted(lpCmdLine); !args.empty() && args[0] == "--headless") {
+		return HeadlessBenchmark::RunFromCommandLine(args);
+	}
+
 	try {
 		//creates an instance of the apps class and calls it Go function starting the game loop
 		return App{ lpCmdLine }.Go();
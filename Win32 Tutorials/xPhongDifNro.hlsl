@@ -19,7 +19,7 @@ Texture2D nmap : register(t2);
 SamplerState splr;
 
 
-float4 main( float3 viewFragPos : Position,float3 viewNormal : Normal,float2 tc : Texcoord ) : SV_Target
+float4 main( float3 viewFragPos : Position,float3 viewNormal : Normal,float2 tc : Texcoord,float4 screenPos : SV_Position ) : SV_Target
 {
 	// sample normal from map if normal mapping enabled
     if (normalMapEnabled)
@@ -30,17 +30,25 @@ float4 main( float3 viewFragPos : Position,float3 viewNormal : Normal,float2 tc
         // bring normal from object space into view space
         viewNormal = normalize(mul(objectNormal, (float3x3) modelView));
     }
-	// fragment to light vector data
-    const LightVectorData lv = CalculateLightVectorData(viewLightPos, viewFragPos);
-	// attenuation
-    const float att = Attenuate(attConst, attLin, attQuad, lv.distToL);
-	// diffuse intensity
-    const float3 diffuse = Diffuse(diffuseColor, diffuseIntensity, att, lv.dirToL, viewNormal);
-	// specular
-    const float3 specular = Speculate(
-        specularIntensity.rrr, 1.0f, viewNormal, lv.vToL,
-        viewFragPos, att, specularPower
-    );
+    // sum the lights reaching this pixel's tile
+    float3 diffuse = 0.0f;
+    float3 specular = 0.0f;
+    const uint2 range = TileLightRange(screenPos);
+    for (uint i = 0; i < range.y; i++)
+    {
+        const PointLight light = TileLight(range, i);
+        // fragment to light vector data
+        const LightVectorData lv = CalculateLightVectorData(light.viewLightPos, viewFragPos);
+        // attenuation
+        const float att = Attenuate(light.attConst, light.attLin, light.attQuad, lv.distToL);
+        // diffuse intensity
+        diffuse += Diffuse(light.diffuseColor, light.diffuseIntensity, att, lv.dirToL, viewNormal);
+        // specular
+        specular += Speculate(
+            specularIntensity.rrr, 1.0f, viewNormal, lv.vToL,
+            viewFragPos, att, specularPower
+        );
+    }
 	// final color
 	return float4( saturate( (diffuse + ambient) * tex.Sample( splr, tc ).rgb + specular ), 1.0f );
 }
\ No newline at end of file